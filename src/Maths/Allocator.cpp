@@ -0,0 +1,166 @@
+#include "Allocator.h"
+
+namespace Gum {
+namespace Maths
+{
+    void* alignedAlloc(size_t bytes, size_t alignment)
+    {
+        return ::operator new(alignUp(bytes > 0 ? bytes : 1, alignment), std::align_val_t(alignment));
+    }
+
+    void alignedFree(void* ptr, size_t alignment)
+    {
+        if(ptr != nullptr)
+            ::operator delete(ptr, std::align_val_t(alignment));
+    }
+
+
+    Arena::Arena(size_t blocksize)
+    {
+        this->iBlockSize = alignUp(blocksize, GUM_MATHS_DEFAULT_ALIGNMENT);
+        this->iCurrentBlock = 0;
+        this->iOffset = 0;
+        this->iBytesUsed = 0;
+    }
+
+    Arena::~Arena()
+    {
+        for(Block& block : vBlocks)
+            alignedFree(block.data);
+    }
+
+    void Arena::nextBlock(size_t minsize)
+    {
+        //Reuse blocks left over from previous frames first
+        while(iCurrentBlock + 1 < vBlocks.size())
+        {
+            iCurrentBlock++;
+            iOffset = 0;
+            if(vBlocks[iCurrentBlock].size >= minsize)
+                return;
+        }
+
+        size_t size = minsize > iBlockSize ? alignUp(minsize, GUM_MATHS_DEFAULT_ALIGNMENT) : iBlockSize;
+        vBlocks.push_back({ (char*)alignedAlloc(size), size });
+        iCurrentBlock = vBlocks.size() - 1;
+        iOffset = 0;
+    }
+
+    void* Arena::allocate(size_t bytes, size_t alignment)
+    {
+        if(vBlocks.empty())
+            nextBlock(bytes);
+
+        size_t offset = alignUp((size_t)(vBlocks[iCurrentBlock].data + iOffset), alignment) - (size_t)vBlocks[iCurrentBlock].data;
+        if(offset + bytes > vBlocks[iCurrentBlock].size)
+        {
+            //Blocks are aligned to GUM_MATHS_DEFAULT_ALIGNMENT, add slack for larger alignments
+            nextBlock(bytes + (alignment > GUM_MATHS_DEFAULT_ALIGNMENT ? alignment : 0));
+            offset = alignUp((size_t)vBlocks[iCurrentBlock].data, alignment) - (size_t)vBlocks[iCurrentBlock].data;
+        }
+
+        iOffset = offset + bytes;
+        iBytesUsed += bytes;
+        return vBlocks[iCurrentBlock].data + offset;
+    }
+
+    void Arena::reset()
+    {
+        iCurrentBlock = 0;
+        iOffset = 0;
+        iBytesUsed = 0;
+    }
+
+    void Arena::shrink()
+    {
+        for(size_t i = 1; i < vBlocks.size(); i++)
+            alignedFree(vBlocks[i].data);
+        if(vBlocks.size() > 1)
+            vBlocks.resize(1);
+        reset();
+    }
+
+    size_t Arena::getBytesReserved() const
+    {
+        size_t reserved = 0;
+        for(const Block& block : vBlocks)
+            reserved += block.size;
+        return reserved;
+    }
+
+
+    PoolResource::PoolResource(size_t chunksize)
+    {
+        this->iChunkSize = chunksize > 0 ? chunksize : 1;
+    }
+
+    PoolResource::~PoolResource()
+    {
+        for(SizeClass& sizeClass : vClasses)
+        {
+            if(sizeClass.numAllocated > 0)
+                std::cerr << "GumMaths: PoolResource destroyed with " << sizeClass.numAllocated << " objects of " << sizeClass.size << " bytes still allocated" << std::endl;
+            for(void* chunk : sizeClass.chunks)
+                alignedFree(chunk, sizeClass.alignment);
+        }
+    }
+
+    PoolResource::SizeClass& PoolResource::getClass(size_t bytes, size_t alignment)
+    {
+        //Slots hold the free list link while unused
+        if(alignment < alignof(void*))
+            alignment = alignof(void*);
+        size_t size = alignUp(bytes > sizeof(void*) ? bytes : sizeof(void*), alignment);
+
+        //Containers only use a few node sizes, a linear search is fine
+        for(SizeClass& sizeClass : vClasses)
+            if(sizeClass.size == size && sizeClass.alignment == alignment)
+                return sizeClass;
+        vClasses.push_back({ size, alignment, nullptr, 0, {} });
+        return vClasses.back();
+    }
+
+    void* PoolResource::allocate(size_t bytes, size_t alignment)
+    {
+        SizeClass& sizeClass = getClass(bytes, alignment);
+        if(sizeClass.freeList == nullptr)
+        {
+            char* chunk = (char*)alignedAlloc(sizeClass.size * iChunkSize, sizeClass.alignment);
+            sizeClass.chunks.push_back(chunk);
+            for(size_t i = 0; i < iChunkSize; i++)
+                *(void**)(chunk + i * sizeClass.size) = i + 1 < iChunkSize ? chunk + (i + 1) * sizeClass.size : nullptr;
+            sizeClass.freeList = chunk;
+        }
+
+        void* slot = sizeClass.freeList;
+        sizeClass.freeList = *(void**)slot;
+        sizeClass.numAllocated++;
+        return slot;
+    }
+
+    void PoolResource::deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        if(ptr == nullptr)
+            return;
+        SizeClass& sizeClass = getClass(bytes, alignment);
+        *(void**)ptr = sizeClass.freeList;
+        sizeClass.freeList = ptr;
+        sizeClass.numAllocated--;
+    }
+
+    size_t PoolResource::getNumAllocated() const
+    {
+        size_t allocated = 0;
+        for(const SizeClass& sizeClass : vClasses)
+            allocated += sizeClass.numAllocated;
+        return allocated;
+    }
+
+    size_t PoolResource::getBytesReserved() const
+    {
+        size_t reserved = 0;
+        for(const SizeClass& sizeClass : vClasses)
+            reserved += sizeClass.chunks.size() * sizeClass.size * iChunkSize;
+        return reserved;
+    }
+}}
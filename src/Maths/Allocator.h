@@ -0,0 +1,272 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <iostream>
+
+#define GUM_MATHS_DEFAULT_ALIGNMENT 64 //One cache line, enough for AVX-512 loads
+
+namespace Gum {
+namespace Maths
+{
+    static inline size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    extern void* alignedAlloc(size_t bytes, size_t alignment = GUM_MATHS_DEFAULT_ALIGNMENT);
+    extern void alignedFree(void* ptr, size_t alignment = GUM_MATHS_DEFAULT_ALIGNMENT);
+
+
+    /**
+     * STL allocator returning memory aligned to Alignment bytes
+     * dmatrix keeps its storage and GEMM packing buffers in aligned_vector. The batch functions take
+     * pointers or spans, so vectors using any allocator in this file can be passed to them directly
+     *
+     * std::vector<mat4, AlignedAllocator<mat4>> matrices(1024);
+     * Gum::Maths::aligned_vector<vec3> points(1024);
+     * Gum::Maths::transformPoints(model, points.data(), points.data(), points.size());
+     */
+    template<typename T, size_t Alignment = GUM_MATHS_DEFAULT_ALIGNMENT>
+    struct AlignedAllocator
+    {
+        static_assert((Alignment & (Alignment - 1)) == 0, "AlignedAllocator: Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "AlignedAllocator: Alignment is smaller than the types alignment");
+
+        typedef T value_type;
+        template<typename U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+        AlignedAllocator() noexcept {}
+        template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            if(n > std::numeric_limits<size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+            return (T*)alignedAlloc(n * sizeof(T), Alignment);
+        }
+
+        void deallocate(T* ptr, size_t n) noexcept { alignedFree(ptr, Alignment); }
+
+        template<typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true;  }
+        template<typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+    };
+
+    template<typename T>
+    using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+
+    /**
+     * Bump allocator for per-frame scratch memory
+     * Allocations are never freed individually, reset() releases everything at once
+     * and keeps the memory blocks around for the next frame.
+     */
+    class Arena
+    {
+    private:
+        struct Block
+        {
+            char* data;
+            size_t size;
+        };
+        std::vector<Block> vBlocks;
+        size_t iCurrentBlock;
+        size_t iOffset;
+        size_t iBlockSize;
+        size_t iBytesUsed;
+
+        void nextBlock(size_t minsize);
+
+    public:
+        Arena(size_t blocksize = 1 << 20);
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        ~Arena();
+
+        void* allocate(size_t bytes, size_t alignment = GUM_MATHS_DEFAULT_ALIGNMENT);
+
+        template<typename T>
+        T* allocate(size_t count)
+        {
+            return (T*)allocate(count * sizeof(T), alignof(T) > GUM_MATHS_DEFAULT_ALIGNMENT ? alignof(T) : GUM_MATHS_DEFAULT_ALIGNMENT);
+        }
+
+        //Releases all allocations, blocks are kept for reuse
+        void reset();
+        //Frees all blocks except the first one
+        void shrink();
+
+        size_t getBytesUsed() const     { return iBytesUsed; }
+        size_t getBytesReserved() const;
+    };
+
+    /**
+     * STL adaptor for Arena, deallocate is a no-op
+     *
+     * Gum::Maths::Arena frameArena;
+     * std::vector<mat4, ArenaAllocator<mat4>> transforms(ArenaAllocator<mat4>(&frameArena));
+     */
+    template<typename T>
+    struct ArenaAllocator
+    {
+        typedef T value_type;
+        template<typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+        Arena* pArena;
+
+        ArenaAllocator(Arena* arena) noexcept : pArena(arena) {}
+        template<typename U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept : pArena(other.pArena) {}
+
+        T* allocate(size_t n)                   { return pArena->allocate<T>(n); }
+        void deallocate(T* ptr, size_t n) noexcept {}
+
+        template<typename U> bool operator==(const ArenaAllocator<U>& other) const noexcept { return pArena == other.pArena; }
+        template<typename U> bool operator!=(const ArenaAllocator<U>& other) const noexcept { return pArena != other.pArena; }
+    };
+
+
+    /**
+     * Fixed size object pool, objects are handed out from aligned chunks through a free list
+     *
+     * Gum::Maths::Pool<mat4> pool;
+     * mat4* m = pool.create();
+     * pool.destroy(m);
+     */
+    template<typename T, size_t ChunkSize = 256>
+    class Pool
+    {
+    private:
+        union Slot
+        {
+            Slot* next;
+            alignas(T) char storage[sizeof(T)];
+        };
+        std::vector<Slot*> vChunks;
+        Slot* pFreeList = nullptr;
+        size_t iNumAllocated = 0;
+
+        void grow()
+        {
+            Slot* chunk = (Slot*)alignedAlloc(ChunkSize * sizeof(Slot), alignof(Slot) > GUM_MATHS_DEFAULT_ALIGNMENT ? alignof(Slot) : GUM_MATHS_DEFAULT_ALIGNMENT);
+            vChunks.push_back(chunk);
+            for(size_t i = 0; i < ChunkSize; i++)
+                chunk[i].next = i + 1 < ChunkSize ? &chunk[i + 1] : pFreeList;
+            pFreeList = chunk;
+        }
+
+    public:
+        Pool() {}
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+        ~Pool()
+        {
+            if(iNumAllocated > 0)
+                std::cerr << "GumMaths: Pool destroyed with " << iNumAllocated << " objects still allocated" << std::endl;
+            for(Slot* chunk : vChunks)
+                alignedFree(chunk, alignof(Slot) > GUM_MATHS_DEFAULT_ALIGNMENT ? alignof(Slot) : GUM_MATHS_DEFAULT_ALIGNMENT);
+        }
+
+        //Raw storage for one object, not constructed
+        T* allocate()
+        {
+            if(pFreeList == nullptr)
+                grow();
+            Slot* slot = pFreeList;
+            pFreeList = slot->next;
+            iNumAllocated++;
+            return (T*)slot->storage;
+        }
+
+        void deallocate(T* ptr)
+        {
+            Slot* slot = (Slot*)ptr;
+            slot->next = pFreeList;
+            pFreeList = slot;
+            iNumAllocated--;
+        }
+
+        template<typename... Args>
+        T* create(Args&&... args)   { return new(allocate()) T(std::forward<Args>(args)...); }
+        void destroy(T* ptr)        { ptr->~T(); deallocate(ptr); }
+
+        size_t getNumAllocated() const { return iNumAllocated; }
+        size_t getCapacity() const     { return vChunks.size() * ChunkSize; }
+    };
+
+    /**
+     * Pools for any object size, for allocators that get rebound to types they do not know in advance
+     * Every slot size (and alignment) gets its own free list, memory is only returned in the destructor.
+     * Not thread safe, like Arena. Everything allocated from it has to be freed before it is destroyed.
+     */
+    class PoolResource
+    {
+    private:
+        struct SizeClass
+        {
+            size_t size;
+            size_t alignment;
+            void* freeList;
+            size_t numAllocated;
+            std::vector<void*> chunks;
+        };
+        std::vector<SizeClass> vClasses;
+        size_t iChunkSize;
+
+        SizeClass& getClass(size_t bytes, size_t alignment);
+
+    public:
+        //chunksize is the amount of slots every chunk holds
+        PoolResource(size_t chunksize = 256);
+        PoolResource(const PoolResource&) = delete;
+        PoolResource& operator=(const PoolResource&) = delete;
+        ~PoolResource();
+
+        void* allocate(size_t bytes, size_t alignment);
+        void deallocate(void* ptr, size_t bytes, size_t alignment);
+
+        size_t getNumAllocated() const;
+        size_t getBytesReserved() const;
+    };
+
+    /**
+     * STL adaptor for PoolResource, meant for node based containers (std::list, std::map, ...)
+     * Single object allocations come from the pools, arrays fall back to aligned allocations.
+     * Copies and rebinds share the resource, so a container can be freed on any thread as long
+     * as the resource is not used by two threads at once
+     *
+     * Gum::Maths::PoolResource nodes;
+     * std::list<vec3, PoolAllocator<vec3>> points(PoolAllocator<vec3>(&nodes));
+     */
+    template<typename T>
+    struct PoolAllocator
+    {
+        typedef T value_type;
+        template<typename U> struct rebind { typedef PoolAllocator<U> other; };
+
+        PoolResource* pResource;
+
+        PoolAllocator(PoolResource* resource) noexcept : pResource(resource) {}
+        template<typename U> PoolAllocator(const PoolAllocator<U>& other) noexcept : pResource(other.pResource) {}
+
+        T* allocate(size_t n)
+        {
+            if(n == 1)
+                return (T*)pResource->allocate(sizeof(T), alignof(T));
+            return AlignedAllocator<T>().allocate(n);
+        }
+
+        void deallocate(T* ptr, size_t n) noexcept
+        {
+            if(n == 1)
+                pResource->deallocate(ptr, sizeof(T), alignof(T));
+            else
+                AlignedAllocator<T>().deallocate(ptr, n);
+        }
+
+        template<typename U> bool operator==(const PoolAllocator<U>& other) const noexcept { return pResource == other.pResource; }
+        template<typename U> bool operator!=(const PoolAllocator<U>& other) const noexcept { return pResource != other.pResource; }
+    };
+}}
@@ -0,0 +1,502 @@
+#include "ArrayFunctions.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace Gum {
+namespace Maths
+{
+    static const size_t REDUCE_GRAIN = 1 << 14;          //Smallest amount of elements per parallel chunk
+    static const size_t BLOCK_SIZE = 2048;               //Elements per float sum block and per argMin/argMax candidate
+    static const size_t RADIX_PARALLEL_THRESHOLD = 1 << 16;
+    static const unsigned int RADIX_BITS = 11;
+    static const unsigned int RADIX_BUCKETS = 1u << RADIX_BITS;
+
+    //Identities of maximum and minimum
+    template<typename T> static T lowestValue()  { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+    template<typename T> static T highestValue() { return std::numeric_limits<T>::has_infinity ?  std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+
+    //Keep acc if x is NaN, min_ps and max_ps return their second operand if either one is NaN
+    template<typename T> static inline T minOf(T acc, T x) { return x < acc ? x : acc; }
+    template<typename T> static inline T maxOf(T acc, T x) { return x > acc ? x : acc; }
+    static inline vfloat minOf(vfloat acc, vfloat x)       { return min(x, acc); }
+    static inline vfloat maxOf(vfloat acc, vfloat x)       { return max(x, acc); }
+
+
+    /**
+     * Block kernels over count vectors of S components, read as one flat array
+     * The flat array is walked in steps of a whole number of vectors spread over several accumulators,
+     * so every lane always sees the same component and the accumulators do not wait on each other.
+     */
+    template<unsigned int S>
+    static void minMaxBlock(const float* data, size_t count, float* lo, float* hi)
+    {
+        const unsigned int W = vfloat::width, R = S == 3 ? 3 : 4, STEP = R * W;
+        const size_t total = count * S;
+        vfloat accLo[R], accHi[R];
+        for(unsigned int r = 0; r < R; r++)
+        {
+            accLo[r] = vfloat(highestValue<float>());
+            accHi[r] = vfloat(lowestValue<float>());
+        }
+
+        size_t i = 0;
+        for(; i + STEP <= total; i += STEP)
+        {
+            for(unsigned int r = 0; r < R; r++)
+            {
+                vfloat x = vfloat::load(data + i + r * W);
+                accLo[r] = minOf(accLo[r], x);
+                accHi[r] = maxOf(accHi[r], x);
+            }
+        }
+
+        alignas(64) float lanesLo[STEP], lanesHi[STEP];
+        for(unsigned int r = 0; r < R; r++)
+        {
+            accLo[r].storeAligned(lanesLo + r * W);
+            accHi[r].storeAligned(lanesHi + r * W);
+        }
+        for(unsigned int c = 0; c < S; c++)
+        {
+            lo[c] = highestValue<float>();
+            hi[c] = lowestValue<float>();
+        }
+        for(unsigned int l = 0; l < STEP; l++)
+        {
+            lo[l % S] = minOf(lo[l % S], lanesLo[l]);
+            hi[l % S] = maxOf(hi[l % S], lanesHi[l]);
+        }
+        for(; i < total; i++)
+        {
+            lo[i % S] = minOf(lo[i % S], data[i]);
+            hi[i % S] = maxOf(hi[i % S], data[i]);
+        }
+    }
+
+    template<unsigned int S, typename T>
+    static void minMaxBlock(const T* data, size_t count, T* lo, T* hi)
+    {
+        const unsigned int STEP = 4 * S;
+        const size_t total = count * S;
+        T accLo[STEP], accHi[STEP];
+        for(unsigned int l = 0; l < STEP; l++)
+        {
+            accLo[l] = highestValue<T>();
+            accHi[l] = lowestValue<T>();
+        }
+
+        size_t i = 0;
+        for(; i + STEP <= total; i += STEP)
+        {
+            for(unsigned int l = 0; l < STEP; l++)
+            {
+                accLo[l] = minOf(accLo[l], data[i + l]);
+                accHi[l] = maxOf(accHi[l], data[i + l]);
+            }
+        }
+
+        for(unsigned int c = 0; c < S; c++)
+        {
+            lo[c] = highestValue<T>();
+            hi[c] = lowestValue<T>();
+        }
+        for(unsigned int l = 0; l < STEP; l++)
+        {
+            lo[l % S] = minOf(lo[l % S], accLo[l]);
+            hi[l % S] = maxOf(hi[l % S], accHi[l]);
+        }
+        for(; i < total; i++)
+        {
+            lo[i % S] = minOf(lo[i % S], data[i]);
+            hi[i % S] = maxOf(hi[i % S], data[i]);
+        }
+    }
+
+    //Adds the block to result, float lanes only ever hold the sum of one block
+    template<unsigned int S>
+    static void sumBlock(const float* data, size_t count, double* result)
+    {
+        const unsigned int W = vfloat::width, R = S == 3 ? 3 : 4, STEP = R * W;
+        const size_t total = count * S;
+        vfloat acc[R];
+        for(unsigned int r = 0; r < R; r++)
+            acc[r] = vfloat(0.0f);
+
+        size_t i = 0;
+        for(; i + STEP <= total; i += STEP)
+            for(unsigned int r = 0; r < R; r++)
+                acc[r] = acc[r] + vfloat::load(data + i + r * W);
+
+        alignas(64) float lanes[STEP];
+        for(unsigned int r = 0; r < R; r++)
+            acc[r].storeAligned(lanes + r * W);
+        for(unsigned int l = 0; l < STEP; l++)
+            result[l % S] += lanes[l];
+        for(; i < total; i++)
+            result[i % S] += data[i];
+    }
+
+    template<unsigned int S, typename T, typename A>
+    static void sumBlock(const T* data, size_t count, A* result)
+    {
+        const unsigned int STEP = 4 * S;
+        const size_t total = count * S;
+        A acc[STEP] = {};
+
+        size_t i = 0;
+        for(; i + STEP <= total; i += STEP)
+            for(unsigned int l = 0; l < STEP; l++)
+                acc[l] += (A)data[i + l];
+
+        for(unsigned int l = 0; l < STEP; l++)
+            result[l % S] += acc[l];
+        for(; i < total; i++)
+            result[i % S] += (A)data[i];
+    }
+
+
+    /**
+     * Parallel reductions, chunks are folded block by block
+     */
+    template<unsigned int S, typename T>
+    static void minMax(const T* data, size_t count, T* lo, T* hi)
+    {
+        typedef std::array<T, 2 * S> Range; //Minimum components followed by the maximum ones
+        Range identity;
+        for(unsigned int c = 0; c < S; c++)
+        {
+            identity[c] = highestValue<T>();
+            identity[S + c] = lowestValue<T>();
+        }
+
+        Range result = parallelReduce(0, count, identity, [data](size_t b, size_t e, Range acc) {
+            T blockLo[S], blockHi[S];
+            minMaxBlock<S>(data + b * S, e - b, blockLo, blockHi);
+            for(unsigned int c = 0; c < S; c++)
+            {
+                acc[c] = minOf(acc[c], blockLo[c]);
+                acc[S + c] = maxOf(acc[S + c], blockHi[c]);
+            }
+            return acc;
+        }, [](Range a, const Range& b) {
+            for(unsigned int c = 0; c < S; c++)
+            {
+                a[c] = minOf(a[c], b[c]);
+                a[S + c] = maxOf(a[S + c], b[S + c]);
+            }
+            return a;
+        }, REDUCE_GRAIN);
+
+        for(unsigned int c = 0; c < S; c++)
+        {
+            lo[c] = result[c];
+            hi[c] = result[S + c];
+        }
+    }
+
+    template<unsigned int S, typename T, typename A>
+    static void sumOf(const T* data, size_t count, A* out)
+    {
+        typedef std::array<A, S> Sums;
+        Sums result = parallelReduce(0, count, Sums{}, [data](size_t b, size_t e, Sums acc) {
+            for(size_t block = b; block < e; block += BLOCK_SIZE)
+                sumBlock<S>(data + block * S, std::min(BLOCK_SIZE, e - block), acc.data());
+            return acc;
+        }, [](Sums a, const Sums& b) {
+            for(unsigned int c = 0; c < S; c++)
+                a[c] += b[c];
+            return a;
+        }, REDUCE_GRAIN);
+
+        for(unsigned int c = 0; c < S; c++)
+            out[c] = result[c];
+    }
+
+    /**
+     * Every block only gets searched for the position of its extreme if that beats the current candidate,
+     * ties go to the lower index so the result does not depend on how the chunks were scheduled
+     */
+    template<bool Largest, typename T>
+    static size_t argExtreme(const T* data, size_t count)
+    {
+        typedef std::pair<T, size_t> Candidate;
+        auto better = [](const Candidate& a, const Candidate& b) {
+            return (Largest ? a.first > b.first : a.first < b.first) || (a.first == b.first && a.second < b.second);
+        };
+
+        Candidate identity(Largest ? lowestValue<T>() : highestValue<T>(), count);
+        Candidate result = parallelReduce(0, count, identity, [data, better](size_t b, size_t e, Candidate acc) {
+            for(size_t block = b; block < e; block += BLOCK_SIZE)
+            {
+                size_t end = std::min(block + BLOCK_SIZE, e);
+                T lo, hi;
+                minMaxBlock<1>(data + block, end - block, &lo, &hi);
+                Candidate extreme(Largest ? hi : lo, block);
+                if(!better(extreme, acc))
+                    continue;
+
+                //Not found if the block is all NaN
+                for(size_t i = block; i < end; i++)
+                {
+                    if(data[i] == extreme.first)
+                    {
+                        acc = Candidate(extreme.first, i);
+                        break;
+                    }
+                }
+            }
+            return acc;
+        }, [better](const Candidate& a, const Candidate& b) { return better(b, a) ? b : a; }, REDUCE_GRAIN);
+
+        return result.second;
+    }
+
+    template<unsigned int S>
+    static tvec<float, S> toVec(const float* components)
+    {
+        tvec<float, S> v;
+        for(unsigned int c = 0; c < S; c++)
+            v[c] = components[c];
+        return v;
+    }
+
+    template<unsigned int S>
+    static tvec<float, S> minimumOf(span<const tvec<float, S>> values)
+    {
+        float lo[S], hi[S];
+        minMax<S>((const float*)values.data(), values.size(), lo, hi);
+        return toVec<S>(lo);
+    }
+
+    template<unsigned int S>
+    static tvec<float, S> maximumOf(span<const tvec<float, S>> values)
+    {
+        float lo[S], hi[S];
+        minMax<S>((const float*)values.data(), values.size(), lo, hi);
+        return toVec<S>(hi);
+    }
+
+    template<unsigned int S>
+    static tvec<float, S> sumOf(span<const tvec<float, S>> values)
+    {
+        double sums[S];
+        sumOf<S>((const float*)values.data(), values.size(), sums);
+        float components[S];
+        for(unsigned int c = 0; c < S; c++)
+            components[c] = (float)sums[c];
+        return toVec<S>(components);
+    }
+
+    template<unsigned int S>
+    static tbbox<float, S> boundsOf(span<const tvec<float, S>> points)
+    {
+        float lo[S], hi[S];
+        minMax<S>((const float*)points.data(), points.size(), lo, hi);
+        tvec<float, S> min = toVec<S>(lo);
+        return tbbox<float, S>(min, toVec<S>(hi) - min);
+    }
+
+    template<typename T>
+    static T minimumOf(span<const T> values)
+    {
+        T lo, hi;
+        minMax<1>(values.data(), values.size(), &lo, &hi);
+        return lo;
+    }
+
+    template<typename T>
+    static T maximumOf(span<const T> values)
+    {
+        T lo, hi;
+        minMax<1>(values.data(), values.size(), &lo, &hi);
+        return hi;
+    }
+
+
+    float    minimum(span<const float> values)    { return minimumOf(values); }
+    double   minimum(span<const double> values)   { return minimumOf(values); }
+    int32_t  minimum(span<const int32_t> values)  { return minimumOf(values); }
+    uint32_t minimum(span<const uint32_t> values) { return minimumOf(values); }
+
+    float    maximum(span<const float> values)    { return maximumOf(values); }
+    double   maximum(span<const double> values)   { return maximumOf(values); }
+    int32_t  maximum(span<const int32_t> values)  { return maximumOf(values); }
+    uint32_t maximum(span<const uint32_t> values) { return maximumOf(values); }
+
+    float    sum(span<const float> values)        { double s;   sumOf<1>(values.data(), values.size(), &s); return (float)s; }
+    double   sum(span<const double> values)       { double s;   sumOf<1>(values.data(), values.size(), &s); return s; }
+    int64_t  sum(span<const int32_t> values)      { int64_t s;  sumOf<1>(values.data(), values.size(), &s); return s; }
+    uint64_t sum(span<const uint32_t> values)     { uint64_t s; sumOf<1>(values.data(), values.size(), &s); return s; }
+
+    size_t argMin(span<const float> values)       { return argExtreme<false>(values.data(), values.size()); }
+    size_t argMin(span<const double> values)      { return argExtreme<false>(values.data(), values.size()); }
+    size_t argMin(span<const int32_t> values)     { return argExtreme<false>(values.data(), values.size()); }
+    size_t argMin(span<const uint32_t> values)    { return argExtreme<false>(values.data(), values.size()); }
+
+    size_t argMax(span<const float> values)       { return argExtreme<true>(values.data(), values.size()); }
+    size_t argMax(span<const double> values)      { return argExtreme<true>(values.data(), values.size()); }
+    size_t argMax(span<const int32_t> values)     { return argExtreme<true>(values.data(), values.size()); }
+    size_t argMax(span<const uint32_t> values)    { return argExtreme<true>(values.data(), values.size()); }
+
+    vec2 minimum(span<const vec2> values)         { return minimumOf<2>(values); }
+    vec3 minimum(span<const vec3> values)         { return minimumOf<3>(values); }
+    vec4 minimum(span<const vec4> values)         { return minimumOf<4>(values); }
+    vec2 maximum(span<const vec2> values)         { return maximumOf<2>(values); }
+    vec3 maximum(span<const vec3> values)         { return maximumOf<3>(values); }
+    vec4 maximum(span<const vec4> values)         { return maximumOf<4>(values); }
+    vec2 sum(span<const vec2> values)             { return sumOf<2>(values); }
+    vec3 sum(span<const vec3> values)             { return sumOf<3>(values); }
+    vec4 sum(span<const vec4> values)             { return sumOf<4>(values); }
+
+    bbox2 bounds(span<const vec2> points)         { return boundsOf<2>(points); }
+    bbox3 bounds(span<const vec3> points)         { return boundsOf<3>(points); }
+
+
+    //Moves [begin, end) to the cursors of their digits
+    template<bool Values, typename K>
+    static void scatter(const K* srcKeys, K* dstKeys, const uint32_t* srcValues, uint32_t* dstValues, size_t begin, size_t end, unsigned int shift, size_t* cursors)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            K key = srcKeys[i];
+            size_t position = cursors[(key >> shift) & (RADIX_BUCKETS - 1)]++;
+            dstKeys[position] = key;
+            if(Values)
+                dstValues[position] = srcValues[i];
+        }
+    }
+
+    /**
+     * The array is split into one chunk per worker. Every pass counts the digits of each chunk,
+     * turns the counts into write cursors (digit major, so chunks keep their order within a digit)
+     * and scatters all chunks at once. Serial sorts count all passes in one read up front.
+     */
+    template<typename K>
+    static void radixSortImpl(K* keys, uint32_t* values, size_t count)
+    {
+        if(count < 2)
+            return;
+
+        const unsigned int PASSES = (sizeof(K) * 8 + RADIX_BITS - 1) / RADIX_BITS;
+        ThreadPool& pool = ThreadPool::getDefault();
+        const size_t chunks = count >= RADIX_PARALLEL_THRESHOLD ? pool.numWorkers() : 1;
+        const size_t chunkSize = (count + chunks - 1) / chunks;
+
+        //[chunk][pass][digit]
+        std::vector<size_t> histograms(chunks * PASSES * RADIX_BUCKETS, 0);
+        auto histogram = [&histograms](size_t chunk, unsigned int pass) { return histograms.data() + (chunk * PASSES + pass) * RADIX_BUCKETS; };
+
+        pool.parallelFor(0, chunks, [&](size_t b, size_t e, unsigned int) {
+            for(size_t c = b; c < e; c++)
+            {
+                const size_t end = std::min(count, (c + 1) * chunkSize);
+                size_t* counts = histogram(c, 0);
+                for(size_t i = c * chunkSize; i < end; i++)
+                    for(unsigned int pass = 0; pass < PASSES; pass++)
+                        counts[pass * RADIX_BUCKETS + ((keys[i] >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+            }
+        }, 1);
+
+        //Passes where every key has the same digit would not move anything
+        bool needed[PASSES];
+        for(unsigned int pass = 0; pass < PASSES; pass++)
+        {
+            needed[pass] = true;
+            for(unsigned int d = 0; d < RADIX_BUCKETS && needed[pass]; d++)
+            {
+                size_t total = 0;
+                for(size_t c = 0; c < chunks; c++)
+                    total += histogram(c, pass)[d];
+                needed[pass] = total != count;
+            }
+        }
+
+        std::unique_ptr<K[]> keyBuffer(new K[count]);
+        std::unique_ptr<uint32_t[]> valueBuffer(values != nullptr ? new uint32_t[count] : nullptr);
+        K* srcKeys = keys;
+        K* dstKeys = keyBuffer.get();
+        uint32_t* srcValues = values;
+        uint32_t* dstValues = valueBuffer.get();
+        bool moved = false;
+
+        for(unsigned int pass = 0; pass < PASSES; pass++)
+        {
+            if(!needed[pass])
+                continue;
+            const unsigned int shift = pass * RADIX_BITS;
+
+            //Chunks hold different keys after the first scatter
+            if(moved && chunks > 1)
+            {
+                pool.parallelFor(0, chunks, [&](size_t b, size_t e, unsigned int) {
+                    for(size_t c = b; c < e; c++)
+                    {
+                        const size_t end = std::min(count, (c + 1) * chunkSize);
+                        size_t* counts = histogram(c, pass);
+                        std::fill(counts, counts + RADIX_BUCKETS, 0);
+                        for(size_t i = c * chunkSize; i < end; i++)
+                            counts[(srcKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                    }
+                }, 1);
+            }
+
+            size_t offset = 0;
+            for(unsigned int d = 0; d < RADIX_BUCKETS; d++)
+            {
+                for(size_t c = 0; c < chunks; c++)
+                {
+                    size_t& cursor = histogram(c, pass)[d];
+                    size_t n = cursor;
+                    cursor = offset;
+                    offset += n;
+                }
+            }
+
+            pool.parallelFor(0, chunks, [&](size_t b, size_t e, unsigned int) {
+                for(size_t c = b; c < e; c++)
+                {
+                    const size_t begin = c * chunkSize, end = std::min(count, begin + chunkSize);
+                    if(srcValues != nullptr) scatter<true>(srcKeys, dstKeys, srcValues, dstValues, begin, end, shift, histogram(c, pass));
+                    else                     scatter<false>(srcKeys, dstKeys, srcValues, dstValues, begin, end, shift, histogram(c, pass));
+                }
+            }, 1);
+
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+            moved = true;
+        }
+
+        //Odd amount of passes, the result is in the buffer
+        if(srcKeys != keys)
+        {
+            parallelFor(0, count, [&](size_t b, size_t e) {
+                memcpy(keys + b, srcKeys + b, (e - b) * sizeof(K));
+                if(values != nullptr)
+                    memcpy(values + b, srcValues + b, (e - b) * sizeof(uint32_t));
+            }, RADIX_PARALLEL_THRESHOLD);
+        }
+    }
+
+    template<typename K>
+    static void radixSortChecked(span<K> keys, span<uint32_t> values)
+    {
+        if(values.size() != keys.size())
+        {
+            std::cerr << "GumMaths: radixSort got " << values.size() << " values for " << keys.size() << " keys" << std::endl;
+            return;
+        }
+        radixSortImpl(keys.data(), values.data(), keys.size());
+    }
+
+    void radixSort(span<uint32_t> keys)                         { radixSortImpl(keys.data(), (uint32_t*)nullptr, keys.size()); }
+    void radixSort(span<uint64_t> keys)                         { radixSortImpl(keys.data(), (uint32_t*)nullptr, keys.size()); }
+    void radixSort(span<uint32_t> keys, span<uint32_t> values)  { radixSortChecked(keys, values); }
+    void radixSort(span<uint64_t> keys, span<uint32_t> values)  { radixSortChecked(keys, values); }
+}}
@@ -0,0 +1,74 @@
+#pragma once
+#include "bbox.h"
+#include "Span.h"
+#include <cstdint>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Reductions over large arrays, split across the default ThreadPool
+     * float arrays are processed with the widest vfloat the target supports, the other types with
+     * several independent accumulators. minimum, maximum, argMin, argMax and bounds skip NaN values.
+     * Empty (or all NaN) arrays give the identity of the reduction: infinity for minimum, -infinity for
+     * maximum (the limits of the type for integers), 0 for sum and values.size() for argMin and argMax.
+     */
+    extern float    minimum(span<const float> values);
+    extern double   minimum(span<const double> values);
+    extern int32_t  minimum(span<const int32_t> values);
+    extern uint32_t minimum(span<const uint32_t> values);
+
+    extern float    maximum(span<const float> values);
+    extern double   maximum(span<const double> values);
+    extern int32_t  maximum(span<const int32_t> values);
+    extern uint32_t maximum(span<const uint32_t> values);
+
+    //float sums are accumulated in double per block of a few thousand values, integer sums in 64 bits
+    extern float    sum(span<const float> values);
+    extern double   sum(span<const double> values);
+    extern int64_t  sum(span<const int32_t> values);
+    extern uint64_t sum(span<const uint32_t> values);
+
+    //Index of the first smallest or largest value
+    extern size_t argMin(span<const float> values);
+    extern size_t argMin(span<const double> values);
+    extern size_t argMin(span<const int32_t> values);
+    extern size_t argMin(span<const uint32_t> values);
+
+    extern size_t argMax(span<const float> values);
+    extern size_t argMax(span<const double> values);
+    extern size_t argMax(span<const int32_t> values);
+    extern size_t argMax(span<const uint32_t> values);
+
+
+    /**
+     * Component wise versions, the vectors are reduced as one flat float array
+     */
+    extern vec2 minimum(span<const vec2> values);
+    extern vec3 minimum(span<const vec3> values);
+    extern vec4 minimum(span<const vec4> values);
+    extern vec2 maximum(span<const vec2> values);
+    extern vec3 maximum(span<const vec3> values);
+    extern vec4 maximum(span<const vec4> values);
+    extern vec2 sum(span<const vec2> values);
+    extern vec3 sum(span<const vec3> values);
+    extern vec4 sum(span<const vec4> values);
+
+    //Smallest box containing all points in one pass, pos is the minimum corner
+    extern bbox2 bounds(span<const vec2> points);
+    extern bbox3 bounds(span<const vec3> points);
+
+
+    /**
+     * Stable LSD radix sort of unsigned keys in ascending order, 11 bits per pass
+     * values are moved along with their keys, e.g. the indices of the points the keys were computed from,
+     * and have to be as many as keys. Passes in which all keys share the same digit are skipped, so keys
+     * that only use their low bits (like 3D Morton keys) cost no more than needed.
+     * Large arrays are counted and scattered in parallel on the default ThreadPool.
+     * A temporary array as large as the input is allocated.
+     */
+    extern void radixSort(span<uint32_t> keys);
+    extern void radixSort(span<uint64_t> keys);
+    extern void radixSort(span<uint32_t> keys, span<uint32_t> values);
+    extern void radixSort(span<uint64_t> keys, span<uint32_t> values);
+}}
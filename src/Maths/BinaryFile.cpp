@@ -0,0 +1,456 @@
+#include "BinaryFile.h"
+#include "Allocator.h"
+#include <cstring>
+#include <iostream>
+
+#ifdef GUM_OS_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define GUM_BINARY_ENDIANNESS 0x01020304
+#define GUM_BINARY_ALIGNMENT  64
+
+namespace Gum {
+namespace Maths
+{
+    static const char* scalarTypeNames[] = {
+        "unknown", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64",
+        "float16", "bfloat16", "float32", "float64", "bool"
+    };
+
+    std::string BinaryElementFormat::toString() const
+    {
+        std::string str = (unsigned int)scalar < sizeof(scalarTypeNames) / sizeof(scalarTypeNames[0]) ? scalarTypeNames[(unsigned int)scalar] : "invalid";
+        switch(kind)
+        {
+            case BinaryElementKind::SCALAR:     return str;
+            case BinaryElementKind::VECTOR:     return "vec" + std::to_string(rows) + "<" + str + ">";
+            case BinaryElementKind::MATRIX:     return "mat" + std::to_string(rows) + "x" + std::to_string(cols) + "<" + str + ">";
+            case BinaryElementKind::QUATERNION: return "quat<" + str + ">";
+        }
+        return "invalid<" + str + ">";
+    }
+
+
+    //
+    // Checksum
+    //
+    static inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    BinaryChecksum::BinaryChecksum()
+    {
+        this->iHash = 0x27D4EB2F165667C5ULL;
+        this->iLength = 0;
+        this->iTailSize = 0;
+    }
+
+    void BinaryChecksum::mix(uint64_t word)
+    {
+        iHash ^= word * 0x9E3779B97F4A7C15ULL;
+        iHash = rotl64(iHash, 31) * 0xC2B2AE3D27D4EB4FULL;
+    }
+
+    void BinaryChecksum::update(const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        iLength += size;
+
+        if(iTailSize > 0)
+        {
+            while(iTailSize < 8 && size > 0)
+            {
+                aTail[iTailSize++] = *bytes++;
+                size--;
+            }
+            if(iTailSize < 8)
+                return;
+
+            uint64_t word;
+            memcpy(&word, aTail, 8);
+            mix(word);
+            iTailSize = 0;
+        }
+
+        for(; size >= 8; size -= 8, bytes += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes, 8);
+            mix(word);
+        }
+
+        for(; size > 0; size--)
+            aTail[iTailSize++] = *bytes++;
+    }
+
+    uint64_t BinaryChecksum::finish() const
+    {
+        BinaryChecksum tmp = *this;
+        if(tmp.iTailSize > 0)
+        {
+            uint64_t word = 0;
+            memcpy(&word, tmp.aTail, tmp.iTailSize);
+            tmp.mix(word);
+        }
+        tmp.mix(iLength);
+
+        uint64_t h = tmp.iHash;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    uint64_t BinaryChecksum::compute(const void* data, size_t size)
+    {
+        BinaryChecksum checksum;
+        checksum.update(data, size);
+        return checksum.finish();
+    }
+
+
+    //
+    // Writer
+    //
+    BinaryFileWriter::BinaryFileWriter()
+    {
+        this->pFile = nullptr;
+        this->iPosition = 0;
+        this->bInSection = false;
+        this->bFailed = false;
+    }
+
+    BinaryFileWriter::~BinaryFileWriter()
+    {
+        if(pFile != nullptr)
+            close();
+    }
+
+    bool BinaryFileWriter::writeRaw(const void* data, size_t size)
+    {
+        if(bFailed)
+            return false;
+
+        if(fwrite(data, 1, size, pFile) != size)
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Failed to write to " << sPath << std::endl;
+            bFailed = true;
+            return false;
+        }
+        iPosition += size;
+        return true;
+    }
+
+    bool BinaryFileWriter::pad()
+    {
+        static const uint8_t zeros[GUM_BINARY_ALIGNMENT] = {0};
+        size_t padding = (size_t)(alignUp(iPosition, GUM_BINARY_ALIGNMENT) - iPosition);
+        return padding == 0 || writeRaw(zeros, padding);
+    }
+
+    bool BinaryFileWriter::open(const std::string& path)
+    {
+        if(pFile != nullptr)
+            close();
+
+        sPath = path;
+        pFile = fopen(path.c_str(), "wb");
+        if(pFile == nullptr)
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Failed to open " << path << std::endl;
+            return false;
+        }
+
+        vSections.clear();
+        iPosition = 0;
+        bInSection = false;
+        bFailed = false;
+
+        //Placeholder, the real header is written in close()
+        BinaryFileHeader header;
+        memset(&header, 0, sizeof(header));
+        return writeRaw(&header, sizeof(header));
+    }
+
+    bool BinaryFileWriter::beginSection(const std::string& name, const BinaryElementFormat& format, uint32_t stride)
+    {
+        if(pFile == nullptr || bInSection)
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Cannot begin section " << name << ", " << (bInSection ? "previous section not ended" : "file not open") << std::endl;
+            return false;
+        }
+        if(name.length() >= sizeof(BinarySectionEntry::name))
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Section name " << name << " is too long" << std::endl;
+            return false;
+        }
+        if(!pad())
+            return false;
+
+        BinarySectionEntry entry;
+        memset((void*)&entry, 0, sizeof(entry));
+        memcpy(entry.name, name.c_str(), name.length());
+        entry.format = format;
+        entry.stride = stride;
+        entry.offset = iPosition;
+        vSections.push_back(entry);
+
+        mChecksum = BinaryChecksum();
+        bInSection = true;
+        return true;
+    }
+
+    bool BinaryFileWriter::writeElements(const void* data, size_t count, const BinaryElementFormat& format, uint32_t stride)
+    {
+        if(!bInSection)
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: write called outside of a section" << std::endl;
+            return false;
+        }
+
+        BinarySectionEntry& entry = vSections.back();
+        if(entry.format != format || entry.stride != stride)
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Section " << entry.name << " holds " << entry.format.toString() << ", cannot write " << format.toString() << std::endl;
+            return false;
+        }
+
+        size_t size = count * stride;
+        mChecksum.update(data, size);
+        entry.count += count;
+        entry.size += size;
+        return writeRaw(data, size);
+    }
+
+    bool BinaryFileWriter::endSection()
+    {
+        if(!bInSection)
+            return false;
+
+        vSections.back().checksum = mChecksum.finish();
+        bInSection = false;
+        return !bFailed;
+    }
+
+    bool BinaryFileWriter::close()
+    {
+        if(pFile == nullptr)
+            return false;
+
+        if(bInSection)
+            endSection();
+
+        BinaryFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = GUM_BINARY_MAGIC;
+        header.version = GUM_BINARY_VERSION;
+        header.endianness = GUM_BINARY_ENDIANNESS;
+        header.sectionCount = (uint32_t)vSections.size();
+
+        pad();
+        header.tableOffset = iPosition;
+        header.tableChecksum = BinaryChecksum::compute(vSections.data(), vSections.size() * sizeof(BinarySectionEntry));
+        writeRaw(vSections.data(), vSections.size() * sizeof(BinarySectionEntry));
+        header.fileSize = iPosition;
+
+        bool success = !bFailed;
+        if(success && (fseek(pFile, 0, SEEK_SET) != 0 || fwrite(&header, 1, sizeof(header), pFile) != sizeof(header)))
+        {
+            std::cerr << "GumMaths: BinaryFileWriter: Failed to write header of " << sPath << std::endl;
+            success = false;
+        }
+        if(fclose(pFile) != 0)
+            success = false;
+
+        pFile = nullptr;
+        vSections.clear();
+        return success;
+    }
+
+
+    //
+    // Reader
+    //
+    BinaryFileReader::BinaryFileReader()
+    {
+        this->pData = nullptr;
+        this->iSize = 0;
+        this->pHeader = nullptr;
+        this->pSections = nullptr;
+#ifdef GUM_OS_WINDOWS
+        this->pFileHandle = nullptr;
+        this->pMappingHandle = nullptr;
+#endif
+    }
+
+    BinaryFileReader::~BinaryFileReader()
+    {
+        close();
+    }
+
+    bool BinaryFileReader::open(const std::string& path, bool verify)
+    {
+        close();
+
+#ifdef GUM_OS_WINDOWS
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to open " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER filesize;
+        GetFileSizeEx(file, &filesize);
+        iSize = (size_t)filesize.QuadPart;
+
+        HANDLE mapping = iSize > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+        pFileHandle = file;
+        pMappingHandle = mapping;
+        if(mapping == NULL || (pData = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) == nullptr)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to map " << path << std::endl;
+            close();
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to open " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to read size of " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        iSize = (size_t)st.st_size;
+
+        void* mapped = mmap(nullptr, iSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); //The mapping keeps its own reference
+        if(mapped == MAP_FAILED)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to map " << path << std::endl;
+            iSize = 0;
+            return false;
+        }
+        pData = (const uint8_t*)mapped;
+#endif
+
+        pHeader = (const BinaryFileHeader*)pData;
+        const char* error = nullptr;
+        if(iSize < sizeof(BinaryFileHeader) || pHeader->magic != GUM_BINARY_MAGIC)         { error = "not a gum binary file"; }
+        else if(pHeader->endianness != GUM_BINARY_ENDIANNESS)                               { error = "file was written with a different byte order"; }
+        else if(pHeader->version > GUM_BINARY_VERSION)                                      { error = "file version is newer than this library"; }
+        else if(pHeader->fileSize != iSize)                                                 { error = "file is truncated"; }
+        else if(pHeader->tableOffset % alignof(BinarySectionEntry) != 0 || pHeader->tableOffset < sizeof(BinaryFileHeader) || pHeader->tableOffset > iSize
+             || pHeader->sectionCount > (iSize - pHeader->tableOffset) / sizeof(BinarySectionEntry))    { error = "section table out of bounds"; }
+        else if(BinaryChecksum::compute(pData + pHeader->tableOffset, pHeader->sectionCount * sizeof(BinarySectionEntry)) != pHeader->tableChecksum) { error = "section table is corrupt"; }
+
+        if(error == nullptr)
+        {
+            pSections = (const BinarySectionEntry*)(pData + pHeader->tableOffset);
+            for(size_t i = 0; i < pHeader->sectionCount && error == nullptr; i++)
+            {
+                //Compared by subtraction, sums of crafted values could wrap around
+                const BinarySectionEntry& section = pSections[i];
+                if(section.offset < sizeof(BinaryFileHeader) || section.offset % GUM_BINARY_ALIGNMENT != 0
+                || section.offset > pHeader->tableOffset || section.size > pHeader->tableOffset - section.offset)
+                    error = "section out of bounds";
+                else if(section.stride == 0 || section.size % section.stride != 0 || section.size / section.stride != section.count)
+                    error = "section size does not match its elements";
+            }
+        }
+
+        if(error == nullptr && verify && !this->verify())
+            error = "checksum mismatch";
+
+        if(error != nullptr)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Failed to load " << path << ": " << error << std::endl;
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void BinaryFileReader::close()
+    {
+#ifdef GUM_OS_WINDOWS
+        if(pData != nullptr)          UnmapViewOfFile(pData);
+        if(pMappingHandle != nullptr) CloseHandle((HANDLE)pMappingHandle);
+        if(pFileHandle != nullptr)    CloseHandle((HANDLE)pFileHandle);
+        pFileHandle = nullptr;
+        pMappingHandle = nullptr;
+#else
+        if(pData != nullptr)
+            munmap((void*)pData, iSize);
+#endif
+        pData = nullptr;
+        iSize = 0;
+        pHeader = nullptr;
+        pSections = nullptr;
+    }
+
+    bool BinaryFileReader::verifySection(size_t index) const
+    {
+        if(index >= numSections())
+            return false;
+        return BinaryChecksum::compute(pData + pSections[index].offset, pSections[index].size) == pSections[index].checksum;
+    }
+
+    bool BinaryFileReader::verify() const
+    {
+        for(size_t i = 0; i < numSections(); i++)
+        {
+            if(!verifySection(i))
+                return false;
+        }
+        return pData != nullptr;
+    }
+
+    size_t BinaryFileReader::numSections() const
+    {
+        return pHeader != nullptr ? pHeader->sectionCount : 0;
+    }
+
+    const BinarySectionEntry& BinaryFileReader::getSection(size_t index) const
+    {
+        return pSections[index];
+    }
+
+    size_t BinaryFileReader::findSection(const std::string& name) const
+    {
+        for(size_t i = 0; i < numSections(); i++)
+        {
+            if(strncmp(pSections[i].name, name.c_str(), sizeof(BinarySectionEntry::name)) == 0)
+                return i;
+        }
+        return numSections();
+    }
+
+    const void* BinaryFileReader::getSectionData(size_t index, const BinaryElementFormat& format, size_t stride, size_t& count) const
+    {
+        count = 0;
+        if(index >= numSections())
+            return nullptr;
+
+        const BinarySectionEntry& entry = pSections[index];
+        if(entry.format != format || entry.stride != stride)
+        {
+            std::cerr << "GumMaths: BinaryFileReader: Section " << entry.name << " holds " << entry.format.toString() << " (stride " << entry.stride << "), requested " << format.toString() << " (stride " << stride << ")" << std::endl;
+            return nullptr;
+        }
+
+        count = (size_t)entry.count;
+        return pData + entry.offset;
+    }
+}}
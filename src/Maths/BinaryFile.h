@@ -0,0 +1,242 @@
+#pragma once
+#include "vec.h"
+#include "mat.h"
+#include "quat.h"
+#include "Span.h"
+#include "half.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Versioned binary container for large vec/mat/quat arrays
+ *
+ * Layout (little endian):
+ *   FileHeader                 64 bytes
+ *   section data               every section starts on a 64 byte boundary
+ *   SectionEntry[sectionCount] section table, written last
+ *
+ * Writing is streamed, a section can be appended in pieces without holding it in memory.
+ * Reading maps the file and hands out spans pointing straight into the mapping.
+ */
+
+#define GUM_BINARY_MAGIC   0x424D5547 // "GUMB"
+#define GUM_BINARY_VERSION 1
+
+namespace Gum {
+namespace Maths
+{
+    enum class BinaryScalarType : uint16_t
+    {
+        UNKNOWN = 0,
+        INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64,
+        FLOAT16, BFLOAT16, FLOAT32, FLOAT64, BOOL
+    };
+
+    enum class BinaryElementKind : uint16_t
+    {
+        SCALAR = 0,
+        VECTOR,
+        MATRIX,
+        QUATERNION
+    };
+
+    struct BinaryElementFormat
+    {
+        BinaryScalarType scalar = BinaryScalarType::UNKNOWN;
+        BinaryElementKind kind = BinaryElementKind::SCALAR;
+        uint16_t rows = 1;  // vector size or matrix height
+        uint16_t cols = 1;  // matrix width
+        uint16_t tag = 0;   // tvec type parameter (rgb, hsv, ...)
+
+        bool operator==(const BinaryElementFormat& other) const { return scalar == other.scalar && kind == other.kind && rows == other.rows && cols == other.cols && tag == other.tag; }
+        bool operator!=(const BinaryElementFormat& other) const { return !this->operator==(other); }
+        std::string toString() const;
+    };
+
+    template<typename T>
+    struct BinaryScalarTraits { static constexpr BinaryScalarType type = BinaryScalarType::UNKNOWN; };
+    template<> struct BinaryScalarTraits<int8_t>   { static constexpr BinaryScalarType type = BinaryScalarType::INT8;    };
+    template<> struct BinaryScalarTraits<uint8_t>  { static constexpr BinaryScalarType type = BinaryScalarType::UINT8;   };
+    template<> struct BinaryScalarTraits<int16_t>  { static constexpr BinaryScalarType type = BinaryScalarType::INT16;   };
+    template<> struct BinaryScalarTraits<uint16_t> { static constexpr BinaryScalarType type = BinaryScalarType::UINT16;  };
+    template<> struct BinaryScalarTraits<int32_t>  { static constexpr BinaryScalarType type = BinaryScalarType::INT32;   };
+    template<> struct BinaryScalarTraits<uint32_t> { static constexpr BinaryScalarType type = BinaryScalarType::UINT32;  };
+    template<> struct BinaryScalarTraits<int64_t>  { static constexpr BinaryScalarType type = BinaryScalarType::INT64;   };
+    template<> struct BinaryScalarTraits<uint64_t> { static constexpr BinaryScalarType type = BinaryScalarType::UINT64;  };
+    template<> struct BinaryScalarTraits<float>    { static constexpr BinaryScalarType type = BinaryScalarType::FLOAT32; };
+    template<> struct BinaryScalarTraits<double>   { static constexpr BinaryScalarType type = BinaryScalarType::FLOAT64; };
+    template<> struct BinaryScalarTraits<bool>     { static constexpr BinaryScalarType type = BinaryScalarType::BOOL;    };
+    template<> struct BinaryScalarTraits<half>     { static constexpr BinaryScalarType type = BinaryScalarType::FLOAT16; };
+    template<> struct BinaryScalarTraits<bfloat16> { static constexpr BinaryScalarType type = BinaryScalarType::BFLOAT16;};
+
+    template<typename T>
+    struct BinaryTypeInfo
+    {
+        static BinaryElementFormat format() { BinaryElementFormat f; f.scalar = BinaryScalarTraits<T>::type; return f; }
+    };
+
+    template<typename T, unsigned int S, unsigned int type>
+    struct BinaryTypeInfo<tvec<T, S, type>>
+    {
+        static BinaryElementFormat format() { BinaryElementFormat f; f.scalar = BinaryScalarTraits<T>::type; f.kind = BinaryElementKind::VECTOR; f.rows = S; f.tag = type; return f; }
+    };
+
+    template<typename T, unsigned int N, unsigned int M>
+    struct BinaryTypeInfo<mat<T, N, M>>
+    {
+        static BinaryElementFormat format() { BinaryElementFormat f; f.scalar = BinaryScalarTraits<T>::type; f.kind = BinaryElementKind::MATRIX; f.rows = N; f.cols = M; return f; }
+    };
+
+    template<typename T>
+    struct BinaryTypeInfo<quat<T>>
+    {
+        static BinaryElementFormat format() { BinaryElementFormat f; f.scalar = BinaryScalarTraits<T>::type; f.kind = BinaryElementKind::QUATERNION; f.rows = 4; return f; }
+    };
+
+
+    struct BinaryFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t endianness;    // 0x01020304 as written by the producer
+        uint32_t sectionCount;
+        uint64_t tableOffset;
+        uint64_t tableChecksum;
+        uint64_t fileSize;
+        uint8_t  reserved[24];
+    };
+    static_assert(sizeof(BinaryFileHeader) == 64, "BinaryFileHeader has to be 64 bytes");
+
+    struct BinarySectionEntry
+    {
+        char name[32];
+        BinaryElementFormat format;
+        uint16_t reserved;
+        uint32_t stride;
+        uint64_t count;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t checksum;
+        uint8_t  padding[16];
+    };
+    static_assert(sizeof(BinarySectionEntry) == 96, "BinarySectionEntry has to be 96 bytes");
+
+
+    /**
+     * Streaming 64bit checksum, processes 8 bytes per step
+     */
+    class BinaryChecksum
+    {
+    private:
+        uint64_t iHash;
+        uint64_t iLength;
+        uint8_t  aTail[8];
+        unsigned int iTailSize;
+
+        void mix(uint64_t word);
+
+    public:
+        BinaryChecksum();
+        void update(const void* data, size_t size);
+        uint64_t finish() const;
+
+        static uint64_t compute(const void* data, size_t size);
+    };
+
+
+    class BinaryFileWriter
+    {
+    private:
+        FILE* pFile;
+        std::string sPath;
+        std::vector<BinarySectionEntry> vSections;
+        BinaryChecksum mChecksum;
+        uint64_t iPosition;
+        bool bInSection;
+        bool bFailed;
+
+        bool writeRaw(const void* data, size_t size);
+        bool pad();
+        bool beginSection(const std::string& name, const BinaryElementFormat& format, uint32_t stride);
+        bool writeElements(const void* data, size_t count, const BinaryElementFormat& format, uint32_t stride);
+
+    public:
+        BinaryFileWriter();
+        BinaryFileWriter(const BinaryFileWriter&) = delete;
+        BinaryFileWriter& operator=(const BinaryFileWriter&) = delete;
+        ~BinaryFileWriter();
+
+        bool open(const std::string& path);
+        //Writes the section table and patches the header
+        bool close();
+
+        template<typename T>
+        bool beginSection(const std::string& name) { return beginSection(name, BinaryTypeInfo<T>::format(), sizeof(T)); }
+
+        //Appends elements to the open section, can be called any number of times
+        template<typename T>
+        bool write(const T* data, size_t count)    { return writeElements(data, count, BinaryTypeInfo<T>::format(), sizeof(T)); }
+        template<typename T>
+        bool write(span<const T> data)             { return write(data.data(), data.size()); }
+
+        bool endSection();
+
+        template<typename T>
+        bool writeSection(const std::string& name, const T* data, size_t count)
+        {
+            return beginSection<T>(name) && write(data, count) && endSection();
+        }
+        template<typename T>
+        bool writeSection(const std::string& name, span<const T> data) { return writeSection(name, data.data(), data.size()); }
+
+        bool isOpen() const { return pFile != nullptr; }
+    };
+
+
+    class BinaryFileReader
+    {
+    private:
+        const uint8_t* pData;
+        size_t iSize;
+        const BinaryFileHeader* pHeader;
+        const BinarySectionEntry* pSections;
+#ifdef GUM_OS_WINDOWS
+        void* pFileHandle;
+        void* pMappingHandle;
+#endif
+
+        const void* getSectionData(size_t index, const BinaryElementFormat& format, size_t stride, size_t& count) const;
+
+    public:
+        BinaryFileReader();
+        BinaryFileReader(const BinaryFileReader&) = delete;
+        BinaryFileReader& operator=(const BinaryFileReader&) = delete;
+        ~BinaryFileReader();
+
+        //Maps the file read-only, checksums are only checked when verify is set since that touches every page
+        bool open(const std::string& path, bool verify = false);
+        void close();
+        bool verify() const;
+        bool verifySection(size_t index) const;
+
+        size_t numSections() const;
+        const BinarySectionEntry& getSection(size_t index) const;
+        //Returns numSections() if there is no section with that name
+        size_t findSection(const std::string& name) const;
+
+        template<typename T>
+        span<const T> get(size_t index) const
+        {
+            size_t count = 0;
+            const T* data = (const T*)getSectionData(index, BinaryTypeInfo<T>::format(), sizeof(T), count);
+            return span<const T>(data, count);
+        }
+
+        template<typename T>
+        span<const T> get(const std::string& name) const { return get<T>(findSection(name)); }
+
+        bool isOpen() const { return pData != nullptr; }
+    };
+}}
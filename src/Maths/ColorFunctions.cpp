@@ -1,5 +1,6 @@
 #include "ColorFunctions.h"
 #include "Maths.h"
+#include "ThreadPool.h"
 #include <iostream>
 
 namespace Gum {
@@ -106,4 +107,20 @@ namespace Maths
         return std::string("#") + r + g + b + a;
     }
 
+    void HSVToRGB(const hsv* in, rgb* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = HSVToRGB(in[i]);
+        }, 1024);
+    }
+
+    void RGBToHSV(const rgb* in, hsv* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = RGBToHSV(in[i]);
+        }, 1024);
+    }
+
 }}
\ No newline at end of file
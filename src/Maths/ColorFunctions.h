@@ -12,4 +12,8 @@ namespace Maths
     extern rgba HEXToRGBA(int hex);
     extern std::string RGBToHEX(rgb val);
     extern std::string RGBAToHEX(rgba val);
+
+    //Batch conversions, split across the default ThreadPool
+    extern void HSVToRGB(const hsv* in, rgb* out, size_t count);
+    extern void RGBToHSV(const rgb* in, hsv* out, size_t count);
 }}
\ No newline at end of file
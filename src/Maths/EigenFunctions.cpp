@@ -0,0 +1,92 @@
+#include "EigenFunctions.h"
+#include "ThreadPool.h"
+
+namespace Gum {
+namespace Maths
+{
+    //Solves W = vfloat::width matrices at once, lanes past count are filled with identity
+    static void eigenSymmetricBlock(const mat3* matrices, vec3* eigenvalues, mat3* eigenvectors, quat<float>* rotations, size_t count)
+    {
+        const unsigned int W = vfloat::width;
+        alignas(32) float in[6][W];
+        for(unsigned int l = 0; l < W; l++)
+        {
+            if(l < count)
+            {
+                const mat3& m = matrices[l];
+                in[0][l] = m[0][0];
+                in[1][l] = m[1][1];
+                in[2][l] = m[2][2];
+                in[3][l] = (m[1][0] + m[0][1]) * 0.5f;
+                in[4][l] = (m[2][0] + m[0][2]) * 0.5f;
+                in[5][l] = (m[2][1] + m[1][2]) * 0.5f;
+            }
+            else
+            {
+                in[0][l] = in[1][l] = in[2][l] = 1.0f;
+                in[3][l] = in[4][l] = in[5][l] = 0.0f;
+            }
+        }
+
+        vfloat d[3], o[3], v[3][3];
+        for(int i = 0; i < 3; i++)
+        {
+            d[i] = vfloat::loadAligned(in[i]);
+            o[i] = vfloat::loadAligned(in[i + 3]);
+        }
+        jacobiEigenSymmetric3<vfloat>(d, o, v);
+
+        alignas(32) float values[3][W];
+        alignas(32) float vectors[3][3][W];
+        for(int i = 0; i < 3; i++)
+        {
+            d[i].storeAligned(values[i]);
+            for(int j = 0; j < 3; j++)
+                v[i][j].storeAligned(vectors[i][j]);
+        }
+
+        for(unsigned int l = 0; l < W && l < count; l++)
+        {
+            if(eigenvalues != nullptr)
+                eigenvalues[l] = vec3(values[0][l], values[1][l], values[2][l]);
+
+            mat3 vecs;
+            for(int i = 0; i < 3; i++)
+                for(int j = 0; j < 3; j++)
+                    vecs[i][j] = vectors[i][j][l];
+
+            if(eigenvectors != nullptr)
+                eigenvectors[l] = vecs;
+            if(rotations != nullptr)
+                rotations[l] = quat<float>(vecs);
+        }
+    }
+
+    static void eigenSymmetricBatch(const mat3* matrices, vec3* eigenvalues, mat3* eigenvectors, quat<float>* rotations, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, float, 3, 3, count);
+        const size_t W = vfloat::width;
+        size_t blocks = (count + W - 1) / W;
+        parallelFor(0, blocks, [=](size_t begin, size_t end) {
+            for(size_t b = begin; b < end; b++)
+            {
+                size_t first = b * W;
+                eigenSymmetricBlock(matrices + first,
+                                    eigenvalues  != nullptr ? eigenvalues  + first : nullptr,
+                                    eigenvectors != nullptr ? eigenvectors + first : nullptr,
+                                    rotations    != nullptr ? rotations    + first : nullptr,
+                                    count - first);
+            }
+        }, 64);
+    }
+
+    void eigenSymmetric(const mat3* matrices, vec3* eigenvalues, mat3* eigenvectors, size_t count)
+    {
+        eigenSymmetricBatch(matrices, eigenvalues, eigenvectors, nullptr, count);
+    }
+
+    void eigenSymmetric(const mat3* matrices, vec3* eigenvalues, quat<float>* rotations, size_t count)
+    {
+        eigenSymmetricBatch(matrices, eigenvalues, nullptr, rotations, count);
+    }
+}}
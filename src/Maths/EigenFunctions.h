@@ -0,0 +1,147 @@
+#pragma once
+#include "mat.h"
+#include "quat.h"
+#include "Simd.h"
+#include <cmath>
+#include <limits>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Cyclic Jacobi iteration on a symmetric 3x3 matrix
+     * Works on one matrix per lane, P is float, double, vfloat4 or vfloat8. Every rotation is
+     * computed without branches, the only branch is the convergence check after each sweep.
+     * On return d holds the eigenvalues in descending order and v the matching eigenvectors
+     * as columns (v[column][row]), forming a right handed orthonormal basis.
+     * @param d diagonal a00, a11, a22
+     * @param o off diagonal a01, a02, a12
+     */
+    template<typename P>
+    static void jacobiEigenSymmetric3(P d[3], P o[3], P v[3][3])
+    {
+        using std::sqrt;
+        using std::abs;
+        using std::copysign;
+        using std::max;
+        typedef typename simd_traits<P>::scalar S;
+        const P zero((S)0), one((S)1), two((S)2);
+        const P tolerance((S)(std::numeric_limits<S>::epsilon() * std::numeric_limits<S>::epsilon()));
+        const int maxSweeps = sizeof(S) > 4 ? 12 : 8;
+
+        for(int i = 0; i < 3; i++)
+            for(int j = 0; j < 3; j++)
+                v[i][j] = i == j ? one : zero;
+
+        //Annihilates apq, r is the remaining index
+        auto rotate = [&](P& app, P& aqq, P& apq, P& arp, P& arq, P* vp, P* vq) {
+            P diff = aqq - app;
+            P twoApq = two * apq;
+            //Squares are taken relative to the larger term. In a batch, lanes that already converged keep rotating
+            //with tiny apq, whose square underflows and would turn t into inf and the lane into NaN
+            P scale = max(abs(diff), abs(twoApq));
+            P x = diff / scale, y = twoApq / scale;
+            //tan of the rotation angle, the smaller root of t^2 + 2t*diff/(2apq) - 1 = 0
+            P t = twoApq * copysign(one, diff) / (abs(diff) + scale * sqrt(x * x + y * y));
+            t = select(apq != zero, t, zero);
+            P c = one / sqrt(one + t * t);
+            P s = t * c;
+
+            app = app - t * apq;
+            aqq = aqq + t * apq;
+            apq = zero;
+
+            P rp = arp, rq = arq;
+            arp = c * rp - s * rq;
+            arq = s * rp + c * rq;
+
+            for(int k = 0; k < 3; k++)
+            {
+                P kp = vp[k], kq = vq[k];
+                vp[k] = c * kp - s * kq;
+                vq[k] = s * kp + c * kq;
+            }
+        };
+
+        for(int sweep = 0; sweep < maxSweeps; sweep++)
+        {
+            P off = o[0] * o[0] + o[1] * o[1] + o[2] * o[2];
+            P norm = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + off;
+            if(all(off <= tolerance * norm))
+                break;
+
+            rotate(d[0], d[1], o[0], o[1], o[2], v[0], v[1]);
+            rotate(d[0], d[2], o[1], o[0], o[2], v[0], v[2]);
+            rotate(d[1], d[2], o[2], o[0], o[1], v[1], v[2]);
+        }
+
+        //Sorting network, descending
+        auto order = [&](int a, int b) {
+            auto swap = d[a] < d[b];
+            P da = d[a], db = d[b];
+            d[a] = select(swap, db, da);
+            d[b] = select(swap, da, db);
+            for(int k = 0; k < 3; k++)
+            {
+                P va = v[a][k], vb = v[b][k];
+                v[a][k] = select(swap, vb, va);
+                v[b][k] = select(swap, va, vb);
+            }
+        };
+        order(0, 1);
+        order(1, 2);
+        order(0, 1);
+
+        //Flip the last axis if the basis came out left handed
+        P det = v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1])
+              - v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0])
+              + v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+        auto flip = det < zero;
+        for(int k = 0; k < 3; k++)
+            v[2][k] = select(flip, -v[2][k], v[2][k]);
+    }
+
+    /**
+     * Eigen decomposition of a symmetric matrix like a covariance or inertia tensor
+     * Off diagonal entries are averaged across both triangles, so slight asymmetry from rounding is fine.
+     * @param m symmetric matrix
+     * @param eigenvalues sorted in descending order
+     * @param eigenvectors unit eigenvectors as columns, eigenvectors[i] belongs to eigenvalues[i], determinant is +1
+     */
+    template<typename T>
+    static void eigenSymmetric(const mat<T,3,3>& m, tvec<T, 3>& eigenvalues, mat<T,3,3>& eigenvectors)
+    {
+        GUM_MATHS_TIMED(MAT_DECOMPOSE, T, 3, 3);
+        T d[3] = { m[0][0], m[1][1], m[2][2] };
+        T o[3] = { (m[1][0] + m[0][1]) * (T)0.5, (m[2][0] + m[0][2]) * (T)0.5, (m[2][1] + m[1][2]) * (T)0.5 };
+        T v[3][3];
+        jacobiEigenSymmetric3<T>(d, o, v);
+
+        eigenvalues.x = d[0];
+        eigenvalues.y = d[1];
+        eigenvalues.z = d[2];
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                eigenvectors[i][j] = v[i][j];
+    }
+
+    /**
+     * Same as above, the eigenvectors are returned as rotation from the principal axes frame
+     * rotation * (1,0,0) is the eigenvector of the largest eigenvalue
+     */
+    template<typename T>
+    static void eigenSymmetric(const mat<T,3,3>& m, tvec<T, 3>& eigenvalues, quat<T>& rotation)
+    {
+        mat<T,3,3> eigenvectors;
+        eigenSymmetric<T>(m, eigenvalues, eigenvectors);
+        rotation = quat<T>(eigenvectors);
+    }
+
+
+    /**
+     * Batched version for many matrices, vectorized across matrices and split across the default ThreadPool
+     * eigenvectors or rotations may be nullptr if they are not needed
+     */
+    extern void eigenSymmetric(const mat3* matrices, vec3* eigenvalues, mat3* eigenvectors, size_t count);
+    extern void eigenSymmetric(const mat3* matrices, vec3* eigenvalues, quat<float>* rotations, size_t count);
+}}
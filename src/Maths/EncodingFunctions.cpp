@@ -0,0 +1,665 @@
+#include "EncodingFunctions.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GUM_MATHS_BMI2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace Gum {
+namespace Maths
+{
+    //Signed value to bits-wide two's complement snorm and back
+    static inline uint32_t toSnorm(float v, unsigned int bits)
+    {
+        float scale = (float)((1u << (bits - 1)) - 1);
+        v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+        int32_t q = (int32_t)std::lround(v * scale);
+        return (uint32_t)q & ((1u << bits) - 1);
+    }
+
+    static inline float fromSnorm(uint32_t bits32, unsigned int bits)
+    {
+        float scale = (float)((1u << (bits - 1)) - 1);
+        int32_t q = (int32_t)(bits32 << (32 - bits)) >> (32 - bits); //Sign extend
+        float v = (float)q / scale;
+        return v < -1.0f ? -1.0f : v;
+    }
+
+    static inline uint32_t toUnorm(float v, unsigned int bits)
+    {
+        float scale = (float)((1ull << bits) - 1);
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        return (uint32_t)std::lround(v * scale);
+    }
+
+    static inline float fromUnorm(uint32_t q, unsigned int bits)
+    {
+        return (float)q / (float)((1ull << bits) - 1);
+    }
+
+    static inline float signNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+
+    //
+    // Octahedral
+    //
+    static inline vec2 octahedralProject(const vec3& n)
+    {
+        float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+        vec2 p(n.x / l1, n.y / l1);
+        if(n.z < 0.0f)
+            p = vec2((1.0f - std::fabs(p.y)) * signNotZero(p.x), (1.0f - std::fabs(p.x)) * signNotZero(p.y));
+        return p;
+    }
+
+    static inline vec3 octahedralUnproject(float x, float y)
+    {
+        vec3 v(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+        if(v.z < 0.0f)
+        {
+            float ox = v.x;
+            v.x = (1.0f - std::fabs(v.y)) * signNotZero(ox);
+            v.y = (1.0f - std::fabs(ox)) * signNotZero(v.y);
+        }
+        float len = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        return vec3(v.x / len, v.y / len, v.z / len);
+    }
+
+    uint32_t encodeOctahedral16(const vec3& normal)
+    {
+        vec2 p = octahedralProject(normal);
+        return toSnorm(p.x, 16) | (toSnorm(p.y, 16) << 16);
+    }
+
+    vec3 decodeOctahedral16(uint32_t encoded)
+    {
+        return octahedralUnproject(fromSnorm(encoded & 0xFFFFu, 16), fromSnorm(encoded >> 16, 16));
+    }
+
+    uint16_t encodeOctahedral8(const vec3& normal)
+    {
+        //With only 8 bits plain rounding is noticeably off, test the four neighbours
+        vec2 p = octahedralProject(normal);
+        float x0 = std::floor(p.x * 127.0f), y0 = std::floor(p.y * 127.0f);
+        uint16_t best = 0;
+        float bestDot = -2.0f;
+        for(int i = 0; i < 4; i++)
+        {
+            float qx = x0 + (float)(i & 1), qy = y0 + (float)(i >> 1);
+            qx = qx < -127.0f ? -127.0f : (qx > 127.0f ? 127.0f : qx);
+            qy = qy < -127.0f ? -127.0f : (qy > 127.0f ? 127.0f : qy);
+            vec3 d = octahedralUnproject(qx / 127.0f, qy / 127.0f);
+            float dot = d.x * normal.x + d.y * normal.y + d.z * normal.z;
+            if(dot > bestDot)
+            {
+                bestDot = dot;
+                best = (uint16_t)(((uint32_t)(int32_t)qx & 0xFFu) | (((uint32_t)(int32_t)qy & 0xFFu) << 8));
+            }
+        }
+        return best;
+    }
+
+    vec3 decodeOctahedral8(uint16_t encoded)
+    {
+        return octahedralUnproject(fromSnorm(encoded & 0xFFu, 8), fromSnorm((uint32_t)encoded >> 8, 8));
+    }
+
+
+    //
+    // Smallest three
+    //
+    static const float QUAT_RANGE = 0.70710678118654752f; //Largest possible value of the three smaller components
+
+    template<typename R, unsigned int BITS>
+    static inline R encodeSmallestThree(const fquat& q)
+    {
+        const float v[4] = { q.w, q.x, q.y, q.z };
+        unsigned int largest = 0;
+        for(unsigned int i = 1; i < 4; i++)
+            if(std::fabs(v[i]) > std::fabs(v[largest]))
+                largest = i;
+
+        //Flip so the dropped component is positive
+        float sign = v[largest] < 0.0f ? -1.0f : 1.0f;
+        const R max = ((R)1 << BITS) - 1;
+        R ret = (R)largest;
+        unsigned int shift = 2;
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            if(i == largest)
+                continue;
+            float n = (v[i] * sign / QUAT_RANGE) * 0.5f + 0.5f;
+            n = n < 0.0f ? 0.0f : (n > 1.0f ? 1.0f : n);
+            ret |= (R)std::llround(n * (double)max) << shift;
+            shift += BITS;
+        }
+        return ret;
+    }
+
+    template<typename R, unsigned int BITS>
+    static inline fquat decodeSmallestThree(R encoded)
+    {
+        unsigned int largest = (unsigned int)(encoded & 3);
+        const R max = ((R)1 << BITS) - 1;
+        float v[4];
+        float sum = 0.0f;
+        unsigned int shift = 2;
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            if(i == largest)
+                continue;
+            float n = (float)((encoded >> shift) & max) / (float)max;
+            v[i] = (n * 2.0f - 1.0f) * QUAT_RANGE;
+            sum += v[i] * v[i];
+            shift += BITS;
+        }
+        v[largest] = std::sqrt(sum < 1.0f ? 1.0f - sum : 0.0f);
+
+        //Renormalize, quantization leaves the small components slightly off
+        float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+        return fquat(v[0] / len, v[1] / len, v[2] / len, v[3] / len);
+    }
+
+    uint32_t encodeQuat32(const fquat& q)       { return encodeSmallestThree<uint32_t, 10>(q); }
+    fquat decodeQuat32(uint32_t encoded)        { return decodeSmallestThree<uint32_t, 10>(encoded); }
+    uint64_t encodeQuat64(const fquat& q)       { return encodeSmallestThree<uint64_t, 20>(q); }
+    fquat decodeQuat64(uint64_t encoded)        { return decodeSmallestThree<uint64_t, 20>(encoded); }
+
+
+    //
+    // snorm / unorm
+    //
+    uint32_t packSnorm2x16(const vec2& v)       { return toSnorm(v.x, 16) | (toSnorm(v.y, 16) << 16); }
+    vec2 unpackSnorm2x16(uint32_t packed)       { return vec2(fromSnorm(packed & 0xFFFFu, 16), fromSnorm(packed >> 16, 16)); }
+    uint32_t packUnorm2x16(const vec2& v)       { return toUnorm(v.x, 16) | (toUnorm(v.y, 16) << 16); }
+    vec2 unpackUnorm2x16(uint32_t packed)       { return vec2(fromUnorm(packed & 0xFFFFu, 16), fromUnorm(packed >> 16, 16)); }
+
+    uint32_t packSnorm4x8(const vec4& v)
+    {
+        return toSnorm(v.x, 8) | (toSnorm(v.y, 8) << 8) | (toSnorm(v.z, 8) << 16) | (toSnorm(v.w, 8) << 24);
+    }
+    vec4 unpackSnorm4x8(uint32_t packed)
+    {
+        return vec4(fromSnorm(packed & 0xFFu, 8), fromSnorm((packed >> 8) & 0xFFu, 8), fromSnorm((packed >> 16) & 0xFFu, 8), fromSnorm(packed >> 24, 8));
+    }
+    uint32_t packUnorm4x8(const vec4& v)
+    {
+        return toUnorm(v.x, 8) | (toUnorm(v.y, 8) << 8) | (toUnorm(v.z, 8) << 16) | (toUnorm(v.w, 8) << 24);
+    }
+    vec4 unpackUnorm4x8(uint32_t packed)
+    {
+        return vec4(fromUnorm(packed & 0xFFu, 8), fromUnorm((packed >> 8) & 0xFFu, 8), fromUnorm((packed >> 16) & 0xFFu, 8), fromUnorm(packed >> 24, 8));
+    }
+
+    uint64_t packSnorm4x16(const vec4& v)
+    {
+        return (uint64_t)packSnorm2x16(vec2(v.x, v.y)) | ((uint64_t)packSnorm2x16(vec2(v.z, v.w)) << 32);
+    }
+    vec4 unpackSnorm4x16(uint64_t packed)
+    {
+        vec2 lo = unpackSnorm2x16((uint32_t)packed), hi = unpackSnorm2x16((uint32_t)(packed >> 32));
+        return vec4(lo.x, lo.y, hi.x, hi.y);
+    }
+    uint64_t packUnorm4x16(const vec4& v)
+    {
+        return (uint64_t)packUnorm2x16(vec2(v.x, v.y)) | ((uint64_t)packUnorm2x16(vec2(v.z, v.w)) << 32);
+    }
+    vec4 unpackUnorm4x16(uint64_t packed)
+    {
+        vec2 lo = unpackUnorm2x16((uint32_t)packed), hi = unpackUnorm2x16((uint32_t)(packed >> 32));
+        return vec4(lo.x, lo.y, hi.x, hi.y);
+    }
+
+
+    //
+    // Space filling curves
+    //
+    static const uint64_t MORTON2_MASK = 0x5555555555555555ull;
+    static const uint64_t MORTON3_MASK = 0x1249249249249249ull;
+    static const uint32_t GRID3_MAX = (1u << 21) - 1;
+
+    //Byte wise bit spreading and gathering
+    struct MortonTables
+    {
+        uint16_t spread2[256] = {};   //8 bits to every second of 16
+        uint32_t spread3[256] = {};   //8 bits to every third of 24
+        uint8_t compact2[256] = {};   //Byte of a 2D key to its x bits | y bits << 4
+        uint16_t compact3[512] = {};  //9 bits of a 3D key to its x bits | y bits << 3 | z bits << 6
+
+        constexpr MortonTables()
+        {
+            for(unsigned int v = 0; v < 256; v++)
+            {
+                for(unsigned int b = 0; b < 8; b++)
+                {
+                    spread2[v] |= (uint16_t)(((v >> b) & 1) << (2 * b));
+                    spread3[v] |= ((v >> b) & 1) << (3 * b);
+                    compact2[v] |= (uint8_t)(((v >> b) & 1) << (b / 2 + (b % 2) * 4));
+                }
+            }
+            for(unsigned int v = 0; v < 512; v++)
+                for(unsigned int b = 0; b < 9; b++)
+                    compact3[v] |= (uint16_t)(((v >> b) & 1) << (b / 3 + (b % 3) * 3));
+        }
+    };
+    static constexpr MortonTables MORTON_TABLES;
+
+    struct TableBits
+    {
+        static uint64_t spread2(uint32_t v)
+        {
+            const uint16_t* t = MORTON_TABLES.spread2;
+            return (uint64_t)t[v & 255] | (uint64_t)t[(v >> 8) & 255] << 16 | (uint64_t)t[(v >> 16) & 255] << 32 | (uint64_t)t[v >> 24] << 48;
+        }
+
+        static uint64_t spread3(uint32_t v)
+        {
+            const uint32_t* t = MORTON_TABLES.spread3;
+            return (uint64_t)t[v & 255] | (uint64_t)t[(v >> 8) & 255] << 24 | (uint64_t)t[(v >> 16) & 31] << 48;
+        }
+
+        static uivec2 compact2(uint64_t key)
+        {
+            uint32_t x = 0, y = 0;
+            for(unsigned int i = 0; i < 8; i++)
+            {
+                uint32_t c = MORTON_TABLES.compact2[(key >> (8 * i)) & 255];
+                x |= (c & 15) << (4 * i);
+                y |= (c >> 4) << (4 * i);
+            }
+            return uivec2(x, y);
+        }
+
+        static uivec3 compact3(uint64_t key)
+        {
+            uint32_t x = 0, y = 0, z = 0;
+            for(unsigned int i = 0; i < 7; i++)
+            {
+                uint32_t c = MORTON_TABLES.compact3[(key >> (9 * i)) & 511];
+                x |= (c & 7) << (3 * i);
+                y |= ((c >> 3) & 7) << (3 * i);
+                z |= (c >> 6) << (3 * i);
+            }
+            return uivec3(x, y, z);
+        }
+    };
+
+#ifdef GUM_MATHS_BMI2_DISPATCH
+    struct Bmi2Bits
+    {
+        __attribute__((target("bmi2"))) static uint64_t spread2(uint32_t v) { return _pdep_u64(v, MORTON2_MASK); }
+        __attribute__((target("bmi2"))) static uint64_t spread3(uint32_t v) { return _pdep_u64(v, MORTON3_MASK); }
+        __attribute__((target("bmi2"))) static uivec2 compact2(uint64_t key) { return uivec2((uint32_t)_pext_u64(key, MORTON2_MASK), (uint32_t)_pext_u64(key, MORTON2_MASK << 1)); }
+        __attribute__((target("bmi2"))) static uivec3 compact3(uint64_t key)
+        {
+            return uivec3((uint32_t)_pext_u64(key, MORTON3_MASK), (uint32_t)_pext_u64(key, MORTON3_MASK << 1), (uint32_t)_pext_u64(key, MORTON3_MASK << 2));
+        }
+    };
+
+    static std::atomic<bool> bCurveTablesForced(false);
+
+    //pdep and pext are microcoded on AMD before Zen 3 and slower than the tables there
+    static bool hasFastBMI2()
+    {
+        static const bool fast = __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+        return fast && !bCurveTablesForced.load(std::memory_order_relaxed);
+    }
+#endif
+
+    void forceCurveTables(bool force)
+    {
+#ifdef GUM_MATHS_BMI2_DISPATCH
+        bCurveTablesForced.store(force, std::memory_order_relaxed);
+#else
+        (void)force;
+#endif
+    }
+
+    /**
+     * Hilbert curves after Skilling, "Programming the Hilbert curve" (2004)
+     * The coordinates are transformed in place into the transposed Hilbert index, whose bits
+     * interleaved with the first coordinate as most significant give the key. Every level either
+     * inverts the lower bits of x or exchanges them with another coordinate.
+     * This is the definition of the curve, keys are computed with the tables built from it below.
+     */
+    static void axesToTranspose(uint32_t* x, unsigned int dims, unsigned int bits)
+    {
+        for(uint32_t level = bits - 1; level > 0; level--)
+        {
+            uint32_t lower = (1u << level) - 1;
+            for(unsigned int i = 0; i < dims; i++)
+            {
+                if(x[i] & (1u << level))
+                    x[0] ^= lower;
+                else
+                {
+                    uint32_t t = (x[0] ^ x[i]) & lower;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        for(unsigned int i = 1; i < dims; i++)
+            x[i] ^= x[i - 1];
+        uint32_t t = 0;
+        for(uint32_t level = bits - 1; level > 0; level--)
+            if(x[dims - 1] & (1u << level))
+                t ^= (1u << level) - 1;
+        for(unsigned int i = 0; i < dims; i++)
+            x[i] ^= t;
+    }
+
+    //Key of the cell at axes with the bits of the first axis in the highest position of every level
+    static uint64_t hilbertReference(const uint32_t* axes, unsigned int dims, unsigned int bits)
+    {
+        uint32_t x[3] = { axes[0], axes[1], dims > 2 ? axes[2] : 0u };
+        axesToTranspose(x, dims, bits);
+        uint64_t key = 0;
+        for(unsigned int level = 0; level < bits; level++)
+            for(unsigned int i = 0; i < dims; i++)
+                key |= (uint64_t)((x[i] >> level) & 1) << (dims * level + dims - 1 - i);
+        return key;
+    }
+
+    /**
+     * The curve as a finite automaton over the levels of a Morton key, from the top level down
+     * Each state is one orientation of the curve inside a cell, it maps the Morton digit of the
+     * child cell (one bit per axis, the first axis highest) to its Hilbert digit and the state inside that child.
+     * States are found by walking the reference curve, a state is identified by the order in which
+     * it visits the children of its cell. The tables combine LEVELS steps into one lookup,
+     * entry [state << CHUNK | digits] holds the converted digits | next state << CHUNK.
+     */
+    template<unsigned int DIMS, unsigned int BITS, unsigned int LEVELS>
+    struct HilbertTables
+    {
+        static const unsigned int CHUNK = DIMS * LEVELS;
+        static const unsigned int CHILDREN = 1u << DIMS;
+
+        std::vector<uint16_t> toHilbert, toMorton;
+
+        HilbertTables()
+        {
+            struct Cell
+            {
+                uint32_t prefix[DIMS];
+                unsigned int level;
+                uint32_t order;
+            };
+
+            //Hilbert digit of every child of a cell, packed
+            auto childOrder = [](const Cell& cell) {
+                uint32_t order = 0;
+                for(uint32_t child = 0; child < CHILDREN; child++)
+                {
+                    uint32_t axes[DIMS];
+                    for(unsigned int i = 0; i < DIMS; i++)
+                        axes[i] = ((cell.prefix[i] << 1) | ((child >> (DIMS - 1 - i)) & 1)) << (BITS - 1 - cell.level);
+                    uint64_t digit = (hilbertReference(axes, DIMS, BITS) >> (DIMS * (BITS - 1 - cell.level))) & (CHILDREN - 1);
+                    order |= (uint32_t)digit << (DIMS * child);
+                }
+                return order;
+            };
+
+            Cell root = {};
+            root.order = childOrder(root);
+            std::vector<Cell> states = { root };
+            std::vector<uint32_t> next;
+            for(size_t s = 0; s < states.size(); s++)
+            {
+                for(uint32_t child = 0; child < CHILDREN; child++)
+                {
+                    Cell cell = states[s];
+                    for(unsigned int i = 0; i < DIMS; i++)
+                        cell.prefix[i] = (cell.prefix[i] << 1) | ((child >> (DIMS - 1 - i)) & 1);
+                    cell.level++;
+                    cell.order = childOrder(cell);
+
+                    size_t found = 0;
+                    while(found < states.size() && states[found].order != cell.order)
+                        found++;
+                    if(found == states.size())
+                        states.push_back(cell);
+                    next.push_back((uint32_t)found);
+                }
+            }
+
+            //Combine LEVELS steps, in both directions
+            const size_t count = states.size();
+            toHilbert.resize(count << CHUNK);
+            toMorton.resize(count << CHUNK);
+            for(uint32_t s = 0; s < count; s++)
+            {
+                for(uint32_t digits = 0; digits < (1u << CHUNK); digits++)
+                {
+                    uint32_t forward = s, backward = s, hilbert = 0, morton = 0;
+                    for(unsigned int l = LEVELS; l-- > 0;)
+                    {
+                        uint32_t digit = (digits >> (DIMS * l)) & (CHILDREN - 1);
+                        hilbert |= ((states[forward].order >> (DIMS * digit)) & (CHILDREN - 1)) << (DIMS * l);
+                        forward = next[forward * CHILDREN + digit];
+
+                        uint32_t child = 0;
+                        while(((states[backward].order >> (DIMS * child)) & (CHILDREN - 1)) != digit)
+                            child++;
+                        morton |= child << (DIMS * l);
+                        backward = next[backward * CHILDREN + child];
+                    }
+                    toHilbert[(s << CHUNK) | digits] = (uint16_t)(hilbert | forward << CHUNK);
+                    toMorton[(s << CHUNK) | digits] = (uint16_t)(morton | backward << CHUNK);
+                }
+            }
+        }
+
+        //Runs the automaton over the key from the top level down
+        static uint64_t convert(const uint16_t* table, uint64_t key)
+        {
+            uint64_t result = 0;
+            uint32_t state = 0;
+            for(int shift = DIMS * BITS - CHUNK; shift >= 0; shift -= CHUNK)
+            {
+                uint32_t entry = table[(state << CHUNK) | ((key >> shift) & ((1u << CHUNK) - 1))];
+                result |= (uint64_t)(entry & ((1u << CHUNK) - 1)) << shift;
+                state = entry >> CHUNK;
+            }
+            return result;
+        }
+    };
+
+    typedef HilbertTables<2, 32, 4> HilbertTables2;
+    typedef HilbertTables<3, 21, 3> HilbertTables3;
+
+    //Built on first use
+    static const HilbertTables2& hilbertTables2() { static const HilbertTables2 tables; return tables; }
+    static const HilbertTables3& hilbertTables3() { static const HilbertTables3 tables; return tables; }
+
+    template<typename Bits>
+    struct Curves
+    {
+        static uint64_t morton2(const uivec2& v) { return Bits::spread2(v.x) | Bits::spread2(v.y) << 1; }
+        static uivec2 morton2(uint64_t key)      { return Bits::compact2(key); }
+        static uint64_t morton3(const uivec3& v) { return Bits::spread3(v.x & GRID3_MAX) | Bits::spread3(v.y & GRID3_MAX) << 1 | Bits::spread3(v.z & GRID3_MAX) << 2; }
+        static uivec3 morton3(uint64_t key)      { return Bits::compact3(key); }
+
+        //Morton keys hold x in the lowest bit of every level, Hilbert keys in the highest
+        static uint64_t hilbert2(const uivec2& v) { return HilbertTables2::convert(hilbertTables2().toHilbert.data(), Bits::spread2(v.y) | Bits::spread2(v.x) << 1); }
+        static uivec2 hilbert2(uint64_t key)
+        {
+            uivec2 yx = Bits::compact2(HilbertTables2::convert(hilbertTables2().toMorton.data(), key));
+            return uivec2(yx.y, yx.x);
+        }
+
+        static uint64_t hilbert3(const uivec3& v)
+        {
+            return HilbertTables3::convert(hilbertTables3().toHilbert.data(), Bits::spread3(v.z & GRID3_MAX) | Bits::spread3(v.y & GRID3_MAX) << 1 | Bits::spread3(v.x & GRID3_MAX) << 2);
+        }
+        static uivec3 hilbert3(uint64_t key)
+        {
+            uivec3 zyx = Bits::compact3(HilbertTables3::convert(hilbertTables3().toMorton.data(), key));
+            return uivec3(zyx.z, zyx.y, zyx.x);
+        }
+    };
+
+    //Grid of the vec3 keys, scale is 0 on flat axes so every position lands in cell 0 there
+    struct CurveGrid
+    {
+        vec3 origin, scale, cellSize;
+
+        CurveGrid(const bbox3& bounds) : origin(bounds.pos)
+        {
+            const float cells = (float)(GRID3_MAX + 1);
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                scale.vals[i] = bounds.size.vals[i] > 0.0f ? cells / bounds.size.vals[i] : 0.0f;
+                cellSize.vals[i] = bounds.size.vals[i] / cells;
+            }
+        }
+
+        uivec3 quantize(const vec3& position) const
+        {
+            uivec3 q;
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                float f = (position.vals[i] - origin.vals[i]) * scale.vals[i];
+                q.vals[i] = f > 0.0f ? (f < (float)GRID3_MAX ? (uint32_t)f : GRID3_MAX) : 0u; //NaN ends up in cell 0 as well
+            }
+            return q;
+        }
+
+        vec3 center(const uivec3& cell) const
+        {
+            return vec3(origin.x + ((float)cell.x + 0.5f) * cellSize.x,
+                        origin.y + ((float)cell.y + 0.5f) * cellSize.y,
+                        origin.z + ((float)cell.z + 0.5f) * cellSize.z);
+        }
+    };
+
+    //Calls f with an empty Curves<Bits> for the instruction set of this CPU
+    template<typename F>
+    static auto withCurves(F f)
+    {
+#ifdef GUM_MATHS_BMI2_DISPATCH
+        if(hasFastBMI2())
+            return f(Curves<Bmi2Bits>());
+#endif
+        return f(Curves<TableBits>());
+    }
+
+    uint64_t encodeMorton2(const uivec2& v)  { return withCurves([&](auto c) { return c.morton2(v); }); }
+    uivec2 decodeMorton2(uint64_t key)       { return withCurves([&](auto c) { return c.morton2(key); }); }
+    uint64_t encodeMorton3(const uivec3& v)  { return withCurves([&](auto c) { return c.morton3(v); }); }
+    uivec3 decodeMorton3(uint64_t key)       { return withCurves([&](auto c) { return c.morton3(key); }); }
+    uint64_t encodeHilbert2(const uivec2& v) { return withCurves([&](auto c) { return c.hilbert2(v); }); }
+    uivec2 decodeHilbert2(uint64_t key)      { return withCurves([&](auto c) { return c.hilbert2(key); }); }
+    uint64_t encodeHilbert3(const uivec3& v) { return withCurves([&](auto c) { return c.hilbert3(v); }); }
+    uivec3 decodeHilbert3(uint64_t key)      { return withCurves([&](auto c) { return c.hilbert3(key); }); }
+
+    uint64_t encodeMorton3(const vec3& position, const bbox3& bounds)  { return withCurves([&](auto c) { return c.morton3(CurveGrid(bounds).quantize(position)); }); }
+    vec3 decodeMorton3(uint64_t key, const bbox3& bounds)              { return withCurves([&](auto c) { return CurveGrid(bounds).center(c.morton3(key)); }); }
+    uint64_t encodeHilbert3(const vec3& position, const bbox3& bounds) { return withCurves([&](auto c) { return c.hilbert3(CurveGrid(bounds).quantize(position)); }); }
+    vec3 decodeHilbert3(uint64_t key, const bbox3& bounds)             { return withCurves([&](auto c) { return CurveGrid(bounds).center(c.hilbert3(key)); }); }
+
+
+    //
+    // Batches
+    //
+    template<typename In, typename Out, typename F>
+    static void encodingBatch(const In* in, Out* out, size_t count, F f)
+    {
+        parallelFor(0, count, [in, out, f](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = f(in[i]);
+        }, 8192);
+    }
+
+    /**
+     * The instruction set is picked once per chunk, f(curves, element) gets an empty Curves<Bits>
+     * to call, so the BMI2 loop is compiled with BMI2 enabled and pdep/pext get inlined.
+     */
+    template<typename In, typename Out, typename F>
+    static void curveRange(const In* in, Out* out, size_t begin, size_t end, F f)
+    {
+        for(size_t i = begin; i < end; i++)
+            out[i] = f(Curves<TableBits>(), in[i]);
+    }
+
+#ifdef GUM_MATHS_BMI2_DISPATCH
+    template<typename In, typename Out, typename F>
+    __attribute__((target("bmi2")))
+    static void curveRangeBMI2(const In* in, Out* out, size_t begin, size_t end, F f)
+    {
+        for(size_t i = begin; i < end; i++)
+            out[i] = f(Curves<Bmi2Bits>(), in[i]);
+    }
+#endif
+
+    template<typename In, typename Out, typename F>
+    static void curveBatch(const In* in, Out* out, size_t count, F f)
+    {
+        parallelFor(0, count, [in, out, f](size_t begin, size_t end) {
+#ifdef GUM_MATHS_BMI2_DISPATCH
+            if(hasFastBMI2())
+            {
+                curveRangeBMI2(in, out, begin, end, f);
+                return;
+            }
+#endif
+            curveRange(in, out, begin, end, f);
+        }, 8192);
+    }
+
+    void encodeOctahedral16(const vec3* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const vec3&))encodeOctahedral16); }
+    void decodeOctahedral16(const uint32_t* in, vec3* out, size_t count) { encodingBatch(in, out, count, (vec3(*)(uint32_t))decodeOctahedral16); }
+    void encodeOctahedral8(const vec3* in, uint16_t* out, size_t count) { encodingBatch(in, out, count, (uint16_t(*)(const vec3&))encodeOctahedral8); }
+    void decodeOctahedral8(const uint16_t* in, vec3* out, size_t count) { encodingBatch(in, out, count, (vec3(*)(uint16_t))decodeOctahedral8); }
+    void encodeQuat32(const fquat* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const fquat&))encodeQuat32); }
+    void decodeQuat32(const uint32_t* in, fquat* out, size_t count) { encodingBatch(in, out, count, (fquat(*)(uint32_t))decodeQuat32); }
+    void encodeQuat64(const fquat* in, uint64_t* out, size_t count) { encodingBatch(in, out, count, (uint64_t(*)(const fquat&))encodeQuat64); }
+    void decodeQuat64(const uint64_t* in, fquat* out, size_t count) { encodingBatch(in, out, count, (fquat(*)(uint64_t))decodeQuat64); }
+    void packSnorm2x16(const vec2* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const vec2&))packSnorm2x16); }
+    void unpackSnorm2x16(const uint32_t* in, vec2* out, size_t count) { encodingBatch(in, out, count, (vec2(*)(uint32_t))unpackSnorm2x16); }
+    void packUnorm2x16(const vec2* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const vec2&))packUnorm2x16); }
+    void unpackUnorm2x16(const uint32_t* in, vec2* out, size_t count) { encodingBatch(in, out, count, (vec2(*)(uint32_t))unpackUnorm2x16); }
+    void packSnorm4x8(const vec4* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const vec4&))packSnorm4x8); }
+    void unpackSnorm4x8(const uint32_t* in, vec4* out, size_t count) { encodingBatch(in, out, count, (vec4(*)(uint32_t))unpackSnorm4x8); }
+    void packUnorm4x8(const vec4* in, uint32_t* out, size_t count) { encodingBatch(in, out, count, (uint32_t(*)(const vec4&))packUnorm4x8); }
+    void unpackUnorm4x8(const uint32_t* in, vec4* out, size_t count) { encodingBatch(in, out, count, (vec4(*)(uint32_t))unpackUnorm4x8); }
+    void packSnorm4x16(const vec4* in, uint64_t* out, size_t count) { encodingBatch(in, out, count, (uint64_t(*)(const vec4&))packSnorm4x16); }
+    void unpackSnorm4x16(const uint64_t* in, vec4* out, size_t count) { encodingBatch(in, out, count, (vec4(*)(uint64_t))unpackSnorm4x16); }
+    void packUnorm4x16(const vec4* in, uint64_t* out, size_t count) { encodingBatch(in, out, count, (uint64_t(*)(const vec4&))packUnorm4x16); }
+    void unpackUnorm4x16(const uint64_t* in, vec4* out, size_t count) { encodingBatch(in, out, count, (vec4(*)(uint64_t))unpackUnorm4x16); }
+
+    void encodeMorton2(const uivec2* in, uint64_t* out, size_t count)  { curveBatch(in, out, count, [](auto c, const uivec2& v) { return c.morton2(v); }); }
+    void decodeMorton2(const uint64_t* in, uivec2* out, size_t count)  { curveBatch(in, out, count, [](auto c, uint64_t key) { return c.morton2(key); }); }
+    void encodeMorton3(const uivec3* in, uint64_t* out, size_t count)  { curveBatch(in, out, count, [](auto c, const uivec3& v) { return c.morton3(v); }); }
+    void decodeMorton3(const uint64_t* in, uivec3* out, size_t count)  { curveBatch(in, out, count, [](auto c, uint64_t key) { return c.morton3(key); }); }
+    void encodeHilbert2(const uivec2* in, uint64_t* out, size_t count) { curveBatch(in, out, count, [](auto c, const uivec2& v) { return c.hilbert2(v); }); }
+    void decodeHilbert2(const uint64_t* in, uivec2* out, size_t count) { curveBatch(in, out, count, [](auto c, uint64_t key) { return c.hilbert2(key); }); }
+    void encodeHilbert3(const uivec3* in, uint64_t* out, size_t count) { curveBatch(in, out, count, [](auto c, const uivec3& v) { return c.hilbert3(v); }); }
+    void decodeHilbert3(const uint64_t* in, uivec3* out, size_t count) { curveBatch(in, out, count, [](auto c, uint64_t key) { return c.hilbert3(key); }); }
+
+    void encodeMorton3(const vec3* in, uint64_t* out, size_t count, const bbox3& bounds)
+    {
+        CurveGrid grid(bounds);
+        curveBatch(in, out, count, [grid](auto c, const vec3& p) { return c.morton3(grid.quantize(p)); });
+    }
+    void decodeMorton3(const uint64_t* in, vec3* out, size_t count, const bbox3& bounds)
+    {
+        CurveGrid grid(bounds);
+        curveBatch(in, out, count, [grid](auto c, uint64_t key) { return grid.center(c.morton3(key)); });
+    }
+    void encodeHilbert3(const vec3* in, uint64_t* out, size_t count, const bbox3& bounds)
+    {
+        CurveGrid grid(bounds);
+        curveBatch(in, out, count, [grid](auto c, const vec3& p) { return c.hilbert3(grid.quantize(p)); });
+    }
+    void decodeHilbert3(const uint64_t* in, vec3* out, size_t count, const bbox3& bounds)
+    {
+        CurveGrid grid(bounds);
+        curveBatch(in, out, count, [grid](auto c, uint64_t key) { return grid.center(c.hilbert3(key)); });
+    }
+}}
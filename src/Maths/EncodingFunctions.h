@@ -0,0 +1,113 @@
+#pragma once
+#include "vec.h"
+#include "quat.h"
+#include "bbox.h"
+#include <cstdint>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Octahedral unit vector encoding
+     * The sphere is projected onto an octahedron and unfolded into a square, both coordinates
+     * are stored as snorm. Input has to be normalized, decoded vectors are normalized.
+     * Measured maximum angular error over the sphere:
+     *   2x16 bit (uint32_t) ~0.004 degrees
+     *   2x8 bit  (uint16_t) ~0.64 degrees, the encoder tests all four roundings and keeps the closest
+     */
+    extern uint32_t encodeOctahedral16(const vec3& normal);
+    extern vec3 decodeOctahedral16(uint32_t encoded);
+    extern uint16_t encodeOctahedral8(const vec3& normal);
+    extern vec3 decodeOctahedral8(uint16_t encoded);
+
+    /**
+     * Smallest three quaternion encoding
+     * The largest component is dropped and rebuilt from the unit length, its index takes 2 bits and
+     * the remaining three lie in [-1/sqrt(2), 1/sqrt(2)]. q and -q are the same rotation, so the sign
+     * of the decoded quaternion may differ from the input. Input has to be normalized.
+     * Measured maximum rotation angle error:
+     *   32 bit (3x10 bit) ~0.25 degrees
+     *   64 bit (3x20 bit) ~0.0003 degrees, limited by float precision rather than the encoding
+     */
+    extern uint32_t encodeQuat32(const fquat& q);
+    extern fquat decodeQuat32(uint32_t encoded);
+    extern uint64_t encodeQuat64(const fquat& q);
+    extern fquat decodeQuat64(uint64_t encoded);
+
+    /**
+     * Normalized integer packing with the GLSL packSnorm / packUnorm conventions
+     * Input is clamped to [-1, 1] (snorm) or [0, 1] (unorm) and rounded to nearest, the first
+     * component goes into the lowest bits. Maximum absolute error is half a step:
+     *   snorm 16: 1.53e-5   unorm 16: 7.63e-6   snorm 8: 3.94e-3   unorm 8: 1.96e-3
+     */
+    extern uint32_t packSnorm2x16(const vec2& v);
+    extern vec2 unpackSnorm2x16(uint32_t packed);
+    extern uint32_t packUnorm2x16(const vec2& v);
+    extern vec2 unpackUnorm2x16(uint32_t packed);
+    extern uint32_t packSnorm4x8(const vec4& v);
+    extern vec4 unpackSnorm4x8(uint32_t packed);
+    extern uint32_t packUnorm4x8(const vec4& v);
+    extern vec4 unpackUnorm4x8(uint32_t packed);
+    extern uint64_t packSnorm4x16(const vec4& v);
+    extern vec4 unpackSnorm4x16(uint64_t packed);
+    extern uint64_t packUnorm4x16(const vec4& v);
+    extern vec4 unpackUnorm4x16(uint64_t packed);
+
+    /**
+     * Morton (Z-order) and Hilbert keys, sorting by them keeps points that are close in space close in memory
+     * 2D keys interleave 32 bits per axis, 3D keys 21 bits per axis, higher bits of the input are ignored.
+     * Consecutive Hilbert keys are always neighboring cells, so they group a little better than Morton keys
+     * for a few more operations per key.
+     * Bits are interleaved with BMI2 pdep/pext where the CPU has fast versions of them, with tables otherwise.
+     * The vec3 versions quantize positions inside bounds (pos is the minimum corner) to the 21 bit grid,
+     * positions outside are clamped to the border cells and decoding returns the center of the cell.
+     */
+    extern uint64_t encodeMorton2(const uivec2& v);
+    extern uivec2 decodeMorton2(uint64_t key);
+    extern uint64_t encodeMorton3(const uivec3& v);
+    extern uivec3 decodeMorton3(uint64_t key);
+    extern uint64_t encodeMorton3(const vec3& position, const bbox3& bounds);
+    extern vec3 decodeMorton3(uint64_t key, const bbox3& bounds);
+    extern uint64_t encodeHilbert2(const uivec2& v);
+    extern uivec2 decodeHilbert2(uint64_t key);
+    extern uint64_t encodeHilbert3(const uivec3& v);
+    extern uivec3 decodeHilbert3(uint64_t key);
+    extern uint64_t encodeHilbert3(const vec3& position, const bbox3& bounds);
+    extern vec3 decodeHilbert3(uint64_t key, const bbox3& bounds);
+    //Uses the tables even where BMI2 is fast, both give the same keys. Mainly for testing
+    extern void forceCurveTables(bool force);
+
+    //Batch versions, split across the default ThreadPool
+    extern void encodeOctahedral16(const vec3* in, uint32_t* out, size_t count);
+    extern void decodeOctahedral16(const uint32_t* in, vec3* out, size_t count);
+    extern void encodeOctahedral8(const vec3* in, uint16_t* out, size_t count);
+    extern void decodeOctahedral8(const uint16_t* in, vec3* out, size_t count);
+    extern void encodeQuat32(const fquat* in, uint32_t* out, size_t count);
+    extern void decodeQuat32(const uint32_t* in, fquat* out, size_t count);
+    extern void encodeQuat64(const fquat* in, uint64_t* out, size_t count);
+    extern void decodeQuat64(const uint64_t* in, fquat* out, size_t count);
+    extern void packSnorm2x16(const vec2* in, uint32_t* out, size_t count);
+    extern void unpackSnorm2x16(const uint32_t* in, vec2* out, size_t count);
+    extern void packUnorm2x16(const vec2* in, uint32_t* out, size_t count);
+    extern void unpackUnorm2x16(const uint32_t* in, vec2* out, size_t count);
+    extern void packSnorm4x8(const vec4* in, uint32_t* out, size_t count);
+    extern void unpackSnorm4x8(const uint32_t* in, vec4* out, size_t count);
+    extern void packUnorm4x8(const vec4* in, uint32_t* out, size_t count);
+    extern void unpackUnorm4x8(const uint32_t* in, vec4* out, size_t count);
+    extern void packSnorm4x16(const vec4* in, uint64_t* out, size_t count);
+    extern void unpackSnorm4x16(const uint64_t* in, vec4* out, size_t count);
+    extern void packUnorm4x16(const vec4* in, uint64_t* out, size_t count);
+    extern void unpackUnorm4x16(const uint64_t* in, vec4* out, size_t count);
+    extern void encodeMorton2(const uivec2* in, uint64_t* out, size_t count);
+    extern void decodeMorton2(const uint64_t* in, uivec2* out, size_t count);
+    extern void encodeMorton3(const uivec3* in, uint64_t* out, size_t count);
+    extern void decodeMorton3(const uint64_t* in, uivec3* out, size_t count);
+    extern void encodeMorton3(const vec3* in, uint64_t* out, size_t count, const bbox3& bounds);
+    extern void decodeMorton3(const uint64_t* in, vec3* out, size_t count, const bbox3& bounds);
+    extern void encodeHilbert2(const uivec2* in, uint64_t* out, size_t count);
+    extern void decodeHilbert2(const uint64_t* in, uivec2* out, size_t count);
+    extern void encodeHilbert3(const uivec3* in, uint64_t* out, size_t count);
+    extern void decodeHilbert3(const uint64_t* in, uivec3* out, size_t count);
+    extern void encodeHilbert3(const vec3* in, uint64_t* out, size_t count, const bbox3& bounds);
+    extern void decodeHilbert3(const uint64_t* in, vec3* out, size_t count, const bbox3& bounds);
+}}
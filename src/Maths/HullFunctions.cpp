@@ -0,0 +1,582 @@
+#include "HullFunctions.h"
+#include "PredicateFunctions.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace Gum {
+namespace Maths
+{
+    static const size_t PARALLEL_THRESHOLD = 1 << 16;
+    static const size_t MIN_CHUNK_SIZE = 1 << 14;
+
+    template<typename T, unsigned int S>
+    static bool finitePoint(const tvec<T, S>& point)
+    {
+        for(unsigned int i = 0; i < S; i++)
+            if(!std::isfinite(point.vals[i]))
+                return false;
+        return true;
+    }
+
+    //Indices of all finite points
+    template<typename T, unsigned int S>
+    static std::vector<uint32_t> finiteIndices(const tvec<T, S>* points, size_t count)
+    {
+        std::vector<uint32_t> indices;
+        indices.reserve(count);
+        for(size_t i = 0; i < count; i++)
+            if(finitePoint(points[i]))
+                indices.push_back((uint32_t)i);
+
+        if(indices.size() < count)
+            std::cerr << "GumMaths: " << count - indices.size() << " hull points are not finite, skipping them" << std::endl;
+        return indices;
+    }
+
+    static bool useParallel(HullMode mode, size_t count)
+    {
+        if(mode == HullMode::AUTO)
+            return count >= PARALLEL_THRESHOLD && ThreadPool::getDefault().numWorkers() > 1;
+        return mode == HullMode::PARALLEL && count >= 2 * MIN_CHUNK_SIZE;
+    }
+
+    /**
+     * Splits indices into chunks, hull(chunk indices, chunk size, candidates of the chunk) runs for
+     * every chunk on the default ThreadPool and the candidates are concatenated
+     */
+    template<typename F>
+    static std::vector<uint32_t> chunkCandidates(const std::vector<uint32_t>& indices, F hull)
+    {
+        size_t chunkCount = std::min<size_t>(ThreadPool::getDefault().numWorkers() * 4, indices.size() / MIN_CHUNK_SIZE);
+        size_t chunkSize = (indices.size() + chunkCount - 1) / chunkCount;
+        std::vector<std::vector<uint32_t>> candidates(chunkCount);
+
+        parallelFor(0, chunkCount, [&](size_t begin, size_t end) {
+            for(size_t c = begin; c < end; c++)
+            {
+                size_t first = c * chunkSize;
+                size_t size = std::min(chunkSize, indices.size() - first);
+                hull(indices.data() + first, size, candidates[c]);
+            }
+        }, 1);
+
+        std::vector<uint32_t> merged;
+        for(const std::vector<uint32_t>& chunk : candidates)
+            merged.insert(merged.end(), chunk.begin(), chunk.end());
+        return merged;
+    }
+
+
+    //
+    // 2D
+    //
+    //Exact orientation, so nearly collinear points never make the chain turn the wrong way
+    template<typename T>
+    static double cross2(const tvec<T, 2>& o, const tvec<T, 2>& a, const tvec<T, 2>& b)
+    {
+        return orient2d(dvec2((double)o.x, (double)o.y), dvec2((double)a.x, (double)a.y), dvec2((double)b.x, (double)b.y));
+    }
+
+    //Sorts indices in place and writes the counter clockwise hull
+    template<typename T>
+    static void monotoneChain(const tvec<T, 2>* points, uint32_t* indices, size_t count, std::vector<uint32_t>& hull)
+    {
+        hull.clear();
+        if(count == 0)
+            return;
+        std::sort(indices, indices + count, [points](uint32_t a, uint32_t b) {
+            return points[a].x < points[b].x || (points[a].x == points[b].x && points[a].y < points[b].y);
+        });
+
+        hull.resize(2 * count);
+        size_t k = 0;
+        for(size_t i = 0; i < count; i++) //Lower chain
+        {
+            while(k >= 2 && cross2(points[hull[k - 2]], points[hull[k - 1]], points[indices[i]]) <= 0.0)
+                k--;
+            hull[k++] = indices[i];
+        }
+        for(size_t i = count - 1, lower = k + 1; i-- > 0;) //Upper chain, the last point is already on it
+        {
+            while(k >= lower && cross2(points[hull[k - 2]], points[hull[k - 1]], points[indices[i]]) <= 0.0)
+                k--;
+            hull[k++] = indices[i];
+        }
+
+        //The first point closes the upper chain, duplicates of a single point collapse to one
+        hull.resize(count > 1 ? k - 1 : count);
+        if(hull.size() == 2 && points[hull[0]].x == points[hull[1]].x && points[hull[0]].y == points[hull[1]].y)
+            hull.resize(1);
+    }
+
+    template<typename T>
+    static bool convexHull2(const tvec<T, 2>* points, size_t count, std::vector<uint32_t>& hull, HullMode mode)
+    {
+        std::vector<uint32_t> indices = finiteIndices(points, count);
+        if(useParallel(mode, indices.size()))
+        {
+            indices = chunkCandidates(indices, [points](const uint32_t* chunk, size_t size, std::vector<uint32_t>& candidates) {
+                std::vector<uint32_t> sorted(chunk, chunk + size);
+                monotoneChain(points, sorted.data(), size, candidates);
+            });
+        }
+
+        monotoneChain(points, indices.data(), indices.size(), hull);
+        return hull.size() >= 3;
+    }
+
+    bool convexHull(const vec2* points, size_t count, std::vector<uint32_t>& hull, HullMode mode)  { return convexHull2(points, count, hull, mode); }
+    bool convexHull(const dvec2* points, size_t count, std::vector<uint32_t>& hull, HullMode mode) { return convexHull2(points, count, hull, mode); }
+
+
+    //
+    // 3D
+    //
+    template<typename T>
+    static dvec3 toDouble(const tvec<T, 3>& point) { return dvec3((double)point.x, (double)point.y, (double)point.z); }
+
+    //dvec3::dot accumulates in float
+    static double dot(const dvec3& a, const dvec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    /**
+     * Quickhull with triangle faces
+     * Every face keeps the points outside of it, the point furthest away from the hull is added next:
+     * faces it sees are removed and the horizon around them is connected to it. Points within the
+     * tolerance of a face count as inside, so they never become vertices. Whether the eye sees a face
+     * is decided exactly with orient3d on the vertices of the face, so the hull stays convex and no
+     * input point ends up further outside of a face than the tolerance plus the rounding of its plane.
+     */
+    template<typename T>
+    class QuickHull
+    {
+    private:
+        struct Face
+        {
+            uint32_t v[3];
+            uint32_t neighbor[3]; //Face across the edge v[i] -> v[i + 1]
+            dvec3 normal;
+            double offset;
+            std::vector<uint32_t> outside;
+            uint32_t furthest;
+            double furthestDistance;
+            uint32_t mark;
+            bool alive;
+        };
+
+        struct HorizonEdge
+        {
+            uint32_t a, b, face;
+        };
+
+        const tvec<T, 3>* pPoints;
+        double fTolerance;
+        std::vector<Face> vFaces;
+        uint32_t iMark;
+
+        double distance(const Face& face, uint32_t point) const
+        {
+            return dot(face.normal, toDouble(pPoints[point])) - face.offset;
+        }
+
+        uint32_t addFace(uint32_t a, uint32_t b, uint32_t c)
+        {
+            Face face{};
+            face.v[0] = a;
+            face.v[1] = b;
+            face.v[2] = c;
+            dvec3 pa = toDouble(pPoints[a]);
+            dvec3 n = dvec3::cross(toDouble(pPoints[b]) - pa, toDouble(pPoints[c]) - pa);
+            double length = n.length();
+            face.normal = length > 0.0 ? n / length : dvec3(0.0);
+            face.offset = dot(face.normal, pa);
+            face.furthestDistance = 0.0;
+            face.mark = 0;
+            face.alive = true;
+            vFaces.push_back(face);
+            return (uint32_t)vFaces.size() - 1;
+        }
+
+        //Index of the edge b -> a in face
+        static unsigned int edgeIndex(const Face& face, uint32_t a, uint32_t b)
+        {
+            for(unsigned int i = 0; i < 3; i++)
+                if(face.v[i] == b && face.v[(i + 1) % 3] == a)
+                    return i;
+            return 0;
+        }
+
+        void link(uint32_t f, unsigned int edge, uint32_t g)
+        {
+            Face& face = vFaces[f];
+            vFaces[f].neighbor[edge] = g;
+            vFaces[g].neighbor[edgeIndex(vFaces[g], face.v[edge], face.v[(edge + 1) % 3])] = f;
+        }
+
+        /**
+         * Compares axis first and the other two in turn
+         * Ties in the searches for extreme points are broken with it, so on inputs like grids the hull
+         * grows through its corners and not through points inside of its edges.
+         */
+        bool lexicographicLess(uint32_t a, uint32_t b, unsigned int axis) const
+        {
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                T pa = pPoints[a].vals[(axis + i) % 3], pb = pPoints[b].vals[(axis + i) % 3];
+                if(pa != pb)
+                    return pa < pb;
+            }
+            return false;
+        }
+
+        //Moves point to the outside set of the first face in [first, end) it is outside of
+        void assign(uint32_t point, size_t first, size_t end)
+        {
+            for(size_t f = first; f < end; f++)
+            {
+                double d = distance(vFaces[f], point);
+                if(d > fTolerance)
+                {
+                    Face& face = vFaces[f];
+                    if(face.outside.empty() || d > face.furthestDistance + fTolerance
+                    || (d >= face.furthestDistance - fTolerance && lexicographicLess(face.furthest, point, 0)))
+                    {
+                        face.furthestDistance = std::max(d, face.furthestDistance);
+                        face.furthest = point;
+                    }
+                    face.outside.push_back(point);
+                    return;
+                }
+            }
+        }
+
+        bool buildSimplex(const uint32_t* indices, size_t count)
+        {
+            //Most distant pair of the axis extremes
+            uint32_t extremes[6];
+            for(unsigned int i = 0; i < 6; i++)
+                extremes[i] = indices[0];
+            for(size_t i = 1; i < count; i++)
+            {
+                for(unsigned int axis = 0; axis < 3; axis++)
+                {
+                    if(lexicographicLess(indices[i], extremes[2 * axis], axis))     extremes[2 * axis] = indices[i];
+                    if(lexicographicLess(extremes[2 * axis + 1], indices[i], axis)) extremes[2 * axis + 1] = indices[i];
+                }
+            }
+
+            uint32_t a = extremes[0], b = extremes[1];
+            double best = 0.0;
+            for(unsigned int i = 0; i < 6; i++)
+            {
+                for(unsigned int j = i + 1; j < 6; j++)
+                {
+                    double d = (toDouble(pPoints[extremes[i]]) - toDouble(pPoints[extremes[j]])).length();
+                    if(d > best)
+                    {
+                        best = d;
+                        a = extremes[i];
+                        b = extremes[j];
+                    }
+                }
+            }
+            if(best <= fTolerance)
+                return false;
+
+            //Furthest from the line, then furthest from the plane
+            dvec3 pa = toDouble(pPoints[a]);
+            dvec3 ab = (toDouble(pPoints[b]) - pa) / best;
+            uint32_t c = a;
+            best = 0.0;
+            for(size_t i = 0; i < count; i++)
+            {
+                double d = dvec3::cross(toDouble(pPoints[indices[i]]) - pa, ab).length();
+                if(d > best || (d == best && lexicographicLess(c, indices[i], 0)))
+                {
+                    best = d;
+                    c = indices[i];
+                }
+            }
+            if(best <= fTolerance)
+                return false;
+
+            dvec3 n = dvec3::cross(toDouble(pPoints[b]) - pa, toDouble(pPoints[c]) - pa);
+            n = n / n.length();
+            uint32_t d = a;
+            double side = 0.0;
+            best = 0.0;
+            for(size_t i = 0; i < count; i++)
+            {
+                double dist = dot(n, toDouble(pPoints[indices[i]]) - pa);
+                if(std::abs(dist) > best || (std::abs(dist) == best && lexicographicLess(d, indices[i], 0)))
+                {
+                    best = std::abs(dist);
+                    side = dist;
+                    d = indices[i];
+                }
+            }
+            if(best <= fTolerance)
+                return false;
+
+            //abc has to face away from d
+            if(side > 0.0)
+                std::swap(b, c);
+            uint32_t f0 = addFace(a, b, c);
+            uint32_t f1 = addFace(b, a, d);
+            uint32_t f2 = addFace(c, b, d);
+            uint32_t f3 = addFace(a, c, d);
+            link(f0, 0, f1);
+            link(f0, 1, f2);
+            link(f0, 2, f3);
+            link(f1, 1, f3);
+            link(f1, 2, f2);
+            link(f2, 2, f3);
+
+            for(size_t i = 0; i < count; i++)
+                if(indices[i] != a && indices[i] != b && indices[i] != c && indices[i] != d)
+                    assign(indices[i], 0, 4);
+            return true;
+        }
+
+        void addPoint(uint32_t start)
+        {
+            const uint32_t eye = vFaces[start].furthest;
+            const dvec3 point = toDouble(pPoints[eye]);
+            iMark++;
+
+            //Depth first search over the visible faces, walking the edges of every face in order yields
+            //the horizon as a closed counter clockwise loop. Unlike the outside sets visibility has no
+            //tolerance, a face the eye is barely in front of would otherwise leave the hull concave there.
+            struct Frame { uint32_t face; unsigned int entry, step; };
+            std::vector<Frame> stack = { { start, 0, 0 } };
+            std::vector<uint32_t> visible = { start };
+            std::vector<HorizonEdge> horizon;
+            vFaces[start].mark = iMark;
+            while(!stack.empty())
+            {
+                Frame& frame = stack.back();
+                if(frame.step == 3)
+                {
+                    stack.pop_back();
+                    continue;
+                }
+
+                uint32_t f = frame.face;
+                unsigned int edge = (frame.entry + frame.step++) % 3;
+                uint32_t g = vFaces[f].neighbor[edge];
+                if(vFaces[g].mark == iMark)
+                    continue;
+
+                const Face& other = vFaces[g];
+                if(orient3d(toDouble(pPoints[other.v[0]]), toDouble(pPoints[other.v[1]]), toDouble(pPoints[other.v[2]]), point) < 0.0)
+                {
+                    vFaces[g].mark = iMark;
+                    visible.push_back(g);
+                    stack.push_back({ g, edgeIndex(other, vFaces[f].v[edge], vFaces[f].v[(edge + 1) % 3]), 1 });
+                }
+                else
+                    horizon.push_back({ vFaces[f].v[edge], vFaces[f].v[(edge + 1) % 3], g });
+            }
+
+            //New faces in horizon order, consecutive ones share the edge to the eye
+            size_t first = vFaces.size();
+            for(const HorizonEdge& edge : horizon)
+            {
+                uint32_t f = addFace(edge.a, edge.b, eye);
+                link(f, 0, edge.face);
+            }
+            for(size_t i = 0; i < horizon.size(); i++)
+            {
+                size_t next = i + 1 < horizon.size() ? i + 1 : 0;
+                vFaces[first + i].neighbor[1] = (uint32_t)(first + next);
+                vFaces[first + next].neighbor[2] = (uint32_t)(first + i);
+            }
+
+            for(uint32_t f : visible)
+            {
+                vFaces[f].alive = false;
+                std::vector<uint32_t> outside;
+                outside.swap(vFaces[f].outside);
+                for(uint32_t p : outside)
+                    if(p != eye)
+                        assign(p, first, vFaces.size());
+            }
+        }
+
+    public:
+        QuickHull(const tvec<T, 3>* points) : pPoints(points), fTolerance(0.0), iMark(0) {}
+
+        bool build(const uint32_t* indices, size_t count, double tolerance)
+        {
+            fTolerance = tolerance;
+            vFaces.clear();
+            if(count < 4 || !buildSimplex(indices, count))
+            {
+                vFaces.clear();
+                return false;
+            }
+
+            //Faces are only appended, so one pass reaches every face that ever gets outside points
+            for(size_t f = 0; f < vFaces.size(); f++)
+                if(vFaces[f].alive && !vFaces[f].outside.empty())
+                    addPoint((uint32_t)f);
+            return true;
+        }
+
+        void triangles(std::vector<uint32_t>& out) const
+        {
+            out.clear();
+            for(const Face& face : vFaces)
+                if(face.alive)
+                    out.insert(out.end(), face.v, face.v + 3);
+        }
+
+        void vertices(std::vector<uint32_t>& out) const
+        {
+            triangles(out);
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        }
+
+        void halfEdges(ConvexHull& hull) const
+        {
+            //Union of neighboring triangles whose planes agree within the tolerance
+            std::vector<uint32_t> group(vFaces.size());
+            for(size_t f = 0; f < vFaces.size(); f++)
+                group[f] = (uint32_t)f;
+            auto find = [&group](uint32_t f) {
+                while(group[f] != f)
+                    f = group[f] = group[group[f]];
+                return f;
+            };
+
+            for(size_t f = 0; f < vFaces.size(); f++)
+            {
+                const Face& face = vFaces[f];
+                if(!face.alive)
+                    continue;
+                for(unsigned int i = 0; i < 3; i++)
+                {
+                    const Face& other = vFaces[face.neighbor[i]];
+                    if(face.neighbor[i] < f || dot(face.normal, other.normal) <= 0.0)
+                        continue;
+                    uint32_t opposite = other.v[(edgeIndex(other, face.v[i], face.v[(i + 1) % 3]) + 2) % 3];
+                    if(std::abs(distance(face, opposite)) <= fTolerance && std::abs(distance(other, face.v[(i + 2) % 3])) <= fTolerance)
+                        group[find(face.neighbor[i])] = find((uint32_t)f);
+                }
+            }
+
+            //Every triangle edge between two groups becomes a half-edge
+            const uint32_t NONE = 0xFFFFFFFFu;
+            std::vector<uint32_t> edgeOf(vFaces.size() * 3, NONE), faceOf(vFaces.size(), NONE);
+            hull.edges.clear();
+            hull.faces.clear();
+            for(size_t f = 0; f < vFaces.size(); f++)
+            {
+                if(!vFaces[f].alive)
+                    continue;
+                uint32_t g = find((uint32_t)f);
+                for(unsigned int i = 0; i < 3; i++)
+                {
+                    if(find(vFaces[f].neighbor[i]) == g)
+                        continue;
+                    if(faceOf[g] == NONE)
+                    {
+                        faceOf[g] = (uint32_t)hull.faces.size();
+                        hull.faces.push_back((uint32_t)hull.edges.size());
+                    }
+                    edgeOf[3 * f + i] = (uint32_t)hull.edges.size();
+                    hull.edges.push_back({ vFaces[f].v[i], NONE, NONE, faceOf[g] });
+                }
+            }
+
+            //Twin across the triangle edge, next by turning around the end point through merged triangles
+            for(size_t f = 0; f < vFaces.size(); f++)
+            {
+                for(unsigned int i = 0; i < 3; i++)
+                {
+                    uint32_t e = edgeOf[3 * f + i];
+                    if(e == NONE)
+                        continue;
+                    const Face& face = vFaces[f];
+                    const Face& other = vFaces[face.neighbor[i]];
+                    hull.edges[e].twin = edgeOf[3 * face.neighbor[i] + edgeIndex(other, face.v[i], face.v[(i + 1) % 3])];
+
+                    uint32_t t = (uint32_t)f;
+                    unsigned int k = (i + 1) % 3;
+                    while(edgeOf[3 * t + k] == NONE)
+                    {
+                        const Face& current = vFaces[t];
+                        uint32_t across = current.neighbor[k];
+                        k = (edgeIndex(vFaces[across], current.v[k], current.v[(k + 1) % 3]) + 1) % 3;
+                        t = across;
+                    }
+                    hull.edges[e].next = edgeOf[3 * t + k];
+                }
+            }
+
+            hull.vertices.clear();
+            for(const HullHalfEdge& edge : hull.edges)
+                hull.vertices.push_back(edge.vertex);
+            std::sort(hull.vertices.begin(), hull.vertices.end());
+            hull.vertices.erase(std::unique(hull.vertices.begin(), hull.vertices.end()), hull.vertices.end());
+        }
+    };
+
+    template<typename T>
+    static bool quickHull(const tvec<T, 3>* points, size_t count, HullMode mode, QuickHull<T>& hull)
+    {
+        std::vector<uint32_t> indices = finiteIndices(points, count);
+
+        //The tolerance depends on the whole point set, so chunks and the final hull agree on it
+        dvec3 extent = parallelReduce(0, indices.size(), dvec3(0.0), [&](size_t begin, size_t end, dvec3 acc) {
+            for(size_t i = begin; i < end; i++)
+                for(unsigned int axis = 0; axis < 3; axis++)
+                    acc.vals[axis] = std::max(acc.vals[axis], std::abs((double)points[indices[i]].vals[axis]));
+            return acc;
+        }, [](dvec3 a, dvec3 b) { return dvec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)); }, 4096);
+        double tolerance = 3.0 * std::numeric_limits<T>::epsilon() * (extent.x + extent.y + extent.z);
+
+        if(useParallel(mode, indices.size()))
+        {
+            indices = chunkCandidates(indices, [points, tolerance](const uint32_t* chunk, size_t size, std::vector<uint32_t>& candidates) {
+                QuickHull<T> local(points);
+                if(local.build(chunk, size, tolerance))
+                    local.vertices(candidates);
+                else
+                    candidates.assign(chunk, chunk + size); //A flat chunk can still contribute to a solid hull
+            });
+        }
+        return hull.build(indices.data(), indices.size(), tolerance);
+    }
+
+    template<typename T>
+    static bool convexHull3(const tvec<T, 3>* points, size_t count, std::vector<uint32_t>& triangles, HullMode mode)
+    {
+        QuickHull<T> hull(points);
+        triangles.clear();
+        if(!quickHull(points, count, mode, hull))
+            return false;
+        hull.triangles(triangles);
+        return true;
+    }
+
+    template<typename T>
+    static bool convexHull3(const tvec<T, 3>* points, size_t count, ConvexHull& out, HullMode mode)
+    {
+        QuickHull<T> hull(points);
+        out = ConvexHull();
+        if(!quickHull(points, count, mode, hull))
+            return false;
+        hull.halfEdges(out);
+        return true;
+    }
+
+    bool convexHull(const vec3* points, size_t count, std::vector<uint32_t>& triangles, HullMode mode)  { return convexHull3(points, count, triangles, mode); }
+    bool convexHull(const dvec3* points, size_t count, std::vector<uint32_t>& triangles, HullMode mode) { return convexHull3(points, count, triangles, mode); }
+    bool convexHull(const vec3* points, size_t count, ConvexHull& hull, HullMode mode)                  { return convexHull3(points, count, hull, mode); }
+    bool convexHull(const dvec3* points, size_t count, ConvexHull& hull, HullMode mode)                 { return convexHull3(points, count, hull, mode); }
+}}
@@ -0,0 +1,57 @@
+#pragma once
+#include "vec.h"
+#include <cstdint>
+#include <vector>
+
+namespace Gum {
+namespace Maths
+{
+    enum class HullMode : uint8_t
+    {
+        AUTO,     //PARALLEL for large inputs when there is more than one worker
+        SERIAL,
+        PARALLEL  //Hulls of chunks on the default ThreadPool, then the hull of their vertices
+    };
+
+    //One directed edge of a ConvexHull, the edges of a face run counter clockwise seen from outside
+    struct HullHalfEdge
+    {
+        uint32_t vertex; //Index of the input point the edge starts at
+        uint32_t twin;   //Edge between the same points in the opposite direction
+        uint32_t next;   //Following edge of the same face
+        uint32_t face;
+    };
+
+    /**
+     * Half-edge structure of a 3D hull, faces are convex polygons
+     * Triangles in the same plane (within the hull tolerance) are merged into one face.
+     */
+    struct ConvexHull
+    {
+        std::vector<uint32_t> vertices;  //Indices of the input points on the hull, ascending
+        std::vector<HullHalfEdge> edges;
+        std::vector<uint32_t> faces;     //One edge of every face
+    };
+
+
+    /**
+     * Andrew's monotone chain, hull receives the indices of the hull points in counter clockwise order
+     * starting at the point with the smallest x (and y), points on an edge of the hull are left out.
+     * Returns false if all points are collinear, hull then holds the 0 to 2 end points.
+     * Points with NaN or infinite coordinates are skipped with an error.
+     */
+    extern bool convexHull(const vec2* points, size_t count, std::vector<uint32_t>& hull, HullMode mode = HullMode::AUTO);
+    extern bool convexHull(const dvec2* points, size_t count, std::vector<uint32_t>& hull, HullMode mode = HullMode::AUTO);
+
+    /**
+     * Quickhull, triangles receives 3 point indices per hull triangle, counter clockwise seen from outside
+     * Points closer to the hull than 3 * epsilon * (max|x| + max|y| + max|z|), with the epsilon of the
+     * point type, count as inside, so rounding noise on flat sides does not add vertices. No input point
+     * lies further in front of a returned triangle than that.
+     * Returns false without output if all points lie in one plane.
+     */
+    extern bool convexHull(const vec3* points, size_t count, std::vector<uint32_t>& triangles, HullMode mode = HullMode::AUTO);
+    extern bool convexHull(const dvec3* points, size_t count, std::vector<uint32_t>& triangles, HullMode mode = HullMode::AUTO);
+    extern bool convexHull(const vec3* points, size_t count, ConvexHull& hull, HullMode mode = HullMode::AUTO);
+    extern bool convexHull(const dvec3* points, size_t count, ConvexHull& hull, HullMode mode = HullMode::AUTO);
+}}
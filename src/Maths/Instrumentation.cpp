@@ -0,0 +1,229 @@
+#include "Instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+namespace Gum {
+namespace Maths
+{
+    static const unsigned int NUM_OPERATIONS = (unsigned int)InstrumentedOperation::NUM_OPERATIONS;
+    static const unsigned int NUM_SCALARS = (unsigned int)InstrumentedScalar::NUM_SCALARS;
+    static const unsigned int NUM_SHAPES = 50; //rows and cols 0 to 4, 0 meaning larger, for matrices and vectors
+    static const unsigned int NUM_SLOTS = NUM_OPERATIONS * NUM_SCALARS * NUM_SHAPES;
+
+    //Only the owning thread writes, so plain relaxed load + store is enough and no locked instruction is needed
+    struct InstrumentationCounter
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> nanoseconds{0};
+
+        static void add(std::atomic<uint64_t>& counter, uint64_t amount) { counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    };
+
+    struct InstrumentationTotals
+    {
+        uint64_t count[NUM_SLOTS] = {0};
+        uint64_t samples[NUM_SLOTS] = {0};
+        uint64_t nanoseconds[NUM_SLOTS] = {0};
+    };
+
+    struct InstrumentationBlock;
+    struct InstrumentationRegistry
+    {
+        std::mutex mutex;
+        std::vector<InstrumentationBlock*> vBlocks;
+        InstrumentationTotals retired; //Threads that already exited
+    };
+
+    //Never destroyed, threads may still exit after static destruction started
+    static InstrumentationRegistry& getRegistry()
+    {
+        static InstrumentationRegistry* registry = new InstrumentationRegistry();
+        return *registry;
+    }
+
+    struct InstrumentationBlock
+    {
+        InstrumentationCounter counters[NUM_SLOTS];
+
+        InstrumentationBlock()
+        {
+            InstrumentationRegistry& registry = getRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+            registry.vBlocks.push_back(this);
+        }
+
+        ~InstrumentationBlock()
+        {
+            InstrumentationRegistry& registry = getRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+            addTo(registry.retired);
+            registry.vBlocks.erase(std::find(registry.vBlocks.begin(), registry.vBlocks.end(), this));
+        }
+
+        void addTo(InstrumentationTotals& totals) const
+        {
+            for(unsigned int i = 0; i < NUM_SLOTS; i++)
+            {
+                totals.count[i]       += counters[i].count.load(std::memory_order_relaxed);
+                totals.samples[i]     += counters[i].samples.load(std::memory_order_relaxed);
+                totals.nanoseconds[i] += counters[i].nanoseconds.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static std::atomic<unsigned int> iSampleInterval{64};
+
+    static InstrumentationCounter& getCounter(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector)
+    {
+        static thread_local InstrumentationBlock block;
+        unsigned int shape = (vector ? 25 : 0) + (rows <= 4 ? rows : 0) * 5 + (cols <= 4 ? cols : 0);
+        return block.counters[((unsigned int)operation * NUM_SCALARS + (unsigned int)scalar) * NUM_SHAPES + shape];
+    }
+
+
+    void instrumentationCount(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector, uint64_t amount)
+    {
+        InstrumentationCounter::add(getCounter(operation, scalar, rows, cols, vector).count, amount);
+    }
+
+    bool instrumentationCountAndSample(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector)
+    {
+        std::atomic<uint64_t>& count = getCounter(operation, scalar, rows, cols, vector).count;
+        uint64_t previous = count.load(std::memory_order_relaxed);
+        count.store(previous + 1, std::memory_order_relaxed);
+
+        unsigned int interval = iSampleInterval.load(std::memory_order_relaxed);
+        return interval > 0 && previous % interval == 0;
+    }
+
+    void instrumentationAddSample(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector, uint64_t nanoseconds)
+    {
+        InstrumentationCounter& counter = getCounter(operation, scalar, rows, cols, vector);
+        InstrumentationCounter::add(counter.samples, 1);
+        InstrumentationCounter::add(counter.nanoseconds, nanoseconds);
+    }
+
+    void setInstrumentationSampleInterval(unsigned int interval)
+    {
+        iSampleInterval.store(interval, std::memory_order_relaxed);
+    }
+
+    std::vector<InstrumentationEntry> getInstrumentationReport()
+    {
+        InstrumentationTotals totals;
+        {
+            InstrumentationRegistry& registry = getRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+            totals = registry.retired;
+            for(InstrumentationBlock* block : registry.vBlocks)
+                block->addTo(totals);
+        }
+
+        std::vector<InstrumentationEntry> entries;
+        for(unsigned int i = 0; i < NUM_SLOTS; i++)
+        {
+            if(totals.count[i] == 0)
+                continue;
+
+            InstrumentationEntry entry;
+            entry.operation = (InstrumentedOperation)(i / (NUM_SCALARS * NUM_SHAPES));
+            entry.scalar = (InstrumentedScalar)(i / NUM_SHAPES % NUM_SCALARS);
+            entry.rows = i % 25 / 5;
+            entry.cols = i % 5;
+            entry.vector = i % NUM_SHAPES >= 25;
+            entry.count = totals.count[i];
+            entry.samples = totals.samples[i];
+            entry.sampledNanoseconds = (double)totals.nanoseconds[i];
+            entry.estimatedNanoseconds = entry.samples > 0 ? entry.sampledNanoseconds / (double)entry.samples * (double)entry.count : 0.0;
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const InstrumentationEntry& a, const InstrumentationEntry& b) { return a.count > b.count; });
+        return entries;
+    }
+
+    std::string instrumentationReportToString()
+    {
+        std::string output = "operation            shape    scalar          count      mean ns  estimated ms\n";
+        char line[160];
+        for(const InstrumentationEntry& entry : getInstrumentationReport())
+        {
+            std::string shape;
+            if(entry.vector)
+                shape = entry.rows > 0 ? "vec" + std::to_string(entry.rows) : "vecN";
+            else
+                shape = "mat" + (entry.rows > 0 ? std::to_string(entry.rows) : std::string("N")) + "x" + (entry.cols > 0 ? std::to_string(entry.cols) : std::string("N"));
+            if(entry.operation == InstrumentedOperation::MAT_BATCH)
+                shape += "[]";
+
+            if(entry.samples > 0)
+                snprintf(line, sizeof(line), "%-20s %-8s %-8s %12llu %12.1f %13.3f\n", instrumentedOperationName(entry.operation), shape.c_str(), instrumentedScalarName(entry.scalar),
+                         (unsigned long long)entry.count, entry.sampledNanoseconds / (double)entry.samples, entry.estimatedNanoseconds * 1e-6);
+            else
+                snprintf(line, sizeof(line), "%-20s %-8s %-8s %12llu %12s %13s\n", instrumentedOperationName(entry.operation), shape.c_str(), instrumentedScalarName(entry.scalar),
+                         (unsigned long long)entry.count, "-", "-");
+            output.append(line);
+        }
+        return output;
+    }
+
+    //Counters of other threads that are running at the same time may lose the reset
+    void resetInstrumentation()
+    {
+        InstrumentationRegistry& registry = getRegistry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        registry.retired = InstrumentationTotals();
+        for(InstrumentationBlock* block : registry.vBlocks)
+        {
+            for(unsigned int i = 0; i < NUM_SLOTS; i++)
+            {
+                block->counters[i].count.store(0, std::memory_order_relaxed);
+                block->counters[i].samples.store(0, std::memory_order_relaxed);
+                block->counters[i].nanoseconds.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const char* instrumentedOperationName(InstrumentedOperation operation)
+    {
+        switch(operation)
+        {
+            case InstrumentedOperation::VEC_CONSTRUCT:       return "VEC_CONSTRUCT";
+            case InstrumentedOperation::VEC_ARITHMETIC:      return "VEC_ARITHMETIC";
+            case InstrumentedOperation::VEC_COMPOUND:        return "VEC_COMPOUND";
+            case InstrumentedOperation::VEC_COMPARE:         return "VEC_COMPARE";
+            case InstrumentedOperation::VEC_LENGTH:          return "VEC_LENGTH";
+            case InstrumentedOperation::VEC_DOT:             return "VEC_DOT";
+            case InstrumentedOperation::VEC_CROSS:           return "VEC_CROSS";
+            case InstrumentedOperation::VEC_NORMALIZE:       return "VEC_NORMALIZE";
+            case InstrumentedOperation::MAT_CONSTRUCT:       return "MAT_CONSTRUCT";
+            case InstrumentedOperation::MAT_MULTIPLY:        return "MAT_MULTIPLY";
+            case InstrumentedOperation::MAT_SCALAR_MULTIPLY: return "MAT_SCALAR_MULTIPLY";
+            case InstrumentedOperation::MAT_VECTOR_MULTIPLY: return "MAT_VECTOR_MULTIPLY";
+            case InstrumentedOperation::MAT_TRANSPOSE:       return "MAT_TRANSPOSE";
+            case InstrumentedOperation::MAT_DETERMINANT:     return "MAT_DETERMINANT";
+            case InstrumentedOperation::MAT_INVERSE:         return "MAT_INVERSE";
+            case InstrumentedOperation::MAT_DECOMPOSE:       return "MAT_DECOMPOSE";
+            case InstrumentedOperation::MAT_COMPOSE:         return "MAT_COMPOSE";
+            case InstrumentedOperation::MAT_BUILD:           return "MAT_BUILD";
+            case InstrumentedOperation::MAT_BATCH:           return "MAT_BATCH";
+            default:                                         return "UNKNOWN";
+        }
+    }
+
+    const char* instrumentedScalarName(InstrumentedScalar scalar)
+    {
+        switch(scalar)
+        {
+            case InstrumentedScalar::FLOAT:        return "float";
+            case InstrumentedScalar::DOUBLE:       return "double";
+            case InstrumentedScalar::INT:          return "int";
+            case InstrumentedScalar::UNSIGNED_INT: return "uint";
+            case InstrumentedScalar::BOOL:         return "bool";
+            default:                               return "other";
+        }
+    }
+}}
@@ -0,0 +1,133 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Opt-in counters for the vec and mat operators and MatrixFunctions
+ * Configure with -DGUM_MATHS_INSTRUMENTATION=ON (or define GUM_MATHS_INSTRUMENTATION for every
+ * translation unit), without it the hooks expand to nothing. Every thread counts into its own
+ * block, getInstrumentationReport() sums all live and finished threads.
+ *
+ * Constructor counts include every temporary the operators return. Copies made by the compiler
+ * are not seen, tvec and mat stay trivially copyable. Timings are sampled, only every n-th call
+ * of a timed operation is measured (setInstrumentationSampleInterval), cheap vec operators are
+ * only counted since reading the clock would cost more than the operation itself. Sampling is
+ * per operation, type and size, so interleaved operations can not alias.
+ */
+namespace Gum {
+namespace Maths
+{
+    enum class InstrumentedOperation : uint8_t
+    {
+        VEC_CONSTRUCT,
+        VEC_ARITHMETIC,       //+ - * / and bitwise operators returning a new vector
+        VEC_COMPOUND,         //+= -= *= /= ^=
+        VEC_COMPARE,
+        VEC_LENGTH,
+        VEC_DOT,
+        VEC_CROSS,
+        VEC_NORMALIZE,
+        MAT_CONSTRUCT,
+        MAT_MULTIPLY,
+        MAT_SCALAR_MULTIPLY,
+        MAT_VECTOR_MULTIPLY,
+        MAT_TRANSPOSE,
+        MAT_DETERMINANT,
+        MAT_INVERSE,
+        MAT_DECOMPOSE,
+        MAT_COMPOSE,
+        MAT_BUILD,            //translate, scale, rotate, perspective, ortho and view matrices
+        MAT_BATCH,            //Counts elements instead of calls
+        NUM_OPERATIONS
+    };
+
+    enum class InstrumentedScalar : uint8_t
+    {
+        FLOAT,
+        DOUBLE,
+        INT,
+        UNSIGNED_INT,
+        BOOL,
+        OTHER,
+        NUM_SCALARS
+    };
+
+    template<typename T>
+    static constexpr InstrumentedScalar instrumentedScalar()
+    {
+        typedef typename std::remove_cv<T>::type U;
+        if constexpr(std::is_same<U, float>::value)         return InstrumentedScalar::FLOAT;
+        else if constexpr(std::is_same<U, double>::value)   return InstrumentedScalar::DOUBLE;
+        else if constexpr(std::is_same<U, bool>::value)     return InstrumentedScalar::BOOL;
+        else if constexpr(std::is_same<U, int>::value)      return InstrumentedScalar::INT;
+        else if constexpr(std::is_same<U, unsigned int>::value) return InstrumentedScalar::UNSIGNED_INT;
+        else                                                return InstrumentedScalar::OTHER;
+    }
+
+    struct InstrumentationEntry
+    {
+        InstrumentedOperation operation;
+        InstrumentedScalar scalar;
+        unsigned int rows, cols;    //cols is 1 for vectors, 0 means larger than 4
+        bool vector;                //tvec, a mat<T, N, 1> has the same rows and cols but is counted separately
+        uint64_t count;
+        uint64_t samples;
+        double sampledNanoseconds;
+        double estimatedNanoseconds; //Mean sample time * count
+    };
+
+    extern void instrumentationCount(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector, uint64_t amount = 1);
+    //Counts like instrumentationCount, true for every n-th call of the same operation, type and shape
+    extern bool instrumentationCountAndSample(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector);
+    extern void instrumentationAddSample(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector, uint64_t nanoseconds);
+
+    //Every interval-th timed call is measured, 0 disables timing, default 64
+    extern void setInstrumentationSampleInterval(unsigned int interval);
+    //Sorted by count, descending
+    extern std::vector<InstrumentationEntry> getInstrumentationReport();
+    extern std::string instrumentationReportToString();
+    extern void resetInstrumentation();
+    extern const char* instrumentedOperationName(InstrumentedOperation operation);
+    extern const char* instrumentedScalarName(InstrumentedScalar scalar);
+
+    class InstrumentationTimer
+    {
+    private:
+        std::chrono::steady_clock::time_point tStart;
+        InstrumentedOperation eOperation;
+        InstrumentedScalar eScalar;
+        unsigned int iRows, iCols;
+        bool bVector;
+        bool bSampled;
+
+    public:
+        InstrumentationTimer(InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector)
+            : eOperation(operation), eScalar(scalar), iRows(rows), iCols(cols), bVector(vector), bSampled(instrumentationCountAndSample(operation, scalar, rows, cols, vector))
+        {
+            if(bSampled)
+                tStart = std::chrono::steady_clock::now();
+        }
+
+        ~InstrumentationTimer()
+        {
+            if(bSampled)
+                instrumentationAddSample(eOperation, eScalar, iRows, iCols, bVector, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count());
+        }
+    };
+}}
+
+#ifdef GUM_MATHS_INSTRUMENTATION
+    #define GUM_MATHS_COUNT(operation, T, rows, cols)          Gum::Maths::instrumentationCount(Gum::Maths::InstrumentedOperation::operation, Gum::Maths::instrumentedScalar<T>(), rows, cols, false)
+    #define GUM_MATHS_COUNT_VEC(operation, T, size)            Gum::Maths::instrumentationCount(Gum::Maths::InstrumentedOperation::operation, Gum::Maths::instrumentedScalar<T>(), size, 1, true)
+    #define GUM_MATHS_COUNT_N(operation, T, rows, cols, amount) Gum::Maths::instrumentationCount(Gum::Maths::InstrumentedOperation::operation, Gum::Maths::instrumentedScalar<T>(), rows, cols, false, amount)
+    #define GUM_MATHS_TIMED(operation, T, rows, cols)          Gum::Maths::InstrumentationTimer gumMathsInstrumentationTimer(Gum::Maths::InstrumentedOperation::operation, Gum::Maths::instrumentedScalar<T>(), rows, cols, false)
+#else
+    #define GUM_MATHS_COUNT(operation, T, rows, cols)          ((void)0)
+    #define GUM_MATHS_COUNT_VEC(operation, T, size)            ((void)0)
+    #define GUM_MATHS_COUNT_N(operation, T, rows, cols, amount) ((void)0)
+    #define GUM_MATHS_TIMED(operation, T, rows, cols)          ((void)0)
+#endif
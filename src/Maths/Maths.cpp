@@ -1,5 +1,8 @@
 #include "Maths.h"
 #include <math.h>
+#include <iostream>
+#include <limits>
+#include <numeric>
 #include "Constants.h"
 
 namespace Gum {
@@ -24,7 +27,29 @@ namespace Maths
     }
     long binomialCoeff(int n, int k) 
     { 
-        return factorial(n) / (factorial(k) * factorial(n-k)); 
+        if(k < 0 || k > n)
+            return 0;
+        k = std::min(k, n - k);
+        uint64_t value = binomial((unsigned int)n, (unsigned int)k);
+        if(value != 0 && value <= (uint64_t)std::numeric_limits<long>::max())
+            return (long)value;
+
+        //Outside the table: C(n - k + i, i) = C(n - k + i - 1, i - 1) * (n - k + i) / i, with the common
+        //factor of the previous value and i divided out first so the product only overflows if the result does
+        long result = 1;
+        for(long i = 1; i <= k; i++)
+        {
+            long g = std::gcd(result, i);
+            long factor = (n - k + i) / (i / g);
+            result /= g;
+            if(result > std::numeric_limits<long>::max() / factor)
+            {
+                std::cerr << "GumMaths: binomialCoeff(" << n << ", " << k << ") overflows" << std::endl;
+                return 0;
+            }
+            result *= factor;
+        }
+        return result; 
     }
 
     float randf(float from, float to)
@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <array>
+#include <cstdint>
+#include "StringConversion.h"
 
 #define PI 3.14159265358979
 
@@ -20,14 +23,12 @@ namespace Maths
     template<typename T>
     static std::string numToString(const T& num, const unsigned short& precision = std::numeric_limits<unsigned short>::max())
     {
+        std::string str;
         if(precision < std::numeric_limits<unsigned short>::max())
-        {
-            std::stringstream sstream;
-            sstream << std::fixed << std::setprecision(precision) << num;
-            return sstream.str();
-        }
-
-        return std::to_string(num);
+            appendNumber(str, num, precision);
+        else
+            appendNumber(str, num, std::is_integral<T>::value ? -1 : 6); //Same output as std::to_string
+        return str;
     }
 
     //Math Functions
@@ -47,7 +48,28 @@ namespace Maths
     extern double fade(double t);
     extern float distance(float a, float b);
     extern long factorial(int n);
-    extern long binomialCoeff(int n, int k);
+    extern long binomialCoeff(int n, int k); //0 for k outside [0, n], and with an error if the result does not fit into a long
+
+    //Pascal's triangle, built at compile time. Every entry up to row 67 fits into uint64_t
+    static const unsigned int BINOMIAL_TABLE_ROWS = 68;
+    static constexpr std::array<std::array<uint64_t, BINOMIAL_TABLE_ROWS>, BINOMIAL_TABLE_ROWS> buildBinomialTable()
+    {
+        std::array<std::array<uint64_t, BINOMIAL_TABLE_ROWS>, BINOMIAL_TABLE_ROWS> table = {};
+        for(unsigned int n = 0; n < BINOMIAL_TABLE_ROWS; n++)
+        {
+            table[n][0] = 1;
+            for(unsigned int k = 1; k <= n; k++)
+                table[n][k] = table[n - 1][k - 1] + (k < n ? table[n - 1][k] : 0);
+        }
+        return table;
+    }
+    inline constexpr std::array<std::array<uint64_t, BINOMIAL_TABLE_ROWS>, BINOMIAL_TABLE_ROWS> BINOMIAL_TABLE = buildBinomialTable();
+
+    //n over k, 0 for k > n and for rows outside the table
+    static constexpr uint64_t binomial(unsigned int n, unsigned int k)
+    {
+        return n < BINOMIAL_TABLE_ROWS && k <= n ? BINOMIAL_TABLE[n][k] : 0;
+    }
     extern float fract(float f);
     extern float smoothstep (float edge0, float edge1, float x);
     extern float inversesqrt(float x);
@@ -59,12 +81,15 @@ namespace Maths
     }
 
 
-    //Sorting
+    //Largest and smallest element, T() for an empty vector. ArrayFunctions.h has parallel versions for large arrays
     template<typename T> 
-    static T max(std::vector<T> vars)
+    static T max(const std::vector<T>& vars)
     {
-        T maxval = T(0);
-        for(T t : vars)
+        if(vars.empty())
+            return T();
+
+        T maxval = vars[0];
+        for(const T& t : vars)
         {
             if(t > maxval) 
                 maxval = t;
@@ -72,6 +97,21 @@ namespace Maths
         return maxval;
     }
 
+    template<typename T> 
+    static T min(const std::vector<T>& vars)
+    {
+        if(vars.empty())
+            return T();
+
+        T minval = vars[0];
+        for(const T& t : vars)
+        {
+            if(t < minval) 
+                minval = t;
+        }
+        return minval;
+    }
+
     template<typename T> 
     static T min(T x, T y)
     {
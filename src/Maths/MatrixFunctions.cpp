@@ -1,11 +1,13 @@
 #include "MatrixFunctions.h"
 #include "Maths.h"
+#include "Simd.h"
 
 namespace Gum {
 namespace Maths
 {
     mat4 perspective(float FOV, float aspectRatio, float near, float far)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, float, 4, 4);
         mat4 perspectiveMat;
         float scale = 1.0f / tandeg(FOV * 0.5f); 
         perspectiveMat[0][0] = scale / aspectRatio;
@@ -19,6 +21,7 @@ namespace Maths
     
     mat4 ortho(float top, float right, float bottom, float left, float near, float far)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, float, 4, 4);
         mat4 orthoMat;
         orthoMat[0][0] = 2.0f / (right - left);
         orthoMat[1][1] = 2.0f / (top - bottom);
@@ -35,6 +38,7 @@ namespace Maths
 
     mat4 view(const vec3& eye, const vec3& position, const vec3& up)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, float, 4, 4);
         vec3 zaxis = vec3::normalize(position - eye);    
         vec3 xaxis = vec3::normalize(vec3::cross(zaxis, up));
         vec3 yaxis = vec3::cross(xaxis, zaxis);
@@ -50,4 +54,74 @@ namespace Maths
 
         return viewMatrix;
     }
+
+    /**
+     * Block inverse, the matrix is split into the 2x2 blocks A B / C D which are each kept in one register.
+     * Works on the rows of the transposed matrix, which gives the transposed inverse in the same layout.
+     */
+    bool invertMatrix(const mat4& m, mat4& out)
+    {
+#ifdef GUM_MATHS_SSE
+        GUM_MATHS_TIMED(MAT_INVERSE, float, 4, 4);
+        #define GUM_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+        #define GUM_SWIZZLE(a, x, y, z, w)    _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x))
+
+        //2x2 products on row major blocks: A*B, adj(A)*B and A*adj(B)
+        auto mul2   = [](__m128 a, __m128 b) { return _mm_add_ps(_mm_mul_ps(a, GUM_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(GUM_SWIZZLE(a, 1, 0, 3, 2), GUM_SWIZZLE(b, 2, 1, 2, 1))); };
+        auto adjMul = [](__m128 a, __m128 b) { return _mm_sub_ps(_mm_mul_ps(GUM_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(GUM_SWIZZLE(a, 1, 1, 2, 2), GUM_SWIZZLE(b, 2, 3, 0, 1))); };
+        auto mulAdj = [](__m128 a, __m128 b) { return _mm_sub_ps(_mm_mul_ps(a, GUM_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(GUM_SWIZZLE(a, 1, 0, 3, 2), GUM_SWIZZLE(b, 2, 1, 2, 1))); };
+
+        __m128 r0 = _mm_loadu_ps(m[0]);
+        __m128 r1 = _mm_loadu_ps(m[1]);
+        __m128 r2 = _mm_loadu_ps(m[2]);
+        __m128 r3 = _mm_loadu_ps(m[3]);
+
+        __m128 A = _mm_movelh_ps(r0, r1);
+        __m128 B = _mm_movehl_ps(r1, r0);
+        __m128 C = _mm_movelh_ps(r2, r3);
+        __m128 D = _mm_movehl_ps(r3, r2);
+
+        //|A| |B| |C| |D|
+        __m128 detSub = _mm_sub_ps(_mm_mul_ps(GUM_SHUFFLE(r0, r2, 0, 2, 0, 2), GUM_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+                                   _mm_mul_ps(GUM_SHUFFLE(r0, r2, 1, 3, 1, 3), GUM_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+        __m128 detA = GUM_SWIZZLE(detSub, 0, 0, 0, 0);
+        __m128 detB = GUM_SWIZZLE(detSub, 1, 1, 1, 1);
+        __m128 detC = GUM_SWIZZLE(detSub, 2, 2, 2, 2);
+        __m128 detD = GUM_SWIZZLE(detSub, 3, 3, 3, 3);
+
+        __m128 DC = adjMul(D, C);
+        __m128 AB = adjMul(A, B);
+        __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mul2(B, DC));
+        __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mul2(C, AB));
+        __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mulAdj(D, AB));
+        __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mulAdj(A, DC));
+
+        //|M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 tr = _mm_mul_ps(AB, GUM_SWIZZLE(DC, 0, 2, 1, 3));
+        tr = _mm_add_ps(tr, GUM_SWIZZLE(tr, 2, 3, 0, 1));
+        tr = _mm_add_ps(tr, GUM_SWIZZLE(tr, 1, 0, 3, 2));
+        __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+        float det = _mm_cvtss_f32(detM);
+        if(det == 0.0f || !std::isfinite(1.0f / det))
+            return false;
+
+        __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+        X = _mm_mul_ps(X, rDetM);
+        Y = _mm_mul_ps(Y, rDetM);
+        Z = _mm_mul_ps(Z, rDetM);
+        W = _mm_mul_ps(W, rDetM);
+
+        _mm_storeu_ps(out[0], GUM_SHUFFLE(X, Y, 3, 1, 3, 1));
+        _mm_storeu_ps(out[1], GUM_SHUFFLE(X, Y, 2, 0, 2, 0));
+        _mm_storeu_ps(out[2], GUM_SHUFFLE(Z, W, 3, 1, 3, 1));
+        _mm_storeu_ps(out[3], GUM_SHUFFLE(Z, W, 2, 0, 2, 0));
+
+        #undef GUM_SHUFFLE
+        #undef GUM_SWIZZLE
+        return true;
+#else
+        return invertMatrix<float>(m, out);
+#endif
+    }
 }}
\ No newline at end of file
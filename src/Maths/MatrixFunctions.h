@@ -1,6 +1,7 @@
 #pragma once
 #include "mat.h"
 #include "quat.h"
+#include "ThreadPool.h"
 
 namespace Gum {
 namespace Maths
@@ -23,6 +24,7 @@ namespace Maths
     template<typename T>
     static mat<T,4,4> translateMatrix(tvec<T, 3> transVector)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 4, 4);
         mat<T,4,4> mat;
         mat[3][0] = (T)transVector.x;
         mat[3][1] = (T)transVector.y;
@@ -33,6 +35,7 @@ namespace Maths
     template<typename T>
     static mat<T,3,3> translateMatrix(tvec<T, 2> transVector)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 3, 3);
         mat<T,3,3> mat;
         mat[2][0] = (T)transVector.x;
         mat[2][1] = (T)transVector.y;
@@ -42,6 +45,7 @@ namespace Maths
     template<typename T>
     static mat<T,4,4> scaleMatrix(tvec<T, 3> scaleVector)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 4, 4);
         mat<T,4,4> mat;
         mat[0][0] = (T)scaleVector.x;
         mat[1][1] = (T)scaleVector.y;
@@ -52,6 +56,7 @@ namespace Maths
     template<typename T>
     static mat<T,3,3> scaleMatrix(tvec<T, 2> scaleVector)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 3, 3);
         mat<T,3,3> mat;
         mat[0][0] = (T)scaleVector.x;
         mat[1][1] = (T)scaleVector.y;
@@ -62,6 +67,7 @@ namespace Maths
     template<typename T>
     static mat<T,4,4> rotateMatrix(tvec<T, 3> deg)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 4, 4);
         mat<T,4,4> retmat, matx, maty, matz;
         tvec<T, 3> rad = tvec<T, 3>::rad(deg);
 
@@ -89,6 +95,7 @@ namespace Maths
     template<typename T>
     static mat<T,4,4> rotateMatrix(quat<T> q)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 4, 4);
         mat<T,4,4> retmat;
 
         T qxx = q.x * q.x;
@@ -116,6 +123,7 @@ namespace Maths
     template<typename T>
     static mat<T,3,3> rotateMatrix(T q)
     {
+        GUM_MATHS_COUNT(MAT_BUILD, T, 3, 3);
         mat<T,3,3> retmat;
         retmat[0][0] = (T) cos(q);
         retmat[1][0] = (T)-sin(q);
@@ -124,19 +132,133 @@ namespace Maths
         return retmat;
     }
 
+    /**
+     * Splits m into translation * rotation * stretch in one pass
+     * The upper 3x3 part is factored with a polar decomposition A = Q * P (scaled Newton iteration),
+     * Q is the closest rotation and P the symmetric stretch. A mirroring matrix negates both, like
+     * glm does, so the reflection ends up as negative scale and rotation stays a proper rotation.
+     * scale is the diagonal of P and shear its off diagonal (xy, xz, yz), composeMatrix() rebuilds m.
+     * @return false if the 3x3 part is singular, translation and scale (column lengths) are still filled then
+     */
     template<typename T>
-    static quat<T> rotationFromMatrix(mat<T,4,4> m)
+    static bool decomposeMatrix(const mat<T,4,4>& m, tvec<T, 3>& translation, quat<T>& rotation, tvec<T, 3>& scale, tvec<T, 3>& shear)
     {
-        T sx = tvec<T, 3>(m[0][0], m[0][1], m[0][2]).length();
-        T sy = tvec<T, 3>(m[1][0], m[1][1], m[1][2]).length();
-        T sz = tvec<T, 3>(m[2][0], m[2][1], m[2][2]).length();
+        GUM_MATHS_TIMED(MAT_DECOMPOSE, T, 4, 4);
+        typedef tvec<T, 3> vec;
+        auto dot3 = [](const vec& a, const vec& b) { return a.x * b.x + a.y * b.y + a.z * b.z; };
+
+        translation = vec(m[3][0], m[3][1], m[3][2]);
+        vec a[3] = { vec(m[0][0], m[0][1], m[0][2]), vec(m[1][0], m[1][1], m[1][2]), vec(m[2][0], m[2][1], m[2][2]) };
+
+        vec q[3] = { a[0], a[1], a[2] };
+        T det = dot3(q[0], vec::cross(q[1], q[2]));
+        T norm = dot3(a[0], a[0]) + dot3(a[1], a[1]) + dot3(a[2], a[2]);
+        if(std::abs(det) <= std::numeric_limits<T>::epsilon() * norm * std::sqrt(norm))
+        {
+            rotation = quat<T>();
+            scale = vec((T)std::sqrt(dot3(a[0], a[0])), (T)std::sqrt(dot3(a[1], a[1])), (T)std::sqrt(dot3(a[2], a[2])));
+            shear = vec(T(0));
+            return false;
+        }
+
+        //Q <- (g * Q + Q^-T / g) / 2, the inverse transpose comes from the cofactors (cross products of the columns)
+        for(int iteration = 0; iteration < 20; iteration++)
+        {
+            vec cof[3] = { vec::cross(q[1], q[2]), vec::cross(q[2], q[0]), vec::cross(q[0], q[1]) };
+            det = dot3(q[0], cof[0]);
+            T invdet = (T)1 / det;
+            for(int i = 0; i < 3; i++)
+                cof[i] = cof[i] * invdet;
+
+            T qnorm   = dot3(q[0], q[0]) + dot3(q[1], q[1]) + dot3(q[2], q[2]);
+            T invnorm = dot3(cof[0], cof[0]) + dot3(cof[1], cof[1]) + dot3(cof[2], cof[2]);
+            T gamma = (T)std::sqrt(std::sqrt(invnorm / qnorm));
+
+            T change = 0;
+            for(int i = 0; i < 3; i++)
+            {
+                vec next = (q[i] * gamma + cof[i] * ((T)1 / gamma)) * (T)0.5;
+                vec diff = next - q[i];
+                change += dot3(diff, diff);
+                q[i] = next;
+            }
+            if(change <= std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * (T)9)
+                break;
+        }
+
+        //The iteration keeps the sign of the determinant
+        if(det < 0)
+            for(int i = 0; i < 3; i++)
+                q[i] = q[i] * (T)-1;
+
+        //P = Q^T * A, symmetrized against rounding
+        T p[3][3];
+        for(int i = 0; i < 3; i++)
+            for(int j = 0; j < 3; j++)
+                p[i][j] = dot3(q[j], a[i]);
+
+        scale = vec(p[0][0], p[1][1], p[2][2]);
+        shear = vec((p[0][1] + p[1][0]) * (T)0.5, (p[0][2] + p[2][0]) * (T)0.5, (p[1][2] + p[2][1]) * (T)0.5);
+
+        mat<T,3,3> r;
+        for(int i = 0; i < 3; i++)
+            for(int j = 0; j < 3; j++)
+                r[i][j] = q[i].vals[j];
+        rotation = quat<T>(r);
+        return true;
+    }
+
+    template<typename T>
+    static bool decomposeMatrix(const mat<T,4,4>& m, tvec<T, 3>& translation, quat<T>& rotation, tvec<T, 3>& scale)
+    {
+        tvec<T, 3> shear;
+        return decomposeMatrix<T>(m, translation, rotation, scale, shear);
+    }
+
+    //Inverse of decomposeMatrix(), translation * rotation * stretch
+    template<typename T>
+    static mat<T,4,4> composeMatrix(tvec<T, 3> translation, quat<T> rotation, tvec<T, 3> scale, tvec<T, 3> shear = tvec<T, 3>(T(0)))
+    {
+        GUM_MATHS_TIMED(MAT_COMPOSE, T, 4, 4);
+        mat<T,4,4> stretch;
+        stretch[0][0] = scale.x;
+        stretch[1][1] = scale.y;
+        stretch[2][2] = scale.z;
+        stretch[1][0] = stretch[0][1] = shear.x;
+        stretch[2][0] = stretch[0][2] = shear.y;
+        stretch[2][1] = stretch[1][2] = shear.z;
+        return translateMatrix<T>(translation) * rotateMatrix<T>(rotation) * stretch;
+    }
 
-        mat<T,3,3U> rot {
-            m[0][0] / sx, m[1][0] / sy, m[2][0] / sz,
-            m[0][1] / sx, m[1][1] / sy, m[2][1] / sz,
-            m[0][2] / sx, m[1][2] / sy, m[2][2] / sz
-        };
-        return quat<T>(rot);
+    /**
+     * Batched decomposeMatrix(), split across the default ThreadPool
+     * Any output array may be nullptr if it is not needed
+     */
+    template<typename T>
+    static void decomposeMatrices(const mat<T,4,4>* matrices, tvec<T, 3>* translations, quat<T>* rotations, tvec<T, 3>* scales, tvec<T, 3>* shears, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [=](size_t begin, size_t end) {
+            tvec<T, 3> translation, scale, shear;
+            quat<T> rotation;
+            for(size_t i = begin; i < end; i++)
+            {
+                decomposeMatrix<T>(matrices[i], translation, rotation, scale, shear);
+                if(translations != nullptr) translations[i] = translation;
+                if(rotations != nullptr)    rotations[i] = rotation;
+                if(scales != nullptr)       scales[i] = scale;
+                if(shears != nullptr)       shears[i] = shear;
+            }
+        }, 256);
+    }
+
+    template<typename T>
+    static quat<T> rotationFromMatrix(mat<T,4,4> m)
+    {
+        tvec<T, 3> translation, scale;
+        quat<T> rotation;
+        decomposeMatrix<T>(m, translation, rotation, scale);
+        return rotation;
     }
 
     template<typename T>
@@ -145,6 +267,7 @@ namespace Maths
         return tvec<T, 3>(m[3][0], m[3][1], m[3][2]);
     }
 
+    //Column lengths, always positive. decomposeMatrix() gives the signed scale of mirroring or sheared matrices
     template<typename T>
     static tvec<T, 3> scaleFromMatrix(mat<T,4,4> m)
     {
@@ -154,7 +277,6 @@ namespace Maths
         return tvec<T, 3>(sx, sy, sz);
     }
 
-
     template<typename T>
     static mat<T,4,4> createTransformationMatrix(tvec<T, 3> translation, tvec<T, 3> rotation, tvec<T, 3> scale)
     {
@@ -176,6 +298,7 @@ namespace Maths
     template<typename T>
     static mat<T,4,4> inverseTransformationMatrix(mat<T,4,4> m)
     {
+      GUM_MATHS_TIMED(MAT_INVERSE, T, 4, 4);
       mat<T,3,3> rotation = mat<T,3,3>::transpose(mat<T,3,3>(m));
       tvec<T,3> translation = rotation * -positionFromMatrix(m);
       tvec<T,3> scale = scaleFromMatrix(m);
@@ -184,4 +307,176 @@ namespace Maths
 
       return translateMatrix<T>(translation) * rotation44 * scaleMatrix<T>(scale);
     }
+
+
+    /**
+     * General 4x4 inverse through the 2x2 sub determinants of the upper and lower half
+     * @return false if m is singular, out is left untouched then
+     */
+    template<typename T>
+    static bool invertMatrix(const mat<T,4,4>& m, mat<T,4,4>& out)
+    {
+        GUM_MATHS_TIMED(MAT_INVERSE, T, 4, 4);
+        T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+        T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+        T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        T invdet = (T)1 / det;
+        if(det == (T)0 || !std::isfinite(invdet))
+            return false;
+
+        mat<T,4,4> r;
+        r[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invdet;
+        r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invdet;
+        r[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invdet;
+        r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invdet;
+
+        r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invdet;
+        r[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invdet;
+        r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invdet;
+        r[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invdet;
+
+        r[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invdet;
+        r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invdet;
+        r[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invdet;
+        r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invdet;
+
+        r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invdet;
+        r[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invdet;
+        r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invdet;
+        r[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invdet;
+
+        out = r;
+        return true;
+    }
+
+    //SSE version of the above for float matrices
+    extern bool invertMatrix(const mat4& m, mat4& out);
+
+    /**
+     * Inverse of a rotation + translation matrix, transposes the rotation and rotates the negated translation
+     * Only valid without scale or shear, use invertMatrix() for everything else
+     */
+    template<typename T>
+    static mat<T,4,4> invertRigidMatrix(const mat<T,4,4>& m)
+    {
+        GUM_MATHS_COUNT(MAT_INVERSE, T, 4, 4);
+        mat<T,4,4> r;
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                r[i][j] = m[j][i];
+
+        for(unsigned int j = 0; j < 3; j++)
+            r[3][j] = -(m[j][0] * m[3][0] + m[j][1] * m[3][1] + m[j][2] * m[3][2]);
+        return r;
+    }
+
+    /**
+     * Batched inverses, split across the default ThreadPool
+     * in and out may point to the same array. invertible may be nullptr, singular matrices are not written to out.
+     * @return amount of singular matrices
+     */
+    template<typename T>
+    static size_t invertMatrices(const mat<T,4,4>* in, mat<T,4,4>* out, bool* invertible, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        return parallelReduce(0, count, (size_t)0, [in, out, invertible](size_t begin, size_t end, size_t singular) {
+            for(size_t i = begin; i < end; i++)
+            {
+                bool ok = invertMatrix(in[i], out[i]);
+                if(invertible != nullptr)
+                    invertible[i] = ok;
+                singular += ok ? 0 : 1;
+            }
+            return singular;
+        }, [](size_t a, size_t b) { return a + b; }, 256);
+    }
+
+    template<typename T>
+    static void invertRigidMatrices(const mat<T,4,4>* in, mat<T,4,4>* out, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = invertRigidMatrix<T>(in[i]);
+        }, 1024);
+    }
+
+    /**
+     * Batch transforms, split across the default ThreadPool
+     * in and out may point to the same array
+     */
+    template<typename T>
+    static void transformPoints(const mat<T,4,4>& m, const tvec<T, 3>* in, tvec<T, 3>* out, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [&m, in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                tvec<T, 3> p = in[i];
+                out[i].x = m[0][0] * p.x + m[1][0] * p.y + m[2][0] * p.z + m[3][0];
+                out[i].y = m[0][1] * p.x + m[1][1] * p.y + m[2][1] * p.z + m[3][1];
+                out[i].z = m[0][2] * p.x + m[1][2] * p.y + m[2][2] * p.z + m[3][2];
+            }
+        }, 1024);
+    }
+
+    //Ignores the translation, for directions and normals pass the inverse transpose
+    template<typename T>
+    static void transformDirections(const mat<T,4,4>& m, const tvec<T, 3>* in, tvec<T, 3>* out, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [&m, in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                tvec<T, 3> d = in[i];
+                out[i].x = m[0][0] * d.x + m[1][0] * d.y + m[2][0] * d.z;
+                out[i].y = m[0][1] * d.x + m[1][1] * d.y + m[2][1] * d.z;
+                out[i].z = m[0][2] * d.x + m[1][2] * d.y + m[2][2] * d.z;
+            }
+        }, 1024);
+    }
+
+    template<typename T>
+    static void transformVectors(const mat<T,4,4>& m, const tvec<T, 4>* in, tvec<T, 4>* out, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [&m, in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                tvec<T, 4> v = in[i];
+                for(unsigned int j = 0; j < 4; j++)
+                    out[i].vals[j] = m[0][j] * v.x + m[1][j] * v.y + m[2][j] * v.z + m[3][j] * v.w;
+            }
+        }, 1024);
+    }
+
+    //out[i] = a[i] * b[i]
+    template<typename T>
+    static void multiplyMatrices(const mat<T,4,4>* a, const mat<T,4,4>* b, mat<T,4,4>* out, size_t count)
+    {
+        GUM_MATHS_COUNT_N(MAT_BATCH, T, 4, 4, count);
+        parallelFor(0, count, [a, b, out](size_t begin, size_t end) {
+            for(size_t n = begin; n < end; n++)
+            {
+                mat<T,4,4> tmp(T(0));
+                for(unsigned int i = 0; i < 4; i++)
+                    for(unsigned int k = 0; k < 4; k++)
+                        for(unsigned int j = 0; j < 4; j++)
+                            tmp[i][j] += a[n][k][j] * b[n][i][k];
+                out[n] = tmp;
+            }
+        }, 256);
+    }
 }}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "MeshFunctions.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+namespace Gum {
+namespace Maths
+{
+    static inline bool validTriangle(const uint32_t* indices, size_t triangle, size_t vertexCount)
+    {
+        return indices[3 * triangle] < vertexCount && indices[3 * triangle + 1] < vertexCount && indices[3 * triangle + 2] < vertexCount;
+    }
+
+    //Angle between a and b, atan2 stays accurate for nearly parallel edges where acos of the dot product does not
+    static inline float angleBetween(const vec3& a, const vec3& b)
+    {
+        return std::atan2(vec3::cross(a, b).length(), vec3::dot(a, b));
+    }
+
+    static const VertexCorners& getAdjacency(const uint32_t* indices, size_t triangleCount, size_t vertexCount, const VertexCorners* adjacency, VertexCorners& storage)
+    {
+        if(adjacency != nullptr && adjacency->offsets.size() == vertexCount + 1)
+            return *adjacency;
+        if(adjacency != nullptr)
+            std::cerr << "GumMaths: Vertex corners were built for a different vertex count, rebuilding" << std::endl;
+        buildVertexCorners(indices, triangleCount, vertexCount, storage);
+        return storage;
+    }
+
+
+    void buildVertexCorners(const uint32_t* indices, size_t triangleCount, size_t vertexCount, VertexCorners& out)
+    {
+        const size_t cornerCount = triangleCount * 3;
+        std::unique_ptr<std::atomic<uint32_t>[]> counters(new std::atomic<uint32_t>[vertexCount]());
+        std::atomic<size_t> invalid{0};
+
+        parallelFor(0, cornerCount, [&](size_t begin, size_t end) {
+            size_t skipped = 0;
+            for(size_t c = begin; c < end; c++)
+            {
+                if(indices[c] < vertexCount) counters[indices[c]].fetch_add(1, std::memory_order_relaxed);
+                else                         skipped++;
+            }
+            if(skipped > 0)
+                invalid.fetch_add(skipped, std::memory_order_relaxed);
+        }, 4096);
+        if(invalid.load() > 0)
+            std::cerr << "GumMaths: " << invalid.load() << " mesh indices are outside of the " << vertexCount << " vertices, skipping them" << std::endl;
+
+        //Counters turn into the write cursors of every vertex
+        out.offsets.resize(vertexCount + 1);
+        uint32_t sum = 0;
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            out.offsets[v] = sum;
+            sum += counters[v].load(std::memory_order_relaxed);
+            counters[v].store(out.offsets[v], std::memory_order_relaxed);
+        }
+        out.offsets[vertexCount] = sum;
+        out.corners.resize(sum);
+
+        uint32_t* corners = out.corners.data();
+        parallelFor(0, cornerCount, [&](size_t begin, size_t end) {
+            for(size_t c = begin; c < end; c++)
+                if(indices[c] < vertexCount)
+                    corners[counters[indices[c]].fetch_add(1, std::memory_order_relaxed)] = (uint32_t)c;
+        }, 4096);
+
+        const uint32_t* offsets = out.offsets.data();
+        parallelFor(0, vertexCount, [offsets, corners](size_t begin, size_t end) {
+            for(size_t v = begin; v < end; v++)
+                std::sort(corners + offsets[v], corners + offsets[v + 1]);
+        }, 4096);
+    }
+
+    void computeNormals(const vec3* positions, size_t vertexCount, const uint32_t* indices, size_t triangleCount, vec3* normals, NormalWeighting weighting, const VertexCorners* adjacency)
+    {
+        VertexCorners storage;
+        const VertexCorners& vertexCorners = getAdjacency(indices, triangleCount, vertexCount, adjacency, storage);
+
+        //Area weighting uses the raw cross product (twice the area), angle weighting the unit normal and the corner angles
+        const bool angle = weighting == NormalWeighting::ANGLE;
+        std::vector<vec3> faceNormals(triangleCount);
+        std::vector<float> cornerWeights(angle ? triangleCount * 3 : 0);
+        vec3* faces = faceNormals.data();
+        float* weights = cornerWeights.data();
+
+        parallelFor(0, triangleCount, [=](size_t begin, size_t end) {
+            for(size_t f = begin; f < end; f++)
+            {
+                if(!validTriangle(indices, f, vertexCount))
+                {
+                    faces[f] = vec3(0.0f);
+                    if(angle)
+                        weights[3 * f] = weights[3 * f + 1] = weights[3 * f + 2] = 0.0f;
+                    continue;
+                }
+
+                const vec3& p0 = positions[indices[3 * f]];
+                const vec3& p1 = positions[indices[3 * f + 1]];
+                const vec3& p2 = positions[indices[3 * f + 2]];
+                vec3 e01 = p1 - p0, e12 = p2 - p1, e20 = p0 - p2;
+                vec3 n = vec3::cross(e01, p2 - p0);
+                if(!angle)
+                {
+                    faces[f] = n;
+                    continue;
+                }
+
+                float length = n.length();
+                faces[f] = length > 0.0f ? n / length : vec3(0.0f);
+                weights[3 * f]     = angleBetween(e01, -e20);
+                weights[3 * f + 1] = angleBetween(e12, -e01);
+                weights[3 * f + 2] = angleBetween(e20, -e12);
+            }
+        }, 1024);
+
+        const uint32_t* offsets = vertexCorners.offsets.data();
+        const uint32_t* corners = vertexCorners.corners.data();
+        parallelFor(0, vertexCount, [=](size_t begin, size_t end) {
+            for(size_t v = begin; v < end; v++)
+            {
+                vec3 sum(0.0f);
+                for(uint32_t i = offsets[v]; i < offsets[v + 1]; i++)
+                {
+                    uint32_t c = corners[i];
+                    sum += angle ? faces[c / 3] * weights[c] : faces[c / 3];
+                }
+                float length = sum.length();
+                normals[v] = length > 0.0f ? sum / length : vec3(0.0f);
+            }
+        }, 1024);
+    }
+
+    void computeTangents(const vec3* positions, const vec3* normals, const vec2* uvs, size_t vertexCount, const uint32_t* indices, size_t triangleCount, vec4* tangents, const VertexCorners* adjacency)
+    {
+        VertexCorners storage;
+        const VertexCorners& vertexCorners = getAdjacency(indices, triangleCount, vertexCount, adjacency, storage);
+
+        //Unit direction of increasing u per face, negated where the UV mapping mirrors the triangle (MikkTSpace vOs),
+        //the sign is 0 for triangles without UV area
+        std::vector<vec3> faceTangents(triangleCount);
+        std::vector<float> faceSigns(triangleCount);
+        vec3* faces = faceTangents.data();
+        float* signs = faceSigns.data();
+
+        parallelFor(0, triangleCount, [=](size_t begin, size_t end) {
+            for(size_t f = begin; f < end; f++)
+            {
+                faces[f] = vec3(0.0f);
+                signs[f] = 0.0f;
+                if(!validTriangle(indices, f, vertexCount))
+                    continue;
+
+                uint32_t i0 = indices[3 * f], i1 = indices[3 * f + 1], i2 = indices[3 * f + 2];
+                vec3 d1 = positions[i1] - positions[i0], d2 = positions[i2] - positions[i0];
+                vec2 t21 = uvs[i1] - uvs[i0], t31 = uvs[i2] - uvs[i0];
+                float signedArea = t21.x * t31.y - t21.y * t31.x;
+                vec3 os = d1 * t31.y - d2 * t21.y;
+                float length = os.length();
+                if(signedArea == 0.0f || !(length > 0.0f))
+                    continue;
+
+                signs[f] = signedArea > 0.0f ? 1.0f : -1.0f;
+                faces[f] = os * (signs[f] / length);
+            }
+        }, 1024);
+
+        const uint32_t* offsets = vertexCorners.offsets.data();
+        const uint32_t* corners = vertexCorners.corners.data();
+        parallelFor(0, vertexCount, [=](size_t begin, size_t end) {
+            for(size_t v = begin; v < end; v++)
+            {
+                //Faces of either orientation are summed separately, the vertex keeps the side with the larger corner angles
+                const vec3& n = normals[v];
+                vec3 sums[2] = { vec3(0.0f), vec3(0.0f) };
+                float orientations[2] = { 0.0f, 0.0f };
+                for(uint32_t i = offsets[v]; i < offsets[v + 1]; i++)
+                {
+                    uint32_t c = corners[i], f = c / 3, k = c % 3;
+                    if(signs[f] == 0.0f)
+                        continue;
+
+                    //Face tangent and both edges at the corner projected into the tangent plane of the vertex
+                    vec3 os = faces[f] - n * vec3::dot(n, faces[f]);
+                    const vec3& p = positions[v];
+                    vec3 e1 = positions[indices[3 * f + (k + 2) % 3]] - p;
+                    vec3 e2 = positions[indices[3 * f + (k + 1) % 3]] - p;
+                    e1 -= n * vec3::dot(n, e1);
+                    e2 -= n * vec3::dot(n, e2);
+                    float length = os.length();
+                    if(!(length > 0.0f))
+                        continue;
+
+                    float weight = angleBetween(e1, e2);
+                    unsigned int side = signs[f] < 0.0f ? 1 : 0;
+                    sums[side] += os * (weight / length);
+                    orientations[side] += weight;
+                }
+
+                unsigned int side = orientations[1] > orientations[0] ? 1 : 0;
+                vec3 sum = sums[side];
+                float length = sum.length();
+                vec3 t;
+                if(length > 0.0f)
+                    t = sum / length;
+                else
+                {
+                    //Any unit vector orthogonal to the normal
+                    vec3 axis = std::abs(n.x) < 0.9f ? vec3(1.0f, 0.0f, 0.0f) : vec3(0.0f, 1.0f, 0.0f);
+                    t = vec3::cross(n, axis);
+                    float l = t.length();
+                    t = l > 0.0f ? t / l : axis;
+                }
+                tangents[v] = vec4(t.x, t.y, t.z, side == 1 ? -1.0f : 1.0f);
+            }
+        }, 1024);
+    }
+}}
@@ -0,0 +1,53 @@
+#pragma once
+#include "vec.h"
+#include <cstdint>
+#include <vector>
+
+namespace Gum {
+namespace Maths
+{
+    enum class NormalWeighting : uint8_t
+    {
+        AREA,  //Face normals weighted by the triangle area, cheapest
+        ANGLE  //Weighted by the corner angle, independent of how the surface is triangulated
+    };
+
+    /**
+     * Corners of every vertex in CSR layout, corner c is vertex c % 3 of triangle c / 3
+     * The corners of vertex v are corners[offsets[v]] to corners[offsets[v + 1] - 1] in ascending order.
+     */
+    struct VertexCorners
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> corners;
+    };
+
+    /**
+     * Built on the default ThreadPool with integer atomics, the per vertex lists are sorted
+     * afterwards so the result does not depend on the thread timing.
+     * Indices outside of [0, vertexCount) are skipped with an error.
+     */
+    extern void buildVertexCorners(const uint32_t* indices, size_t triangleCount, size_t vertexCount, VertexCorners& out);
+
+    /**
+     * Smooth vertex normals of an indexed triangle list (3 indices per triangle, counter clockwise front faces)
+     * Face values are computed in one pass, every vertex then sums the faces around it, so no two
+     * threads ever write the same vertex. Pass adjacency to reuse it between calls, it is built
+     * otherwise. Vertices without a non degenerate triangle get a zero normal.
+     */
+    extern void computeNormals(const vec3* positions, size_t vertexCount, const uint32_t* indices, size_t triangleCount, vec3* normals,
+                               NormalWeighting weighting = NormalWeighting::AREA, const VertexCorners* adjacency = nullptr);
+
+    /**
+     * Per vertex tangents, xyz is the tangent and w the bitangent sign, bitangent = w * cross(normal, tangent).
+     * The per face UV directions are projected into the tangent plane of every corner and weighted by
+     * the corner angle like in MikkTSpace, w is +1 where the UV mapping keeps the orientation.
+     * This is not MikkTSpace compatible at mirrored UV seams: MikkTSpace splits a vertex whose faces
+     * disagree in orientation, here the vertex is not split and only the faces of the orientation with
+     * the larger corner angles are averaged (ties keep w = +1). Split such vertices beforehand where a
+     * baked normal map has to match exactly.
+     * Vertices without usable UVs get an arbitrary tangent orthogonal to the normal.
+     */
+    extern void computeTangents(const vec3* positions, const vec3* normals, const vec2* uvs, size_t vertexCount, const uint32_t* indices, size_t triangleCount,
+                                vec4* tangents, const VertexCorners* adjacency = nullptr);
+}}
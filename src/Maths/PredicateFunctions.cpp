@@ -0,0 +1,313 @@
+#include "PredicateFunctions.h"
+#include "ThreadPool.h"
+#include <cmath>
+
+//The error free transformations below need every product and sum rounded on its own, src/CMakeLists.txt turns off FMA contraction for this file
+
+namespace Gum {
+namespace Maths
+{
+    static const double EPSILON = 1.1102230246251565e-16;  //2^-53, half an ulp of 1
+    static const double SPLITTER = 134217729.0;             //2^27 + 1
+
+    //Error bounds of the filters relative to the permanent of the determinant
+    static const double ORIENT2D_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+    static const double ORIENT3D_BOUND = (7.0 + 56.0 * EPSILON) * EPSILON;
+    static const double INCIRCLE_BOUND = (10.0 + 96.0 * EPSILON) * EPSILON;
+
+    //
+    // Expansion arithmetic
+    // A value is the exact sum of its terms, which do not overlap and grow in magnitude,
+    // so the last term carries the sign. Zero terms are dropped.
+    //
+    template<int N>
+    struct Expansion
+    {
+        double terms[N];
+        int length = 0;
+
+        void push(double term)
+        {
+            if(term != 0.0)
+                terms[length++] = term;
+        }
+
+        //The largest term, an expansion of 0 still has one term
+        double value() const { return terms[length - 1]; }
+    };
+
+    static inline void twoSum(double a, double b, double& x, double& y)
+    {
+        x = a + b;
+        double bv = x - a;
+        double av = x - bv;
+        y = (a - av) + (b - bv);
+    }
+
+    //Requires |a| >= |b|
+    static inline void fastTwoSum(double a, double b, double& x, double& y)
+    {
+        x = a + b;
+        y = b - (x - a);
+    }
+
+    static inline void twoDiff(double a, double b, double& x, double& y)
+    {
+        x = a - b;
+        double bv = a - x;
+        double av = x + bv;
+        y = (a - av) + (bv - b);
+    }
+
+    static inline void split(double a, double& hi, double& lo)
+    {
+        double c = SPLITTER * a;
+        hi = c - (c - a);
+        lo = a - hi;
+    }
+
+    static inline void twoProduct(double a, double b, double& x, double& y)
+    {
+        x = a * b;
+        double ahi, alo, bhi, blo;
+        split(a, ahi, alo);
+        split(b, bhi, blo);
+        double err = x - ahi * bhi;
+        err -= alo * bhi;
+        err -= ahi * blo;
+        y = alo * blo - err;
+    }
+
+    static inline Expansion<2> difference(double a, double b)
+    {
+        double x, y;
+        twoDiff(a, b, x, y);
+        Expansion<2> result;
+        result.push(y);
+        if(x != 0.0 || result.length == 0)
+            result.terms[result.length++] = x;
+        return result;
+    }
+
+    //Shewchuk's fast_expansion_sum_zeroelim, merges the terms by magnitude and carries the sum through them
+    template<int N, int M>
+    static Expansion<N + M> add(const Expansion<N>& e, const Expansion<M>& f)
+    {
+        Expansion<N + M> h;
+        int ei = 0, fi = 0;
+        auto nextFromE = [&]() { return fi >= f.length || (ei < e.length && (f.terms[fi] > e.terms[ei]) == (f.terms[fi] > -e.terms[ei])); };
+
+        double q = nextFromE() ? e.terms[ei++] : f.terms[fi++];
+        double sum, error;
+        if(ei < e.length && fi < f.length)
+        {
+            double next = nextFromE() ? e.terms[ei++] : f.terms[fi++];
+            fastTwoSum(next, q, sum, error);
+            q = sum;
+            h.push(error);
+        }
+        while(ei < e.length || fi < f.length)
+        {
+            double next = nextFromE() ? e.terms[ei++] : f.terms[fi++];
+            twoSum(q, next, sum, error);
+            q = sum;
+            h.push(error);
+        }
+        if(q != 0.0 || h.length == 0)
+            h.terms[h.length++] = q;
+        return h;
+    }
+
+    template<int N>
+    static Expansion<N> negate(Expansion<N> e)
+    {
+        for(int i = 0; i < e.length; i++)
+            e.terms[i] = -e.terms[i];
+        return e;
+    }
+
+    template<int N, int M>
+    static Expansion<N + M> subtract(const Expansion<N>& e, const Expansion<M>& f)
+    {
+        return add(e, negate(f));
+    }
+
+    //Shewchuk's scale_expansion_zeroelim
+    template<int N>
+    static Expansion<2 * N> scale(const Expansion<N>& e, double b)
+    {
+        Expansion<2 * N> h;
+        double q, error;
+        twoProduct(e.terms[0], b, q, error);
+        h.push(error);
+        for(int i = 1; i < e.length; i++)
+        {
+            double high, low, sum;
+            twoProduct(e.terms[i], b, high, low);
+            twoSum(q, low, sum, error);
+            h.push(error);
+            fastTwoSum(high, sum, q, error);
+            h.push(error);
+        }
+        if(q != 0.0 || h.length == 0)
+            h.terms[h.length++] = q;
+        return h;
+    }
+
+    //Sum of e scaled by every term of f
+    template<int N, int M>
+    static Expansion<2 * N * M> multiply(const Expansion<N>& e, const Expansion<M>& f)
+    {
+        Expansion<2 * N * M> h;
+        Expansion<2 * N> first = scale(e, f.terms[0]);
+        h.length = first.length;
+        for(int k = 0; k < first.length; k++)
+            h.terms[k] = first.terms[k];
+        for(int i = 1; i < f.length; i++)
+        {
+            Expansion<2 * N> part = scale(e, f.terms[i]);
+            Expansion<2 * N * M + 2 * N> sum = add(h, part);
+            h.length = sum.length;
+            for(int k = 0; k < sum.length; k++)
+                h.terms[k] = sum.terms[k];
+        }
+        return h;
+    }
+
+
+    //
+    // Exact evaluation, differences of the inputs are kept as 2 term expansions
+    //
+    static double orient2dExact(const dvec2& a, const dvec2& b, const dvec2& c)
+    {
+        Expansion<2> acx = difference(a.x, c.x), acy = difference(a.y, c.y);
+        Expansion<2> bcx = difference(b.x, c.x), bcy = difference(b.y, c.y);
+        return subtract(multiply(acx, bcy), multiply(acy, bcx)).value();
+    }
+
+    static double orient3dExact(const dvec3& a, const dvec3& b, const dvec3& c, const dvec3& d)
+    {
+        Expansion<2> adx = difference(a.x, d.x), ady = difference(a.y, d.y), adz = difference(a.z, d.z);
+        Expansion<2> bdx = difference(b.x, d.x), bdy = difference(b.y, d.y), bdz = difference(b.z, d.z);
+        Expansion<2> cdx = difference(c.x, d.x), cdy = difference(c.y, d.y), cdz = difference(c.z, d.z);
+
+        Expansion<16> bc = subtract(multiply(bdx, cdy), multiply(cdx, bdy));
+        Expansion<16> ca = subtract(multiply(cdx, ady), multiply(adx, cdy));
+        Expansion<16> ab = subtract(multiply(adx, bdy), multiply(bdx, ady));
+        return add(add(multiply(bc, adz), multiply(ca, bdz)), multiply(ab, cdz)).value();
+    }
+
+    static double incircleExact(const dvec2& a, const dvec2& b, const dvec2& c, const dvec2& d)
+    {
+        Expansion<2> adx = difference(a.x, d.x), ady = difference(a.y, d.y);
+        Expansion<2> bdx = difference(b.x, d.x), bdy = difference(b.y, d.y);
+        Expansion<2> cdx = difference(c.x, d.x), cdy = difference(c.y, d.y);
+
+        Expansion<16> alift = add(multiply(adx, adx), multiply(ady, ady));
+        Expansion<16> blift = add(multiply(bdx, bdx), multiply(bdy, bdy));
+        Expansion<16> clift = add(multiply(cdx, cdx), multiply(cdy, cdy));
+        Expansion<16> bc = subtract(multiply(bdx, cdy), multiply(cdx, bdy));
+        Expansion<16> ca = subtract(multiply(cdx, ady), multiply(adx, cdy));
+        Expansion<16> ab = subtract(multiply(adx, bdy), multiply(bdx, ady));
+        return add(add(multiply(alift, bc), multiply(blift, ca)), multiply(clift, ab)).value();
+    }
+
+
+    //
+    // Filters, return the double determinant and the bound its error stays below
+    //
+    static inline double orient2dFilter(const dvec2& a, const dvec2& b, const dvec2& c, double& bound)
+    {
+        double left = (a.x - c.x) * (b.y - c.y);
+        double right = (a.y - c.y) * (b.x - c.x);
+        bound = ORIENT2D_BOUND * (std::abs(left) + std::abs(right));
+        return left - right;
+    }
+
+    static inline double orient3dFilter(const dvec3& a, const dvec3& b, const dvec3& c, const dvec3& d, double& bound)
+    {
+        double adx = a.x - d.x, ady = a.y - d.y, adz = a.z - d.z;
+        double bdx = b.x - d.x, bdy = b.y - d.y, bdz = b.z - d.z;
+        double cdx = c.x - d.x, cdy = c.y - d.y, cdz = c.z - d.z;
+
+        double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+        double cdxady = cdx * ady, adxcdy = adx * cdy;
+        double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+        bound = ORIENT3D_BOUND * ((std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz)
+                                + (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz)
+                                + (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz));
+        return adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    }
+
+    static inline double incircleFilter(const dvec2& a, const dvec2& b, const dvec2& c, const dvec2& d, double& bound)
+    {
+        double adx = a.x - d.x, ady = a.y - d.y;
+        double bdx = b.x - d.x, bdy = b.y - d.y;
+        double cdx = c.x - d.x, cdy = c.y - d.y;
+
+        double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy, alift = adx * adx + ady * ady;
+        double cdxady = cdx * ady, adxcdy = adx * cdy, blift = bdx * bdx + bdy * bdy;
+        double adxbdy = adx * bdy, bdxady = bdx * ady, clift = cdx * cdx + cdy * cdy;
+
+        bound = INCIRCLE_BOUND * ((std::abs(bdxcdy) + std::abs(cdxbdy)) * alift
+                                + (std::abs(cdxady) + std::abs(adxcdy)) * blift
+                                + (std::abs(adxbdy) + std::abs(bdxady)) * clift);
+        return alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    }
+
+
+    double orient2d(const dvec2& a, const dvec2& b, const dvec2& c)
+    {
+        double bound;
+        double det = orient2dFilter(a, b, c, bound);
+        return std::abs(det) > bound ? det : orient2dExact(a, b, c);
+    }
+
+    double orient3d(const dvec3& a, const dvec3& b, const dvec3& c, const dvec3& d)
+    {
+        double bound;
+        double det = orient3dFilter(a, b, c, d, bound);
+        return std::abs(det) > bound ? det : orient3dExact(a, b, c, d);
+    }
+
+    double incircle(const dvec2& a, const dvec2& b, const dvec2& c, const dvec2& d)
+    {
+        double bound;
+        double det = incircleFilter(a, b, c, d, bound);
+        return std::abs(det) > bound ? det : incircleExact(a, b, c, d);
+    }
+
+
+    //filter(i, bound) returns the filtered determinant of element i, exact(i) the exact one
+    template<typename Filter, typename Exact>
+    static void batch(double* results, size_t count, Filter filter, Exact exact)
+    {
+        parallelFor(0, count, [=](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                double bound;
+                double det = filter(i, bound);
+                results[i] = std::abs(det) > bound ? det : exact(i);
+            }
+        }, 4096);
+    }
+
+    void orient2d(const dvec2* a, const dvec2* b, const dvec2* c, double* results, size_t count)
+    {
+        batch(results, count, [=](size_t i, double& bound) { return orient2dFilter(a[i], b[i], c[i], bound); },
+                              [=](size_t i) { return orient2dExact(a[i], b[i], c[i]); });
+    }
+
+    void orient3d(const dvec3* a, const dvec3* b, const dvec3* c, const dvec3* d, double* results, size_t count)
+    {
+        batch(results, count, [=](size_t i, double& bound) { return orient3dFilter(a[i], b[i], c[i], d[i], bound); },
+                              [=](size_t i) { return orient3dExact(a[i], b[i], c[i], d[i]); });
+    }
+
+    void incircle(const dvec2* a, const dvec2* b, const dvec2* c, const dvec2* d, double* results, size_t count)
+    {
+        batch(results, count, [=](size_t i, double& bound) { return incircleFilter(a[i], b[i], c[i], d[i], bound); },
+                              [=](size_t i) { return incircleExact(a[i], b[i], c[i], d[i]); });
+    }
+}}
@@ -0,0 +1,34 @@
+#pragma once
+#include "vec.h"
+#include <cstddef>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Adaptive precision predicates after Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates"
+     * The determinant is evaluated in plain double first together with a bound on its rounding error.
+     * Only if the result is smaller than that bound it is recomputed exactly with expansion arithmetic,
+     * so the sign is always correct while nearly all calls cost a handful of multiplications.
+     * The returned value approximates the determinant, only its sign is exact.
+     * Inputs have to be finite and small enough that products of coordinate differences do not overflow.
+     */
+
+    //Positive if a, b and c are in counter clockwise order, negative if clockwise and zero if collinear
+    extern double orient2d(const dvec2& a, const dvec2& b, const dvec2& c);
+
+    //Positive if d lies below the plane through a, b and c, which appear counter clockwise seen from above, zero if coplanar
+    extern double orient3d(const dvec3& a, const dvec3& b, const dvec3& c, const dvec3& d);
+
+    //Positive if d lies inside the circle through a, b and c, which have to be counter clockwise, zero if on it
+    extern double incircle(const dvec2& a, const dvec2& b, const dvec2& c, const dvec2& d);
+
+
+    /**
+     * Batch versions, results[i] is the predicate of the i-th element of every array
+     * Split across the default ThreadPool.
+     */
+    extern void orient2d(const dvec2* a, const dvec2* b, const dvec2* c, double* results, size_t count);
+    extern void orient3d(const dvec3* a, const dvec3* b, const dvec3* c, const dvec3* d, double* results, size_t count);
+    extern void incircle(const dvec2* a, const dvec2* b, const dvec2* c, const dvec2* d, double* results, size_t count);
+}}
@@ -0,0 +1,40 @@
+#include "RayFunctions.h"
+#include "ThreadPool.h"
+
+namespace Gum {
+namespace Maths
+{
+    void intersectTriangles(const ray3* rays, RayHit* hits, size_t rayCount, const vec3* vertices, const uint32_t* indices, size_t triangleCount)
+    {
+        const size_t W = vfloat::width;
+        size_t packets = (rayCount + W - 1) / W;
+        parallelFor(0, packets, [=](size_t begin, size_t end) {
+            for(size_t p = begin; p < end; p++)
+            {
+                RayPacket<vfloat> packet(rays + p * W, rayCount - p * W);
+                RayPacketHit<vfloat> hit;
+                for(size_t i = 0; i < triangleCount; i++)
+                    packet.intersectTriangle(vertices[indices[3 * i]], vertices[indices[3 * i + 1]], vertices[indices[3 * i + 2]], (uint32_t)i, hit);
+                hit.store(hits + p * W, rayCount - p * W);
+            }
+        }, triangleCount > 256 ? 1 : 64);
+    }
+
+    void intersectBox(const ray3* rays, float* distances, size_t rayCount, const bbox3& box)
+    {
+        const size_t W = vfloat::width;
+        size_t packets = (rayCount + W - 1) / W;
+        parallelFor(0, packets, [=, &box](size_t begin, size_t end) {
+            alignas(32) float lanes[vfloat::width];
+            for(size_t p = begin; p < end; p++)
+            {
+                RayPacket<vfloat> packet(rays + p * W, rayCount - p * W);
+                vfloat tNear, tFar;
+                vfloat mask = packet.intersectBox(box, tNear, tFar);
+                select(mask, tNear, vfloat(std::numeric_limits<float>::infinity())).storeAligned(lanes);
+                for(size_t l = 0; l < W && p * W + l < rayCount; l++)
+                    distances[p * W + l] = lanes[l];
+            }
+        }, 1024);
+    }
+}}
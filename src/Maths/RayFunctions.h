@@ -0,0 +1,164 @@
+#pragma once
+#include "ray.h"
+#include "Simd.h"
+#include <cstdint>
+
+namespace Gum {
+namespace Maths
+{
+    //Closest hit of a ray, distance is infinity and primitive NO_HIT on a miss
+    struct RayHit
+    {
+        static constexpr uint32_t NO_HIT = 0xFFFFFFFFu;
+        float distance;
+        float u, v;         //Barycentric weights of the second and third vertex
+        uint32_t primitive;
+    };
+
+    /**
+     * Hit records of a packet, primitive holds the raw bits of the triangle index in every lane
+     */
+    template<typename V>
+    struct RayPacketHit
+    {
+        V distance, u, v, primitive;
+
+        RayPacketHit() : distance(std::numeric_limits<float>::infinity()), u(0.0f), v(0.0f), primitive(V::fromBits(RayHit::NO_HIT)) {}
+
+        void update(V mask, V t, V hitU, V hitV, uint32_t index)
+        {
+            distance = select(mask, t, distance);
+            u = select(mask, hitU, u);
+            v = select(mask, hitV, v);
+            primitive = select(mask, V::fromBits(index), primitive);
+        }
+
+        void store(RayHit* hits, size_t count) const
+        {
+            alignas(32) float d[V::width], hu[V::width], hv[V::width];
+            alignas(32) uint32_t p[V::width];
+            distance.storeAligned(d);
+            u.storeAligned(hu);
+            v.storeAligned(hv);
+            primitive.storeAligned((float*)p);
+            for(unsigned int l = 0; l < V::width && l < count; l++)
+                hits[l] = { d[l], hu[l], hv[l], p[l] };
+        }
+    };
+
+    /**
+     * V::width rays in SoA layout, V is vfloat4 or vfloat8
+     * The tests return a lane mask (all bits set where the ray hits) and never branch per lane,
+     * so they can be called from a BVH traversal loop. Lanes of a partially filled packet get
+     * an empty interval and never hit.
+     */
+    template<typename V>
+    struct RayPacket
+    {
+        V origin[3], direction[3], invDirection[3];
+        V tmin, tmax;
+
+        RayPacket() {}
+
+        RayPacket(const ray3* rays, size_t count)
+        {
+            alignas(32) float lanes[11][V::width];
+            for(unsigned int l = 0; l < V::width; l++)
+            {
+                const bool used = l < count;
+                for(unsigned int c = 0; c < 3; c++)
+                {
+                    lanes[c][l]     = used ? rays[l].origin.vals[c] : 0.0f;
+                    lanes[3 + c][l] = used ? rays[l].direction.vals[c] : 1.0f;
+                    lanes[6 + c][l] = used ? rays[l].invDirection.vals[c] : 1.0f;
+                }
+                lanes[9][l]  = used ? rays[l].tmin : 1.0f;
+                lanes[10][l] = used ? rays[l].tmax : -1.0f;
+            }
+
+            for(unsigned int c = 0; c < 3; c++)
+            {
+                origin[c] = V::loadAligned(lanes[c]);
+                direction[c] = V::loadAligned(lanes[3 + c]);
+                invDirection[c] = V::loadAligned(lanes[6 + c]);
+            }
+            tmin = V::loadAligned(lanes[9]);
+            tmax = V::loadAligned(lanes[10]);
+        }
+
+        /**
+         * Slab test against one box, see tray::intersectsBox() for the NaN handling
+         */
+        V intersectBox(const bbox3& box, V& tNear, V& tFar) const
+        {
+            tNear = tmin;
+            tFar = tmax;
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                V t0 = (V(box.pos.vals[i]) - origin[i]) * invDirection[i];
+                V t1 = (V(box.pos.vals[i] + box.size.vals[i]) - origin[i]) * invDirection[i];
+                t0 = select(t0 != t0, -t1, t0);
+                t1 = select(t1 != t1, -t0, t1);
+                tNear = max(min(t0, t1), tNear);
+                tFar = min(max(t0, t1), tFar);
+            }
+            return tNear <= tFar;
+        }
+
+        /**
+         * Möller-Trumbore against one triangle shared by all lanes, see tray::intersectsTriangle()
+         */
+        V intersectTriangle(const vec3& v0, const vec3& v1, const vec3& v2, V& distance, V& u, V& v) const
+        {
+            const V e1[3] = { V(v1.x - v0.x), V(v1.y - v0.y), V(v1.z - v0.z) };
+            const V e2[3] = { V(v2.x - v0.x), V(v2.y - v0.y), V(v2.z - v0.z) };
+            const V* d = direction;
+
+            V p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+            V det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+            V invDet = V(1.0f) / det;
+
+            V s[3] = { origin[0] - V(v0.x), origin[1] - V(v0.y), origin[2] - V(v0.z) };
+            u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+
+            V q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+            distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+
+            //A parallel ray gives det 0 and NaN or inf, every comparison below rejects those
+            return (abs(det) >= V(std::numeric_limits<float>::min())) & (u >= V(0.0f)) & (v >= V(0.0f)) & (u + v <= V(1.0f))
+                 & (distance >= tmin) & (distance <= tmax);
+        }
+
+        /**
+         * Keeps the closest hit, tmax shrinks to it so farther triangles are rejected early
+         * @return lanes that hit this triangle closer than before
+         */
+        V intersectTriangle(const vec3& v0, const vec3& v1, const vec3& v2, uint32_t index, RayPacketHit<V>& hit)
+        {
+            V t, u, v;
+            V mask = intersectTriangle(v0, v1, v2, t, u, v);
+            if(any(mask))
+            {
+                hit.update(mask, t, u, v, index);
+                tmax = select(mask, t, tmax);
+            }
+            return mask;
+        }
+    };
+
+    typedef RayPacket<vfloat4> RayPacket4;
+    typedef RayPacket<vfloat8> RayPacket8;
+
+
+    /**
+     * Closest hit of every ray against an indexed triangle list (3 indices per triangle)
+     * Rays are traced in packets of vfloat::width against every triangle, packets are split across
+     * the default ThreadPool. This is a brute force loop meant for picking and small meshes, larger
+     * scenes should run RayPacket inside their own acceleration structure.
+     */
+    extern void intersectTriangles(const ray3* rays, RayHit* hits, size_t rayCount, const vec3* vertices, const uint32_t* indices, size_t triangleCount);
+
+    //Entry distance of every ray into box, infinity on a miss
+    extern void intersectBox(const ray3* rays, float* distances, size_t rayCount, const bbox3& box);
+}}
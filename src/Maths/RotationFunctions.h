@@ -0,0 +1,123 @@
+#pragma once
+#include "vec.h"
+#include "quat.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Axes in the order they are applied, XYZ rotates around X first, then Y, then Z (R = Rz * Ry * Rx)
+     * Angles are always stored per axis, angles.x is the rotation around X for every order.
+     * XYZ is what quat::toQuaternion and quat::toEuler use.
+     */
+    enum class RotationOrder : uint8_t
+    {
+        XYZ,
+        XZY,
+        YXZ,
+        YZX,
+        ZXY,
+        ZYX
+    };
+
+    enum class ConversionPrecision : uint8_t
+    {
+        PRECISE, //Within a few float ulp of the double conversion
+        FAST     //Shorter polynomials, about 2e-4 degrees off (see RotationFunctions.cpp)
+    };
+
+    //First, second and third axis of the order and the parity, +1 for cyclic orders (XYZ, YZX, ZXY), -1 otherwise
+    static inline void rotationOrderAxes(RotationOrder order, unsigned int& i, unsigned int& j, unsigned int& k, int& parity)
+    {
+        static const unsigned char axes[6][3] = { {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0} };
+        static const int parities[6] = { 1, -1, -1, 1, 1, -1 };
+        i = axes[(unsigned int)order][0];
+        j = axes[(unsigned int)order][1];
+        k = axes[(unsigned int)order][2];
+        parity = parities[(unsigned int)order];
+    }
+
+    /**
+     * q = qk * qj * qi, expanded with half angles c = cos(a / 2), s = sin(a / 2) and parity e
+     * w = ci cj ck + e si sj sk
+     * i = si cj ck - e ci sj sk
+     * j = ci sj ck + e si cj sk
+     * k = ci cj sk - e si sj ck
+     */
+    template<typename T>
+    static quat<T> eulerToQuaternion(const tvec<T, 3>& anglesDeg, RotationOrder order = RotationOrder::XYZ)
+    {
+        unsigned int i, j, k;
+        int parity;
+        rotationOrderAxes(order, i, j, k, parity);
+
+        const T halfRad = (T)(GUM_PI / 360.0);
+        T ci = (T)std::cos(anglesDeg.vals[i] * halfRad), si = (T)std::sin(anglesDeg.vals[i] * halfRad);
+        T cj = (T)std::cos(anglesDeg.vals[j] * halfRad), sj = (T)std::sin(anglesDeg.vals[j] * halfRad);
+        T ck = (T)std::cos(anglesDeg.vals[k] * halfRad), sk = (T)std::sin(anglesDeg.vals[k] * halfRad);
+        T e = (T)parity;
+
+        T v[3];
+        quat<T> q;
+        q.w  = ci * cj * ck + e * si * sj * sk;
+        v[i] = si * cj * ck - e * ci * sj * sk;
+        v[j] = ci * sj * ck + e * si * cj * sk;
+        v[k] = ci * cj * sk - e * si * sj * ck;
+        q.x = v[0];
+        q.y = v[1];
+        q.z = v[2];
+        return q;
+    }
+
+    /**
+     * Inverse of eulerToQuaternion(), the middle angle is in [-90, 90], the others in [-180, 180]
+     * Uses the half angle sums instead of asin of a matrix element, with k' = e * qk:
+     *   w + qj = (cj + sj) cos((i - k') / 2),  qi - qk' = (cj + sj) sin((i - k') / 2)
+     *   w - qj = (cj - sj) cos((i + k') / 2),  qi + qk' = (cj - sj) sin((i + k') / 2)
+     * so every angle comes from an atan2 of two well scaled values, also close to gimbal lock.
+     * At gimbal lock (angle j = +-90) only the sum or difference of the other two is defined,
+     * angle k is set to 0 then.
+     */
+    template<typename T>
+    static tvec<T, 3> quaternionToEuler(const quat<T>& q, RotationOrder order = RotationOrder::XYZ)
+    {
+        unsigned int i, j, k;
+        int parity;
+        rotationOrderAxes(order, i, j, k, parity);
+
+        const T v[3] = { q.x, q.y, q.z };
+        const T qi = v[i], qj = v[j], qk = (T)parity * v[k], w = q.w;
+        const T toDeg = (T)(180.0 / GUM_PI);
+        const T lockTolerance = std::numeric_limits<T>::epsilon() * (T)16;
+
+        T plus = (T)std::hypot(w + qj, qi - qk);  //sqrt(1 + sin(j)) for a unit quaternion
+        T minus = (T)std::hypot(w - qj, qi + qk); //sqrt(1 - sin(j))
+        T difference = (T)std::atan2(qi - qk, w + qj);
+        T sum = (T)std::atan2(qi + qk, w - qj);
+
+        T ai = sum + difference, ak = sum - difference;
+        if(minus < lockTolerance)     { ai = difference + difference; ak = (T)0; }
+        else if(plus < lockTolerance) { ai = sum + sum; ak = (T)0; }
+
+        //q and -q give the same rotation but angles 2 pi apart
+        const T pi = (T)GUM_PI, twoPi = (T)(2.0 * GUM_PI);
+        ai = ai > pi ? ai - twoPi : (ai < -pi ? ai + twoPi : ai);
+        ak = ak > pi ? ak - twoPi : (ak < -pi ? ak + twoPi : ak);
+
+        tvec<T, 3> angles;
+        angles.vals[i] = ai * toDeg;
+        angles.vals[j] = ((T)2 * (T)std::atan2(plus, minus) - (T)GUM_PI_DIV_2) * toDeg;
+        angles.vals[k] = (T)parity * ak * toDeg;
+        return angles;
+    }
+
+    /**
+     * Batched conversions of degree angles, vectorized across elements with a shared sincos
+     * kernel and split across the default ThreadPool. in and out may not overlap.
+     */
+    extern void eulerToQuaternions(const vec3* anglesDeg, quat<float>* out, size_t count, RotationOrder order = RotationOrder::XYZ, ConversionPrecision precision = ConversionPrecision::PRECISE);
+    extern void quaternionsToEuler(const quat<float>* in, vec3* anglesDeg, size_t count, RotationOrder order = RotationOrder::XYZ, ConversionPrecision precision = ConversionPrecision::PRECISE);
+}}
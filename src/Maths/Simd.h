@@ -0,0 +1,198 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Thin wrappers around SSE/AVX registers for the batch kernels
+ * Kernels are written once against these types and the scalar overloads at the bottom,
+ * so the same template runs on float, double, vfloat4 and vfloat8.
+ * Without SSE or AVX the types fall back to plain arrays.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUM_MATHS_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define GUM_MATHS_AVX 1
+#include <immintrin.h>
+#endif
+
+namespace Gum {
+namespace Maths
+{
+    struct vfloat4
+    {
+        static constexpr unsigned int width = 4;
+#ifdef GUM_MATHS_SSE
+        __m128 v;
+        vfloat4() {}
+        vfloat4(__m128 val)  : v(val) {}
+        vfloat4(float f)     : v(_mm_set1_ps(f)) {}
+        vfloat4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+        static vfloat4 load(const float* ptr)          { return _mm_loadu_ps(ptr); }
+        static vfloat4 loadAligned(const float* ptr)   { return _mm_load_ps(ptr); }
+        void store(float* ptr) const                   { _mm_storeu_ps(ptr, v); }
+        void storeAligned(float* ptr) const            { _mm_store_ps(ptr, v); }
+        static vfloat4 fromBits(uint32_t bits)         { return _mm_castsi128_ps(_mm_set1_epi32((int)bits)); }
+        float operator[](unsigned int i) const         { alignas(16) float tmp[4]; _mm_store_ps(tmp, v); return tmp[i]; }
+#else
+        float v[4];
+        vfloat4() {}
+        vfloat4(float f)     { v[0] = v[1] = v[2] = v[3] = f; }
+        vfloat4(float a, float b, float c, float d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+
+        static vfloat4 load(const float* ptr)          { vfloat4 r; memcpy(r.v, ptr, sizeof(r.v)); return r; }
+        static vfloat4 loadAligned(const float* ptr)   { return load(ptr); }
+        void store(float* ptr) const                   { memcpy(ptr, v, sizeof(v)); }
+        void storeAligned(float* ptr) const            { store(ptr); }
+        static vfloat4 fromBits(uint32_t bits)         { float f; memcpy(&f, &bits, 4); return vfloat4(f); }
+        float operator[](unsigned int i) const         { return v[i]; }
+#endif
+    };
+
+#ifdef GUM_MATHS_SSE
+    inline vfloat4 operator+(vfloat4 a, vfloat4 b)  { return _mm_add_ps(a.v, b.v); }
+    inline vfloat4 operator-(vfloat4 a, vfloat4 b)  { return _mm_sub_ps(a.v, b.v); }
+    inline vfloat4 operator*(vfloat4 a, vfloat4 b)  { return _mm_mul_ps(a.v, b.v); }
+    inline vfloat4 operator/(vfloat4 a, vfloat4 b)  { return _mm_div_ps(a.v, b.v); }
+    inline vfloat4 operator-(vfloat4 a)             { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+    inline vfloat4 operator&(vfloat4 a, vfloat4 b)  { return _mm_and_ps(a.v, b.v); }
+    inline vfloat4 operator|(vfloat4 a, vfloat4 b)  { return _mm_or_ps(a.v, b.v); }
+    inline vfloat4 operator^(vfloat4 a, vfloat4 b)  { return _mm_xor_ps(a.v, b.v); }
+    inline vfloat4 operator< (vfloat4 a, vfloat4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    inline vfloat4 operator<=(vfloat4 a, vfloat4 b) { return _mm_cmple_ps(a.v, b.v); }
+    inline vfloat4 operator> (vfloat4 a, vfloat4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+    inline vfloat4 operator>=(vfloat4 a, vfloat4 b) { return _mm_cmpge_ps(a.v, b.v); }
+    inline vfloat4 operator==(vfloat4 a, vfloat4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+    inline vfloat4 operator!=(vfloat4 a, vfloat4 b) { return _mm_cmpneq_ps(a.v, b.v); }
+    inline vfloat4 min(vfloat4 a, vfloat4 b)        { return _mm_min_ps(a.v, b.v); }
+    inline vfloat4 max(vfloat4 a, vfloat4 b)        { return _mm_max_ps(a.v, b.v); }
+    inline vfloat4 sqrt(vfloat4 a)                  { return _mm_sqrt_ps(a.v); }
+    inline vfloat4 abs(vfloat4 a)                   { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+    inline vfloat4 andnot(vfloat4 mask, vfloat4 a)  { return _mm_andnot_ps(mask.v, a.v); }
+    //mask ? a : b, mask lanes have to be all ones or all zeros
+    inline vfloat4 select(vfloat4 mask, vfloat4 a, vfloat4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+    inline int movemask(vfloat4 mask)               { return _mm_movemask_ps(mask.v); }
+#else
+#define GUM_VFLOAT4_OP(op) inline vfloat4 operator op(vfloat4 a, vfloat4 b) { vfloat4 r; for(int i = 0; i < 4; i++) r.v[i] = a.v[i] op b.v[i]; return r; }
+#define GUM_VFLOAT4_BITOP(op) inline vfloat4 operator op(vfloat4 a, vfloat4 b) { vfloat4 r; for(int i = 0; i < 4; i++) { uint32_t x, y; memcpy(&x, &a.v[i], 4); memcpy(&y, &b.v[i], 4); x = x op y; memcpy(&r.v[i], &x, 4); } return r; }
+#define GUM_VFLOAT4_CMP(op) inline vfloat4 operator op(vfloat4 a, vfloat4 b) { vfloat4 r; for(int i = 0; i < 4; i++) { uint32_t x = a.v[i] op b.v[i] ? 0xFFFFFFFFu : 0u; memcpy(&r.v[i], &x, 4); } return r; }
+    GUM_VFLOAT4_OP(+) GUM_VFLOAT4_OP(-) GUM_VFLOAT4_OP(*) GUM_VFLOAT4_OP(/)
+    GUM_VFLOAT4_BITOP(&) GUM_VFLOAT4_BITOP(|) GUM_VFLOAT4_BITOP(^)
+    GUM_VFLOAT4_CMP(<) GUM_VFLOAT4_CMP(<=) GUM_VFLOAT4_CMP(>) GUM_VFLOAT4_CMP(>=) GUM_VFLOAT4_CMP(==) GUM_VFLOAT4_CMP(!=)
+#undef GUM_VFLOAT4_OP
+#undef GUM_VFLOAT4_BITOP
+#undef GUM_VFLOAT4_CMP
+    inline vfloat4 operator-(vfloat4 a)             { return vfloat4(-a.v[0], -a.v[1], -a.v[2], -a.v[3]); }
+    inline vfloat4 min(vfloat4 a, vfloat4 b)        { vfloat4 r; for(int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+    inline vfloat4 max(vfloat4 a, vfloat4 b)        { vfloat4 r; for(int i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+    inline vfloat4 sqrt(vfloat4 a)                  { vfloat4 r; for(int i = 0; i < 4; i++) r.v[i] = std::sqrt(a.v[i]); return r; }
+    inline vfloat4 abs(vfloat4 a)                   { vfloat4 r; for(int i = 0; i < 4; i++) r.v[i] = std::fabs(a.v[i]); return r; }
+    inline vfloat4 andnot(vfloat4 mask, vfloat4 a)  { return (mask ^ vfloat4::fromBits(0xFFFFFFFFu)) & a; }
+    inline vfloat4 select(vfloat4 mask, vfloat4 a, vfloat4 b) { return (mask & a) | andnot(mask, b); }
+    inline int movemask(vfloat4 mask)               { int m = 0; for(int i = 0; i < 4; i++) { uint32_t x; memcpy(&x, &mask.v[i], 4); m |= (int)(x >> 31) << i; } return m; }
+#endif
+    inline vfloat4 copysign(vfloat4 mag, vfloat4 sgn)  { vfloat4 signbit(-0.0f); return andnot(signbit, mag) | (sgn & signbit); }
+    inline bool all(vfloat4 mask)                      { return movemask(mask) == 0xF; }
+    inline bool any(vfloat4 mask)                      { return movemask(mask) != 0; }
+
+
+    /**
+     * 8 lanes, one AVX register or two vfloat4 halves
+     */
+    struct vfloat8
+    {
+        static constexpr unsigned int width = 8;
+#ifdef GUM_MATHS_AVX
+        __m256 v;
+        vfloat8() {}
+        vfloat8(__m256 val)  : v(val) {}
+        vfloat8(float f)     : v(_mm256_set1_ps(f)) {}
+        vfloat8(vfloat4 lo, vfloat4 hi) : v(_mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1)) {}
+
+        static vfloat8 load(const float* ptr)          { return _mm256_loadu_ps(ptr); }
+        static vfloat8 loadAligned(const float* ptr)   { return _mm256_load_ps(ptr); }
+        void store(float* ptr) const                   { _mm256_storeu_ps(ptr, v); }
+        void storeAligned(float* ptr) const            { _mm256_store_ps(ptr, v); }
+        static vfloat8 fromBits(uint32_t bits)         { return _mm256_castsi256_ps(_mm256_set1_epi32((int)bits)); }
+        vfloat4 low() const                            { return _mm256_castps256_ps128(v); }
+        vfloat4 high() const                           { return _mm256_extractf128_ps(v, 1); }
+        float operator[](unsigned int i) const         { alignas(32) float tmp[8]; _mm256_store_ps(tmp, v); return tmp[i]; }
+#else
+        vfloat4 lo, hi;
+        vfloat8() {}
+        vfloat8(float f) : lo(f), hi(f) {}
+        vfloat8(vfloat4 l, vfloat4 h) : lo(l), hi(h) {}
+
+        static vfloat8 load(const float* ptr)          { return vfloat8(vfloat4::load(ptr), vfloat4::load(ptr + 4)); }
+        static vfloat8 loadAligned(const float* ptr)   { return vfloat8(vfloat4::loadAligned(ptr), vfloat4::loadAligned(ptr + 4)); }
+        void store(float* ptr) const                   { lo.store(ptr); hi.store(ptr + 4); }
+        void storeAligned(float* ptr) const            { lo.storeAligned(ptr); hi.storeAligned(ptr + 4); }
+        static vfloat8 fromBits(uint32_t bits)         { return vfloat8(vfloat4::fromBits(bits), vfloat4::fromBits(bits)); }
+        vfloat4 low() const                            { return lo; }
+        vfloat4 high() const                           { return hi; }
+        float operator[](unsigned int i) const         { return i < 4 ? lo[i] : hi[i - 4]; }
+#endif
+    };
+
+#ifdef GUM_MATHS_AVX
+    inline vfloat8 operator+(vfloat8 a, vfloat8 b)  { return _mm256_add_ps(a.v, b.v); }
+    inline vfloat8 operator-(vfloat8 a, vfloat8 b)  { return _mm256_sub_ps(a.v, b.v); }
+    inline vfloat8 operator*(vfloat8 a, vfloat8 b)  { return _mm256_mul_ps(a.v, b.v); }
+    inline vfloat8 operator/(vfloat8 a, vfloat8 b)  { return _mm256_div_ps(a.v, b.v); }
+    inline vfloat8 operator-(vfloat8 a)             { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+    inline vfloat8 operator&(vfloat8 a, vfloat8 b)  { return _mm256_and_ps(a.v, b.v); }
+    inline vfloat8 operator|(vfloat8 a, vfloat8 b)  { return _mm256_or_ps(a.v, b.v); }
+    inline vfloat8 operator^(vfloat8 a, vfloat8 b)  { return _mm256_xor_ps(a.v, b.v); }
+    inline vfloat8 operator< (vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    inline vfloat8 operator<=(vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+    inline vfloat8 operator> (vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    inline vfloat8 operator>=(vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+    inline vfloat8 operator==(vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+    inline vfloat8 operator!=(vfloat8 a, vfloat8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ); }
+    inline vfloat8 min(vfloat8 a, vfloat8 b)        { return _mm256_min_ps(a.v, b.v); }
+    inline vfloat8 max(vfloat8 a, vfloat8 b)        { return _mm256_max_ps(a.v, b.v); }
+    inline vfloat8 sqrt(vfloat8 a)                  { return _mm256_sqrt_ps(a.v); }
+    inline vfloat8 abs(vfloat8 a)                   { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+    inline vfloat8 andnot(vfloat8 mask, vfloat8 a)  { return _mm256_andnot_ps(mask.v, a.v); }
+    inline vfloat8 select(vfloat8 mask, vfloat8 a, vfloat8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+    inline int movemask(vfloat8 mask)               { return _mm256_movemask_ps(mask.v); }
+#else
+#define GUM_VFLOAT8_OP(op) inline vfloat8 operator op(vfloat8 a, vfloat8 b) { return vfloat8(a.lo op b.lo, a.hi op b.hi); }
+    GUM_VFLOAT8_OP(+) GUM_VFLOAT8_OP(-) GUM_VFLOAT8_OP(*) GUM_VFLOAT8_OP(/)
+    GUM_VFLOAT8_OP(&) GUM_VFLOAT8_OP(|) GUM_VFLOAT8_OP(^)
+    GUM_VFLOAT8_OP(<) GUM_VFLOAT8_OP(<=) GUM_VFLOAT8_OP(>) GUM_VFLOAT8_OP(>=) GUM_VFLOAT8_OP(==) GUM_VFLOAT8_OP(!=)
+#undef GUM_VFLOAT8_OP
+    inline vfloat8 operator-(vfloat8 a)             { return vfloat8(-a.lo, -a.hi); }
+    inline vfloat8 min(vfloat8 a, vfloat8 b)        { return vfloat8(min(a.lo, b.lo), min(a.hi, b.hi)); }
+    inline vfloat8 max(vfloat8 a, vfloat8 b)        { return vfloat8(max(a.lo, b.lo), max(a.hi, b.hi)); }
+    inline vfloat8 sqrt(vfloat8 a)                  { return vfloat8(sqrt(a.lo), sqrt(a.hi)); }
+    inline vfloat8 abs(vfloat8 a)                   { return vfloat8(abs(a.lo), abs(a.hi)); }
+    inline vfloat8 andnot(vfloat8 mask, vfloat8 a)  { return vfloat8(andnot(mask.lo, a.lo), andnot(mask.hi, a.hi)); }
+    inline vfloat8 select(vfloat8 mask, vfloat8 a, vfloat8 b) { return vfloat8(select(mask.lo, a.lo, b.lo), select(mask.hi, a.hi, b.hi)); }
+    inline int movemask(vfloat8 mask)               { return movemask(mask.lo) | (movemask(mask.hi) << 4); }
+#endif
+    inline vfloat8 copysign(vfloat8 mag, vfloat8 sgn)  { vfloat8 signbit(-0.0f); return andnot(signbit, mag) | (sgn & signbit); }
+    inline bool all(vfloat8 mask)                      { return movemask(mask) == 0xFF; }
+    inline bool any(vfloat8 mask)                      { return movemask(mask) != 0; }
+
+
+    //Scalar counterparts so kernels can be instantiated with plain floating point types
+    inline float  select(bool mask, float a, float b)   { return mask ? a : b; }
+    inline double select(bool mask, double a, double b) { return mask ? a : b; }
+    inline bool   all(bool mask)                        { return mask; }
+    inline bool   any(bool mask)                        { return mask; }
+    template<typename T> struct simd_traits             { typedef T scalar; static constexpr unsigned int width = 1; };
+    template<> struct simd_traits<vfloat4>              { typedef float scalar; static constexpr unsigned int width = 4; };
+    template<> struct simd_traits<vfloat8>              { typedef float scalar; static constexpr unsigned int width = 8; };
+
+#if defined(GUM_MATHS_AVX)
+    typedef vfloat8 vfloat;  //Widest float pack the target supports natively
+#else
+    typedef vfloat4 vfloat;
+#endif
+}}
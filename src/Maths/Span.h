@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Non owning view of a contiguous array, used by the batch functions
+     *
+     * std::vector<vec3> points;
+     * span<const vec3> view(points);
+     */
+    template<typename T>
+    struct span
+    {
+        T* ptr = nullptr;
+        size_t count = 0;
+
+        span() {}
+        span(T* data, size_t size) : ptr(data), count(size) {}
+        template<size_t N>
+        span(T (&arr)[N]) : ptr(arr), count(N) {}
+        template<typename U, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+        span(const span<U>& other) : ptr(other.ptr), count(other.count) {}
+        template<typename U, typename A, typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+        span(std::vector<U, A>& vec) : ptr(vec.data()), count(vec.size()) {}
+        template<typename U, typename A, typename = typename std::enable_if<std::is_convertible<const U(*)[], T(*)[]>::value>::type>
+        span(const std::vector<U, A>& vec) : ptr(vec.data()), count(vec.size()) {}
+
+        T* data() const              { return ptr; }
+        size_t size() const          { return count; }
+        size_t sizeBytes() const     { return count * sizeof(T); }
+        bool empty() const           { return count == 0; }
+        T* begin() const             { return ptr; }
+        T* end() const               { return ptr + count; }
+        T& operator[](size_t i) const { return ptr[i]; }
+
+        span<T> subspan(size_t offset, size_t size = (size_t)-1) const
+        {
+            if(offset > count)
+                offset = count;
+            if(size > count - offset)
+                size = count - offset;
+            return span<T>(ptr + offset, size);
+        }
+    };
+}}
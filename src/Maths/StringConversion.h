@@ -0,0 +1,115 @@
+#pragma once
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <system_error>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Appends num to out without temporary strings
+     * @param precision digits after the decimal point, negative for the shortest representation that reads back exactly
+     */
+    template<typename T>
+    static void appendNumber(std::string& out, const T& num, const int& precision = -1)
+    {
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            out += num ? '1' : '0';
+        }
+        else if constexpr (std::is_integral<T>::value)
+        {
+            char buffer[24];
+            std::to_chars_result res = std::to_chars(buffer, buffer + sizeof(buffer), num);
+            out.append(buffer, res.ptr);
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            char buffer[512];
+            std::to_chars_result res = precision < 0
+                ? std::to_chars(buffer, buffer + sizeof(buffer), num)
+                : std::to_chars(buffer, buffer + sizeof(buffer), num, std::chars_format::fixed, precision);
+
+            if(res.ec != std::errc()) //Too long for fixed notation, the shortest form always fits
+                res = std::to_chars(buffer, buffer + sizeof(buffer), num);
+            out.append(buffer, res.ptr);
+        }
+        else
+        {
+            appendNumber(out, static_cast<double>(num), precision);
+        }
+    }
+
+    /**
+     * Parses one number from the front of str and removes it from str
+     * Leading whitespace and a leading '+' are skipped
+     * @return true on success, str is left untouched otherwise
+     */
+    template<typename T>
+    static bool parseNumber(std::string_view& str, T& out)
+    {
+        size_t start = 0;
+        while(start < str.size() && (str[start] == ' ' || str[start] == '\t' || str[start] == '\n' || str[start] == '\r'))
+            start++;
+        if(start < str.size() && str[start] == '+')
+        {
+            start++;
+            if(start < str.size() && str[start] == '-') //from_chars would accept "+-1"
+                return false;
+        }
+
+        const char* first = str.data() + start;
+        const char* last = str.data() + str.size();
+
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            if(first == last || (*first != '0' && *first != '1'))
+                return false;
+            out = *first == '1';
+            str.remove_prefix(start + 1);
+            return true;
+        }
+        else if constexpr (std::is_arithmetic<T>::value)
+        {
+            std::from_chars_result res = std::from_chars(first, last, out);
+            if(res.ec != std::errc())
+                return false;
+            str.remove_prefix(res.ptr - str.data());
+            return true;
+        }
+        else
+        {
+            double tmp;
+            if(!parseNumber(str, tmp))
+                return false;
+            out = static_cast<T>(tmp);
+            return true;
+        }
+    }
+
+    /**
+     * Parses up to count numbers from text like "vec3(1, 2, 3)", "1 2 3" or "(1;2;3)"
+     * Everything up to an opening bracket is treated as a type name and skipped,
+     * numbers may be separated by commas, semicolons and whitespace.
+     * @return amount of numbers that were parsed
+     */
+    template<typename T>
+    static size_t parseNumbers(std::string_view str, T* out, const size_t& count)
+    {
+        size_t bracket = str.find('(');
+        if(bracket != std::string_view::npos)
+            str.remove_prefix(bracket + 1);
+
+        for(size_t i = 0; i < count; i++)
+        {
+            while(!str.empty() && (str.front() == ',' || str.front() == ';' || str.front() == ' ' || str.front() == '\t' || str.front() == '\n' || str.front() == '\r'))
+                str.remove_prefix(1);
+
+            if(!parseNumber(str, out[i]))
+                return i;
+        }
+        return count;
+    }
+}}
@@ -0,0 +1,187 @@
+#include "ThreadPool.h"
+
+namespace Gum {
+namespace Maths
+{
+    //Pool the current thread is working for, used to run nested jobs serially
+    static thread_local ThreadPool* pCurrentPool = nullptr;
+
+    ThreadPool::ThreadPool(unsigned int numthreads)
+    {
+        if(numthreads == 0)
+            numthreads = std::thread::hardware_concurrency();
+        if(numthreads == 0)
+            numthreads = 1;
+
+        this->iNumWorkers = numthreads;
+        this->pRanges = new WorkerRange[numthreads];
+        this->iGeneration = 0;
+        this->bShutdown = false;
+        this->pFunction = nullptr;
+        this->pContext = nullptr;
+        this->iGrain = 1;
+        this->iRemaining = 0;
+        this->iActiveWorkers = 0;
+
+        //Worker 0 is whichever thread calls run()
+        for(unsigned int i = 1; i < numthreads; i++)
+            vThreads.emplace_back(&ThreadPool::threadMain, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            bShutdown = true;
+        }
+        mWakeCondition.notify_all();
+        for(std::thread& thread : vThreads)
+            thread.join();
+        delete[] pRanges;
+    }
+
+    ThreadPool& ThreadPool::getDefault()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    bool ThreadPool::takeChunk(unsigned int worker, size_t& begin, size_t& end)
+    {
+        WorkerRange& range = pRanges[worker];
+        std::lock_guard<std::mutex> lock(range.lock);
+        size_t available = range.end - range.begin;
+        if(available == 0)
+            return false;
+
+        //Chunks shrink with the remaining work so the tail of the range balances well
+        size_t chunk = available / 4;
+        if(chunk < iGrain)     chunk = iGrain;
+        if(chunk > available)  chunk = available;
+
+        begin = range.begin;
+        end = begin + chunk;
+        range.begin = end;
+        return true;
+    }
+
+    bool ThreadPool::steal(unsigned int worker)
+    {
+        for(unsigned int i = 1; i < iNumWorkers; i++)
+        {
+            WorkerRange& victim = pRanges[(worker + i) % iNumWorkers];
+            size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.lock);
+                size_t available = victim.end - victim.begin;
+                if(available == 0)
+                    continue;
+
+                //Take the back half, the victim keeps working on the front
+                size_t half = available > iGrain ? available / 2 : available;
+                begin = victim.end - half;
+                end = victim.end;
+                victim.end = begin;
+            }
+
+            WorkerRange& own = pRanges[worker];
+            std::lock_guard<std::mutex> lock(own.lock);
+            own.begin = begin;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::work(unsigned int worker)
+    {
+        ThreadPool* previous = pCurrentPool;
+        pCurrentPool = this;
+
+        size_t begin, end;
+        while(takeChunk(worker, begin, end) || (steal(worker) && takeChunk(worker, begin, end)))
+        {
+            pFunction(pContext, begin, end, worker);
+            if(iRemaining.fetch_sub(end - begin) == end - begin)
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mDoneCondition.notify_all();
+            }
+        }
+
+        pCurrentPool = previous;
+    }
+
+    void ThreadPool::threadMain(unsigned int worker)
+    {
+        uint64_t generation = 0;
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mWakeMutex);
+                mWakeCondition.wait(lock, [&]() { return bShutdown || iGeneration != generation; });
+                if(bShutdown)
+                    return;
+                generation = iGeneration;
+                iActiveWorkers++;
+            }
+
+            work(worker);
+
+            if(iActiveWorkers.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mDoneCondition.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::run(size_t begin, size_t end, RangeFunction function, void* context, size_t grain)
+    {
+        if(end <= begin)
+            return;
+
+        size_t count = end - begin;
+        if(grain == 0)
+        {
+            grain = count / ((size_t)iNumWorkers * 64);
+            if(grain == 0)
+                grain = 1;
+        }
+
+        if(iNumWorkers == 1 || count <= grain || pCurrentPool == this)
+        {
+            function(context, begin, end, 0);
+            return;
+        }
+
+        std::lock_guard<std::mutex> jobLock(mJobMutex);
+        {
+            //The job is published under the wake mutex, which workers hold when they pick up a generation.
+            //A worker that woke up too late for the previous job may still be looking for chunks, so wait for it first
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mDoneCondition.wait(lock, [&]() { return iActiveWorkers == 0; });
+
+            pFunction = function;
+            pContext = context;
+            iGrain = grain;
+            iRemaining = count;
+
+            size_t share = count / iNumWorkers;
+            for(unsigned int i = 0; i < iNumWorkers; i++)
+            {
+                std::lock_guard<std::mutex> rangeLock(pRanges[i].lock);
+                pRanges[i].begin = begin + share * i;
+                pRanges[i].end = i + 1 < iNumWorkers ? begin + share * (i + 1) : end;
+            }
+            iGeneration++;
+        }
+        mWakeCondition.notify_all();
+
+        work(0);
+
+        //Wait for the last chunks and for every worker to leave the job before it goes out of scope
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        mDoneCondition.wait(lock, [&]() { return iRemaining == 0 && iActiveWorkers == 0; });
+    }
+}}
@@ -0,0 +1,165 @@
+#pragma once
+#include "Span.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Work stealing scheduler for data parallel loops
+     *
+     * A job is a single index range. It is split evenly across all workers, each worker
+     * processes its part front to back in shrinking chunks (guided scheduling) and steals
+     * the back half of another workers range once its own is empty. Ranges are the only
+     * unit of work, so scheduling does not allocate.
+     * The calling thread takes part as worker 0, nested calls from inside a job run serially.
+     */
+    class ThreadPool
+    {
+    public:
+        //Called for every chunk with [begin, end) and the index of the executing worker
+        typedef void (*RangeFunction)(void* context, size_t begin, size_t end, unsigned int worker);
+
+    private:
+        struct alignas(64) WorkerRange
+        {
+            std::mutex lock;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        std::vector<std::thread> vThreads;
+        WorkerRange* pRanges;
+        unsigned int iNumWorkers;
+
+        std::mutex mJobMutex;
+        std::mutex mWakeMutex;
+        std::condition_variable mWakeCondition;
+        std::condition_variable mDoneCondition;
+        uint64_t iGeneration;
+        bool bShutdown;
+
+        RangeFunction pFunction;
+        void* pContext;
+        size_t iGrain;
+        std::atomic<size_t> iRemaining;
+        std::atomic<unsigned int> iActiveWorkers;
+
+        bool takeChunk(unsigned int worker, size_t& begin, size_t& end);
+        bool steal(unsigned int worker);
+        void work(unsigned int worker);
+        void threadMain(unsigned int worker);
+
+    public:
+        //numthreads = 0 uses one worker per hardware thread
+        ThreadPool(unsigned int numthreads = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        static ThreadPool& getDefault();
+
+        //Amount of workers including the calling thread, worker indices passed to jobs are below this
+        unsigned int numWorkers() const { return iNumWorkers; }
+
+        //Blocks until every index in [begin, end) has been processed, grain 0 picks a chunk size from the range length
+        void run(size_t begin, size_t end, RangeFunction function, void* context, size_t grain = 0);
+
+        /**
+         * f(size_t begin, size_t end, unsigned int worker) is called for disjoint chunks covering [begin, end)
+         */
+        template<typename F>
+        void parallelFor(size_t begin, size_t end, F&& f, size_t grain = 0)
+        {
+            typedef typename std::remove_reference<F>::type Func;
+            run(begin, end, [](void* context, size_t b, size_t e, unsigned int worker) { (*(Func*)context)(b, e, worker); }, (void*)&f, grain);
+        }
+    };
+
+
+    /**
+     * Range version, f(size_t begin, size_t end) is called for disjoint chunks
+     */
+    template<typename F>
+    static void parallelFor(size_t begin, size_t end, F&& f, size_t grain = 0)
+    {
+        ThreadPool::getDefault().parallelFor(begin, end, [&f](size_t b, size_t e, unsigned int) { f(b, e); }, grain);
+    }
+
+    /**
+     * f(T& element) is called once per element
+     */
+    template<typename T, typename F>
+    static void parallelFor(span<T> data, F&& f, size_t grain = 0)
+    {
+        T* ptr = data.data();
+        ThreadPool::getDefault().parallelFor(0, data.size(), [ptr, &f](size_t b, size_t e, unsigned int) {
+            for(size_t i = b; i < e; i++)
+                f(ptr[i]);
+        }, grain);
+    }
+
+    /**
+     * out[i] = f(in[i]), out has to be at least as large as in
+     */
+    template<typename In, typename Out, typename F>
+    static void parallelTransform(span<const In> in, span<Out> out, F&& f, size_t grain = 0)
+    {
+        const In* src = in.data();
+        Out* dst = out.data();
+        size_t count = in.size() < out.size() ? in.size() : out.size();
+        ThreadPool::getDefault().parallelFor(0, count, [src, dst, &f](size_t b, size_t e, unsigned int) {
+            for(size_t i = b; i < e; i++)
+                dst[i] = f(src[i]);
+        }, grain);
+    }
+
+    /**
+     * Every worker folds its chunks into its own accumulator with map(R acc, const T& element),
+     * the per worker results are merged with combine(R a, R b) afterwards
+     * Which worker gets which chunk depends on scheduling, so the result is only reproducible if map and
+     * combine are associative and commutative. Floating point sums can differ in the last bits between runs
+     */
+    template<typename T, typename R, typename Map, typename Combine>
+    static R parallelReduce(span<const T> data, const R& identity, Map&& map, Combine&& combine, size_t grain = 0)
+    {
+        ThreadPool& pool = ThreadPool::getDefault();
+        std::vector<R> partials(pool.numWorkers(), identity);
+        const T* ptr = data.data();
+        pool.parallelFor(0, data.size(), [ptr, &partials, &map](size_t b, size_t e, unsigned int worker) {
+            R acc = partials[worker];
+            for(size_t i = b; i < e; i++)
+                acc = map(acc, ptr[i]);
+            partials[worker] = acc;
+        }, grain);
+
+        R result = identity;
+        for(const R& partial : partials)
+            result = combine(result, partial);
+        return result;
+    }
+
+    /**
+     * Range version, map(size_t begin, size_t end, R acc) returns acc with the chunk folded in
+     * Reproducible under the same conditions as above
+     */
+    template<typename R, typename Map, typename Combine>
+    static R parallelReduce(size_t begin, size_t end, const R& identity, Map&& map, Combine&& combine, size_t grain = 0)
+    {
+        ThreadPool& pool = ThreadPool::getDefault();
+        std::vector<R> partials(pool.numWorkers(), identity);
+        pool.parallelFor(begin, end, [&partials, &map](size_t b, size_t e, unsigned int worker) {
+            partials[worker] = map(b, e, partials[worker]);
+        }, grain);
+
+        R result = identity;
+        for(const R& partial : partials)
+            result = combine(result, partial);
+        return result;
+    }
+}}
@@ -0,0 +1,389 @@
+#pragma once
+#include "vec.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <type_traits>
+
+namespace Gum {
+namespace Maths
+{
+    //Bernstein basis of degree D at t, binomials come from the compile time table
+    template<unsigned int D, typename T>
+    static void bernstein(T t, T out[D + 1])
+    {
+        T s = (T)1 - t;
+        T tPow = (T)1;
+        for(unsigned int i = 0; i <= D; i++)
+        {
+            out[i] = (T)binomial(D, i) * tPow;
+            tPow *= t;
+        }
+        T sPow = (T)1;
+        for(unsigned int i = D + 1; i-- > 0;)
+        {
+            out[i] *= sPow;
+            sPow *= s;
+        }
+    }
+
+    //Derivative of the degree D basis, D * (B(i-1, D-1) - B(i, D-1))
+    template<unsigned int D, typename T>
+    static void bernsteinDerivative(T t, T out[D + 1])
+    {
+        if constexpr (D == 0)
+        {
+            out[0] = (T)0;
+        }
+        else
+        {
+            T lower[D];
+            bernstein<D - 1>(t, lower);
+            for(unsigned int i = 0; i <= D; i++)
+                out[i] = (T)D * ((i > 0 ? lower[i - 1] : (T)0) - (i < D ? lower[i] : (T)0));
+        }
+    }
+}}
+
+
+/**
+ * Bezier curve of degree D over tvec<T, S>
+ * evaluate() uses de Casteljau, which is the most stable. For many parameters on the same curve
+ * convert to power basis once with getPowerCoefficients() and evaluate with Horner, that is
+ * D multiply-adds per component, which is what the batch functions do.
+ */
+template<typename T, unsigned int S, unsigned int D>
+struct tbezier
+{
+    tvec<T, S> points[D + 1];
+
+    tbezier() = default;
+    tbezier(const tvec<T, S> (&controlPoints)[D + 1])
+    {
+        for(unsigned int i = 0; i <= D; i++)
+            points[i] = controlPoints[i];
+    }
+    template <typename... Args, typename = typename std::enable_if<sizeof...(Args) == D + 1>::type>
+    tbezier(const Args&... controlPoints) : points{ controlPoints... } {}
+
+    static constexpr unsigned int degree() { return D; }
+
+
+    //
+    // Single evaluation
+    //
+    tvec<T, S> evaluate(T t) const
+    {
+        tvec<T, S> tmp[D + 1];
+        for(unsigned int i = 0; i <= D; i++)
+            tmp[i] = points[i];
+        T s = (T)1 - t;
+        for(unsigned int r = 1; r <= D; r++)
+            for(unsigned int i = 0; i <= D - r; i++)
+                for(unsigned int c = 0; c < S; c++)
+                    tmp[i].vals[c] = tmp[i].vals[c] * s + tmp[i + 1].vals[c] * t;
+        return tmp[0];
+    }
+
+    //Position and first derivative in one de Casteljau pass
+    void evaluate(T t, tvec<T, S>& position, tvec<T, S>& tangent) const
+    {
+        if constexpr (D == 0)
+        {
+            position = points[0];
+            tangent = tvec<T, S>((T)0);
+        }
+        else
+        {
+            tvec<T, S> tmp[D + 1];
+            for(unsigned int i = 0; i <= D; i++)
+                tmp[i] = points[i];
+            T s = (T)1 - t;
+            for(unsigned int r = 1; r < D; r++)
+                for(unsigned int i = 0; i <= D - r; i++)
+                    for(unsigned int c = 0; c < S; c++)
+                        tmp[i].vals[c] = tmp[i].vals[c] * s + tmp[i + 1].vals[c] * t;
+
+            for(unsigned int c = 0; c < S; c++)
+            {
+                position.vals[c] = tmp[0].vals[c] * s + tmp[1].vals[c] * t;
+                tangent.vals[c] = (tmp[1].vals[c] - tmp[0].vals[c]) * (T)D;
+            }
+        }
+    }
+
+    tvec<T, S> tangent(T t) const
+    {
+        tvec<T, S> position, ret;
+        evaluate(t, position, ret);
+        return ret;
+    }
+
+    //Hodograph, the derivative curve of degree D - 1
+    template<unsigned int DD = D, typename = typename std::enable_if<(DD > 0)>::type>
+    tbezier<T, S, DD - 1> derivative() const
+    {
+        tbezier<T, S, DD - 1> ret;
+        for(unsigned int i = 0; i < D; i++)
+            for(unsigned int c = 0; c < S; c++)
+                ret.points[i].vals[c] = (points[i + 1].vals[c] - points[i].vals[c]) * (T)D;
+        return ret;
+    }
+
+    //Splits at t into [0, t] and [t, 1]
+    void split(T t, tbezier& left, tbezier& right) const
+    {
+        tvec<T, S> tmp[D + 1];
+        for(unsigned int i = 0; i <= D; i++)
+            tmp[i] = points[i];
+        T s = (T)1 - t;
+        left.points[0] = tmp[0];
+        right.points[D] = tmp[D];
+        for(unsigned int r = 1; r <= D; r++)
+        {
+            for(unsigned int i = 0; i <= D - r; i++)
+                for(unsigned int c = 0; c < S; c++)
+                    tmp[i].vals[c] = tmp[i].vals[c] * s + tmp[i + 1].vals[c] * t;
+            left.points[r] = tmp[0];
+            right.points[D - r] = tmp[D - r];
+        }
+    }
+
+
+    //
+    // Power basis
+    //
+    //c[j] = C(D, j) * sum (-1)^(j-i) C(j, i) P[i], so that B(t) = sum c[j] t^j
+    void getPowerCoefficients(tvec<T, S> coefficients[D + 1]) const
+    {
+        for(unsigned int j = 0; j <= D; j++)
+        {
+            tvec<T, S> sum((T)0);
+            for(unsigned int i = 0; i <= j; i++)
+            {
+                T w = (T)Gum::Maths::binomial(j, i) * ((j - i) % 2 ? (T)-1 : (T)1);
+                for(unsigned int c = 0; c < S; c++)
+                    sum.vals[c] += points[i].vals[c] * w;
+            }
+            T scale = (T)Gum::Maths::binomial(D, j);
+            for(unsigned int c = 0; c < S; c++)
+                coefficients[j].vals[c] = sum.vals[c] * scale;
+        }
+    }
+
+    static tvec<T, S> evaluateHorner(const tvec<T, S> coefficients[D + 1], T t)
+    {
+        tvec<T, S> ret = coefficients[D];
+        for(unsigned int j = D; j-- > 0;)
+            for(unsigned int c = 0; c < S; c++)
+                ret.vals[c] = ret.vals[c] * t + coefficients[j].vals[c];
+        return ret;
+    }
+
+    tvec<T, S> evaluateHorner(T t) const
+    {
+        tvec<T, S> coefficients[D + 1];
+        getPowerCoefficients(coefficients);
+        return evaluateHorner(coefficients, t);
+    }
+
+
+    //
+    // Batches
+    //
+    //Evaluates count parameters, large inputs are split across the default ThreadPool
+    void evaluate(const T* params, tvec<T, S>* out, size_t count) const
+    {
+        tvec<T, S> coefficients[D + 1];
+        getPowerCoefficients(coefficients);
+        Gum::Maths::parallelFor(0, count, [&coefficients, params, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = evaluateHorner(coefficients, params[i]);
+        }, 4096);
+    }
+
+    //segments + 1 evenly spaced points including both ends, nothing is written for 0 segments
+    void tessellate(unsigned int segments, tvec<T, S>* out) const
+    {
+        if(segments == 0)
+        {
+            std::cerr << "GumMaths: tbezier::tessellate: needs at least one segment" << std::endl;
+            return;
+        }
+        tvec<T, S> coefficients[D + 1];
+        getPowerCoefficients(coefficients);
+        T step = (T)1 / (T)segments;
+        for(unsigned int i = 0; i < segments; i++)
+            out[i] = evaluateHorner(coefficients, (T)i * step);
+        out[segments] = points[D];
+    }
+
+    //Tessellates many curves, curve i writes to out[i * (segments + 1)]
+    static void tessellate(const tbezier* curves, size_t count, unsigned int segments, tvec<T, S>* out)
+    {
+        if(segments == 0)
+        {
+            std::cerr << "GumMaths: tbezier::tessellate: needs at least one segment" << std::endl;
+            return;
+        }
+        Gum::Maths::parallelFor(0, count, [curves, segments, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                curves[i].tessellate(segments, out + i * (segments + 1));
+        }, 64);
+    }
+};
+
+
+/**
+ * Tensor product Bezier surface of degree DU x DV, points are indexed [v][u]
+ * Grid tessellation builds the Bernstein weights of every u and v sample once and reduces each
+ * row of the grid to a single curve in u before evaluating it.
+ */
+template<typename T, unsigned int S, unsigned int DU, unsigned int DV>
+struct tbeziersurface
+{
+    tvec<T, S> points[DV + 1][DU + 1];
+
+    tvec<T, S> evaluate(T u, T v) const
+    {
+        T bu[DU + 1], bv[DV + 1];
+        Gum::Maths::bernstein<DU>(u, bu);
+        Gum::Maths::bernstein<DV>(v, bv);
+        tvec<T, S> ret((T)0);
+        for(unsigned int j = 0; j <= DV; j++)
+            for(unsigned int i = 0; i <= DU; i++)
+                for(unsigned int c = 0; c < S; c++)
+                    ret.vals[c] += points[j][i].vals[c] * (bu[i] * bv[j]);
+        return ret;
+    }
+
+    //Position and partial derivatives along u and v
+    void evaluate(T u, T v, tvec<T, S>& position, tvec<T, S>& du, tvec<T, S>& dv) const
+    {
+        T bu[DU + 1], bv[DV + 1], dbu[DU + 1], dbv[DV + 1];
+        Gum::Maths::bernstein<DU>(u, bu);
+        Gum::Maths::bernstein<DV>(v, bv);
+        Gum::Maths::bernsteinDerivative<DU>(u, dbu);
+        Gum::Maths::bernsteinDerivative<DV>(v, dbv);
+        position = du = dv = tvec<T, S>((T)0);
+        for(unsigned int j = 0; j <= DV; j++)
+        {
+            for(unsigned int i = 0; i <= DU; i++)
+            {
+                for(unsigned int c = 0; c < S; c++)
+                {
+                    T p = points[j][i].vals[c];
+                    position.vals[c] += p * (bu[i] * bv[j]);
+                    du.vals[c] += p * (dbu[i] * bv[j]);
+                    dv.vals[c] += p * (bu[i] * dbv[j]);
+                }
+            }
+        }
+    }
+
+    //Unnormalized for degenerate (collapsed) edges, zero there
+    template<unsigned int SS = S, typename = typename std::enable_if<SS == 3>::type>
+    tvec<T, 3> normal(T u, T v) const
+    {
+        tvec<T, 3> position, du, dv;
+        evaluate(u, v, position, du, dv);
+        tvec<T, 3> n = tvec<T, 3>::cross(du, dv);
+        T length = (T)n.length();
+        return length > (T)0 ? n / length : n;
+    }
+
+    /**
+     * Evaluates a (uSegments + 1) x (vSegments + 1) grid, row major with u running fastest.
+     * Normals are only written for S == 3 and when not nullptr. Nothing is written if either count is 0.
+     */
+    void tessellate(unsigned int uSegments, unsigned int vSegments, tvec<T, S>* positions, tvec<T, S>* normals = nullptr) const
+    {
+        if(uSegments == 0 || vSegments == 0)
+        {
+            std::cerr << "GumMaths: tbeziersurface::tessellate: needs at least one segment along u and v" << std::endl;
+            return;
+        }
+        const unsigned int uCount = uSegments + 1, vCount = vSegments + 1;
+        std::vector<T> bu(uCount * (DU + 1)), dbu(uCount * (DU + 1));
+        for(unsigned int i = 0; i < uCount; i++)
+        {
+            T u = (T)i / (T)uSegments;
+            Gum::Maths::bernstein<DU>(u, &bu[i * (DU + 1)]);
+            Gum::Maths::bernsteinDerivative<DU>(u, &dbu[i * (DU + 1)]);
+        }
+
+        for(unsigned int j = 0; j < vCount; j++)
+        {
+            T v = (T)j / (T)vSegments;
+            T bv[DV + 1], dbv[DV + 1];
+            Gum::Maths::bernstein<DV>(v, bv);
+            Gum::Maths::bernsteinDerivative<DV>(v, dbv);
+
+            //The row at v as a curve in u and its derivative along v
+            tvec<T, S> row[DU + 1], rowDv[DU + 1];
+            for(unsigned int i = 0; i <= DU; i++)
+            {
+                row[i] = rowDv[i] = tvec<T, S>((T)0);
+                for(unsigned int k = 0; k <= DV; k++)
+                {
+                    for(unsigned int c = 0; c < S; c++)
+                    {
+                        row[i].vals[c] += points[k][i].vals[c] * bv[k];
+                        rowDv[i].vals[c] += points[k][i].vals[c] * dbv[k];
+                    }
+                }
+            }
+
+            for(unsigned int i = 0; i < uCount; i++)
+            {
+                const T* w = &bu[i * (DU + 1)];
+                tvec<T, S>& p = positions[j * uCount + i];
+                p = tvec<T, S>((T)0);
+                for(unsigned int k = 0; k <= DU; k++)
+                    for(unsigned int c = 0; c < S; c++)
+                        p.vals[c] += row[k].vals[c] * w[k];
+
+                if constexpr (S == 3)
+                {
+                    if(normals == nullptr)
+                        continue;
+                    const T* dw = &dbu[i * (DU + 1)];
+                    tvec<T, 3> du((T)0), dv((T)0);
+                    for(unsigned int k = 0; k <= DU; k++)
+                    {
+                        for(unsigned int c = 0; c < 3; c++)
+                        {
+                            du.vals[c] += row[k].vals[c] * dw[k];
+                            dv.vals[c] += rowDv[k].vals[c] * w[k];
+                        }
+                    }
+                    tvec<T, 3> n = tvec<T, 3>::cross(du, dv);
+                    T length = (T)n.length();
+                    normals[j * uCount + i] = length > (T)0 ? n / length : n;
+                }
+            }
+        }
+    }
+
+    //Tessellates many patches, patch i writes to positions[i * (uSegments + 1) * (vSegments + 1)]
+    static void tessellate(const tbeziersurface* surfaces, size_t count, unsigned int uSegments, unsigned int vSegments, tvec<T, S>* positions, tvec<T, S>* normals = nullptr)
+    {
+        if(uSegments == 0 || vSegments == 0)
+        {
+            std::cerr << "GumMaths: tbeziersurface::tessellate: needs at least one segment along u and v" << std::endl;
+            return;
+        }
+        const size_t stride = (size_t)(uSegments + 1) * (vSegments + 1);
+        Gum::Maths::parallelFor(0, count, [=](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                surfaces[i].tessellate(uSegments, vSegments, positions + i * stride, normals != nullptr ? normals + i * stride : nullptr);
+        }, 16);
+    }
+};
+
+typedef tbezier<float, 2, 2>  qbezier2;
+typedef tbezier<float, 3, 2>  qbezier3;
+typedef tbezier<float, 2, 3>   bezier2;
+typedef tbezier<float, 3, 3>   bezier3;
+typedef tbezier<double, 2, 3> dbezier2;
+typedef tbezier<double, 3, 3> dbezier3;
+typedef tbeziersurface<float, 3, 3, 3> beziersurface;
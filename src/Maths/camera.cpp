@@ -0,0 +1,299 @@
+#include "camera.h"
+#include "MatrixFunctions.h"
+#include <cmath>
+#include <iostream>
+
+using namespace Gum::Maths;
+
+camera::camera()
+    : vPosition(0.0f), eProjection(ProjectionType::PERSPECTIVE), eDepthRange(DepthRange::NEGATIVE_ONE_TO_ONE),
+      fFOV(60.0f), fAspectRatio(1.0f), fLeft(-1.0f), fRight(1.0f), fBottom(-1.0f), fTop(1.0f), fNear(0.1f), fFar(1000.0f),
+      bReversedZ(false), bInfiniteFar(false), bViewDirty(true), bProjectionDirty(true), bCombinedDirty(true)
+{
+}
+
+camera::camera(const vec3& position, const quat<float>& rotation, float fov, float aspectRatio, float zNear, float zFar)
+    : camera()
+{
+    vPosition = position;
+    qRotation = rotation;
+    setPerspective(fov, aspectRatio, zNear, zFar);
+}
+
+
+//
+// Setters
+//
+void camera::setRotation(const quat<float>& rotation)
+{
+    quat<float> q = rotation;
+    if(q == qRotation)
+        return;
+    qRotation = q;
+    bViewDirty = bCombinedDirty = true;
+}
+
+void camera::lookAt(const vec3& target, const vec3& up)
+{
+    vec3 direction = target - vPosition;
+    float distance = direction.length();
+    if(!(distance > 0.0f) || !std::isfinite(distance))
+    {
+        std::cerr << "GumMaths: camera::lookAt target has to differ from the camera position, keeping the rotation" << std::endl;
+        return;
+    }
+    vec3 forward = direction / distance;
+
+    //Nearly parallel up vectors leave the right axis to rounding, fall back to the world axis least aligned with forward
+    vec3 right = vec3::cross(forward, up);
+    float upLength = std::sqrt(vec3::dot(up, up));
+    if(!(right.length() > 1e-4f * upLength))
+    {
+        std::cerr << "GumMaths: camera::lookAt up vector is zero or parallel to the view direction, using another axis" << std::endl;
+        vec3 ax(std::abs(forward.x), std::abs(forward.y), std::abs(forward.z));
+        vec3 fallback = ax.x <= ax.y && ax.x <= ax.z ? vec3(1, 0, 0) : (ax.y <= ax.z ? vec3(0, 1, 0) : vec3(0, 0, 1));
+        right = vec3::cross(forward, fallback);
+    }
+    right = vec3::normalize(right);
+    vec3 realUp = vec3::cross(right, forward);
+
+    mat3 basis;
+    for(unsigned int i = 0; i < 3; i++)
+    {
+        basis[0][i] = right.vals[i];
+        basis[1][i] = realUp.vals[i];
+        basis[2][i] = -forward.vals[i];
+    }
+    setRotation(quat<float>::normalize(quat<float>(basis)));
+}
+
+void camera::setPerspective(float fov, float aspectRatio, float zNear, float zFar)
+{
+    setValue(eProjection, ProjectionType::PERSPECTIVE, bProjectionDirty);
+    setFOV(fov);
+    setAspectRatio(aspectRatio);
+    setNear(zNear);
+    setFar(zFar);
+}
+
+void camera::setOrthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+    setValue(eProjection, ProjectionType::ORTHOGRAPHIC, bProjectionDirty);
+    setValue(fLeft, left, bProjectionDirty);
+    setValue(fRight, right, bProjectionDirty);
+    setValue(fBottom, bottom, bProjectionDirty);
+    setValue(fTop, top, bProjectionDirty);
+    setNear(zNear);
+    setFar(zFar);
+}
+
+
+//
+// Axes
+//
+vec3 camera::getRight() const   { updateView(); return vec3(mInverseView[0][0], mInverseView[0][1], mInverseView[0][2]); }
+vec3 camera::getUp() const      { updateView(); return vec3(mInverseView[1][0], mInverseView[1][1], mInverseView[1][2]); }
+vec3 camera::getForward() const { updateView(); return vec3(-mInverseView[2][0], -mInverseView[2][1], -mInverseView[2][2]); }
+
+
+//
+// Matrices
+//
+void camera::updateView() const
+{
+    if(!bViewDirty)
+        return;
+
+    //Camera to world is rotation then translation, the view matrix is its rigid inverse
+    mInverseView = rotateMatrix(qRotation);
+    mInverseView[3][0] = vPosition.x;
+    mInverseView[3][1] = vPosition.y;
+    mInverseView[3][2] = vPosition.z;
+
+    mView = mat4();
+    for(unsigned int col = 0; col < 3; col++)
+    {
+        for(unsigned int row = 0; row < 3; row++)
+            mView[col][row] = mInverseView[row][col];
+        mView[3][col] = -(mInverseView[col][0] * vPosition.x + mInverseView[col][1] * vPosition.y + mInverseView[col][2] * vPosition.z);
+    }
+    bViewDirty = false;
+}
+
+void camera::updateProjection() const
+{
+    if(!bProjectionDirty)
+        return;
+
+    const bool zeroToOne = eDepthRange == DepthRange::ZERO_TO_ONE;
+    const bool infinite = bInfiniteFar && eProjection == ProjectionType::PERSPECTIVE;
+    const float n = fNear, f = fFar;
+
+    /**
+     * Only the depth row differs between the variants, z_clip = c * z_view + d with
+     *                  finite                                  infinite far
+     * [-1,1]           -(f+n)/(f-n), -2fn/(f-n)                -1, -2n
+     * [-1,1] reversed   (f+n)/(f-n),  2fn/(f-n)                 1,  2n
+     * [0,1]            -f/(f-n),     -fn/(f-n)                 -1, -n
+     * [0,1] reversed    n/(f-n),      fn/(f-n)                  0,  n
+     * for perspective, and for orthographic (w_clip = 1)
+     * [-1,1]           -2/(f-n),     -(f+n)/(f-n)
+     * [0,1]            -1/(f-n),     -n/(f-n)
+     * where reversing negates both terms for [-1,1] and maps to 1 - z for [0,1]
+     */
+    float c, d;
+    if(eProjection == ProjectionType::PERSPECTIVE)
+    {
+        if(infinite)
+        {
+            c = zeroToOne ? (bReversedZ ? 0.0f : -1.0f) : (bReversedZ ? 1.0f : -1.0f);
+            d = zeroToOne ? (bReversedZ ? n : -n) : (bReversedZ ? 2.0f * n : -2.0f * n);
+        }
+        else if(zeroToOne)
+        {
+            c = bReversedZ ? n / (f - n) : -f / (f - n);
+            d = (bReversedZ ? 1.0f : -1.0f) * f * n / (f - n);
+        }
+        else
+        {
+            float sign = bReversedZ ? 1.0f : -1.0f;
+            c = sign * (f + n) / (f - n);
+            d = sign * 2.0f * f * n / (f - n);
+        }
+
+        float scale = 1.0f / std::tan(toRadians(fFOV * 0.5f));
+        float sx = scale / fAspectRatio;
+
+        mProjection = mat4(0.0f);
+        mProjection[0][0] = sx;
+        mProjection[1][1] = scale;
+        mProjection[2][2] = c;
+        mProjection[3][2] = d;
+        mProjection[2][3] = -1.0f;
+
+        //x = x'/sx, y = y'/scale and the depth block [c d; -1 0] inverts to [0 -1; 1/d c/d]
+        mInverseProjection = mat4(0.0f);
+        mInverseProjection[0][0] = 1.0f / sx;
+        mInverseProjection[1][1] = 1.0f / scale;
+        mInverseProjection[3][2] = -1.0f;
+        mInverseProjection[2][3] = 1.0f / d;
+        mInverseProjection[3][3] = c / d;
+    }
+    else
+    {
+        if(zeroToOne)
+        {
+            c = bReversedZ ?  1.0f / (f - n) : -1.0f / (f - n);
+            d = bReversedZ ?     f / (f - n) :    -n / (f - n);
+        }
+        else
+        {
+            float sign = bReversedZ ? -1.0f : 1.0f;
+            c = sign * -2.0f / (f - n);
+            d = sign * -(f + n) / (f - n);
+        }
+
+        float sx = 2.0f / (fRight - fLeft), tx = -(fRight + fLeft) / (fRight - fLeft);
+        float sy = 2.0f / (fTop - fBottom), ty = -(fTop + fBottom) / (fTop - fBottom);
+
+        mProjection = mat4();
+        mProjection[0][0] = sx;
+        mProjection[1][1] = sy;
+        mProjection[2][2] = c;
+        mProjection[3][0] = tx;
+        mProjection[3][1] = ty;
+        mProjection[3][2] = d;
+
+        mInverseProjection = mat4();
+        mInverseProjection[0][0] = 1.0f / sx;
+        mInverseProjection[1][1] = 1.0f / sy;
+        mInverseProjection[2][2] = 1.0f / c;
+        mInverseProjection[3][0] = -tx / sx;
+        mInverseProjection[3][1] = -ty / sy;
+        mInverseProjection[3][2] = -d / c;
+    }
+    bProjectionDirty = false;
+}
+
+void camera::updateCombined() const
+{
+    updateView();
+    updateProjection();
+    if(!bCombinedDirty)
+        return;
+
+    mViewProjection = mProjection * mView;
+    mInverseViewProjection = mInverseView * mInverseProjection;
+
+    //Gribb/Hartmann, the planes are combinations of the rows of the view projection matrix
+    vec4 rows[4];
+    for(unsigned int r = 0; r < 4; r++)
+        rows[r] = vec4(mViewProjection[0][r], mViewProjection[1][r], mViewProjection[2][r], mViewProjection[3][r]);
+
+    vFrustumPlanes[0] = rows[3] + rows[0];
+    vFrustumPlanes[1] = rows[3] - rows[0];
+    vFrustumPlanes[2] = rows[3] + rows[1];
+    vFrustumPlanes[3] = rows[3] - rows[1];
+
+    //Near and far depend on which end of the depth range they land on
+    vec4 lower = eDepthRange == DepthRange::ZERO_TO_ONE ? rows[2] : rows[3] + rows[2]; //z >= 0 or z >= -w
+    vec4 upper = rows[3] - rows[2];                                                     //z <= w
+    vFrustumPlanes[4] = bReversedZ ? upper : lower;
+    vFrustumPlanes[5] = bReversedZ ? lower : upper;
+    if(bInfiniteFar && eProjection == ProjectionType::PERSPECTIVE)
+        vFrustumPlanes[5] = vec4(0, 0, 0, 1);
+
+    for(unsigned int i = 0; i < 6; i++)
+    {
+        vec4& p = vFrustumPlanes[i];
+        float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        if(length > 0.0f)
+            p = p / length;
+    }
+    bCombinedDirty = false;
+}
+
+const mat4& camera::getView() const                  { updateView(); return mView; }
+const mat4& camera::getInverseView() const           { updateView(); return mInverseView; }
+const mat4& camera::getProjection() const            { updateProjection(); return mProjection; }
+const mat4& camera::getInverseProjection() const     { updateProjection(); return mInverseProjection; }
+const mat4& camera::getViewProjection() const        { updateCombined(); return mViewProjection; }
+const mat4& camera::getInverseViewProjection() const { updateCombined(); return mInverseViewProjection; }
+const vec4* camera::getFrustumPlanes() const         { updateCombined(); return vFrustumPlanes; }
+
+
+//
+// Culling
+//
+bool camera::isVisible(const vec3& point) const
+{
+    return isVisible(point, 0.0f);
+}
+
+bool camera::isVisible(const vec3& center, float radius) const
+{
+    const vec4* planes = getFrustumPlanes();
+    for(unsigned int i = 0; i < 6; i++)
+    {
+        const vec4& p = planes[i];
+        if(p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+bool camera::isVisible(const bbox3& box) const
+{
+    const vec4* planes = getFrustumPlanes();
+    for(unsigned int i = 0; i < 6; i++)
+    {
+        //Corner furthest along the plane normal
+        const vec4& p = planes[i];
+        float x = box.pos.x + (p.x >= 0.0f ? box.size.x : 0.0f);
+        float y = box.pos.y + (p.y >= 0.0f ? box.size.y : 0.0f);
+        float z = box.pos.z + (p.z >= 0.0f ? box.size.z : 0.0f);
+        if(p.x * x + p.y * y + p.z * z + p.w < 0.0f)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "vec.h"
+#include "mat.h"
+#include "quat.h"
+#include "bbox.h"
+#include <cstdint>
+
+namespace Gum {
+namespace Maths
+{
+    enum class ProjectionType : uint8_t
+    {
+        PERSPECTIVE,
+        ORTHOGRAPHIC
+    };
+
+    //Clip space depth range the projection maps near and far to
+    enum class DepthRange : uint8_t
+    {
+        NEGATIVE_ONE_TO_ONE, //OpenGL default, same as perspective() and ortho()
+        ZERO_TO_ONE          //D3D, Vulkan, Metal and OpenGL with glClipControl
+    };
+}}
+
+
+/**
+ * View and projection parameters with lazily cached matrices
+ * Setters only mark the affected matrices dirty when the value actually changes, the matrices,
+ * their inverses and the frustum planes are rebuilt on the next access. The camera looks down
+ * its local -Z axis with +Y up, like view().
+ *
+ * Reversed Z maps near to 1 and far to 0, combined with ZERO_TO_ONE and a float depth buffer the
+ * precision is spread almost evenly over the whole range. An infinite far plane drops far from
+ * the projection entirely (perspective only).
+ */
+class camera
+{
+private:
+    vec3 vPosition;
+    quat<float> qRotation;
+
+    Gum::Maths::ProjectionType eProjection;
+    Gum::Maths::DepthRange eDepthRange;
+    float fFOV, fAspectRatio;
+    float fLeft, fRight, fBottom, fTop;
+    float fNear, fFar;
+    bool bReversedZ, bInfiniteFar;
+
+    mutable mat4 mView, mInverseView;
+    mutable mat4 mProjection, mInverseProjection;
+    mutable mat4 mViewProjection, mInverseViewProjection;
+    mutable vec4 vFrustumPlanes[6];
+    mutable bool bViewDirty, bProjectionDirty, bCombinedDirty;
+
+    void updateView() const;
+    void updateProjection() const;
+    void updateCombined() const;
+
+    template<typename T>
+    void setValue(T& member, const T& value, bool& dirty)
+    {
+        if(member == value)
+            return;
+        member = value;
+        dirty = true;
+        bCombinedDirty = true;
+    }
+
+public:
+    camera();
+    camera(const vec3& position, const quat<float>& rotation, float fov, float aspectRatio, float zNear, float zFar);
+
+    //View
+    void setPosition(const vec3& position)       { setValue(vPosition, position, bViewDirty); }
+    void setRotation(const quat<float>& rotation);
+    //Keeps the rotation if target is the position, picks another up vector if up is parallel to the view direction
+    void lookAt(const vec3& target, const vec3& up = vec3(0, 1, 0));
+    void move(const vec3& offset)                { setPosition(vPosition + offset); }
+
+    //Projection
+    void setPerspective(float fov, float aspectRatio, float zNear, float zFar);
+    void setOrthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+    void setFOV(float fov)                                  { setValue(fFOV, fov, bProjectionDirty); }
+    void setAspectRatio(float aspectRatio)                  { setValue(fAspectRatio, aspectRatio, bProjectionDirty); }
+    void setNear(float zNear)                               { setValue(fNear, zNear, bProjectionDirty); }
+    void setFar(float zFar)                                 { setValue(fFar, zFar, bProjectionDirty); }
+    void setReversedZ(bool reversed)                        { setValue(bReversedZ, reversed, bProjectionDirty); }
+    void setInfiniteFar(bool infinite)                      { setValue(bInfiniteFar, infinite, bProjectionDirty); }
+    void setDepthRange(Gum::Maths::DepthRange range)        { setValue(eDepthRange, range, bProjectionDirty); }
+
+    vec3 getPosition() const                                { return vPosition; }
+    quat<float> getRotation() const                         { return qRotation; }
+    vec3 getRight() const;
+    vec3 getUp() const;
+    vec3 getForward() const;
+
+    Gum::Maths::ProjectionType getProjectionType() const    { return eProjection; }
+    Gum::Maths::DepthRange getDepthRange() const            { return eDepthRange; }
+    float getFOV() const                                    { return fFOV; }
+    float getAspectRatio() const                            { return fAspectRatio; }
+    float getNear() const                                   { return fNear; }
+    float getFar() const                                    { return fFar; }
+    bool isReversedZ() const                                { return bReversedZ; }
+    bool isInfiniteFar() const                              { return bInfiniteFar; }
+
+    const mat4& getView() const;
+    const mat4& getInverseView() const;
+    const mat4& getProjection() const;
+    const mat4& getInverseProjection() const;
+    const mat4& getViewProjection() const;
+    const mat4& getInverseViewProjection() const;
+
+    /**
+     * World space planes (a, b, c, d) with normalized normals pointing inside,
+     * in the order left, right, bottom, top, near, far. With an infinite far plane
+     * the last one is (0, 0, 0, 1) and never culls.
+     */
+    const vec4* getFrustumPlanes() const;
+
+    //Conservative frustum tests, objects close to an edge may be reported visible
+    bool isVisible(const vec3& point) const;
+    bool isVisible(const vec3& center, float radius) const;
+    bool isVisible(const bbox3& box) const;
+};
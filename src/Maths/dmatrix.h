@@ -0,0 +1,456 @@
+#pragma once
+#include "mat.h"
+#include "Allocator.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include <iostream>
+
+namespace Gum {
+namespace Maths
+{
+    enum class MatrixLayout : uint8_t
+    {
+        ROW_MAJOR = 0,
+        COLUMN_MAJOR
+    };
+}}
+
+/**
+ * Non owning window into a dense matrix
+ * Element (r, c) lives at ptr[r * rowStride + c * colStride], so sub blocks, single rows or
+ * columns and transposes are all views of the same memory without copying.
+ */
+template<typename T>
+struct dmatrix_view
+{
+    T* ptr = nullptr;
+    size_t iRows = 0, iCols = 0;
+    ptrdiff_t iRowStride = 0, iColStride = 0;
+
+    dmatrix_view() {}
+    dmatrix_view(T* ptr, size_t rows, size_t cols, ptrdiff_t rowstride, ptrdiff_t colstride)
+        : ptr(ptr), iRows(rows), iCols(cols), iRowStride(rowstride), iColStride(colstride) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    dmatrix_view(const dmatrix_view<U>& other)
+        : ptr(other.ptr), iRows(other.iRows), iCols(other.iCols), iRowStride(other.iRowStride), iColStride(other.iColStride) {}
+
+    T& operator()(size_t row, size_t col) const { return ptr[(ptrdiff_t)row * iRowStride + (ptrdiff_t)col * iColStride]; }
+
+    size_t rows() const { return iRows; }
+    size_t cols() const { return iCols; }
+    bool isRowContiguous() const { return iColStride == 1; }
+    bool isColContiguous() const { return iRowStride == 1; }
+
+    dmatrix_view<T> block(size_t row, size_t col, size_t rows, size_t cols) const
+    {
+        return dmatrix_view<T>(&(*this)(row, col), rows, cols, iRowStride, iColStride);
+    }
+    dmatrix_view<T> row(size_t index) const { return block(index, 0, 1, iCols); }
+    dmatrix_view<T> col(size_t index) const { return block(0, index, iRows, 1); }
+    dmatrix_view<T> transpose() const       { return dmatrix_view<T>(ptr, iCols, iRows, iColStride, iRowStride); }
+
+    //Copies the N x M block starting at (row, col) into a small fixed size matrix
+    template<unsigned int N, unsigned int M>
+    mat<typename std::remove_const<T>::type, N, M> getBlock(size_t row, size_t col) const
+    {
+        mat<typename std::remove_const<T>::type, N, M> ret;
+        for(unsigned int c = 0; c < M; c++)
+            for(unsigned int r = 0; r < N; r++)
+                ret[c][r] = (*this)(row + r, col + c);
+        return ret;
+    }
+
+    template<typename TT, unsigned int N, unsigned int M>
+    void setBlock(size_t row, size_t col, const mat<TT, N, M>& m) const
+    {
+        for(unsigned int c = 0; c < M; c++)
+            for(unsigned int r = 0; r < N; r++)
+                (*this)(row + r, col + c) = (T)m[c][r];
+    }
+
+    void fill(const T& value) const
+    {
+        for(size_t r = 0; r < iRows; r++)
+            for(size_t c = 0; c < iCols; c++)
+                (*this)(r, c) = value;
+    }
+
+    template<typename U>
+    void copyFrom(const dmatrix_view<U>& other) const
+    {
+        for(size_t r = 0; r < iRows; r++)
+            for(size_t c = 0; c < iCols; c++)
+                (*this)(r, c) = (T)other(r, c);
+    }
+};
+
+
+/**
+ * Heap backed dense matrix with runtime size
+ * Rows (or columns in column major layout) are padded to the cache line size, so every
+ * row starts aligned. Use mat<T,N,M> for small fixed sizes, getBlock/setBlock move data between both.
+ */
+template<typename T>
+class dmatrix
+{
+private:
+    Gum::Maths::aligned_vector<T> vData;
+    size_t iRows, iCols, iStride;
+    Gum::Maths::MatrixLayout eLayout;
+
+    static size_t paddedStride(size_t count)
+    {
+        const size_t perLine = GUM_MATHS_DEFAULT_ALIGNMENT / sizeof(T);
+        if(perLine == 0 || GUM_MATHS_DEFAULT_ALIGNMENT % sizeof(T) != 0)
+            return count;
+        return Gum::Maths::alignUp(count, perLine);
+    }
+
+public:
+    dmatrix() : iRows(0), iCols(0), iStride(0), eLayout(Gum::Maths::MatrixLayout::ROW_MAJOR) {}
+
+    dmatrix(size_t rows, size_t cols, Gum::Maths::MatrixLayout layout = Gum::Maths::MatrixLayout::ROW_MAJOR)
+    {
+        resize(rows, cols, layout);
+    }
+
+    dmatrix(size_t rows, size_t cols, const T& value, Gum::Maths::MatrixLayout layout = Gum::Maths::MatrixLayout::ROW_MAJOR)
+    {
+        resize(rows, cols, layout);
+        view().fill(value);
+    }
+
+    template<typename TT, unsigned int N, unsigned int M>
+    explicit dmatrix(const mat<TT, N, M>& m, Gum::Maths::MatrixLayout layout = Gum::Maths::MatrixLayout::ROW_MAJOR)
+    {
+        resize(N, M, layout);
+        view().setBlock(0, 0, m);
+    }
+
+    template<typename U>
+    explicit dmatrix(const dmatrix_view<U>& other, Gum::Maths::MatrixLayout layout = Gum::Maths::MatrixLayout::ROW_MAJOR)
+    {
+        resize(other.rows(), other.cols(), layout);
+        view().copyFrom(other);
+    }
+
+    //Contents are zeroed
+    void resize(size_t rows, size_t cols, Gum::Maths::MatrixLayout layout)
+    {
+        iRows = rows;
+        iCols = cols;
+        eLayout = layout;
+        iStride = paddedStride(layout == Gum::Maths::MatrixLayout::ROW_MAJOR ? cols : rows);
+        size_t outer = layout == Gum::Maths::MatrixLayout::ROW_MAJOR ? rows : cols;
+        vData.assign(outer * iStride, T(0));
+    }
+    void resize(size_t rows, size_t cols) { resize(rows, cols, eLayout); }
+
+    static dmatrix<T> identity(size_t size, Gum::Maths::MatrixLayout layout = Gum::Maths::MatrixLayout::ROW_MAJOR)
+    {
+        dmatrix<T> ret(size, size, layout);
+        for(size_t i = 0; i < size; i++)
+            ret(i, i) = T(1);
+        return ret;
+    }
+
+
+    T& operator()(size_t row, size_t col)             { return vData[eLayout == Gum::Maths::MatrixLayout::ROW_MAJOR ? row * iStride + col : col * iStride + row]; }
+    const T& operator()(size_t row, size_t col) const { return vData[eLayout == Gum::Maths::MatrixLayout::ROW_MAJOR ? row * iStride + col : col * iStride + row]; }
+
+    size_t rows() const                      { return iRows; }
+    size_t cols() const                      { return iCols; }
+    //Distance in elements between two rows (row major) or columns (column major)
+    size_t stride() const                    { return iStride; }
+    Gum::Maths::MatrixLayout layout() const  { return eLayout; }
+    T* data()                                { return vData.data(); }
+    const T* data() const                    { return vData.data(); }
+
+    dmatrix_view<T> view()
+    {
+        return eLayout == Gum::Maths::MatrixLayout::ROW_MAJOR
+            ? dmatrix_view<T>(vData.data(), iRows, iCols, (ptrdiff_t)iStride, 1)
+            : dmatrix_view<T>(vData.data(), iRows, iCols, 1, (ptrdiff_t)iStride);
+    }
+    dmatrix_view<const T> view() const
+    {
+        return eLayout == Gum::Maths::MatrixLayout::ROW_MAJOR
+            ? dmatrix_view<const T>(vData.data(), iRows, iCols, (ptrdiff_t)iStride, 1)
+            : dmatrix_view<const T>(vData.data(), iRows, iCols, 1, (ptrdiff_t)iStride);
+    }
+    operator dmatrix_view<T>()             { return view(); }
+    operator dmatrix_view<const T>() const { return view(); }
+
+    dmatrix_view<T> block(size_t row, size_t col, size_t rows, size_t cols)             { return view().block(row, col, rows, cols); }
+    dmatrix_view<const T> block(size_t row, size_t col, size_t rows, size_t cols) const { return view().block(row, col, rows, cols); }
+    dmatrix_view<T> row(size_t index)             { return view().row(index); }
+    dmatrix_view<const T> row(size_t index) const { return view().row(index); }
+    dmatrix_view<T> col(size_t index)             { return view().col(index); }
+    dmatrix_view<const T> col(size_t index) const { return view().col(index); }
+
+    template<unsigned int N, unsigned int M>
+    mat<T, N, M> getBlock(size_t row, size_t col) const { return view().template getBlock<N, M>(row, col); }
+    template<typename TT, unsigned int N, unsigned int M>
+    void setBlock(size_t row, size_t col, const mat<TT, N, M>& m) { view().setBlock(row, col, m); }
+
+    //Copy with rows and columns swapped, keeps the layout
+    dmatrix<T> transposed() const { return dmatrix<T>(view().transpose(), eLayout); }
+
+    dmatrix<T> operator*(const dmatrix<T>& other) const;
+};
+
+
+namespace Gum {
+namespace Maths
+{
+    //Keeps a parameter out of template argument deduction, so T comes from the output view alone
+    template<typename T>
+    struct dmatrix_nondeduced { typedef T type; };
+    template<typename T>
+    using dmatrix_nondeduced_t = typename dmatrix_nondeduced<T>::type;
+
+    /**
+     * Register tile of the GEMM, acc (MR x NR, row major) = sum over k of a[k] * b[k]^T
+     * a is packed as kc slivers of MR values, b as kc slivers of NR values.
+     */
+    template<typename T>
+    struct GemmKernel
+    {
+        static constexpr size_t MR = 4, NR = 4;
+        static void run(size_t kc, const T* a, const T* b, T* acc)
+        {
+            for(size_t i = 0; i < MR * NR; i++)
+                acc[i] = T(0);
+            for(size_t k = 0; k < kc; k++, a += MR, b += NR)
+                for(size_t i = 0; i < MR; i++)
+                    for(size_t j = 0; j < NR; j++)
+                        acc[i * NR + j] += a[i] * b[j];
+        }
+    };
+
+    template<>
+    struct GemmKernel<float>
+    {
+        static constexpr size_t MR = 4, NR = 8;
+        static void run(size_t kc, const float* a, const float* b, float* acc)
+        {
+            vfloat8 c0(0.0f), c1(0.0f), c2(0.0f), c3(0.0f);
+            for(size_t k = 0; k < kc; k++, a += MR, b += NR)
+            {
+                vfloat8 bv = vfloat8::loadAligned(b);
+                c0 = c0 + vfloat8(a[0]) * bv;
+                c1 = c1 + vfloat8(a[1]) * bv;
+                c2 = c2 + vfloat8(a[2]) * bv;
+                c3 = c3 + vfloat8(a[3]) * bv;
+            }
+            c0.storeAligned(acc);
+            c1.storeAligned(acc + 8);
+            c2.storeAligned(acc + 16);
+            c3.storeAligned(acc + 24);
+        }
+    };
+
+    /**
+     * C = alpha * A * B + beta * C
+     * Cache blocked in the usual way: a KC x NC panel of B and an MC x KC block of A are packed into
+     * contiguous slivers and multiplied by the register tile kernel. Blocks of C are split across the
+     * default ThreadPool. Views may have any strides, C must not overlap A or B.
+     * T is deduced from C only, A and B may be mutable views and alpha and beta any convertible scalar.
+     * @return false if the dimensions do not match
+     */
+    template<typename T>
+    static bool gemm(const dmatrix_nondeduced_t<T>& alpha, dmatrix_view<const dmatrix_nondeduced_t<T>> A, dmatrix_view<const dmatrix_nondeduced_t<T>> B, const dmatrix_nondeduced_t<T>& beta, dmatrix_view<T> C)
+    {
+        if(A.cols() != B.rows() || C.rows() != A.rows() || C.cols() != B.cols())
+        {
+            std::cerr << "GumMaths: gemm: dimension mismatch (" << A.rows() << "x" << A.cols() << " * " << B.rows() << "x" << B.cols() << " -> " << C.rows() << "x" << C.cols() << ")" << std::endl;
+            return false;
+        }
+
+        typedef GemmKernel<T> Kernel;
+        const size_t MR = Kernel::MR, NR = Kernel::NR;
+        const size_t MC = 64, KC = 256, NC = 2048, NGROUP = 256;
+        const size_t m = A.rows(), n = B.cols(), k = A.cols();
+
+        //Scale C once, beta 0 overwrites so garbage or NaN in C does not leak through
+        parallelFor(0, m, [&C, &beta](size_t begin, size_t end) {
+            for(size_t r = begin; r < end; r++)
+                for(size_t c = 0; c < C.cols(); c++)
+                    C(r, c) = beta == T(0) ? T(0) : C(r, c) * beta;
+        }, 16);
+        if(k == 0 || alpha == T(0))
+            return true;
+
+        //A blocks are packed into one buffer per worker, allocated on first use
+        ThreadPool& pool = ThreadPool::getDefault();
+        std::vector<aligned_vector<T>> apacks(pool.numWorkers());
+        aligned_vector<T> bpack(alignUp(NC, NR) * KC);
+        for(size_t jc = 0; jc < n; jc += NC)
+        {
+            size_t nc = n - jc < NC ? n - jc : NC;
+            for(size_t pc = 0; pc < k; pc += KC)
+            {
+                size_t kc = k - pc < KC ? k - pc : KC;
+
+                //B panel as NR wide slivers, zero padded at the right edge
+                size_t panels = (nc + NR - 1) / NR;
+                T* bp = bpack.data();
+                parallelFor(0, panels, [&](size_t begin, size_t end) {
+                    for(size_t p = begin; p < end; p++)
+                    {
+                        T* dst = bp + p * NR * kc;
+                        for(size_t kk = 0; kk < kc; kk++)
+                            for(size_t j = 0; j < NR; j++)
+                            {
+                                size_t col = p * NR + j;
+                                dst[kk * NR + j] = col < nc ? B(pc + kk, jc + col) : T(0);
+                            }
+                    }
+                }, 4);
+
+                //Tasks are MC rows of C times NGROUP columns of the panel
+                size_t mblocks = (m + MC - 1) / MC;
+                size_t ngroups = (nc + NGROUP - 1) / NGROUP;
+                pool.parallelFor(0, mblocks * ngroups, [&](size_t begin, size_t end, unsigned int worker) {
+                    aligned_vector<T>& apack = apacks[worker];
+                    if(apack.empty())
+                        apack.resize(MC * KC);
+                    alignas(64) T acc[MR * NR];
+                    for(size_t task = begin; task < end; task++)
+                    {
+                        size_t ic = (task / ngroups) * MC;
+                        size_t jg = (task % ngroups) * NGROUP;
+                        size_t mc = m - ic < MC ? m - ic : MC;
+                        size_t ng = nc - jg < NGROUP ? nc - jg : NGROUP;
+
+                        for(size_t ir = 0; ir < mc; ir += MR)
+                        {
+                            T* dst = apack.data() + ir * kc;
+                            for(size_t kk = 0; kk < kc; kk++)
+                                for(size_t i = 0; i < MR; i++)
+                                    dst[kk * MR + i] = ir + i < mc ? A(ic + ir + i, pc + kk) : T(0);
+                        }
+
+                        for(size_t jr = 0; jr < ng; jr += NR)
+                        {
+                            const T* b = bp + ((jg + jr) / NR) * NR * kc;
+                            size_t nr = ng - jr < NR ? ng - jr : NR;
+                            for(size_t ir = 0; ir < mc; ir += MR)
+                            {
+                                Kernel::run(kc, apack.data() + ir * kc, b, acc);
+                                size_t mr = mc - ir < MR ? mc - ir : MR;
+                                for(size_t i = 0; i < mr; i++)
+                                    for(size_t j = 0; j < nr; j++)
+                                        C(ic + ir + i, jc + jg + jr + j) += alpha * acc[i * NR + j];
+                            }
+                        }
+                    }
+                }, 1);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * y = alpha * A * x + beta * y, x and y are single column (or row) views
+     * @return false if the dimensions do not match
+     */
+    template<typename T>
+    static bool gemv(const dmatrix_nondeduced_t<T>& alpha, dmatrix_view<const dmatrix_nondeduced_t<T>> A, dmatrix_view<const dmatrix_nondeduced_t<T>> x, const dmatrix_nondeduced_t<T>& beta, dmatrix_view<T> y)
+    {
+        if(x.cols() != 1 && x.rows() == 1) x = x.transpose();
+        if(y.cols() != 1 && y.rows() == 1) y = y.transpose();
+        if(x.cols() != 1 || y.cols() != 1 || A.cols() != x.rows() || A.rows() != y.rows())
+        {
+            std::cerr << "GumMaths: gemv: dimension mismatch (" << A.rows() << "x" << A.cols() << " * " << x.rows() << "x" << x.cols() << " -> " << y.rows() << "x" << y.cols() << ")" << std::endl;
+            return false;
+        }
+
+        const size_t n = A.cols();
+        if(A.isRowContiguous())
+        {
+            //Dot product per row
+            parallelFor(0, A.rows(), [&](size_t begin, size_t end) {
+                for(size_t r = begin; r < end; r++)
+                {
+                    const T* row = &A(r, 0);
+                    T sum = T(0);
+                    size_t c = 0;
+                    if constexpr(std::is_same<T, float>::value)
+                    {
+                        if(x.isColContiguous())
+                        {
+                            const float* xs = &x(0, 0);
+                            vfloat8 acc(0.0f);
+                            for(; c + 8 <= n; c += 8)
+                                acc = acc + vfloat8::load(row + c) * vfloat8::load(xs + c);
+                            alignas(32) float lanes[8];
+                            acc.storeAligned(lanes);
+                            for(int l = 0; l < 8; l++)
+                                sum += lanes[l];
+                        }
+                    }
+                    for(; c < n; c++)
+                        sum += row[c] * x(c, 0);
+                    y(r, 0) = alpha * sum + (beta == T(0) ? T(0) : beta * y(r, 0));
+                }
+            }, 64);
+        }
+        else
+        {
+            //Column sweeps over blocks of rows, keeps the strided access inside contiguous columns
+            parallelFor(0, A.rows(), [&](size_t begin, size_t end) {
+                const size_t BLOCK = 256;
+                T sums[BLOCK];
+                for(size_t r0 = begin; r0 < end; r0 += BLOCK)
+                {
+                    size_t rn = end - r0 < BLOCK ? end - r0 : BLOCK;
+                    for(size_t i = 0; i < rn; i++)
+                        sums[i] = T(0);
+                    for(size_t c = 0; c < n; c++)
+                    {
+                        T xc = x(c, 0);
+                        for(size_t i = 0; i < rn; i++)
+                            sums[i] += A(r0 + i, c) * xc;
+                    }
+                    for(size_t i = 0; i < rn; i++)
+                        y(r0 + i, 0) = alpha * sums[i] + (beta == T(0) ? T(0) : beta * y(r0 + i, 0));
+                }
+            }, 256);
+        }
+        return true;
+    }
+
+    //Whole matrices, forwarded to the view versions
+    template<typename T>
+    static bool gemm(const dmatrix_nondeduced_t<T>& alpha, const dmatrix<T>& A, const dmatrix<T>& B, const dmatrix_nondeduced_t<T>& beta, dmatrix<T>& C)
+    {
+        return gemm<T>(alpha, A.view(), B.view(), beta, C.view());
+    }
+
+    template<typename T>
+    static bool gemv(const dmatrix_nondeduced_t<T>& alpha, const dmatrix<T>& A, const dmatrix<T>& x, const dmatrix_nondeduced_t<T>& beta, dmatrix<T>& y)
+    {
+        return gemv<T>(alpha, A.view(), x.view(), beta, y.view());
+    }
+
+    //out = a * b, out is resized (and keeps its layout)
+    template<typename T>
+    static bool multiply(const dmatrix<T>& a, const dmatrix<T>& b, dmatrix<T>& out)
+    {
+        out.resize(a.rows(), b.cols());
+        return gemm<T>(T(1), a.view(), b.view(), T(0), out.view());
+    }
+}}
+
+template<typename T>
+dmatrix<T> dmatrix<T>::operator*(const dmatrix<T>& other) const
+{
+    dmatrix<T> ret(iRows, other.cols(), eLayout);
+    Gum::Maths::gemm<T>(T(1), view(), other.view(), T(0), ret.view());
+    return ret;
+}
+
+typedef dmatrix<float>  dmatrixf;
+typedef dmatrix<double> dmatrixd;
@@ -0,0 +1,135 @@
+#include "fixed.h"
+#include <array>
+#include <limits>
+
+namespace Gum {
+namespace Maths
+{
+    //Tables are built by the compiler, so they don't depend on the libm of the target
+    static constexpr double constexprSin(double x)
+    {
+        double term = x, sum = x;
+        for(int n = 1; n < 12; n++)
+        {
+            term *= -x * x / (double)((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr double constexprAtan(double x)
+    {
+        //Only called for x <= 0.5 and 1
+        if(x == 1.0)
+            return GUM_PI_DIV_4;
+        double term = x, sum = x;
+        for(int n = 1; n < 30; n++)
+        {
+            term *= -x * x;
+            sum += term / (double)(2 * n + 1);
+        }
+        return sum;
+    }
+
+    static const unsigned int SIN_TABLE_BITS = 12;
+    static const unsigned int SIN_TABLE_SIZE = 1 << SIN_TABLE_BITS;
+
+    static constexpr std::array<int32_t, SIN_TABLE_SIZE + 1> buildSinTable()
+    {
+        std::array<int32_t, SIN_TABLE_SIZE + 1> table = {};
+        for(unsigned int i = 0; i <= SIN_TABLE_SIZE; i++)
+            table[i] = (int32_t)(constexprSin(GUM_PI_DIV_2 * (double)i / (double)SIN_TABLE_SIZE) * (double)(1 << 30) + 0.5);
+        return table;
+    }
+
+    static const unsigned int CORDIC_ITERATIONS = 31;
+
+    static constexpr std::array<int64_t, CORDIC_ITERATIONS> buildAtanTable()
+    {
+        std::array<int64_t, CORDIC_ITERATIONS> table = {};
+        for(unsigned int i = 0; i < CORDIC_ITERATIONS; i++)
+            table[i] = (int64_t)(constexprAtan(1.0 / (double)((int64_t)1 << i)) / GUM_TWO_PI * 4294967296.0 + 0.5);
+        return table;
+    }
+
+    static constexpr std::array<int32_t, SIN_TABLE_SIZE + 1> SIN_TABLE = buildSinTable();
+    static constexpr std::array<int64_t, CORDIC_ITERATIONS> ATAN_TABLE = buildAtanTable();
+
+
+    int32_t fixedSinTurn(uint32_t phase)
+    {
+        const unsigned int fracBits = 30 - SIN_TABLE_BITS;
+        uint32_t quadrant = phase >> 30;
+        uint32_t x = phase & 0x3FFFFFFFu;
+        if(quadrant & 1)
+            x = 0x40000000u - x; //Mirror, x can be a full quarter now
+
+        uint32_t index = x >> fracBits;
+        int64_t value = SIN_TABLE[index];
+        if(index < SIN_TABLE_SIZE)
+        {
+            int64_t frac = x & ((1u << fracBits) - 1);
+            value += ((SIN_TABLE[index + 1] - value) * frac) >> fracBits;
+        }
+        return (int32_t)(quadrant & 2 ? -value : value);
+    }
+
+    int64_t fixedAtan2Turn(int64_t y, int64_t x)
+    {
+        if(x == 0 && y == 0)
+            return 0;
+
+        if(x == std::numeric_limits<int64_t>::min() || y == std::numeric_limits<int64_t>::min())
+        {
+            x >>= 1;
+            y >>= 1;
+        }
+
+        //Rotate into the right half plane
+        int64_t angle = 0;
+        if(x < 0)
+        {
+            angle = y >= 0 ? ((int64_t)1 << 31) : -((int64_t)1 << 31);
+            x = -x;
+            y = -y;
+        }
+
+        //Bring the magnitude to 2^29..2^30, leaves room for the CORDIC gain of ~1.65
+        uint64_t mag = (uint64_t)x | (uint64_t)(y < 0 ? -y : y);
+        int shift = 0;
+        while((mag >> shift) >= ((uint64_t)1 << 30)) shift++;
+        if(shift > 0)
+        {
+            x >>= shift;
+            y >>= shift;
+        }
+        else
+        {
+            while(mag < ((uint64_t)1 << 29))
+            {
+                mag <<= 1;
+                x *= 2;
+                y *= 2;
+            }
+        }
+
+        for(unsigned int i = 0; i < CORDIC_ITERATIONS; i++)
+        {
+            int64_t nx;
+            if(y > 0)
+            {
+                nx = x + (y >> i);
+                y = y - (x >> i);
+                angle += ATAN_TABLE[i];
+            }
+            else
+            {
+                nx = x - (y >> i);
+                y = y + (x >> i);
+                angle -= ATAN_TABLE[i];
+            }
+            x = nx;
+        }
+        return angle;
+    }
+}}
@@ -0,0 +1,342 @@
+#pragma once
+#include "vec.h"
+#include "mat.h"
+#include "quat.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Integer kernels behind the fixed point functions, they only use integer arithmetic so the
+     * results are bit identical on every compiler and CPU.
+     * Angles are in turns, 2^32 is a full circle.
+     */
+    //sin of phase in Q2.30, 4096 entry quarter wave table with linear interpolation (max error ~2e-8)
+    extern int32_t fixedSinTurn(uint32_t phase);
+    //CORDIC atan2 of y and x (any common scale), result in [-2^31, 2^31]
+    extern int64_t fixedAtan2Turn(int64_t y, int64_t x);
+
+    //Full 64x64 bit multiply and 128/64 bit divide for compilers without __int128
+    static inline void mulU64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo)
+    {
+        const uint64_t mask = 0xFFFFFFFFu;
+        uint64_t a0 = a & mask, a1 = a >> 32;
+        uint64_t b0 = b & mask, b1 = b >> 32;
+        uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        uint64_t mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+        lo = (mid << 32) | (p00 & mask);
+        hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    }
+
+    //Returns false if the quotient does not fit into 64 bit
+    static inline bool divU128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t& q)
+    {
+        if(hi >= d)
+            return false;
+        q = 0;
+        for(int i = 0; i < 64; i++)
+        {
+            uint64_t carry = hi >> 63;
+            hi = (hi << 1) | (lo >> 63);
+            lo <<= 1;
+            q <<= 1;
+            if(carry || hi >= d)
+            {
+                hi -= d;
+                q |= 1;
+            }
+        }
+        return true;
+    }
+}}
+
+
+/**
+ * Signed fixed point scalar with F fractional bits stored in S
+ * Meant for deterministic simulations: every operation is integer only, so results are identical
+ * across compilers and CPUs. Usable as T in tvec, mat and quat.
+ * Integers convert implicitly (saturating outside the range), floating point only explicitly to keep
+ * float math from sneaking in.
+ * Multiply and divide use a double width intermediate and saturate instead of overflowing,
+ * addition and subtraction wrap. Multiply rounds towards negative infinity, divide towards zero.
+ */
+template<typename S, unsigned int F>
+struct tfixed
+{
+    static_assert(std::is_integral<S>::value && std::is_signed<S>::value, "tfixed: storage has to be a signed integer");
+    static_assert(F > 0 && F + 4 <= sizeof(S) * 8, "tfixed: too many fractional bits");
+
+    typedef S storage_type;
+    typedef typename std::make_unsigned<S>::type unsigned_type;
+    static constexpr unsigned int FRACTION_BITS = F;
+    static constexpr S ONE = (S)1 << F;
+
+    S raw;
+
+    tfixed() = default;
+
+    //Integers outside the range saturate to the largest or smallest value
+    template<typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+    constexpr tfixed(I i) : raw(integerToRaw(i)) {}
+
+    template<typename R, typename std::enable_if<std::is_floating_point<R>::value, int>::type = 0>
+    constexpr explicit tfixed(R r) : raw((S)(r * (R)ONE + (r < 0 ? (R)-0.5 : (R)0.5))) {}
+
+    static constexpr tfixed fromRaw(S r) { tfixed f = tfixed(); f.raw = r; return f; }
+
+    template<typename I>
+    static constexpr S integerToRaw(I i)
+    {
+        constexpr S maxInt = std::numeric_limits<S>::max() >> F;
+        constexpr S minInt = -maxInt - 1;
+        if constexpr (std::is_signed<I>::value)
+        {
+            if((intmax_t)i > (intmax_t)maxInt) return std::numeric_limits<S>::max();
+            if((intmax_t)i < (intmax_t)minInt) return std::numeric_limits<S>::min();
+        }
+        else if((uintmax_t)i > (uintmax_t)maxInt)
+            return std::numeric_limits<S>::max();
+        return (S)((S)i * ONE);
+    }
+
+    template<typename R, typename std::enable_if<std::is_floating_point<R>::value, int>::type = 0>
+    constexpr explicit operator R() const { return (R)raw / (R)ONE; }
+
+    //Truncates towards zero like a float to int cast
+    template<typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+    constexpr explicit operator I() const { return (I)(raw / ONE); }
+
+
+    //
+    // Arithmetic
+    //
+    static tfixed saturate(bool negative) { return fromRaw(negative ? std::numeric_limits<S>::min() : std::numeric_limits<S>::max()); }
+
+    static tfixed multiply(S a, S b)
+    {
+        if constexpr (sizeof(S) <= 4)
+        {
+            int64_t p = ((int64_t)a * (int64_t)b) >> F;
+            if(p > (int64_t)std::numeric_limits<S>::max() || p < (int64_t)std::numeric_limits<S>::min())
+                return saturate(p < 0);
+            return fromRaw((S)p);
+        }
+#ifdef __SIZEOF_INT128__
+        else
+        {
+            __int128 p = ((__int128)a * (__int128)b) >> F;
+            if(p > (__int128)std::numeric_limits<S>::max() || p < (__int128)std::numeric_limits<S>::min())
+                return saturate(p < 0);
+            return fromRaw((S)p);
+        }
+#else
+        else
+        {
+            bool negative = (a < 0) != (b < 0);
+            uint64_t hi, lo;
+            Gum::Maths::mulU64(a < 0 ? 0 - (uint64_t)a : (uint64_t)a, b < 0 ? 0 - (uint64_t)b : (uint64_t)b, hi, lo);
+            uint64_t q = (lo >> F) | (hi << (64 - F));
+            if(negative && (lo & (((uint64_t)1 << F) - 1)) != 0)
+                q++; //Round towards negative infinity like the arithmetic shift above
+            if((hi >> F) != 0 || q > (uint64_t)std::numeric_limits<S>::max() + (negative ? 1 : 0))
+                return saturate(negative);
+            return fromRaw(negative ? (S)(0 - q) : (S)q);
+        }
+#endif
+    }
+
+    static tfixed divide(S a, S b)
+    {
+        if(b == 0)
+            return saturate(a < 0);
+
+        if constexpr (sizeof(S) <= 4)
+        {
+            int64_t q = ((int64_t)a * (int64_t)ONE) / (int64_t)b;
+            if(q > (int64_t)std::numeric_limits<S>::max() || q < (int64_t)std::numeric_limits<S>::min())
+                return saturate(q < 0);
+            return fromRaw((S)q);
+        }
+#ifdef __SIZEOF_INT128__
+        else
+        {
+            __int128 q = ((__int128)a * (__int128)ONE) / (__int128)b;
+            if(q > (__int128)std::numeric_limits<S>::max() || q < (__int128)std::numeric_limits<S>::min())
+                return saturate(q < 0);
+            return fromRaw((S)q);
+        }
+#else
+        else
+        {
+            bool negative = (a < 0) != (b < 0);
+            uint64_t ua = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+            uint64_t ub = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+            uint64_t q;
+            if(!Gum::Maths::divU128(ua >> (64 - F), ua << F, ub, q) || q > (uint64_t)std::numeric_limits<S>::max() + (negative ? 1 : 0))
+                return saturate(negative);
+            return fromRaw(negative ? (S)(0 - q) : (S)q);
+        }
+#endif
+    }
+
+    friend constexpr tfixed operator+(tfixed a, tfixed b) { return fromRaw((S)((unsigned_type)a.raw + (unsigned_type)b.raw)); }
+    friend constexpr tfixed operator-(tfixed a, tfixed b) { return fromRaw((S)((unsigned_type)a.raw - (unsigned_type)b.raw)); }
+    friend tfixed operator*(tfixed a, tfixed b)           { return multiply(a.raw, b.raw); }
+    friend tfixed operator/(tfixed a, tfixed b)           { return divide(a.raw, b.raw); }
+    constexpr tfixed operator-() const                    { return fromRaw((S)(0 - (unsigned_type)raw)); }
+    constexpr tfixed operator+() const                    { return *this; }
+
+    tfixed& operator+=(tfixed b) { return *this = *this + b; }
+    tfixed& operator-=(tfixed b) { return *this = *this - b; }
+    tfixed& operator*=(tfixed b) { return *this = *this * b; }
+    tfixed& operator/=(tfixed b) { return *this = *this / b; }
+
+    friend constexpr bool operator==(tfixed a, tfixed b) { return a.raw == b.raw; }
+    friend constexpr bool operator!=(tfixed a, tfixed b) { return a.raw != b.raw; }
+    friend constexpr bool operator< (tfixed a, tfixed b) { return a.raw <  b.raw; }
+    friend constexpr bool operator<=(tfixed a, tfixed b) { return a.raw <= b.raw; }
+    friend constexpr bool operator> (tfixed a, tfixed b) { return a.raw >  b.raw; }
+    friend constexpr bool operator>=(tfixed a, tfixed b) { return a.raw >= b.raw; }
+};
+
+
+//
+// Math functions, found through ADL so templates calling sqrt(x) or sin(x) unqualified pick them up
+//
+template<typename S, unsigned int F>
+static inline tfixed<S, F> abs(tfixed<S, F> a)  { return a.raw < 0 ? -a : a; }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> fabs(tfixed<S, F> a) { return abs(a); }
+
+template<typename S, unsigned int F>
+static inline tfixed<S, F> floor(tfixed<S, F> a) { return tfixed<S, F>::fromRaw(a.raw & ~(tfixed<S, F>::ONE - 1)); }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> ceil(tfixed<S, F> a)  { return -floor(-a); }
+
+template<typename S, unsigned int F>
+static inline tfixed<S, F> min(tfixed<S, F> a, tfixed<S, F> b) { return a < b ? a : b; }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> max(tfixed<S, F> a, tfixed<S, F> b) { return a > b ? a : b; }
+
+//Bitwise square root, exact to the last bit (rounded down), negative input gives 0
+template<typename S, unsigned int F>
+static inline tfixed<S, F> sqrt(tfixed<S, F> a)
+{
+    typedef typename tfixed<S, F>::unsigned_type U;
+    const unsigned int bits = sizeof(S) * 8;
+    if(a.raw <= 0)
+        return tfixed<S, F>(0);
+
+    //The radicand is raw * 2^F, taken two bits at a time. With an odd number of bits the first pair
+    //only holds the sign bit, which is 0 here, so it is skipped
+    U x = (U)a.raw, root = 0, rem = 0;
+    const unsigned int odd = (bits + F) % 2;
+    x <<= odd;
+    for(unsigned int i = 0; i < (bits + F - odd) / 2; i++)
+    {
+        rem = (rem << 2) | (x >> (bits - 2));
+        x <<= 2;
+        root <<= 1;
+        U test = (root << 1) | 1;
+        if(rem >= test)
+        {
+            rem -= test;
+            root |= 1;
+        }
+    }
+    return tfixed<S, F>::fromRaw((S)root);
+}
+
+//Radians to turns, the full 128 bit product wraps around the circle on its own, so large angles lose no precision
+template<typename S, unsigned int F>
+static inline uint32_t fixedToTurn(tfixed<S, F> a)
+{
+    constexpr uint64_t scale = (uint64_t)(73786976294838206464.0 / GUM_TWO_PI); //2^66 / 2pi
+    constexpr unsigned int shift = F + 34;
+    uint64_t hi, lo;
+    Gum::Maths::mulU64(a.raw < 0 ? 0 - (uint64_t)a.raw : (uint64_t)a.raw, scale, hi, lo);
+    uint32_t turn = (uint32_t)(shift >= 64 ? hi >> (shift - 64) : (lo >> shift) | (hi << (64 - shift)));
+    return a.raw < 0 ? 0 - turn : turn;
+}
+
+//Turns back to radians
+template<typename S, unsigned int F>
+static inline tfixed<S, F> fixedFromTurn(int64_t turn)
+{
+    constexpr int64_t twoPi28 = (int64_t)(GUM_TWO_PI * (double)(1 << 28) + 0.5);
+    return tfixed<S, F>::fromRaw((S)((turn * twoPi28) >> (60 - F)));
+}
+
+//Q2.30 to F fractional bits
+template<typename S, unsigned int F>
+static inline tfixed<S, F> fixedFromQ30(int64_t v)
+{
+    if constexpr (F <= 30) return tfixed<S, F>::fromRaw((S)((v + ((int64_t)1 << (30 - F) >> 1)) >> (30 - F)));
+    else                   return tfixed<S, F>::fromRaw((S)(v * ((int64_t)1 << (F - 30))));
+}
+
+template<typename S, unsigned int F>
+static inline tfixed<S, F> sin(tfixed<S, F> a) { return fixedFromQ30<S, F>(Gum::Maths::fixedSinTurn(fixedToTurn(a))); }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> cos(tfixed<S, F> a) { return fixedFromQ30<S, F>(Gum::Maths::fixedSinTurn(fixedToTurn(a) + 0x40000000u)); }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> tan(tfixed<S, F> a)
+{
+    uint32_t turn = fixedToTurn(a);
+    return tfixed<S, F>::divide(fixedFromQ30<S, F>(Gum::Maths::fixedSinTurn(turn)).raw, fixedFromQ30<S, F>(Gum::Maths::fixedSinTurn(turn + 0x40000000u)).raw);
+}
+
+template<typename S, unsigned int F>
+static inline tfixed<S, F> atan2(tfixed<S, F> y, tfixed<S, F> x) { return fixedFromTurn<S, F>(Gum::Maths::fixedAtan2Turn(y.raw, x.raw)); }
+template<typename S, unsigned int F>
+static inline tfixed<S, F> atan(tfixed<S, F> a) { return atan2(a, tfixed<S, F>(1)); }
+
+//Input is clamped to [-1, 1]
+template<typename S, unsigned int F>
+static inline tfixed<S, F> asin(tfixed<S, F> a)
+{
+    a = max(min(a, tfixed<S, F>(1)), tfixed<S, F>(-1));
+    return atan2(a, sqrt(tfixed<S, F>(1) - a * a));
+}
+template<typename S, unsigned int F>
+static inline tfixed<S, F> acos(tfixed<S, F> a)
+{
+    a = max(min(a, tfixed<S, F>(1)), tfixed<S, F>(-1));
+    return atan2(sqrt(tfixed<S, F>(1) - a * a), a);
+}
+
+
+namespace std
+{
+    template<typename S, unsigned int F>
+    class numeric_limits<tfixed<S, F>> : public numeric_limits<S>
+    {
+    public:
+        static constexpr bool is_integer = false;
+        static constexpr bool is_exact = true;
+        static constexpr tfixed<S, F> min()     noexcept { return tfixed<S, F>::fromRaw(1); }
+        static constexpr tfixed<S, F> max()     noexcept { return tfixed<S, F>::fromRaw(numeric_limits<S>::max()); }
+        static constexpr tfixed<S, F> lowest()  noexcept { return tfixed<S, F>::fromRaw(numeric_limits<S>::min()); }
+        static constexpr tfixed<S, F> epsilon() noexcept { return tfixed<S, F>::fromRaw(1); }
+    };
+}
+
+
+typedef tfixed<int32_t, 16> fixed16; //Q16.16, range +-32768, resolution 1.5e-5
+typedef tfixed<int64_t, 32> fixed32; //Q32.32, range +-2.1e9, resolution 2.3e-10
+
+typedef tvec<fixed16, 2>  fxvec2;
+typedef tvec<fixed16, 3>  fxvec3;
+typedef tvec<fixed16, 4>  fxvec4;
+typedef tvec<fixed32, 2> dfxvec2;
+typedef tvec<fixed32, 3> dfxvec3;
+typedef tvec<fixed32, 4> dfxvec4;
+typedef mat<fixed16, 3, 3>  fxmat3;
+typedef mat<fixed16, 4, 4>  fxmat4;
+typedef mat<fixed32, 3, 3> dfxmat3;
+typedef mat<fixed32, 4, 4> dfxmat4;
+typedef quat<fixed16>  fxquat;
+typedef quat<fixed32> dfxquat;
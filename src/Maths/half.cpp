@@ -0,0 +1,88 @@
+#include "half.h"
+#include "ThreadPool.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GUM_MATHS_F16C_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace Gum {
+namespace Maths
+{
+#ifdef GUM_MATHS_F16C_DISPATCH
+    __attribute__((target("avx,f16c")))
+    static void floatToHalfF16C(const float* in, half* out, size_t count)
+    {
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+        for(; i < count; i++)
+            out[i].bits = floatToHalfBits(in[i]);
+    }
+
+    __attribute__((target("avx,f16c")))
+    static void halfToFloatF16C(const half* in, float* out, size_t count)
+    {
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i))));
+        for(; i < count; i++)
+            out[i] = halfBitsToFloat(in[i].bits);
+    }
+
+    static bool hasF16C()
+    {
+        static const bool supported = __builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx");
+        return supported;
+    }
+#endif
+
+    //Conversion is bandwidth bound, only very large arrays gain from more threads
+    static const size_t CONVERT_GRAIN = 1 << 16;
+
+    void convert(const float* in, half* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+#ifdef GUM_MATHS_F16C_DISPATCH
+            if(hasF16C())
+            {
+                floatToHalfF16C(in + begin, out + begin, end - begin);
+                return;
+            }
+#endif
+            for(size_t i = begin; i < end; i++)
+                out[i].bits = floatToHalfBits(in[i]);
+        }, CONVERT_GRAIN);
+    }
+
+    void convert(const half* in, float* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+#ifdef GUM_MATHS_F16C_DISPATCH
+            if(hasF16C())
+            {
+                halfToFloatF16C(in + begin, out + begin, end - begin);
+                return;
+            }
+#endif
+            for(size_t i = begin; i < end; i++)
+                out[i] = halfBitsToFloat(in[i].bits);
+        }, CONVERT_GRAIN);
+    }
+
+    void convert(const float* in, bfloat16* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i].bits = floatToBFloat16Bits(in[i]);
+        }, CONVERT_GRAIN);
+    }
+
+    void convert(const bfloat16* in, float* out, size_t count)
+    {
+        parallelFor(0, count, [in, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = bfloat16BitsToFloat(in[i].bits);
+        }, CONVERT_GRAIN);
+    }
+}}
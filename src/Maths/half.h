@@ -0,0 +1,168 @@
+#pragma once
+#include "vec.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * IEEE binary16 conversion with round to nearest even, bit exact with the F16C instructions
+     * including subnormals, infinities and NaN payloads (NaNs come out quiet)
+     */
+    static inline uint16_t floatToHalfBits(float value)
+    {
+        uint32_t f;
+        memcpy(&f, &value, 4);
+        uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+
+        uint16_t o;
+        if(f >= 0x47800000u) //Too large for half (2^16), infinity or NaN
+        {
+            o = f > 0x7F800000u ? (uint16_t)(0x7E00u | ((f >> 13) & 0x3FFu)) : (uint16_t)0x7C00u;
+        }
+        else if(f < 0x38800000u) //Below the smallest normal half (2^-14)
+        {
+            //Adding 0.5 shifts the mantissa into place and lets the FPU do the rounding
+            const uint32_t magicBits = 0x3F000000u;
+            float magic, ff;
+            memcpy(&magic, &magicBits, 4);
+            memcpy(&ff, &f, 4);
+            ff += magic;
+            uint32_t r;
+            memcpy(&r, &ff, 4);
+            o = (uint16_t)(r - magicBits);
+        }
+        else
+        {
+            uint32_t mantOdd = (f >> 13) & 1;
+            f += 0xC8000FFFu; //Rebias the exponent (-112 << 23) and add rounding bias
+            f += mantOdd;
+            o = (uint16_t)(f >> 13);
+        }
+        return (uint16_t)(o | (sign >> 16));
+    }
+
+    //Exact, every half is representable as float
+    static inline float halfBitsToFloat(uint16_t h)
+    {
+        uint32_t o = (uint32_t)(h & 0x7FFFu) << 13;
+        uint32_t exp = o & 0x0F800000u;
+        o += 0x38000000u; //Exponent rebias (127 - 15) << 23
+
+        if(exp == 0x0F800000u) //Infinity or NaN
+        {
+            o += 0x38000000u;
+            if(o & 0x007FFFFFu)
+                o |= 0x00400000u; //NaNs come out quiet
+        }
+        else if(exp == 0) //Zero or subnormal, renormalize through the FPU
+        {
+            const uint32_t magicBits = 0x38800000u;
+            float magic, ff;
+            o += 0x00800000u;
+            memcpy(&magic, &magicBits, 4);
+            memcpy(&ff, &o, 4);
+            ff -= magic;
+            memcpy(&o, &ff, 4);
+        }
+
+        o |= (uint32_t)(h & 0x8000u) << 16;
+        float ret;
+        memcpy(&ret, &o, 4);
+        return ret;
+    }
+
+    //bfloat16 is the upper half of a float, rounding to nearest even
+    static inline uint16_t floatToBFloat16Bits(float value)
+    {
+        uint32_t f;
+        memcpy(&f, &value, 4);
+        if((f & 0x7FFFFFFFu) > 0x7F800000u)
+            return (uint16_t)((f >> 16) | 0x0040u); //Keep NaNs NaN and quiet
+        f += 0x7FFFu + ((f >> 16) & 1);
+        return (uint16_t)(f >> 16);
+    }
+
+    static inline float bfloat16BitsToFloat(uint16_t b)
+    {
+        uint32_t f = (uint32_t)b << 16;
+        float ret;
+        memcpy(&ret, &f, 4);
+        return ret;
+    }
+}}
+
+
+/**
+ * 16 bit storage floats
+ * Arithmetic happens in float, values convert implicitly in both directions, so they can be
+ * used as tvec element type (hvec3) and mixed with regular floats.
+ */
+struct half
+{
+    uint16_t bits;
+
+    half() = default;
+    half(float f) : bits(Gum::Maths::floatToHalfBits(f)) {}
+    static half fromBits(uint16_t bits) { half h; h.bits = bits; return h; }
+
+    operator float() const { return Gum::Maths::halfBitsToFloat(bits); }
+
+    half operator-() const { return fromBits(bits ^ 0x8000u); }
+    template<typename TT> half& operator+=(const TT& f) { *this = half((float)*this + (float)f); return *this; }
+    template<typename TT> half& operator-=(const TT& f) { *this = half((float)*this - (float)f); return *this; }
+    template<typename TT> half& operator*=(const TT& f) { *this = half((float)*this * (float)f); return *this; }
+    template<typename TT> half& operator/=(const TT& f) { *this = half((float)*this / (float)f); return *this; }
+};
+
+struct bfloat16
+{
+    uint16_t bits;
+
+    bfloat16() = default;
+    bfloat16(float f) : bits(Gum::Maths::floatToBFloat16Bits(f)) {}
+    static bfloat16 fromBits(uint16_t bits) { bfloat16 b; b.bits = bits; return b; }
+
+    operator float() const { return Gum::Maths::bfloat16BitsToFloat(bits); }
+
+    bfloat16 operator-() const { return fromBits(bits ^ 0x8000u); }
+    template<typename TT> bfloat16& operator+=(const TT& f) { *this = bfloat16((float)*this + (float)f); return *this; }
+    template<typename TT> bfloat16& operator-=(const TT& f) { *this = bfloat16((float)*this - (float)f); return *this; }
+    template<typename TT> bfloat16& operator*=(const TT& f) { *this = bfloat16((float)*this * (float)f); return *this; }
+    template<typename TT> bfloat16& operator/=(const TT& f) { *this = bfloat16((float)*this / (float)f); return *this; }
+};
+
+static_assert(sizeof(half) == 2 && sizeof(bfloat16) == 2, "16 bit floats have to be packed");
+
+typedef tvec<half, 2>      hvec2;
+typedef tvec<half, 3>      hvec3;
+typedef tvec<half, 4>      hvec4;
+typedef tvec<bfloat16, 2> bhvec2;
+typedef tvec<bfloat16, 3> bhvec3;
+typedef tvec<bfloat16, 4> bhvec4;
+
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Bulk conversion, F16C is used when the CPU has it (detected at runtime), otherwise the
+     * bit exact software path. Large arrays are split across the default ThreadPool.
+     */
+    extern void convert(const float* in, half* out, size_t count);
+    extern void convert(const half* in, float* out, size_t count);
+    extern void convert(const float* in, bfloat16* out, size_t count);
+    extern void convert(const bfloat16* in, float* out, size_t count);
+
+    //Vector arrays, e.g. vec3 positions to hvec3
+    template<unsigned int S, unsigned int type>
+    static void convert(const tvec<float, S, type>* in, tvec<half, S, type>* out, size_t count)     { convert((const float*)in, (half*)out, count * S); }
+    template<unsigned int S, unsigned int type>
+    static void convert(const tvec<half, S, type>* in, tvec<float, S, type>* out, size_t count)     { convert((const half*)in, (float*)out, count * S); }
+    template<unsigned int S, unsigned int type>
+    static void convert(const tvec<float, S, type>* in, tvec<bfloat16, S, type>* out, size_t count) { convert((const float*)in, (bfloat16*)out, count * S); }
+    template<unsigned int S, unsigned int type>
+    static void convert(const tvec<bfloat16, S, type>* in, tvec<float, S, type>* out, size_t count) { convert((const bfloat16*)in, (float*)out, count * S); }
+}}
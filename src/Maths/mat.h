@@ -2,6 +2,7 @@
 #include "vec.h"
 #include <iostream>
 #include <string>
+#include <string_view>
 
 template<typename T, unsigned int N, unsigned int M>
 struct mat
@@ -10,6 +11,7 @@ struct mat
     
     mat()
     {
+        GUM_MATHS_COUNT(MAT_CONSTRUCT, T, N, M);
         for(unsigned int i = 0; i < M; i++)
             for(unsigned int j = 0; j < N; j++)
                 v[i][j] = i == j ? T(1) : T(0);
@@ -17,6 +19,7 @@ struct mat
 
     mat(T const& f)
     {
+        GUM_MATHS_COUNT(MAT_CONSTRUCT, T, N, M);
         for(unsigned int i = 0; i < M; i++)
             for(unsigned int j = 0; j < N; j++)
                 v[i][j] = f;
@@ -24,6 +27,7 @@ struct mat
     template<typename TT>
     mat(const mat<TT, N, M>& m)
     {
+        GUM_MATHS_COUNT(MAT_CONSTRUCT, T, N, M);
         for(unsigned int i = 0; i < N; i++)
             for(unsigned int j = 0; j < M; j++)
                 v[i][j] = m[i][j];
@@ -32,6 +36,7 @@ struct mat
     template<typename TT, unsigned int NN, unsigned int MM>
     mat(mat<TT, NN, MM> const& m)
     {
+        GUM_MATHS_COUNT(MAT_CONSTRUCT, T, N, M);
         for(unsigned int i = 0; i < (N > NN ? NN : N); i++)
             for(unsigned int j = 0; j < (M > MM ? MM : M); j++)
                 v[i][j] = m[i][j];
@@ -41,6 +46,7 @@ struct mat
     explicit mat(Args&&... values) 
     {
         //static_assert(is_all_same<T, values...>::value, "Arguments must be int.");
+        GUM_MATHS_COUNT(MAT_CONSTRUCT, T, N, M);
         T args[] = { static_cast<T>(values)... };
         memcpy(&v[0], &args[0], M * N * sizeof(T));
         this->operator=(transpose(*this));
@@ -60,6 +66,7 @@ struct mat
     mat<T, N, MM> operator*(mat<TT, NN, MM> const& m)
     {
         static_assert(M == NN, "Matrices can't be multiplied!");
+        GUM_MATHS_TIMED(MAT_MULTIPLY, T, N, M);
         mat<T, N, MM> tmpMat(T(0));
         for(unsigned int i = 0; i < MM; i++)
             for(unsigned int j = 0; j < N; j++)
@@ -71,6 +78,7 @@ struct mat
     void operator*=(mat<TT, NN, MM> const& m)
     {
         static_assert(M == NN, "Matrices can't be multiplied!");
+        GUM_MATHS_TIMED(MAT_MULTIPLY, T, N, M);
         mat<T, N, MM> tmpMat(T(0));
         for(unsigned int i = 0; i < MM; i++)
             for(unsigned int j = 0; j < N; j++)
@@ -91,6 +99,7 @@ struct mat
     template<typename TT>
     mat<T, N, M> operator*(TT const& f)
     {
+        GUM_MATHS_COUNT(MAT_SCALAR_MULTIPLY, T, N, M);
         mat<T, N, M> retmat(0);
         for(unsigned int i = 0; i < M; i++)
             for(unsigned int j = 0; j < N; j++)
@@ -100,6 +109,7 @@ struct mat
     template<typename TT>
     void operator*=(TT const& f)
     {
+        GUM_MATHS_COUNT(MAT_SCALAR_MULTIPLY, T, N, M);
         for(unsigned int i = 0; i < M; i++)
             for(unsigned int j = 0; j < N; j++)
                 v[i][j] *= f;
@@ -117,6 +127,7 @@ struct mat
     template<typename TT>
     tvec<TT, N> operator*(tvec<TT, M> const& vvec)
     {
+        GUM_MATHS_COUNT(MAT_VECTOR_MULTIPLY, T, N, M);
         tvec<TT, N> retvec;
         for(unsigned int i = 0; i < N; i++)
             for(unsigned int j = 0; j < M; j++)
@@ -169,6 +180,7 @@ struct mat
 
     T determinant()
     {
+        GUM_MATHS_COUNT(MAT_DETERMINANT, T, N, M);
         T det = 0;
         if(N == M)
         {
@@ -208,6 +220,7 @@ struct mat
     template<typename TT, unsigned int NN, unsigned int MM>
     static mat<TT, MM, NN> transpose(mat<TT, NN, MM> const& m)
     {
+        GUM_MATHS_COUNT(MAT_TRANSPOSE, TT, NN, MM);
         mat<TT, MM, NN> tmpMat;
         for(unsigned int i = 0; i < MM; i++)
             for(unsigned int j = 0; j < NN; j++)
@@ -215,15 +228,20 @@ struct mat
         return tmpMat;
     }
 
+    /**
+     * Only implemented for 4x4, other sizes are returned unchanged
+     * A singular matrix is returned unchanged as well, use invertMatrix() to check for that without the error message
+     */
     template<typename TT, unsigned int NN, unsigned int MM>
     static mat<TT, NN, MM> inverse(mat<TT, NN, MM> const& m)
     {
         static_assert(MM == NN, "Matrix has no inverse!");
-        if(NN == 4 && MM == 4)
+        GUM_MATHS_TIMED(MAT_INVERSE, TT, NN, MM);
+        if constexpr(NN == 4 && MM == 4)
         {
             mat<TT, NN, MM> retmat(0), inv(0);
 
-            inv[0][0] =  m[1][1] * m[2][2] * m[3][3] - m[1][1] * m[2][3] * m[3][2] - m[2][1] * m[1][2] * m[3][3] + m[2][1] * m[1][3] * m[3][2] + m[2][1] * m[1][2] * m[2][2] - m[2][1] * m[1][2] * m[2][1];
+            inv[0][0] =  m[1][1] * m[2][2] * m[3][3] - m[1][1] * m[2][3] * m[3][2] - m[2][1] * m[1][2] * m[3][3] + m[2][1] * m[1][3] * m[3][2] + m[3][1] * m[1][2] * m[2][3] - m[3][1] * m[1][3] * m[2][2];
             inv[1][0] = -m[1][0] * m[2][2] * m[3][3] + m[1][0] * m[2][3] * m[3][2] + m[2][0] * m[1][2] * m[3][3] - m[2][0] * m[1][3] * m[3][2] - m[3][0] * m[1][2] * m[2][3] + m[3][0] * m[1][3] * m[2][2];
             inv[2][0] =  m[1][0] * m[2][1] * m[3][3] - m[1][0] * m[2][3] * m[3][1] - m[2][0] * m[1][1] * m[3][3] + m[2][0] * m[1][3] * m[3][1] + m[3][0] * m[1][1] * m[2][3] - m[3][0] * m[1][3] * m[2][1];
             inv[3][0] = -m[1][0] * m[2][1] * m[3][2] + m[1][0] * m[2][2] * m[3][1] + m[2][0] * m[1][1] * m[3][2] - m[2][0] * m[1][2] * m[3][1] - m[3][0] * m[1][1] * m[2][2] + m[3][0] * m[1][2] * m[2][1];
@@ -240,10 +258,13 @@ struct mat
             inv[2][3] = -m[0][0] * m[1][1] * m[2][3] + m[0][0] * m[1][3] * m[2][1] + m[1][0] * m[0][1] * m[2][3] - m[1][0] * m[0][3] * m[2][1] - m[2][0] * m[0][1] * m[1][3] + m[2][0] * m[0][3] * m[1][1];
             inv[3][3] =  m[0][0] * m[1][1] * m[2][2] - m[0][0] * m[1][2] * m[2][1] - m[1][0] * m[0][1] * m[2][2] + m[1][0] * m[0][2] * m[2][1] + m[2][0] * m[0][1] * m[1][2] - m[2][0] * m[0][2] * m[1][1];
 
-            float det = m[0][0] * inv[0][0] + m[0][1] * inv[1][0] + m[0][2] * inv[2][0] + m[0][3] * inv[3][0];
+            TT det = m[0][0] * inv[0][0] + m[0][1] * inv[1][0] + m[0][2] * inv[2][0] + m[0][3] * inv[3][0];
 
             if (det == 0)
-                return m; //There's no inverse
+            {
+                std::cerr << "GumMaths: Matrix inverse failed: matrix is singular" << std::endl;
+                return m;
+            }
 
             det = (TT)1.0 / det;
 
@@ -271,30 +292,58 @@ struct mat
         }
     }
 
-    std::string toString(const bool& oneline = true, const std::string& prefix = "mat"+std::to_string(N)+"x"+std::to_string(M)+"(", const std::string& suffix = ")", const std::string& delimiter = ", ")
+    static const std::string& typeName() { static const std::string typename_str = "mat" + std::to_string(N) + "x" + std::to_string(M); return typename_str; }
+
+    void appendToString(std::string& out, const bool& oneline, std::string_view prefix, std::string_view suffix = ")", std::string_view delimiter = ", ", const int& precision = 6) const
     {
-        std::string output = prefix;
+        out.append(prefix);
         if(!oneline)
-            output += "\n";
+            out += '\n';
         for(unsigned int i = 0; i < N; i++)
         {
             if(!oneline)
-                output += "    ";
+                out.append("    ");
             for(unsigned int j = 0; j < M; j++)
             {
+                Gum::Maths::appendNumber(out, v[j][i], precision);
                 if(j + i * M < M * N - 1)
-                    output += std::to_string(v[j][i]) + delimiter;
-                else
-                    output += std::to_string(v[j][i]);
+                    out.append(delimiter);
             }
             if(!oneline)
-                output += "\n";
+                out += '\n';
         }
-        output += suffix;
+        out.append(suffix);
+    }
+
+    std::string toString(const bool& oneline, std::string_view prefix, std::string_view suffix = ")", std::string_view delimiter = ", ", const int& precision = 6) const
+    {
+        std::string output;
+        appendToString(output, oneline, prefix, suffix, delimiter, precision);
+        return output;
+    }
+    std::string toString(const bool& oneline = true) const
+    {
+        std::string output = typeName();
+        appendToString(output, oneline, "(");
         return output;
     }
     operator std::string() const { return toString(); }
 
+    /**
+     * Reads a matrix in the row by row layout written by toString
+     * @return false if there were not enough numbers
+     */
+    static bool fromString(std::string_view str, mat<T, N, M>& out)
+    {
+        T vals[N * M];
+        if(Gum::Maths::parseNumbers(str, vals, N * M) != N * M)
+            return false;
+        for(unsigned int i = 0; i < N; i++)
+            for(unsigned int j = 0; j < M; j++)
+                out.v[j][i] = vals[j + i * M];
+        return true;
+    }
+
     unsigned int width() 
     {
         return M;
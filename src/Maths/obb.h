@@ -0,0 +1,418 @@
+#pragma once
+#include "vec.h"
+#include "mat.h"
+#include "quat.h"
+#include "bbox.h"
+#include "EigenFunctions.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <limits>
+
+/**
+ * Oriented bounding box
+ * axes holds the unit local axes as columns (axes[i] is axis i), halfExtents is measured along them.
+ * The separating axis tests read the rotation as matrix, so that is what gets stored.
+ */
+template<typename T>
+struct tobb
+{
+    tvec<T, 3> center, halfExtents;
+    mat<T, 3, 3> axes;
+
+    tobb() : center(T(0)), halfExtents(T(0)) {}
+
+    tobb(tvec<T, 3> center, tvec<T, 3> halfExtents, mat<T, 3, 3> axes = mat<T, 3, 3>())
+    {
+        this->center = center;
+        this->halfExtents = halfExtents;
+        this->axes = axes;
+    }
+
+    tobb(tvec<T, 3> center, tvec<T, 3> halfExtents, quat<T> rotation)
+    {
+        this->center = center;
+        this->halfExtents = halfExtents;
+        setRotation(rotation);
+    }
+
+    //From an axis aligned box, pos is the minimum corner
+    tobb(const tbbox<T, 3>& box)
+    {
+        this->halfExtents = box.size * (T)0.5;
+        this->center = box.pos + this->halfExtents;
+    }
+
+
+    tvec<T, 3> getAxis(unsigned int index) const { return tvec<T, 3>(axes[index][0], axes[index][1], axes[index][2]); }
+    tvec<T, 3> getSize() const                   { return halfExtents * (T)2; }
+    quat<T> getRotation() const                  { return quat<T>(axes); }
+
+    void setRotation(quat<T> rotation)
+    {
+        T xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+        T xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+        T wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+        axes[0][0] = (T)1 - (T)2 * (yy + zz);  axes[0][1] = (T)2 * (xy + wz);         axes[0][2] = (T)2 * (xz - wy);
+        axes[1][0] = (T)2 * (xy - wz);         axes[1][1] = (T)1 - (T)2 * (xx + zz);  axes[1][2] = (T)2 * (yz + wx);
+        axes[2][0] = (T)2 * (xz + wy);         axes[2][1] = (T)2 * (yz - wx);         axes[2][2] = (T)1 - (T)2 * (xx + yy);
+    }
+
+    //Corner i has the sign pattern of bits 0..2 of i applied to the half extents
+    void getCorners(tvec<T, 3> corners[8]) const
+    {
+        for(unsigned int i = 0; i < 8; i++)
+        {
+            tvec<T, 3> corner = center;
+            for(unsigned int a = 0; a < 3; a++)
+            {
+                T e = (i >> a) & 1 ? halfExtents.vals[a] : -halfExtents.vals[a];
+                corner += getAxis(a) * e;
+            }
+            corners[i] = corner;
+        }
+    }
+
+    //Axis aligned box enclosing this one, pos is the minimum corner
+    tbbox<T, 3> getBoundingBox() const
+    {
+        tvec<T, 3> extent;
+        for(unsigned int i = 0; i < 3; i++)
+            extent.vals[i] = std::abs(axes[0][i]) * halfExtents.x + std::abs(axes[1][i]) * halfExtents.y + std::abs(axes[2][i]) * halfExtents.z;
+        return tbbox<T, 3>(center - extent, extent * (T)2);
+    }
+
+    bool contains(const tvec<T, 3>& point) const
+    {
+        tvec<T, 3> d = point - center;
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            T proj = d.x * axes[i][0] + d.y * axes[i][1] + d.z * axes[i][2];
+            if(std::abs(proj) > halfExtents.vals[i])
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Applies an affine transformation
+     * Scale along the box axes is moved into the half extents. Under shear the box is no longer
+     * a box, the result then keeps the transformed axes re-orthogonalized and stays an approximation.
+     */
+    tobb<T> transform(const mat<T, 4, 4>& m) const
+    {
+        tobb<T> ret;
+        for(unsigned int i = 0; i < 3; i++)
+            ret.center.vals[i] = m[0][i] * center.x + m[1][i] * center.y + m[2][i] * center.z + m[3][i];
+
+        tvec<T, 3> a[3];
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                a[i].vals[j] = m[0][j] * axes[i][0] + m[1][j] * axes[i][1] + m[2][j] * axes[i][2];
+
+        //Gram-Schmidt, scale of each axis goes into the extents
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            for(unsigned int j = 0; j < i; j++)
+            {
+                T d = a[i].x * a[j].x + a[i].y * a[j].y + a[i].z * a[j].z;
+                a[i] -= a[j] * d;
+            }
+            T len = std::sqrt(a[i].x * a[i].x + a[i].y * a[i].y + a[i].z * a[i].z);
+            ret.halfExtents.vals[i] = halfExtents.vals[i] * len;
+            if(len > (T)0)
+                a[i] /= len;
+        }
+
+        //Mirroring transforms would leave a left handed basis
+        tvec<T, 3> c = tvec<T, 3>::cross(a[0], a[1]);
+        if(c.x * a[2].x + c.y * a[2].y + c.z * a[2].z < (T)0)
+            a[2] = a[2] * (T)-1;
+
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                ret.axes[i][j] = a[i].vals[j];
+        return ret;
+    }
+
+    /**
+     * Separating axis test against the 3 + 3 face normals and 9 edge cross products
+     */
+    bool intersects(const tobb<T>& other) const
+    {
+        const T epsilon = std::numeric_limits<T>::epsilon() * (T)16;
+        T R[3][3], AbsR[3][3], t[3];
+        const T* a = halfExtents.vals;
+        const T* b = other.halfExtents.vals;
+
+        //other expressed in the frame of this
+        for(unsigned int i = 0; i < 3; i++)
+            for(unsigned int j = 0; j < 3; j++)
+            {
+                R[i][j] = axes[i][0] * other.axes[j][0] + axes[i][1] * other.axes[j][1] + axes[i][2] * other.axes[j][2];
+                //Epsilon keeps near parallel edges from producing a zero cross product that separates everything
+                AbsR[i][j] = std::abs(R[i][j]) + epsilon;
+            }
+
+        tvec<T, 3> d = other.center - center;
+        for(unsigned int i = 0; i < 3; i++)
+            t[i] = d.x * axes[i][0] + d.y * axes[i][1] + d.z * axes[i][2];
+
+        T ra, rb;
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            ra = a[i];
+            rb = b[0] * AbsR[i][0] + b[1] * AbsR[i][1] + b[2] * AbsR[i][2];
+            if(std::abs(t[i]) > ra + rb) return false;
+        }
+
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            ra = a[0] * AbsR[0][i] + a[1] * AbsR[1][i] + a[2] * AbsR[2][i];
+            rb = b[i];
+            if(std::abs(t[0] * R[0][i] + t[1] * R[1][i] + t[2] * R[2][i]) > ra + rb) return false;
+        }
+
+        //A0 x B0..B2
+        ra = a[1] * AbsR[2][0] + a[2] * AbsR[1][0];  rb = b[1] * AbsR[0][2] + b[2] * AbsR[0][1];
+        if(std::abs(t[2] * R[1][0] - t[1] * R[2][0]) > ra + rb) return false;
+        ra = a[1] * AbsR[2][1] + a[2] * AbsR[1][1];  rb = b[0] * AbsR[0][2] + b[2] * AbsR[0][0];
+        if(std::abs(t[2] * R[1][1] - t[1] * R[2][1]) > ra + rb) return false;
+        ra = a[1] * AbsR[2][2] + a[2] * AbsR[1][2];  rb = b[0] * AbsR[0][1] + b[1] * AbsR[0][0];
+        if(std::abs(t[2] * R[1][2] - t[1] * R[2][2]) > ra + rb) return false;
+
+        //A1 x B0..B2
+        ra = a[0] * AbsR[2][0] + a[2] * AbsR[0][0];  rb = b[1] * AbsR[1][2] + b[2] * AbsR[1][1];
+        if(std::abs(t[0] * R[2][0] - t[2] * R[0][0]) > ra + rb) return false;
+        ra = a[0] * AbsR[2][1] + a[2] * AbsR[0][1];  rb = b[0] * AbsR[1][2] + b[2] * AbsR[1][0];
+        if(std::abs(t[0] * R[2][1] - t[2] * R[0][1]) > ra + rb) return false;
+        ra = a[0] * AbsR[2][2] + a[2] * AbsR[0][2];  rb = b[0] * AbsR[1][1] + b[1] * AbsR[1][0];
+        if(std::abs(t[0] * R[2][2] - t[2] * R[0][2]) > ra + rb) return false;
+
+        //A2 x B0..B2
+        ra = a[0] * AbsR[1][0] + a[1] * AbsR[0][0];  rb = b[1] * AbsR[2][2] + b[2] * AbsR[2][1];
+        if(std::abs(t[1] * R[0][0] - t[0] * R[1][0]) > ra + rb) return false;
+        ra = a[0] * AbsR[1][1] + a[1] * AbsR[0][1];  rb = b[0] * AbsR[2][2] + b[2] * AbsR[2][0];
+        if(std::abs(t[1] * R[0][1] - t[0] * R[1][1]) > ra + rb) return false;
+        ra = a[0] * AbsR[1][2] + a[1] * AbsR[0][2];  rb = b[0] * AbsR[2][1] + b[1] * AbsR[2][0];
+        if(std::abs(t[1] * R[0][2] - t[0] * R[1][2]) > ra + rb) return false;
+
+        return true;
+    }
+
+    /**
+     * Slab test in the local frame of the box
+     * @param distance distance along direction to the entry point, 0 if origin is inside
+     * @return true if the ray hits the box in front of origin
+     */
+    bool intersectsRay(const tvec<T, 3>& origin, const tvec<T, 3>& direction, T& distance) const
+    {
+        T tmin = (T)0;
+        T tmax = std::numeric_limits<T>::max();
+        tvec<T, 3> p = origin - center;
+
+        for(unsigned int i = 0; i < 3; i++)
+        {
+            T o = p.x * axes[i][0] + p.y * axes[i][1] + p.z * axes[i][2];
+            T d = direction.x * axes[i][0] + direction.y * axes[i][1] + direction.z * axes[i][2];
+            T e = halfExtents.vals[i];
+
+            if(std::abs(d) < std::numeric_limits<T>::min())
+            {
+                //Parallel to the slab
+                if(std::abs(o) > e)
+                    return false;
+                continue;
+            }
+
+            T inv = (T)1 / d;
+            T t0 = (-e - o) * inv;
+            T t1 = ( e - o) * inv;
+            if(t0 > t1) std::swap(t0, t1);
+            if(t0 > tmin) tmin = t0;
+            if(t1 < tmax) tmax = t1;
+            if(tmin > tmax)
+                return false;
+        }
+
+        distance = tmin;
+        return true;
+    }
+
+    bool intersectsRay(const tvec<T, 3>& origin, const tvec<T, 3>& direction) const
+    {
+        T distance;
+        return intersectsRay(origin, direction, distance);
+    }
+
+
+    /**
+     * Fits a box to a point cloud
+     * The axes are the principal components of the point covariance, the extents are the
+     * exact range of the points along them. Large inputs are reduced on the default ThreadPool.
+     * Moments are accumulated in double around the mean, so clouds far from the origin fit as well.
+     */
+    static tobb<T> fromPoints(const tvec<T, 3>* points, size_t count)
+    {
+        if(count == 0)
+            return tobb<T>();
+
+        //Second pass over the points relative to their mean, products of raw coordinates would cancel
+        const tvec<double, 3> mean = centroid(points, count);
+        struct Moments { double products[6]; };
+        Moments identity = {{0, 0, 0, 0, 0, 0}};
+        Moments moments = Gum::Maths::parallelReduce(0, count, identity, [points, &mean](size_t begin, size_t end, Moments acc) {
+            for(size_t i = begin; i < end; i++)
+            {
+                double x = (double)points[i].x - mean.x, y = (double)points[i].y - mean.y, z = (double)points[i].z - mean.z;
+                acc.products[0] += x * x; acc.products[1] += y * y; acc.products[2] += z * z;
+                acc.products[3] += x * y; acc.products[4] += x * z; acc.products[5] += y * z;
+            }
+            return acc;
+        }, [](Moments a, const Moments& b) {
+            for(int i = 0; i < 6; i++) a.products[i] += b.products[i];
+            return a;
+        }, 4096);
+
+        double n = (double)count;
+        mat<T, 3, 3> covariance;
+        covariance[0][0] = (T)(moments.products[0] / n);
+        covariance[1][1] = (T)(moments.products[1] / n);
+        covariance[2][2] = (T)(moments.products[2] / n);
+        covariance[1][0] = covariance[0][1] = (T)(moments.products[3] / n);
+        covariance[2][0] = covariance[0][2] = (T)(moments.products[4] / n);
+        covariance[2][1] = covariance[1][2] = (T)(moments.products[5] / n);
+
+        tvec<T, 3> variances;
+        mat<T, 3, 3> axes;
+        Gum::Maths::eigenSymmetric<T>(covariance, variances, axes);
+        return fitExtents(points, count, axes, mean);
+    }
+
+    //Fits a box with fixed axes to a point cloud
+    static tobb<T> fromPoints(const tvec<T, 3>* points, size_t count, const mat<T, 3, 3>& axes)
+    {
+        if(count == 0)
+            return tobb<T>(tvec<T, 3>(T(0)), tvec<T, 3>(T(0)), axes);
+        return fitExtents(points, count, axes, centroid(points, count));
+    }
+
+private:
+    static tvec<double, 3> centroid(const tvec<T, 3>* points, size_t count)
+    {
+        struct Sum { double vals[3]; };
+        Sum identity = {{0, 0, 0}};
+        Sum sum = Gum::Maths::parallelReduce(0, count, identity, [points](size_t begin, size_t end, Sum acc) {
+            for(size_t i = begin; i < end; i++)
+            {
+                acc.vals[0] += (double)points[i].x;
+                acc.vals[1] += (double)points[i].y;
+                acc.vals[2] += (double)points[i].z;
+            }
+            return acc;
+        }, [](Sum a, const Sum& b) {
+            for(int i = 0; i < 3; i++) a.vals[i] += b.vals[i];
+            return a;
+        }, 4096);
+        return tvec<double, 3>(sum.vals[0] / (double)count, sum.vals[1] / (double)count, sum.vals[2] / (double)count);
+    }
+
+    //Range of the points along the axes, projected relative to origin to keep the offset out of the extents
+    static tobb<T> fitExtents(const tvec<T, 3>* points, size_t count, const mat<T, 3, 3>& axes, const tvec<double, 3>& origin)
+    {
+        struct Range { double lo[3]; double hi[3]; };
+        const double big = std::numeric_limits<double>::max();
+        Range identity = {{big, big, big}, {-big, -big, -big}};
+        Range range = Gum::Maths::parallelReduce(0, count, identity, [points, &axes, &origin](size_t begin, size_t end, Range acc) {
+            for(size_t i = begin; i < end; i++)
+            {
+                double x = (double)points[i].x - origin.x, y = (double)points[i].y - origin.y, z = (double)points[i].z - origin.z;
+                for(unsigned int a = 0; a < 3; a++)
+                {
+                    double proj = x * (double)axes[a][0] + y * (double)axes[a][1] + z * (double)axes[a][2];
+                    if(proj < acc.lo[a]) acc.lo[a] = proj;
+                    if(proj > acc.hi[a]) acc.hi[a] = proj;
+                }
+            }
+            return acc;
+        }, [](Range a, const Range& b) {
+            for(int i = 0; i < 3; i++)
+            {
+                if(b.lo[i] < a.lo[i]) a.lo[i] = b.lo[i];
+                if(b.hi[i] > a.hi[i]) a.hi[i] = b.hi[i];
+            }
+            return a;
+        }, 4096);
+
+        tobb<T> ret;
+        ret.axes = axes;
+        tvec<double, 3> center = origin;
+        for(unsigned int a = 0; a < 3; a++)
+        {
+            double mid = (range.lo[a] + range.hi[a]) * 0.5;
+            ret.halfExtents.vals[a] = (T)((range.hi[a] - range.lo[a]) * 0.5);
+            center += tvec<double, 3>((double)axes[a][0], (double)axes[a][1], (double)axes[a][2]) * mid;
+        }
+        ret.center = tvec<T, 3>((T)center.x, (T)center.y, (T)center.z);
+        return ret;
+    }
+};
+
+typedef tobb<float>  obb;
+typedef tobb<double> dobb;
+
+
+namespace Gum {
+namespace Maths
+{
+    /**
+     * Batch tests, split across the default ThreadPool
+     * results[i] is set for others[i]
+     */
+    template<typename T>
+    static void intersects(const tobb<T>& box, const tobb<T>* others, bool* results, size_t count)
+    {
+        parallelFor(0, count, [&box, others, results](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                results[i] = box.intersects(others[i]);
+        }, 256);
+    }
+
+    //Pairwise, results[i] is set for a[i] against b[i]
+    template<typename T>
+    static void intersects(const tobb<T>* a, const tobb<T>* b, bool* results, size_t count)
+    {
+        parallelFor(0, count, [a, b, results](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                results[i] = a[i].intersects(b[i]);
+        }, 256);
+    }
+
+    /**
+     * One ray against many boxes
+     * distances[i] is the entry distance into boxes[i], or infinity on a miss
+     */
+    template<typename T>
+    static void intersectsRay(const tvec<T, 3>& origin, const tvec<T, 3>& direction, const tobb<T>* boxes, T* distances, size_t count)
+    {
+        parallelFor(0, count, [&origin, &direction, boxes, distances](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                T distance;
+                distances[i] = boxes[i].intersectsRay(origin, direction, distance) ? distance : std::numeric_limits<T>::infinity();
+            }
+        }, 256);
+    }
+
+    //Many rays against one box
+    template<typename T>
+    static void intersectsRay(const tobb<T>& box, const tvec<T, 3>* origins, const tvec<T, 3>* directions, T* distances, size_t count)
+    {
+        parallelFor(0, count, [&box, origins, directions, distances](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                T distance;
+                distances[i] = box.intersectsRay(origins[i], directions[i], distance) ? distance : std::numeric_limits<T>::infinity();
+            }
+        }, 256);
+    }
+}}
@@ -14,52 +14,52 @@ struct quat
     quat(T f)                    : w(f),      x(f),       y(f),        z(f)     {}
     quat(T sw, T sx, T sy, T sz) : w(sw),     x(sx),      y(sy),       z(sz)    {}
     quat(T sw, tvec<T,3> vec)    : w(sw),     x(vec.x),   y(vec.y),    z(vec.z) {}
+    //Rotation matrix to quaternion, mat is indexed [column][row] like everywhere else
     quat(mat<T, 3, 3> mat)
     {
-        T t = mat[0][0] + mat[1][1] + mat[2][2];
+        //r<row><col>
+        T r00 = mat[0][0], r01 = mat[1][0], r02 = mat[2][0];
+        T r10 = mat[0][1], r11 = mat[1][1], r12 = mat[2][1];
+        T r20 = mat[0][2], r21 = mat[1][2], r22 = mat[2][2];
+
+        T t = r00 + r11 + r22;
         // we protect the division by s by ensuring that s>=1
         if (t >= 0) 
         { // by w
             T s = (T)sqrt(t + 1);
+            w = (T)0.5 * s;
             s = (T)0.5 / s;
-            w = (T)0.5 * s;                 
-            x = (mat[2][1] - mat[1][2]) * s;
-            y = (mat[0][2] - mat[2][0]) * s;
-            z = (mat[1][0] - mat[0][1]) * s;
+            x = (r21 - r12) * s;
+            y = (r02 - r20) * s;
+            z = (r10 - r01) * s;
         } 
-        else if ((mat[0][0] > mat[1][1]) && (mat[0][0] > mat[2][2])) 
+        else if ((r00 > r11) && (r00 > r22)) 
         { // by x
-            T s = (T)sqrt(1 + mat[0][0] - mat[1][1] - mat[2][2]); 
+            T s = (T)sqrt(1 + r00 - r11 - r22); 
+            x = (T)0.5 * s;
             s = (T)0.5 / s;
-            x = s * (T)0.5;
-            y = (mat[1][0] + mat[0][1]) * s;
-            z = (mat[0][2] + mat[2][0]) * s;
-            w = (mat[2][1] - mat[1][2]) * s;
+            y = (r10 + r01) * s;
+            z = (r02 + r20) * s;
+            w = (r21 - r12) * s;
         } 
-        else if (mat[1][1] > mat[2][2]) 
+        else if (r11 > r22) 
         { // by y
-            T s = (T)sqrt(1 + mat[1][1] - mat[0][0] - mat[2][2]);  
+            T s = (T)sqrt(1 + r11 - r00 - r22);  
+            y = (T)0.5 * s;
             s = (T)0.5 / s;
-            y = s * (T)0.5;
-            x = (mat[1][0] + mat[0][1]) * s;
-            z = (mat[2][1] + mat[1][2]) * s;
-            w = (mat[0][2] - mat[2][0]) * s;
+            x = (r10 + r01) * s;
+            z = (r21 + r12) * s;
+            w = (r02 - r20) * s;
         } 
         else 
         { // by z
-            T s = (T)sqrt(1 + mat[2][2] - mat[0][0] - mat[1][1]); 
-            z = s * (T)0.5; 
+            T s = (T)sqrt(1 + r22 - r00 - r11); 
+            z = (T)0.5 * s; 
             s = (T)0.5 / s;
-            x = (mat[0][2] + mat[2][0]) * s;
-            y = (mat[2][1] + mat[1][2]) * s;
-            w = (mat[1][0] - mat[0][1]) * s;
+            x = (r02 + r20) * s;
+            y = (r21 + r12) * s;
+            w = (r10 - r01) * s;
         }
-        //w = std::sqrt(1.0f + mat[0][0] + mat[1][1] + mat[2][2]) / 2.0f;
-        //T w4 = ((T)4.0 * w);
-        //std::cout << "w: " << w << std::endl;
-        //x = (mat[2][1] - mat[1][2]) / w4;
-        //y = (mat[0][2] - mat[2][0]) / w4;
-        //z = (mat[1][0] - mat[0][1]) / w4;
     }
 
 
@@ -125,53 +125,65 @@ struct quat
 
     static quat<T> normalize(quat q)
     {
-        T length_of_v = std::sqrt((*q.x * *q.x) + (*q.y * *q.y) + (*q.z * *q.z) + (*q.w * *q.w));;
-        return quat(*q.w / length_of_v, *q.x / length_of_v, *q.y / length_of_v, *q.z / length_of_v);
+        using std::sqrt;
+        T length_of_v = (T)sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        return quat(q.w / length_of_v, q.x / length_of_v, q.y / length_of_v, q.z / length_of_v);
     }
 
     static tvec<T, 3> toEuler(quat q)
     {
+        //Half angle sums, w + y = (cp + sp) cos((roll - yaw) / 2), w - y = (cp - sp) cos((roll + yaw) / 2)
+        //Stays accurate close to gimbal lock, where atan2 of two matrix elements only sees rounding noise
+        using std::sqrt; using std::atan2;
+        T a = q.w + q.y, b = q.x - q.z, c = q.w - q.y, d = q.x + q.z;
+        T plus = (T)sqrt(a * a + b * b);  //sqrt(1 + sin(pitch))
+        T minus = (T)sqrt(c * c + d * d); //sqrt(1 - sin(pitch))
+        T difference = (T)atan2(b, a);
+        T sum = (T)atan2(d, c);
+
         tvec<T, 3> euler;
-        // roll (x-axis rotation)
-        T sinr_cosp = (T)2.0 * (q.w * q.x + q.y * q.z);
-        T cosr_cosp = (T)1.0 - 2 * (q.x * q.x + q.y * q.y);
-        euler.x = (T)std::atan2(sinr_cosp, cosr_cosp);
-
-        // pitch (y-axis rotation)
-        T sinp = (T)2.0 * (q.w * q.y - q.z * q.x);
-        if (std::abs(sinp) >= 1.0)
-            euler.y = (T)std::copysign(GUM_PI / 2, sinp); // use 90 degrees if out of range
-        else
-            euler.y = (T)std::asin(sinp);
-
-        // yaw (z-axis rotation)
-        T siny_cosp = (T)2.0 * (q.w * q.z + q.x * q.y);
-        T cosy_cosp = (T)1.0 - 2 * (q.y * q.y + q.z * q.z);
-        euler.z = (T)std::atan2(siny_cosp, cosy_cosp);
-
-        return euler * 180 / GUM_PI;
+        euler.x = sum + difference;
+        euler.y = (T)2 * (T)atan2(plus, minus) - (T)(GUM_PI / 2);
+        euler.z = sum - difference;
+
+        //Gimbal lock, only roll - yaw (pitch 90) or roll + yaw (pitch -90) is defined, yaw is set to 0
+        const T lockTolerance = std::numeric_limits<T>::epsilon() * (T)16;
+        if(minus < lockTolerance)     { euler.x = difference + difference; euler.z = (T)0; }
+        else if(plus < lockTolerance) { euler.x = sum + sum; euler.z = (T)0; }
+
+        //q and -q give the same rotation but angles 2 pi apart
+        for(unsigned int i = 0; i < 3; i += 2)
+        {
+            if(euler.vals[i] > (T)GUM_PI)       euler.vals[i] -= (T)(2 * GUM_PI);
+            else if(euler.vals[i] < (T)-GUM_PI) euler.vals[i] += (T)(2 * GUM_PI);
+        }
+
+        return euler * (T)(180.0 / GUM_PI);
     }
 
 
     static T dot(quat a, quat b)  { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
     
+    //Constants are converted to T first, scalars like tfixed do not mix with double
     static quat rotateAround(T angle, tvec<T, 3> up)
     {
-        T rad = angle * GUM_PI / (T)180.0;
-        T s = std::sin(rad * 0.5);
-        return quat(std::cos(rad * 0.5), up * s);
+        using std::sin; using std::cos;
+        T half = angle * (T)(GUM_PI / 360.0);
+        T s = (T)sin(half);
+        return quat((T)cos(half), up * s);
     }
 
     static quat toQuaternion(tvec<T, 3> anglesDeg)
     {
-        tvec<T, 3> rad = anglesDeg * GUM_PI / 180.0;
+        using std::sin; using std::cos;
+        tvec<T, 3> half = anglesDeg * (T)(GUM_PI / 360.0);
         // Abbreviations for the various angular functions
-        T cy = (T)std::cos(rad.z * 0.5);
-        T sy = (T)std::sin(rad.z * 0.5);
-        T cp = (T)std::cos(rad.y * 0.5);
-        T sp = (T)std::sin(rad.y * 0.5);
-        T cr = (T)std::cos(rad.x * 0.5);
-        T sr = (T)std::sin(rad.x * 0.5);
+        T cy = (T)cos(half.z);
+        T sy = (T)sin(half.z);
+        T cp = (T)cos(half.y);
+        T sp = (T)sin(half.y);
+        T cr = (T)cos(half.x);
+        T sr = (T)sin(half.x);
 
         quat q;
         q.w = cr * cp * cy + sr * sp * sy;
@@ -184,6 +196,8 @@ struct quat
 
     static quat slerp(quat a, quat b, T f)
     {
+        //Unqualified calls, so custom scalar types like tfixed bring their own through ADL
+        using std::abs; using std::acos; using std::sin; using std::sqrt;
         quat qm;
         T cosHalfTheta = (T)dot(a,b);
 
@@ -196,16 +210,16 @@ struct quat
         }
 
         // if qa=qb or qa=-qb then theta = 0 and we can return qa
-        if(std::abs(cosHalfTheta) >= 1.0)
+        if(abs(cosHalfTheta) >= (T)1)
             return a;
 
         // Calculate temporary values.
         T halfTheta = (T)acos(cosHalfTheta);
-        T sinHalfTheta = (T)sqrt(1.0 - cosHalfTheta*cosHalfTheta);
+        T sinHalfTheta = (T)sqrt((T)1 - cosHalfTheta*cosHalfTheta);
         // if theta = 180 degrees then result is not fully defined
         // we could rotate around any axis normal to qa or qb
-        if (fabs(sinHalfTheta) < 0.001)
-        { // fabs is floating point absolute
+        if (abs(sinHalfTheta) < (T)0.001)
+        {
             qm.w = (a.w * (T)0.5 + b.w * (T)0.5);
             qm.x = (a.x * (T)0.5 + b.x * (T)0.5);
             qm.y = (a.y * (T)0.5 + b.y * (T)0.5);
@@ -213,7 +227,7 @@ struct quat
             return qm;
         }
 
-        T ratioA = (T)sin((1 - f) * halfTheta) / sinHalfTheta;
+        T ratioA = (T)sin(((T)1 - f) * halfTheta) / sinHalfTheta;
         T ratioB = (T)sin(f * halfTheta) / sinHalfTheta; 
         //calculate Quaternion.
         qm.w = (a.w * ratioA + b.w * ratioB);
@@ -248,11 +262,31 @@ struct quat
     }
 
     
-    std::string toString(std::string prefix = "quat(", std::string suffix = ")", std::string delimiter = ",") const
+    void appendToString(std::string& out, std::string_view prefix = "quat(", std::string_view suffix = ")", std::string_view delimiter = ",", const int& precision = 6) const
     {
-      return prefix + std::to_string(this->w) + delimiter + std::to_string(this->x) + delimiter + std::to_string(this->y) + delimiter + std::to_string(this->z) + suffix;
+        out.append(prefix);
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            if(i > 0)
+                out.append(delimiter);
+            Gum::Maths::appendNumber(out, vals[i], precision);
+        }
+        out.append(suffix);
+    }
+
+    std::string toString(std::string_view prefix = "quat(", std::string_view suffix = ")", std::string_view delimiter = ",", const int& precision = 6) const
+    {
+        std::string str;
+        appendToString(str, prefix, suffix, delimiter, precision);
+        return str;
     }
     operator std::string() const { return toString(); }
+
+    //Reads w, x, y, z as written by toString
+    static bool fromString(std::string_view str, quat<T>& out)
+    {
+        return Gum::Maths::parseNumbers(str, out.vals, 4) == 4;
+    }
 };
 
 typedef quat<float>  fquat;
@@ -0,0 +1,120 @@
+#pragma once
+#include "vec.h"
+#include "bbox.h"
+#include <cmath>
+#include <limits>
+
+/**
+ * Ray from origin along direction, only distances in [tmin, tmax] count as hits
+ * The direction does not have to be normalized, distances are measured in multiples of it.
+ * invDirection is kept for the slab tests, so change the direction through setDirection().
+ * Packets of 4 or 8 rays and batched intersections are in RayFunctions.h.
+ */
+template<typename T, int S>
+struct tray
+{
+    tvec<T, S> origin, direction, invDirection;
+    T tmin, tmax;
+
+    tray() : origin(T(0)), direction(T(0)), invDirection(std::numeric_limits<T>::infinity()), tmin(T(0)), tmax(std::numeric_limits<T>::infinity()) {}
+
+    tray(tvec<T, S> origin, tvec<T, S> direction, T tmin = T(0), T tmax = std::numeric_limits<T>::infinity())
+    {
+        this->origin = origin;
+        this->tmin = tmin;
+        this->tmax = tmax;
+        setDirection(direction);
+    }
+
+    //Zero components give an infinite inverse, the slab tests handle that
+    void setDirection(const tvec<T, S>& direction)
+    {
+        this->direction = direction;
+        for(unsigned int i = 0; i < (unsigned int)S; i++)
+            invDirection.vals[i] = (T)1 / direction.vals[i];
+    }
+
+    tvec<T, S> at(T distance) const
+    {
+        tvec<T, S> point;
+        for(unsigned int i = 0; i < (unsigned int)S; i++)
+            point.vals[i] = origin.vals[i] + direction.vals[i] * distance;
+        return point;
+    }
+
+
+    /**
+     * Slab test, pos of the box is the minimum corner
+     * A ray lying exactly in a slab plane produces 0 * inf = NaN for that plane, while the other plane
+     * of the slab is at +-inf. Replacing NaN with the negated other bound makes the slab unbounded,
+     * so such rays count as touching the box.
+     * @param tNear entry distance, tmin if the origin is inside
+     * @param tFar exit distance, clipped to tmax
+     */
+    bool intersectsBox(const tbbox<T, S>& box, T& tNear, T& tFar) const
+    {
+        tNear = tmin;
+        tFar = tmax;
+        for(unsigned int i = 0; i < (unsigned int)S; i++)
+        {
+            T t0 = (box.pos.vals[i] - origin.vals[i]) * invDirection.vals[i];
+            T t1 = (box.pos.vals[i] + box.size.vals[i] - origin.vals[i]) * invDirection.vals[i];
+            if(t0 != t0) t0 = -t1;
+            if(t1 != t1) t1 = -t0;
+            T lo = t0 < t1 ? t0 : t1;
+            T hi = t0 < t1 ? t1 : t0;
+            if(lo > tNear) tNear = lo;
+            if(hi < tFar)  tFar = hi;
+        }
+        return tNear <= tFar;
+    }
+
+    bool intersectsBox(const tbbox<T, S>& box) const
+    {
+        T tNear, tFar;
+        return intersectsBox(box, tNear, tFar);
+    }
+
+    /**
+     * Möller-Trumbore, both sides of the triangle count
+     * @param distance hit distance in [tmin, tmax]
+     * @param u, v barycentric weights of v1 and v2, the hit point is v0 + u (v1 - v0) + v (v2 - v0)
+     */
+    bool intersectsTriangle(const tvec<T, 3>& v0, const tvec<T, 3>& v1, const tvec<T, 3>& v2, T& distance, T& u, T& v) const
+    {
+        static_assert(S == 3, "Triangles can only be hit by 3 dimensional rays");
+        const T* d = direction.vals;
+        T e1[3] = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+        T e2[3] = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+
+        T p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        T det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if(std::abs(det) < std::numeric_limits<T>::min()) //Parallel to the plane
+            return false;
+
+        T invDet = (T)1 / det;
+        T s[3] = { origin.x - v0.x, origin.y - v0.y, origin.z - v0.z };
+        u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+        if(u < (T)0 || u > (T)1)
+            return false;
+
+        T q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+        if(v < (T)0 || u + v > (T)1)
+            return false;
+
+        distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+        return distance >= tmin && distance <= tmax;
+    }
+
+    bool intersectsTriangle(const tvec<T, 3>& v0, const tvec<T, 3>& v1, const tvec<T, 3>& v2, T& distance) const
+    {
+        T u, v;
+        return intersectsTriangle(v0, v1, v2, distance, u, v);
+    }
+};
+
+typedef tray<float,  2>  ray2;
+typedef tray<float,  3>  ray3;
+typedef tray<double, 2> dray2;
+typedef tray<double, 3> dray3;
@@ -0,0 +1,512 @@
+#pragma once
+#include "vec.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace Gum {
+namespace Maths
+{
+    enum class SparseFormat : uint8_t
+    {
+        CSR = 0, //Compressed rows, parallel products
+        CSC      //Compressed columns, parallel transposed products
+    };
+
+    /**
+     * Operations the sparse kernels need on vector entries
+     * Entries are either scalars or tvec<T,S> with one unknown per component, in that case
+     * the scalar matrix acts on every component separately (like a Laplacian on positions).
+     * This is not block storage: matrix entries are always scalars, so coupled 3x3 blocks (e.g.
+     * the stiffness of an elastic mesh) have to be assembled as a scalar matrix over 3n unknowns.
+     */
+    template<typename V>
+    struct SparseValueTraits
+    {
+        typedef V scalar;
+        static scalar dot(const V& a, const V& b) { return a * b; }
+    };
+
+    template<typename T, unsigned int S, unsigned int type>
+    struct SparseValueTraits<tvec<T, S, type>>
+    {
+        typedef T scalar;
+        static T dot(const tvec<T, S, type>& a, const tvec<T, S, type>& b)
+        {
+            T sum = T(0);
+            for(unsigned int i = 0; i < S; i++)
+                sum += a.vals[i] * b.vals[i];
+            return sum;
+        }
+    };
+}}
+
+/**
+ * Compressed sparse matrix
+ * In CSR offsets has one entry per row plus one, indices holds the column of every stored value,
+ * CSC is the same with rows and columns swapped. Indices are sorted and unique within a row (column).
+ * Stored values are scalars of type T, there is no block (BSR) format.
+ */
+template<typename T>
+class smatrix
+{
+public:
+    struct Triplet
+    {
+        size_t row, col;
+        T value;
+    };
+
+private:
+    size_t iRows, iCols;
+    Gum::Maths::SparseFormat eFormat;
+    std::vector<size_t> vOffsets;
+    std::vector<size_t> vIndices;
+    std::vector<T> vValues;
+
+public:
+    smatrix() : iRows(0), iCols(0), eFormat(Gum::Maths::SparseFormat::CSR), vOffsets(1, 0) {}
+
+    smatrix(size_t rows, size_t cols, Gum::Maths::SparseFormat format = Gum::Maths::SparseFormat::CSR)
+        : iRows(rows), iCols(cols), eFormat(format)
+    {
+        vOffsets.assign(outerSize() + 1, 0);
+    }
+
+    /**
+     * Assembles a matrix from (row, col, value) entries in any order, duplicates are summed
+     * Runs in O(rows + cols + entries) apart from sorting inside each row
+     */
+    static smatrix<T> fromTriplets(size_t rows, size_t cols, const Triplet* triplets, size_t count, Gum::Maths::SparseFormat format = Gum::Maths::SparseFormat::CSR)
+    {
+        smatrix<T> ret(rows, cols, format);
+        bool csr = format == Gum::Maths::SparseFormat::CSR;
+        size_t outer = ret.outerSize();
+
+        //Counting sort by outer index
+        std::vector<size_t> offsets(outer + 1, 0);
+        for(size_t i = 0; i < count; i++)
+        {
+            const Triplet& t = triplets[i];
+            if(t.row >= rows || t.col >= cols)
+            {
+                std::cerr << "GumMaths: smatrix::fromTriplets: entry (" << t.row << ", " << t.col << ") is out of range" << std::endl;
+                continue;
+            }
+            offsets[(csr ? t.row : t.col) + 1]++;
+        }
+        for(size_t i = 0; i < outer; i++)
+            offsets[i + 1] += offsets[i];
+
+        std::vector<std::pair<size_t, T>> entries(offsets[outer]);
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for(size_t i = 0; i < count; i++)
+        {
+            const Triplet& t = triplets[i];
+            if(t.row >= rows || t.col >= cols)
+                continue;
+            entries[cursor[csr ? t.row : t.col]++] = std::make_pair(csr ? t.col : t.row, t.value);
+        }
+
+        //Sort and merge within every row, rows are independent
+        std::vector<size_t> uniqueCount(outer, 0);
+        Gum::Maths::parallelFor(0, outer, [&](size_t begin, size_t end) {
+            for(size_t o = begin; o < end; o++)
+            {
+                auto first = entries.begin() + offsets[o], last = entries.begin() + offsets[o + 1];
+                std::sort(first, last, [](const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) { return a.first < b.first; });
+                size_t unique = 0;
+                for(auto it = first; it != last; ++it)
+                {
+                    if(unique > 0 && (first + unique - 1)->first == it->first)
+                        (first + unique - 1)->second += it->second;
+                    else
+                        *(first + unique++) = *it;
+                }
+                uniqueCount[o] = unique;
+            }
+        }, 256);
+
+        for(size_t o = 0; o < outer; o++)
+            ret.vOffsets[o + 1] = ret.vOffsets[o] + uniqueCount[o];
+        ret.vIndices.resize(ret.vOffsets[outer]);
+        ret.vValues.resize(ret.vOffsets[outer]);
+        Gum::Maths::parallelFor(0, outer, [&](size_t begin, size_t end) {
+            for(size_t o = begin; o < end; o++)
+                for(size_t i = 0; i < uniqueCount[o]; i++)
+                {
+                    ret.vIndices[ret.vOffsets[o] + i] = entries[offsets[o] + i].first;
+                    ret.vValues[ret.vOffsets[o] + i] = entries[offsets[o] + i].second;
+                }
+        }, 256);
+        return ret;
+    }
+
+    static smatrix<T> fromTriplets(size_t rows, size_t cols, const std::vector<Triplet>& triplets, Gum::Maths::SparseFormat format = Gum::Maths::SparseFormat::CSR)
+    {
+        return fromTriplets(rows, cols, triplets.data(), triplets.size(), format);
+    }
+
+    static smatrix<T> identity(size_t size, Gum::Maths::SparseFormat format = Gum::Maths::SparseFormat::CSR)
+    {
+        smatrix<T> ret(size, size, format);
+        ret.vIndices.resize(size);
+        ret.vValues.assign(size, T(1));
+        for(size_t i = 0; i < size; i++)
+        {
+            ret.vOffsets[i + 1] = i + 1;
+            ret.vIndices[i] = i;
+        }
+        return ret;
+    }
+
+
+    size_t rows() const                         { return iRows; }
+    size_t cols() const                         { return iCols; }
+    size_t nonZeros() const                     { return vValues.size(); }
+    Gum::Maths::SparseFormat format() const     { return eFormat; }
+    size_t outerSize() const                    { return eFormat == Gum::Maths::SparseFormat::CSR ? iRows : iCols; }
+    const std::vector<size_t>& offsets() const  { return vOffsets; }
+    const std::vector<size_t>& indices() const  { return vIndices; }
+    const std::vector<T>& values() const        { return vValues; }
+    std::vector<T>& values()                    { return vValues; }
+
+    //Stored value at (row, col) or 0, binary search within the row (column)
+    T get(size_t row, size_t col) const
+    {
+        size_t outer = eFormat == Gum::Maths::SparseFormat::CSR ? row : col;
+        size_t inner = eFormat == Gum::Maths::SparseFormat::CSR ? col : row;
+        auto first = vIndices.begin() + vOffsets[outer], last = vIndices.begin() + vOffsets[outer + 1];
+        auto it = std::lower_bound(first, last, inner);
+        return it != last && *it == inner ? vValues[it - vIndices.begin()] : T(0);
+    }
+
+    /**
+     * Same matrix in the other compressed format
+     * CSR of A has the same arrays as CSC of A^T, so this is a transpose of the storage
+     */
+    smatrix<T> convert(Gum::Maths::SparseFormat format) const
+    {
+        if(format == eFormat)
+            return *this;
+
+        smatrix<T> ret(iRows, iCols, format);
+        size_t outer = ret.outerSize();
+        for(size_t i = 0; i < vIndices.size(); i++)
+            ret.vOffsets[vIndices[i] + 1]++;
+        for(size_t i = 0; i < outer; i++)
+            ret.vOffsets[i + 1] += ret.vOffsets[i];
+
+        ret.vIndices.resize(vIndices.size());
+        ret.vValues.resize(vValues.size());
+        std::vector<size_t> cursor(ret.vOffsets.begin(), ret.vOffsets.end() - 1);
+        //Walking the source in order keeps the new inner indices sorted
+        for(size_t o = 0; o < outerSize(); o++)
+            for(size_t i = vOffsets[o]; i < vOffsets[o + 1]; i++)
+            {
+                size_t dst = cursor[vIndices[i]]++;
+                ret.vIndices[dst] = o;
+                ret.vValues[dst] = vValues[i];
+            }
+        return ret;
+    }
+
+    smatrix<T> toCSR() const { return convert(Gum::Maths::SparseFormat::CSR); }
+    smatrix<T> toCSC() const { return convert(Gum::Maths::SparseFormat::CSC); }
+
+    smatrix<T> transposed() const
+    {
+        smatrix<T> ret = *this;
+        std::swap(ret.iRows, ret.iCols);
+        ret.eFormat = eFormat == Gum::Maths::SparseFormat::CSR ? Gum::Maths::SparseFormat::CSC : Gum::Maths::SparseFormat::CSR;
+        return ret.convert(eFormat);
+    }
+
+    //Diagonal entries, 0 where nothing is stored
+    void diagonal(T* out) const
+    {
+        size_t n = iRows < iCols ? iRows : iCols;
+        Gum::Maths::parallelFor(0, n, [this, out](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                out[i] = get(i, i);
+        }, 1024);
+    }
+
+    /**
+     * y = A * x, x has cols() entries and y rows() entries, they must not overlap
+     * CSR runs in parallel over rows, CSC scatters serially (convert to CSR for repeated products)
+     */
+    template<typename V>
+    void multiply(const V* x, V* y) const
+    {
+        if(eFormat == Gum::Maths::SparseFormat::CSR)
+            gatherProduct(x, y);
+        else
+            scatterProduct(x, y, iRows);
+    }
+
+    //y = A^T * x, parallel for CSC
+    template<typename V>
+    void transposeMultiply(const V* x, V* y) const
+    {
+        if(eFormat == Gum::Maths::SparseFormat::CSC)
+            gatherProduct(x, y);
+        else
+            scatterProduct(x, y, iCols);
+    }
+
+    template<typename V>
+    std::vector<V> operator*(const std::vector<V>& x) const
+    {
+        std::vector<V> y(iRows);
+        if(x.size() != iCols)
+        {
+            std::cerr << "GumMaths: smatrix: vector has " << x.size() << " entries, expected " << iCols << std::endl;
+            return y;
+        }
+        multiply(x.data(), y.data());
+        return y;
+    }
+
+private:
+    //out[o] = sum over the stored entries of outer index o
+    template<typename V>
+    void gatherProduct(const V* x, V* out) const
+    {
+        Gum::Maths::parallelFor(0, outerSize(), [this, x, out](size_t begin, size_t end) {
+            for(size_t o = begin; o < end; o++)
+            {
+                V sum = V(T(0));
+                for(size_t i = vOffsets[o]; i < vOffsets[o + 1]; i++)
+                    sum += x[vIndices[i]] * vValues[i];
+                out[o] = sum;
+            }
+        }, 512);
+    }
+
+    template<typename V>
+    void scatterProduct(const V* x, V* out, size_t outsize) const
+    {
+        for(size_t i = 0; i < outsize; i++)
+            out[i] = V(T(0));
+        for(size_t o = 0; o < outerSize(); o++)
+        {
+            V xo = x[o];
+            for(size_t i = vOffsets[o]; i < vOffsets[o + 1]; i++)
+                out[vIndices[i]] += xo * vValues[i];
+        }
+    }
+};
+
+typedef smatrix<float>  smatrixf;
+typedef smatrix<double> smatrixd;
+
+
+namespace Gum {
+namespace Maths
+{
+    struct SparseSolverSettings
+    {
+        size_t maxIterations = 1000;
+        double tolerance = 1e-6;  //Relative to the norm of b
+        bool jacobi = true;       //Scale by the inverse diagonal as preconditioner
+    };
+
+    struct SparseSolverResult
+    {
+        size_t iterations = 0;
+        double residual = 0;      //Final |b - Ax| / |b|
+        bool converged = false;
+    };
+
+    //Shared vector kernels of the solvers, all split across the default ThreadPool
+    template<typename V>
+    static typename SparseValueTraits<V>::scalar sparseDot(const V* a, const V* b, size_t count)
+    {
+        typedef typename SparseValueTraits<V>::scalar T;
+        return parallelReduce(0, count, T(0), [a, b](size_t begin, size_t end, T acc) {
+            for(size_t i = begin; i < end; i++)
+                acc += SparseValueTraits<V>::dot(a[i], b[i]);
+            return acc;
+        }, [](T x, T y) { return x + y; }, 4096);
+    }
+
+    //Inverse diagonal for the Jacobi preconditioner, 1 where the diagonal is 0
+    template<typename T>
+    static std::vector<T> sparseJacobi(const smatrix<T>& A, bool enabled)
+    {
+        std::vector<T> inv(A.rows(), T(1));
+        if(!enabled)
+            return inv;
+        A.diagonal(inv.data());
+        for(T& d : inv)
+            d = d != T(0) ? T(1) / d : T(1);
+        return inv;
+    }
+
+    /**
+     * Preconditioned conjugate gradient for symmetric positive definite A
+     * A should be CSR so the products run in parallel
+     * @param x initial guess, receives the solution
+     */
+    template<typename T, typename V>
+    static SparseSolverResult conjugateGradient(const smatrix<T>& A, const V* b, V* x, const SparseSolverSettings& settings = SparseSolverSettings())
+    {
+        SparseSolverResult result;
+        const size_t n = A.rows();
+        if(A.rows() != A.cols())
+        {
+            std::cerr << "GumMaths: conjugateGradient: matrix is not square" << std::endl;
+            return result;
+        }
+
+        std::vector<T> invdiag = sparseJacobi(A, settings.jacobi);
+        std::vector<V> r(n), z(n), p(n), Ap(n);
+
+        A.multiply(x, Ap.data());
+        parallelFor(0, n, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                r[i] = b[i] - Ap[i];
+                z[i] = r[i] * invdiag[i];
+                p[i] = z[i];
+            }
+        }, 4096);
+
+        double bnorm = std::sqrt((double)sparseDot(b, b, n));
+        if(bnorm == 0)
+            bnorm = 1;
+        T rz = sparseDot(r.data(), z.data(), n);
+        result.residual = std::sqrt((double)sparseDot(r.data(), r.data(), n)) / bnorm;
+
+        while(result.residual > settings.tolerance && result.iterations < settings.maxIterations)
+        {
+            A.multiply(p.data(), Ap.data());
+            T pAp = sparseDot(p.data(), Ap.data(), n);
+            if(pAp == T(0))
+                break;
+            T alpha = rz / pAp;
+
+            parallelFor(0, n, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    x[i] += p[i] * alpha;
+                    r[i] -= Ap[i] * alpha;
+                    z[i] = r[i] * invdiag[i];
+                }
+            }, 4096);
+            result.iterations++;
+            result.residual = std::sqrt((double)sparseDot(r.data(), r.data(), n)) / bnorm;
+
+            T rzNew = sparseDot(r.data(), z.data(), n);
+            T beta = rzNew / rz;
+            rz = rzNew;
+            parallelFor(0, n, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                    p[i] = z[i] + p[i] * beta;
+            }, 4096);
+        }
+
+        result.converged = result.residual <= settings.tolerance;
+        return result;
+    }
+
+    /**
+     * Preconditioned BiCGSTAB for general square A
+     * @param x initial guess, receives the solution
+     */
+    template<typename T, typename V>
+    static SparseSolverResult biCGSTAB(const smatrix<T>& A, const V* b, V* x, const SparseSolverSettings& settings = SparseSolverSettings())
+    {
+        SparseSolverResult result;
+        const size_t n = A.rows();
+        if(A.rows() != A.cols())
+        {
+            std::cerr << "GumMaths: biCGSTAB: matrix is not square" << std::endl;
+            return result;
+        }
+
+        std::vector<T> invdiag = sparseJacobi(A, settings.jacobi);
+        std::vector<V> r(n), r0(n), p(n, V(T(0))), v(n, V(T(0))), s(n), t(n), ph(n), sh(n);
+
+        A.multiply(x, v.data());
+        parallelFor(0, n, [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+            {
+                r[i] = b[i] - v[i];
+                r0[i] = r[i];
+                v[i] = V(T(0));
+            }
+        }, 4096);
+
+        double bnorm = std::sqrt((double)sparseDot(b, b, n));
+        if(bnorm == 0)
+            bnorm = 1;
+        result.residual = std::sqrt((double)sparseDot(r.data(), r.data(), n)) / bnorm;
+
+        T rho = T(1), alpha = T(1), omega = T(1);
+        while(result.residual > settings.tolerance && result.iterations < settings.maxIterations)
+        {
+            T rhoNew = sparseDot(r0.data(), r.data(), n);
+            if(rhoNew == T(0) || omega == T(0))
+                break; //Breakdown, restarting with a new r0 would be the fix
+            T beta = (rhoNew / rho) * (alpha / omega);
+            rho = rhoNew;
+
+            parallelFor(0, n, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    p[i] = r[i] + (p[i] - v[i] * omega) * beta;
+                    ph[i] = p[i] * invdiag[i];
+                }
+            }, 4096);
+            A.multiply(ph.data(), v.data());
+
+            T r0v = sparseDot(r0.data(), v.data(), n);
+            if(r0v == T(0))
+                break;
+            alpha = rho / r0v;
+
+            parallelFor(0, n, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    s[i] = r[i] - v[i] * alpha;
+                    sh[i] = s[i] * invdiag[i];
+                }
+            }, 4096);
+            result.iterations++;
+
+            double snorm = std::sqrt((double)sparseDot(s.data(), s.data(), n)) / bnorm;
+            if(snorm <= settings.tolerance)
+            {
+                parallelFor(0, n, [&](size_t begin, size_t end) {
+                    for(size_t i = begin; i < end; i++)
+                    {
+                        x[i] += ph[i] * alpha;
+                        r[i] = s[i];
+                    }
+                }, 4096);
+                result.residual = snorm;
+                break;
+            }
+
+            A.multiply(sh.data(), t.data());
+            T tt = sparseDot(t.data(), t.data(), n);
+            omega = tt != T(0) ? sparseDot(t.data(), s.data(), n) / tt : T(0);
+
+            parallelFor(0, n, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++)
+                {
+                    x[i] += ph[i] * alpha + sh[i] * omega;
+                    r[i] = s[i] - t[i] * omega;
+                }
+            }, 4096);
+            result.residual = std::sqrt((double)sparseDot(r.data(), r.data(), n)) / bnorm;
+        }
+
+        result.converged = result.residual <= settings.tolerance;
+        return result;
+    }
+}}
@@ -0,0 +1,410 @@
+#pragma once
+#include "vec.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <cstdint>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+namespace Gum {
+namespace Maths
+{
+    enum class SplineType : uint8_t
+    {
+        CATMULL_ROM, //Interpolating, knots spaced by |p(i+1) - p(i)|^alpha (0.5 centripetal, no cusps or self intersections)
+        HERMITE,     //Interpolating with explicit tangents per point
+        BSPLINE      //Uniform cubic B-spline, approximating and C2, open splines are clamped to the end points
+    };
+}}
+
+
+/**
+ * Piecewise cubic spline with an arc length table
+ * Every segment is stored in power basis, the parameter u runs from 0 to getSegmentCount(),
+ * segment i covering [i, i + 1]. The arc length table holds samplesPerSegment entries per
+ * segment, integrated with 5 point Gauss-Legendre, plus even distance buckets pointing into it so
+ * distance -> parameter lookups are possible in O(log n) (getParameter) or O(1) (getParameterFast).
+ * Both interpolate the table with cubic Hermite using du/ds = 1 / |p'(u)| as slopes.
+ * Distances are clamped for open splines and wrap around for closed ones.
+ */
+template<typename T, unsigned int S>
+class tspline
+{
+private:
+    typedef tvec<T, S> point;
+
+    Gum::Maths::SplineType eType;
+    bool bClosed;
+    T fAlpha;
+    unsigned int iSamplesPerSegment;
+
+    std::vector<point> vPoints;
+    std::vector<point> vTangents;
+    std::vector<std::array<point, 4>> vSegments;
+
+    //Cumulative length and parameter at each sample, du/ds at the start and end of each interval
+    std::vector<T> vTableDistances, vTableParameters, vTableSlopes;
+    //Table interval containing every multiple of fBucketSize, buckets are finer than the table
+    std::vector<uint32_t> vBuckets;
+    T fLength, fBucketSize;
+
+    static T norm(const point& v)
+    {
+        using std::sqrt;
+        T sum = (T)0;
+        for(unsigned int c = 0; c < S; c++)
+            sum += v.vals[c] * v.vals[c];
+        return (T)sqrt(sum);
+    }
+
+    static std::array<point, 4> hermiteToPower(const point& p0, const point& m0, const point& p1, const point& m1)
+    {
+        std::array<point, 4> ret;
+        for(unsigned int c = 0; c < S; c++)
+        {
+            ret[0].vals[c] = p0.vals[c];
+            ret[1].vals[c] = m0.vals[c];
+            ret[2].vals[c] = (T)-3 * p0.vals[c] - (T)2 * m0.vals[c] + (T)3 * p1.vals[c] - m1.vals[c];
+            ret[3].vals[c] = (T)2 * p0.vals[c] + m0.vals[c] - (T)2 * p1.vals[c] + m1.vals[c];
+        }
+        return ret;
+    }
+
+    //Barry-Goldman tangents of the segment p1 -> p2, scaled to the unit parameter interval
+    std::array<point, 4> catmullRomSegment(const point& p0, const point& p1, const point& p2, const point& p3) const
+    {
+        using std::pow;
+        auto knot = [this](const point& a, const point& b) {
+            T d = (T)pow(norm(b - a), fAlpha);
+            return d > (T)1e-12 ? d : (T)1; //Coincident points, fall back to uniform spacing
+        };
+        T t01 = knot(p0, p1), t12 = knot(p1, p2), t23 = knot(p2, p3);
+
+        point m1, m2;
+        for(unsigned int c = 0; c < S; c++)
+        {
+            m1.vals[c] = (p2.vals[c] - p1.vals[c]) + t12 * ((p1.vals[c] - p0.vals[c]) / t01 - (p2.vals[c] - p0.vals[c]) / (t01 + t12));
+            m2.vals[c] = (p2.vals[c] - p1.vals[c]) + t12 * ((p3.vals[c] - p2.vals[c]) / t23 - (p3.vals[c] - p1.vals[c]) / (t12 + t23));
+        }
+        return hermiteToPower(p1, m1, p2, m2);
+    }
+
+    static std::array<point, 4> bsplineSegment(const point& p0, const point& p1, const point& p2, const point& p3)
+    {
+        std::array<point, 4> ret;
+        const T sixth = (T)1 / (T)6;
+        for(unsigned int c = 0; c < S; c++)
+        {
+            ret[0].vals[c] = (p0.vals[c] + (T)4 * p1.vals[c] + p2.vals[c]) * sixth;
+            ret[1].vals[c] = ((T)-3 * p0.vals[c] + (T)3 * p2.vals[c]) * sixth;
+            ret[2].vals[c] = ((T)3 * p0.vals[c] - (T)6 * p1.vals[c] + (T)3 * p2.vals[c]) * sixth;
+            ret[3].vals[c] = (-p0.vals[c] + (T)3 * p1.vals[c] - (T)3 * p2.vals[c] + p3.vals[c]) * sixth;
+        }
+        return ret;
+    }
+
+    void buildSegments()
+    {
+        vSegments.clear();
+        const size_t n = vPoints.size();
+        if(n < 2)
+        {
+            if(n > 0)
+                std::cerr << "GumMaths: tspline needs at least 2 points" << std::endl;
+            return;
+        }
+
+        //Points outside of the range wrap for closed splines, open ones are extended
+        auto at = [this, n](long i) -> point {
+            if(bClosed)
+                return vPoints[(size_t)(((i % (long)n) + (long)n) % (long)n)];
+            if(i < 0)
+                return eType == Gum::Maths::SplineType::BSPLINE ? vPoints[0] : vPoints[0] * (T)2 - vPoints[1];
+            if(i >= (long)n)
+                return eType == Gum::Maths::SplineType::BSPLINE ? vPoints[n - 1] : vPoints[n - 1] * (T)2 - vPoints[n - 2];
+            return vPoints[(size_t)i];
+        };
+
+        switch(eType)
+        {
+            case Gum::Maths::SplineType::CATMULL_ROM:
+                for(long i = 0; i < (long)(bClosed ? n : n - 1); i++)
+                    vSegments.push_back(catmullRomSegment(at(i - 1), at(i), at(i + 1), at(i + 2)));
+                break;
+
+            case Gum::Maths::SplineType::HERMITE:
+                for(size_t i = 0; i < (bClosed ? n : n - 1); i++)
+                    vSegments.push_back(hermiteToPower(vPoints[i], vTangents[i], vPoints[(i + 1) % n], vTangents[(i + 1) % n]));
+                break;
+
+            case Gum::Maths::SplineType::BSPLINE:
+                //Open: the end points are tripled, which pins the curve to them
+                for(long i = bClosed ? 0 : -1; i < (long)n; i++)
+                    vSegments.push_back(bsplineSegment(at(i - 1), at(i), at(i + 1), at(i + 2)));
+                break;
+        }
+    }
+
+    T speed(const std::array<point, 4>& seg, T t) const
+    {
+        point d;
+        for(unsigned int c = 0; c < S; c++)
+            d.vals[c] = seg[1].vals[c] + t * ((T)2 * seg[2].vals[c] + t * (T)3 * seg[3].vals[c]);
+        return norm(d);
+    }
+
+    //du/ds, one sided since the parameter speed may jump at segment joins
+    T slope(T u, bool fromLeft) const
+    {
+        size_t index = (size_t)u;
+        if(fromLeft && index > 0 && (T)index == u)
+            index--;
+        if(index >= vSegments.size())
+            index = vSegments.size() - 1;
+        T v = speed(vSegments[index], u - (T)index);
+        return v > (T)1e-12 ? (T)1 / v : (T)0; //Cusp, interpolate() falls back to the secant
+    }
+
+    void buildTables()
+    {
+        static const T gaussNodes[5]   = { (T)-0.906179845938664, (T)-0.538469310105683, (T)0.0, (T)0.538469310105683, (T)0.906179845938664 };
+        static const T gaussWeights[5] = { (T)0.236926885056189, (T)0.478628670499366, (T)0.568888888888889, (T)0.478628670499366, (T)0.236926885056189 };
+
+        const size_t count = vSegments.size() * iSamplesPerSegment;
+        vTableDistances.assign(count + 1, (T)0);
+        vTableParameters.assign(count + 1, (T)0);
+        vTableSlopes.assign(2 * count, (T)0);
+        if(count == 0)
+        {
+            fLength = fBucketSize = (T)0;
+            vBuckets.clear();
+            return;
+        }
+        const T h = (T)1 / (T)iSamplesPerSegment;
+
+        T distance = (T)0;
+        for(size_t s = 0; s < vSegments.size(); s++)
+        {
+            for(unsigned int k = 0; k < iSamplesPerSegment; k++)
+            {
+                T a = (T)k * h;
+                T sum = (T)0;
+                for(unsigned int g = 0; g < 5; g++)
+                    sum += gaussWeights[g] * speed(vSegments[s], a + h * (T)0.5 * (gaussNodes[g] + (T)1));
+                distance += sum * h * (T)0.5;
+
+                size_t index = s * iSamplesPerSegment + k + 1;
+                vTableDistances[index] = distance;
+                vTableParameters[index] = (T)s + a + h;
+            }
+        }
+        fLength = distance;
+        for(size_t i = 0; i < count; i++)
+        {
+            vTableSlopes[2 * i] = slope(vTableParameters[i], false);
+            vTableSlopes[2 * i + 1] = slope(vTableParameters[i + 1], true);
+        }
+
+        //Even distance buckets, a single walk over the table
+        const size_t buckets = 4 * count;
+        vBuckets.assign(buckets + 1, 0);
+        fBucketSize = fLength / (T)buckets;
+        size_t j = 0;
+        for(size_t i = 0; i <= buckets; i++)
+        {
+            T d = (T)i * fBucketSize;
+            while(j + 1 < count && vTableDistances[j + 1] <= d)
+                j++;
+            vBuckets[i] = (uint32_t)j;
+        }
+    }
+
+    //Cubic Hermite through the parameters of two table entries, using du/ds as slopes
+    static T interpolate(const T* distances, const T* parameters, const T* slopes, size_t index, T distance)
+    {
+        T d0 = distances[index], d1 = distances[index + 1];
+        T u0 = parameters[index], u1 = parameters[index + 1];
+        T h = d1 - d0;
+        if(h <= (T)0)
+            return u0;
+        T f = (distance - d0) / h;
+        f = f < (T)0 ? (T)0 : (f > (T)1 ? (T)1 : f);
+
+        //Fritsch-Carlson limit, slopes above 3x the secant (near cusps) would overshoot
+        T secant = (u1 - u0) / h;
+        T m0 = slopes[2 * index] > (T)0 ? std::min(slopes[2 * index], (T)3 * secant) : secant;
+        T m1 = slopes[2 * index + 1] > (T)0 ? std::min(slopes[2 * index + 1], (T)3 * secant) : secant;
+
+        T f2 = f * f, f3 = f2 * f;
+        T u = ((T)2 * f3 - (T)3 * f2 + (T)1) * u0 + (f3 - (T)2 * f2 + f) * h * m0 + ((T)-2 * f3 + (T)3 * f2) * u1 + (f3 - f2) * h * m1;
+        return u < u0 ? u0 : (u > u1 ? u1 : u);
+    }
+
+    T wrapDistance(T distance) const
+    {
+        using std::fmod;
+        if(bClosed && fLength > (T)0)
+        {
+            distance = (T)fmod(distance, fLength);
+            if(distance < (T)0)
+                distance += fLength;
+            return distance;
+        }
+        return distance < (T)0 ? (T)0 : (distance > fLength ? fLength : distance);
+    }
+
+    void build()
+    {
+        buildSegments();
+        buildTables();
+    }
+
+public:
+    tspline(Gum::Maths::SplineType type = Gum::Maths::SplineType::CATMULL_ROM)
+        : eType(type), bClosed(false), fAlpha((T)0.5), iSamplesPerSegment(16), fLength((T)0), fBucketSize((T)0) {}
+
+    tspline(Gum::Maths::SplineType type, const std::vector<point>& points, bool closed = false)
+        : tspline(type)
+    {
+        setPoints(points.data(), points.size(), closed);
+    }
+
+    //Catmull-Rom and B-spline control points
+    void setPoints(const point* points, size_t count, bool closed = false)
+    {
+        vPoints.assign(points, points + count);
+        bClosed = closed;
+        if(eType == Gum::Maths::SplineType::HERMITE)
+        {
+            std::cerr << "GumMaths: tspline::setPoints on a Hermite spline, use setHermite to pass tangents" << std::endl;
+            vTangents.assign(count, point((T)0));
+        }
+        build();
+    }
+    void setPoints(const std::vector<point>& points, bool closed = false) { setPoints(points.data(), points.size(), closed); }
+
+    //Points with tangents, tangents are derivatives with respect to the segment parameter
+    void setHermite(const point* points, const point* tangents, size_t count, bool closed = false)
+    {
+        eType = Gum::Maths::SplineType::HERMITE;
+        vPoints.assign(points, points + count);
+        vTangents.assign(tangents, tangents + count);
+        bClosed = closed;
+        build();
+    }
+
+    //0 uniform, 0.5 centripetal, 1 chordal, only used by Catmull-Rom
+    void setAlpha(T alpha)                          { fAlpha = alpha; build(); }
+    //More samples make distance lookups more exact, the tables grow linearly
+    void setSamplesPerSegment(unsigned int samples) { iSamplesPerSegment = samples > 0 ? samples : 1; buildTables(); }
+
+    Gum::Maths::SplineType getType() const  { return eType; }
+    bool isClosed() const                   { return bClosed; }
+    size_t getSegmentCount() const          { return vSegments.size(); }
+    T getLength() const                     { return fLength; }
+    const std::vector<point>& getPoints() const { return vPoints; }
+
+
+    //
+    // Parameter space
+    //
+    void evaluate(T u, point& position, point& tangent) const
+    {
+        if(vSegments.empty())
+        {
+            position = vPoints.empty() ? point((T)0) : vPoints[0];
+            tangent = point((T)0);
+            return;
+        }
+
+        const T segments = (T)vSegments.size();
+        u = u < (T)0 ? (T)0 : (u > segments ? segments : u);
+        size_t index = (size_t)u;
+        if(index >= vSegments.size())
+            index = vSegments.size() - 1;
+        T t = u - (T)index;
+
+        const std::array<point, 4>& seg = vSegments[index];
+        for(unsigned int c = 0; c < S; c++)
+        {
+            position.vals[c] = seg[0].vals[c] + t * (seg[1].vals[c] + t * (seg[2].vals[c] + t * seg[3].vals[c]));
+            tangent.vals[c] = seg[1].vals[c] + t * ((T)2 * seg[2].vals[c] + t * (T)3 * seg[3].vals[c]);
+        }
+    }
+
+    point evaluate(T u) const
+    {
+        point position, tangent;
+        evaluate(u, position, tangent);
+        return position;
+    }
+
+    point tangent(T u) const
+    {
+        point position, ret;
+        evaluate(u, position, ret);
+        return ret;
+    }
+
+
+    //
+    // Distance space
+    //
+    //Binary search in the arc length table, O(log n)
+    T getParameter(T distance) const
+    {
+        if(vTableDistances.size() < 2)
+            return (T)0;
+        distance = wrapDistance(distance);
+        size_t index = (size_t)(std::upper_bound(vTableDistances.begin() + 1, vTableDistances.end() - 1, distance) - vTableDistances.begin()) - 1;
+        return interpolate(vTableDistances.data(), vTableParameters.data(), vTableSlopes.data(), index, distance);
+    }
+
+    //Bucket lookup followed by a short forward scan, O(1) unless the sample spacing is very uneven
+    T getParameterFast(T distance) const
+    {
+        if(vBuckets.empty() || fBucketSize <= (T)0)
+            return (T)0;
+        distance = wrapDistance(distance);
+        size_t bucket = (size_t)(distance / fBucketSize);
+        size_t index = vBuckets[bucket < vBuckets.size() ? bucket : vBuckets.size() - 1];
+        const size_t last = vTableDistances.size() - 2;
+        while(index < last && vTableDistances[index + 1] <= distance)
+            index++;
+        return interpolate(vTableDistances.data(), vTableParameters.data(), vTableSlopes.data(), index, distance);
+    }
+
+    point evaluateAtDistance(T distance) const { return evaluate(getParameterFast(distance)); }
+
+    /**
+     * Samples positions (and optionally tangents) at count distances, e.g. one per follower.
+     * Uses the O(1) table, large batches are split across the default ThreadPool.
+     */
+    void sample(const T* distances, point* positions, point* tangents, size_t count) const
+    {
+        Gum::Maths::parallelFor(0, count, [this, distances, positions, tangents](size_t begin, size_t end) {
+            point tangent;
+            for(size_t i = begin; i < end; i++)
+                evaluate(getParameterFast(distances[i]), positions[i], tangents != nullptr ? tangents[i] : tangent);
+        }, 2048);
+    }
+
+    //count evenly spaced points from start to end (or around the loop for closed splines)
+    void sampleUniform(point* positions, size_t count) const
+    {
+        if(count == 0)
+            return;
+        T step = count > 1 ? fLength / (T)(bClosed ? count : count - 1) : (T)0;
+        Gum::Maths::parallelFor(0, count, [this, positions, step](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++)
+                positions[i] = evaluate(getParameterFast((T)i * step));
+        }, 2048);
+    }
+};
+
+typedef tspline<float,  2>  spline2;
+typedef tspline<float,  3>  spline3;
+typedef tspline<double, 2> dspline2;
+typedef tspline<double, 3> dspline3;
@@ -2,8 +2,11 @@
 #include "Maths.h"
 #include "Random.h"
 #include "Constants.h"
+#include "StringConversion.h"
+#include "Instrumentation.h"
 #include <limits>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <cmath>
 #include <array>
@@ -14,23 +17,28 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 
+//Result of dot and distance, float unless the element type only converts explicitly (e.g. tfixed)
+template<typename T>
+using tvec_scalar_t = typename std::conditional<std::is_convertible<T, float>::value, float, T>::type;
+
 //VS:
 //#pragma warning(disable: 4201)
 //#pragma warning( push )
 #define VEC_TEMPLATE_CONSTRUCTORS(size, t) \
-    tvec()                  { for(unsigned int i = 0; i < size; i++) vals[i] = 0; } \
-    tvec(const T& f)        { for(unsigned int i = 0; i < size; i++) vals[i] = (T)f; } \
+    tvec()                  { GUM_MATHS_COUNT_VEC(VEC_CONSTRUCT, T, size); for(unsigned int i = 0; i < size; i++) vals[i] = 0; } \
+    tvec(const T& f)        { GUM_MATHS_COUNT_VEC(VEC_CONSTRUCT, T, size); for(unsigned int i = 0; i < size; i++) vals[i] = (T)f; } \
     \
     template<typename TT, unsigned int SS> \
-    tvec(tvec<TT, SS, t> vvec) { for(unsigned int i = 0; i < (size < SS ? size : SS); i++) vals[i] = (T)vvec[i]; } \
+    tvec(tvec<TT, SS, t> vvec) { GUM_MATHS_COUNT_VEC(VEC_CONSTRUCT, T, size); for(unsigned int i = 0; i < (size < SS ? size : SS); i++) vals[i] = (T)vvec[i]; } \
     \
     template <typename... Args, typename = typename std::enable_if<sizeof...(Args) == size>::type> \
-    tvec(Args&&... values)  { T args[] = { (T)values... }; memcpy(&vals[0], &args[0], size * sizeof(T)); } \
+    tvec(Args&&... values)  { GUM_MATHS_COUNT_VEC(VEC_CONSTRUCT, T, size); T args[] = { (T)values... }; memcpy(&vals[0], &args[0], size * sizeof(T)); } \
     \
     template <typename TT, unsigned int SS, typename... Args, typename = typename std::enable_if<sizeof...(Args) == size - SS>::type> \
     tvec(tvec<TT, SS, t> vvec, Args&&... values)  \
     { \
         static_assert(SS < size, "Passed vector is too large"); \
+        GUM_MATHS_COUNT_VEC(VEC_CONSTRUCT, T, size); \
         for(unsigned int i = 0; i < SS; i++) vals[i] = (T)vvec[i]; \
     \
         T args[] = { (T)values... }; \
@@ -38,40 +46,40 @@
     }
 
 #define VEC_TEMPLATE_OPERATORS(size, type) \
-    template<typename TT> void operator+=(const TT& f)       { for(unsigned int i = 0; i < size; i++) vals[i] += (T)f; } \
-    template<typename TT> void operator-=(const TT& f)       { for(unsigned int i = 0; i < size; i++) vals[i] -= (T)f; } \
-    template<typename TT> void operator/=(const TT& f)       { for(unsigned int i = 0; i < size; i++) vals[i] /= (T)f; } \
-    template<typename TT> void operator*=(const TT& f)       { for(unsigned int i = 0; i < size; i++) vals[i] *= (T)f; } \
-    template<typename TT> void operator^=(const TT& f)       { for(unsigned int i = 0; i < size; i++) vals[i] ^= (T)f; } \
-    template<typename TT> bool operator!=(const TT& f) const { for(unsigned int i = 0; i < size; i++) if(vals[i] != f) { return true;  } return false; } \
-    template<typename TT> bool operator==(const TT& f) const { for(unsigned int i = 0; i < size; i++) if(vals[i] != f) { return false; } return true;  } \
-    template<typename TT> void operator+=(const tvec<TT, size, type>& vvec)       { for(unsigned int i = 0; i < size; i++) vals[i] += (T)vvec.vals[i]; } \
-    template<typename TT> void operator-=(const tvec<TT, size, type>& vvec)       { for(unsigned int i = 0; i < size; i++) vals[i] -= (T)vvec.vals[i]; } \
-    template<typename TT> void operator/=(const tvec<TT, size, type>& vvec)       { for(unsigned int i = 0; i < size; i++) vals[i] /= (T)vvec.vals[i]; } \
-    template<typename TT> void operator*=(const tvec<TT, size, type>& vvec)       { for(unsigned int i = 0; i < size; i++) vals[i] *= (T)vvec.vals[i]; } \
-    template<typename TT> void operator^=(const tvec<TT, size, type>& vvec)       { for(unsigned int i = 0; i < size; i++) vals[i] ^= (T)vvec.vals[i]; } \
-    template<typename TT> bool operator!=(const tvec<TT, size, type>& vvec) const { for(unsigned int i = 0; i < size; i++) if( vals[i] != vvec.vals[i]) { return true;  } return false; } \
-    template<typename TT> bool operator==(const tvec<TT, size, type>& vvec) const { for(unsigned int i = 0; i < size; i++) if( vals[i] != vvec.vals[i]) { return false; } return true;  } \
+    template<typename TT> void operator+=(const TT& f)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] += (T)f; } \
+    template<typename TT> void operator-=(const TT& f)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] -= (T)f; } \
+    template<typename TT> void operator/=(const TT& f)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] /= (T)f; } \
+    template<typename TT> void operator*=(const TT& f)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] *= (T)f; } \
+    template<typename TT> void operator^=(const TT& f)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] ^= (T)f; } \
+    template<typename TT> bool operator!=(const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_COMPARE, T, size); for(unsigned int i = 0; i < size; i++) if(vals[i] != f) { return true;  } return false; } \
+    template<typename TT> bool operator==(const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_COMPARE, T, size); for(unsigned int i = 0; i < size; i++) if(vals[i] != f) { return false; } return true;  } \
+    template<typename TT> void operator+=(const tvec<TT, size, type>& vvec)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] += (T)vvec.vals[i]; } \
+    template<typename TT> void operator-=(const tvec<TT, size, type>& vvec)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] -= (T)vvec.vals[i]; } \
+    template<typename TT> void operator/=(const tvec<TT, size, type>& vvec)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] /= (T)vvec.vals[i]; } \
+    template<typename TT> void operator*=(const tvec<TT, size, type>& vvec)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] *= (T)vvec.vals[i]; } \
+    template<typename TT> void operator^=(const tvec<TT, size, type>& vvec)       { GUM_MATHS_COUNT_VEC(VEC_COMPOUND, T, size); for(unsigned int i = 0; i < size; i++) vals[i] ^= (T)vvec.vals[i]; } \
+    template<typename TT> bool operator!=(const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_COMPARE, T, size); for(unsigned int i = 0; i < size; i++) if( vals[i] != vvec.vals[i]) { return true;  } return false; } \
+    template<typename TT> bool operator==(const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_COMPARE, T, size); for(unsigned int i = 0; i < size; i++) if( vals[i] != vvec.vals[i]) { return false; } return true;  } \
     \
-    template<typename TT> tvec<T, size, type> operator/ (const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] /  (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator* (const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] *  (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator+ (const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] +  (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator- (const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] -  (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator^ (const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] ^  (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator<<(const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] << (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator>>(const TT& f) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] >> (T)f; return nvec; } \
-    template<typename TT> tvec<T, size, type> operator+ (const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] +  vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator- (const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] -  vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator/ (const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] /  vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator* (const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] *  vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator^ (const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] ^  vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator<<(const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] << vvec.vals[i]); return nvec; } \
-    template<typename TT> tvec<T, size, type> operator>>(const tvec<TT, size, type>& vvec) const { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] >> vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator/ (const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] /  (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator* (const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] *  (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator+ (const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] +  (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator- (const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] -  (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator^ (const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] ^  (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator<<(const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] << (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator>>(const TT& f) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = vals[i] >> (T)f; return nvec; } \
+    template<typename TT> tvec<T, size, type> operator+ (const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] +  vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator- (const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] -  vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator/ (const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] /  vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator* (const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] *  vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator^ (const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] ^  vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator<<(const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] << vvec.vals[i]); return nvec; } \
+    template<typename TT> tvec<T, size, type> operator>>(const tvec<TT, size, type>& vvec) const { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = (T)(vals[i] >> vvec.vals[i]); return nvec; } \
     template<typename TT, unsigned int SS> void operator=(const tvec<TT, SS, type>& vvec) { for(unsigned int i = 0; i < (size < SS ? size : SS); i++) vals[i] = (T)vvec.vals[i]; } \
     /*void    operator=(tvec<T, size, type> vvec)  { for(unsigned int i = 0; i < size; i++) vals[i] = vvec.vals[i]; }*/ \
     \
-    tvec<T, size, type> operator-()                { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = -vals[i]; return nvec; } \
-    const tvec<T, size, type>& operator-() const   { tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = -vals[i]; return nvec; } \
+    tvec<T, size, type> operator-()                { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = -vals[i]; return nvec; } \
+    const tvec<T, size, type>& operator-() const   { GUM_MATHS_COUNT_VEC(VEC_ARITHMETIC, T, size); tvec<T, size, type> nvec; for(unsigned int i = 0; i < size; i++) nvec.vals[i] = -vals[i]; return nvec; } \
     T& operator[](unsigned int& index)             { return vals[index]; } \
     const T& operator[](unsigned int& index) const { return vals[index]; } \
     const T& at(unsigned int index) const          { return vals[index]; }
@@ -87,10 +95,12 @@
 #define VEC_TEMPLATE_LENGTH_FUNC(size, type) \
     T length() \
     { \
+        GUM_MATHS_COUNT_VEC(VEC_LENGTH, T, size); \
         T sum = 0; \
         for(unsigned int i = 0; i < size; i++) \
             sum += vals[i] * vals[i]; \
-        return (float)::sqrt(sum); \
+        using std::sqrt; /*Unqualified so custom scalars like tfixed are found through ADL*/ \
+        return (T)sqrt(sum); \
     }
 
 #define VEC_TEMPLATE_ABS_FUNC(size, type) \
@@ -198,6 +208,7 @@
     template<typename TT>  \
     static tvec<T, size, type> cross(tvec<TT, size, type> a, tvec<TT, size, type> b)  \
     {  \
+        GUM_MATHS_COUNT_VEC(VEC_CROSS, T, size); \
         if      constexpr (size == 3) { return tvec<T, size, type>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); } \
         else if constexpr (size == 7) { return tvec<T, size, type>(); } /*TODO*/ \
         else                          { std::cerr << "GumMaths: Crossproduct not defined for " + std::to_string(size) + "-dimensional vectors." << std::endl; return tvec<T, size, type>(); } \
@@ -207,6 +218,7 @@
     template<typename TT>  \
     static tvec<T, size, type> normalize(tvec<TT, size, type> vvec) \
     {  \
+        GUM_MATHS_COUNT_VEC(VEC_NORMALIZE, T, size); \
         T length_of_v = (T)vvec.length();  \
         tvec<T, size, type> ret; \
         for(unsigned int i = 0; i < size; i++) \
@@ -318,9 +330,10 @@
 
 #define VEC_TEMPLATE_DOT_FUNC(size, type) \
     template<typename TT> \
-    static float dot(tvec<TT, size, type> a, tvec<TT, size, type> b)  \
+    static tvec_scalar_t<TT> dot(tvec<TT, size, type> a, tvec<TT, size, type> b)  \
     { \
-        float ret = 0.0f; \
+        GUM_MATHS_COUNT_VEC(VEC_DOT, T, size); \
+        tvec_scalar_t<TT> ret = 0; \
         for(unsigned int i = 0; i < size; i++) \
             ret += a[i] * b[i]; \
         return ret;  \
@@ -344,22 +357,44 @@
 
 #define VEC_TEMPLATE_DISTANCE_FUNC(size, type) \
     template<typename TT>  \
-    static float distance(tvec<TT, size, type> a, tvec<TT, size, type> b)  \
+    static tvec_scalar_t<TT> distance(tvec<TT, size, type> a, tvec<TT, size, type> b)  \
     { \
         return (a - b).length();  \
     }
 
+//precision < 0 writes the shortest form that reads back exactly, see appendNumber
 #define VEC_TEMPLATE_TO_STRING_FUNC(size, type, name) \
-    std::string toString(std::string prefix = std::string(name) + "(", std::string suffix = ")", std::string delimiter = ", ", const unsigned short& precision = 2) const \
+    static const std::string& typeName() { static const std::string typename_str = name; return typename_str; } \
+    \
+    void appendToString(std::string& out, std::string_view prefix, std::string_view suffix = ")", std::string_view delimiter = ", ", const int& precision = 2) const \
     { \
-        std::string str = prefix; \
+        out.append(prefix); \
         for(unsigned int i = 0; i < size; i++) \
-            str += Gum::Maths::numToString(vals[i], precision) + delimiter; \
-        str = str.substr(0, str.length() - delimiter.length()); \
-        str += suffix; \
+        { \
+            if(i > 0) \
+                out.append(delimiter); \
+            Gum::Maths::appendNumber(out, vals[i], precision); \
+        } \
+        out.append(suffix); \
+    } \
+    std::string toString(std::string_view prefix, std::string_view suffix = ")", std::string_view delimiter = ", ", const int& precision = 2) const \
+    { \
+        std::string str; \
+        appendToString(str, prefix, suffix, delimiter, precision); \
         return str; \
     } \
-    operator std::string() const { return toString(); }
+    std::string toString() const \
+    { \
+        std::string str = typeName(); \
+        appendToString(str, "(", ")"); \
+        return str; \
+    } \
+    operator std::string() const { return toString(); } \
+    \
+    static bool fromString(std::string_view str, tvec<T, size, type>& out) \
+    { \
+        return Gum::Maths::parseNumbers(str, out.vals, size) == size; \
+    }
 
 #define VEC_TEMPLATE(size, name, type, ...) \
     union { \
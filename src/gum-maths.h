@@ -7,4 +7,27 @@
 #include "Maths/ColorFunctions.h"
 #include "Maths/MatrixFunctions.h"
 #include "Maths/Maths.h"
-#include "Maths/quat.h"
\ No newline at end of file
+#include "Maths/quat.h"
+#include "Maths/Allocator.h"
+#include "Maths/Span.h"
+#include "Maths/BinaryFile.h"
+#include "Maths/ThreadPool.h"
+#include "Maths/Simd.h"
+#include "Maths/EigenFunctions.h"
+#include "Maths/obb.h"
+#include "Maths/dmatrix.h"
+#include "Maths/smatrix.h"
+#include "Maths/half.h"
+#include "Maths/EncodingFunctions.h"
+#include "Maths/fixed.h"
+#include "Maths/camera.h"
+#include "Maths/bezier.h"
+#include "Maths/spline.h"
+#include "Maths/Instrumentation.h"
+#include "Maths/RotationFunctions.h"
+#include "Maths/ray.h"
+#include "Maths/RayFunctions.h"
+#include "Maths/MeshFunctions.h"
+#include "Maths/HullFunctions.h"
+#include "Maths/PredicateFunctions.h"
+#include "Maths/ArrayFunctions.h"
\ No newline at end of file
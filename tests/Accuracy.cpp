@@ -0,0 +1,532 @@
+#include <gum-maths.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Accuracy regression against a long double reference
+ * Every function is run over random or exhaustively enumerated inputs on all workers of the
+ * default ThreadPool. Inputs only depend on the sample index, so the results do not depend on
+ * the amount of threads. Errors are measured normwise: ulp is the distance in units of the float
+ * spacing at the given scale (the largest reference component unless the function passes the
+ * condition of the problem, like sum |a_i * b_i| for dot products), relative is distance / scale.
+ *
+ * Test_Accuracy [multiplier] runs multiplier times more random samples.
+ */
+typedef long double ld;
+
+struct ErrorStats
+{
+  uint64_t count = 0;
+  double maxUlp = 0, sumUlp = 0;
+  double maxRelative = 0, sumRelative = 0;
+  uint64_t worstSample = 0;
+
+  void add(uint64_t sample, double ulp, double relative)
+  {
+    count++;
+    sumUlp += ulp;
+    sumRelative += relative;
+    if(ulp > maxUlp || count == 1) { maxUlp = ulp; worstSample = sample; }
+    maxRelative = std::max(maxRelative, relative);
+  }
+
+  void merge(const ErrorStats& other)
+  {
+    if(other.count > 0 && (other.maxUlp > maxUlp || count == 0)) { maxUlp = other.maxUlp; worstSample = other.worstSample; }
+    count += other.count;
+    sumUlp += other.sumUlp;
+    sumRelative += other.sumRelative;
+    maxRelative = std::max(maxRelative, other.maxRelative);
+  }
+};
+
+//Spacing of floats at x, 2^-149 below the normal range
+static ld floatUlp(ld x)
+{
+  x = std::fabs(x);
+  if(x < (ld)std::numeric_limits<float>::min())
+    return std::ldexp((ld)1, -149);
+  return std::ldexp((ld)1, std::ilogb(x) - 23);
+}
+
+//Normwise error of n components, scale 0 uses the largest reference component
+static void measure(ErrorStats& stats, uint64_t sample, const float* result, const ld* reference, unsigned int n, ld scale = 0, ld ulp = 0)
+{
+  ld error = 0, largest = 0;
+  for(unsigned int i = 0; i < n; i++)
+  {
+    if(std::isnan(result[i]) != std::isnan(reference[i]) || std::isinf(result[i]) != std::isinf(reference[i]))
+      error = std::numeric_limits<ld>::infinity();
+    else if(std::isfinite(reference[i]))
+      error = std::max(error, std::fabs((ld)result[i] - reference[i]));
+    else if((ld)result[i] != reference[i] && !std::isnan(result[i]))
+      error = std::numeric_limits<ld>::infinity();
+    if(std::isfinite(reference[i]))
+      largest = std::max(largest, std::fabs(reference[i]));
+  }
+  if(scale == 0)
+    scale = largest;
+  if(ulp == 0)
+    ulp = floatUlp(scale);
+  stats.add(sample, (double)(error / ulp), scale > 0 ? (double)(error / scale) : (double)error);
+}
+
+//splitmix64 seeded with the sample index
+struct SampleRandom
+{
+  uint64_t state;
+  SampleRandom(uint64_t sample) : state(sample * 0x9E3779B97F4A7C15ull + 0x2545F4914F6CDD1Dull) {}
+
+  uint64_t next()
+  {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  float uniform(float min, float max) { return min + (max - min) * (float)(next() >> 40) * (1.0f / 16777216.0f); }
+  vec3 uniform3(float min, float max) { return vec3(uniform(min, max), uniform(min, max), uniform(min, max)); }
+
+  fquat rotation()
+  {
+    //Uniform in the 4D unit ball by rejection, normalized that is uniform on the rotation group
+    float v[4];
+    float length = 0;
+    do
+    {
+      length = 0;
+      for(unsigned int i = 0; i < 4; i++)
+      {
+        v[i] = uniform(-1.0f, 1.0f);
+        length += v[i] * v[i];
+      }
+    } while(length > 1.0f || length < 1e-4f);
+    return fquat::normalize(fquat(v[0], v[1], v[2], v[3]));
+  }
+};
+
+struct AccuracyCheck
+{
+  std::string name;
+  ErrorStats stats;
+  double ulpLimit;
+  double relativeLimit;
+  bool passed() const { return stats.count > 0 && stats.maxUlp <= ulpLimit && stats.maxRelative <= relativeLimit; }
+};
+
+static std::vector<AccuracyCheck> checks;
+static uint64_t randomSamples = 1 << 17;
+
+//Batch kernels get this many elements per call, so both full vector packets and the scalar tail run
+static const uint64_t BATCH_SIZE = 1003;
+
+/**
+ * test(uint64_t sample, ErrorStats& stats) is called for every sample in [0, count), grain samples per task
+ */
+template<typename F>
+static void run(const std::string& name, uint64_t count, double ulpLimit, double relativeLimit, F&& test, size_t grain = 4096)
+{
+  AccuracyCheck check;
+  check.name = name;
+  check.ulpLimit = ulpLimit;
+  check.relativeLimit = relativeLimit;
+  check.stats = Gum::Maths::parallelReduce(0, (size_t)count, ErrorStats(), [&test](size_t begin, size_t end, ErrorStats stats) {
+    for(size_t i = begin; i < end; i++)
+      test((uint64_t)i, stats);
+    return stats;
+  }, [](ErrorStats a, const ErrorStats& b) { a.merge(b); return a; }, grain);
+  checks.push_back(check);
+}
+
+
+//
+// References
+//
+//Product of the three axis rotations, the first axis of the order is applied first: q = qk * qj * qi
+static void referenceEulerToQuaternion(const vec3& anglesDeg, Gum::Maths::RotationOrder order, ld out[4])
+{
+  static const char* names[6] = { "XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX" };
+  const ld pi = std::acos((ld)-1);
+  ld q[4] = { 1, 0, 0, 0 };
+  for(unsigned int c = 0; c < 3; c++)
+  {
+    unsigned int axis = (unsigned int)(names[(unsigned int)order][c] - 'X');
+    ld half = (ld)anglesDeg.vals[axis] * pi / 360;
+    ld r[4] = { std::cos(half), 0, 0, 0 };
+    r[1 + axis] = std::sin(half);
+
+    //q = r * q
+    ld w = r[0] * q[0] - r[1] * q[1] - r[2] * q[2] - r[3] * q[3];
+    ld x = r[0] * q[1] + r[1] * q[0] + r[2] * q[3] - r[3] * q[2];
+    ld y = r[0] * q[2] - r[1] * q[3] + r[2] * q[0] + r[3] * q[1];
+    ld z = r[0] * q[3] + r[1] * q[2] - r[2] * q[1] + r[3] * q[0];
+    q[0] = w; q[1] = x; q[2] = y; q[3] = z;
+  }
+  for(unsigned int c = 0; c < 4; c++)
+    out[c] = q[c];
+}
+
+//Distance of two rotations, q and -q are the same
+static ld rotationDistance(const fquat& result, const ld reference[4])
+{
+  ld plus = 0, minus = 0;
+  for(unsigned int i = 0; i < 4; i++)
+  {
+    plus = std::max(plus, std::fabs((ld)result.vals[i] - reference[i]));
+    minus = std::max(minus, std::fabs((ld)result.vals[i] + reference[i]));
+  }
+  return std::min(plus, minus);
+}
+
+//Gauss-Jordan with partial pivoting, false if singular
+static bool referenceInverse(const mat4& m, ld out[4][4])
+{
+  ld a[4][8];
+  for(unsigned int i = 0; i < 4; i++)
+    for(unsigned int j = 0; j < 4; j++)
+    {
+      a[i][j] = m[i][j];
+      a[i][j + 4] = i == j ? 1 : 0;
+    }
+
+  for(unsigned int c = 0; c < 4; c++)
+  {
+    unsigned int pivot = c;
+    for(unsigned int r = c + 1; r < 4; r++)
+      if(std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+        pivot = r;
+    if(a[pivot][c] == 0)
+      return false;
+    for(unsigned int j = 0; j < 8; j++)
+      std::swap(a[c][j], a[pivot][j]);
+
+    ld inv = 1 / a[c][c];
+    for(unsigned int j = 0; j < 8; j++)
+      a[c][j] *= inv;
+    for(unsigned int r = 0; r < 4; r++)
+    {
+      if(r == c)
+        continue;
+      ld f = a[r][c];
+      for(unsigned int j = 0; j < 8; j++)
+        a[r][j] -= f * a[c][j];
+    }
+  }
+
+  for(unsigned int i = 0; i < 4; i++)
+    for(unsigned int j = 0; j < 4; j++)
+      out[i][j] = a[i][j + 4];
+  return true;
+}
+
+//Rotation * scale in [0.5, 2] + translation, condition number at most 4 for the upper 3x3
+static mat4 randomTransform(SampleRandom& random)
+{
+  fquat q = random.rotation();
+  mat4 rotation = Gum::Maths::rotateMatrix<float>(q);
+  mat4 scale = Gum::Maths::scaleMatrix<float>(vec3(random.uniform(0.5f, 2.0f), random.uniform(0.5f, 2.0f), random.uniform(0.5f, 2.0f)));
+  mat4 translation = Gum::Maths::translateMatrix<float>(random.uniform3(-100.0f, 100.0f));
+  return translation * rotation * scale;
+}
+
+static void referenceRGBToHSV(ld r, ld g, ld b, ld out[3])
+{
+  r /= 255; g /= 255; b /= 255;
+  ld cmax = std::max(std::max(r, g), b);
+  ld cmin = std::min(std::min(r, g), b);
+  ld delta = cmax - cmin;
+  ld hue = 0;
+  if(delta > 0)
+  {
+    if(cmax == r)      hue = std::fmod((g - b) / delta + 6, (ld)6);
+    else if(cmax == g) hue = (b - r) / delta + 2;
+    else               hue = (r - g) / delta + 4;
+  }
+  out[0] = hue * 60;
+  out[1] = (cmax == 0 ? 0 : delta / cmax) * 100;
+  out[2] = cmax * 100;
+}
+
+static void referenceHSVToRGB(ld h, ld s, ld v, ld out[3])
+{
+  s /= 100; v /= 100;
+  //f(n) = v - v s max(0, min(k, 4 - k, 1)), k = (n + h / 60) mod 6
+  const ld n[3] = { 5, 3, 1 };
+  for(unsigned int i = 0; i < 3; i++)
+  {
+    ld k = std::fmod(n[i] + h / 60, (ld)6);
+    out[i] = (v - v * s * std::max((ld)0, std::min(std::min(k, 4 - k), (ld)1))) * 255;
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  using namespace Gum::Maths;
+  if(argc > 1)
+    randomSamples *= (uint64_t)std::max(1, atoi(argv[1]));
+
+  //
+  // vec
+  //
+  run("vec3 length", randomSamples, 2, 2e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    vec3 a = random.uniform3(-1000.0f, 1000.0f);
+    float result = a.length();
+    ld reference = std::sqrt((ld)a.x * a.x + (ld)a.y * a.y + (ld)a.z * a.z);
+    measure(stats, i, &result, &reference, 1);
+  });
+
+  run("vec3 normalize", randomSamples, 4, 5e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    vec3 a = random.uniform3(-1000.0f, 1000.0f);
+    vec3 result = vec3::normalize(a);
+    ld length = std::sqrt((ld)a.x * a.x + (ld)a.y * a.y + (ld)a.z * a.z);
+    ld reference[3] = { a.x / length, a.y / length, a.z / length };
+    measure(stats, i, result.vals, reference, 3);
+  });
+
+  run("vec4 dot", randomSamples, 4, 4e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    vec4 a(random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f));
+    vec4 b(random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f), random.uniform(-100.0f, 100.0f));
+    float result = vec4::dot(a, b);
+    ld reference = 0, condition = 0;
+    for(unsigned int c = 0; c < 4; c++)
+    {
+      reference += (ld)a.vals[c] * b.vals[c];
+      condition += std::fabs((ld)a.vals[c] * b.vals[c]);
+    }
+    measure(stats, i, &result, &reference, 1, condition);
+  });
+
+  run("vec3 cross", randomSamples, 2, 2e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    vec3 a = random.uniform3(-100.0f, 100.0f), b = random.uniform3(-100.0f, 100.0f);
+    vec3 result = vec3::cross(a, b);
+    ld reference[3] = { (ld)a.y * b.z - (ld)a.z * b.y, (ld)a.z * b.x - (ld)a.x * b.z, (ld)a.x * b.y - (ld)a.y * b.x };
+    ld condition = std::max(std::max(std::fabs((ld)a.y * b.z) + std::fabs((ld)a.z * b.y), std::fabs((ld)a.z * b.x) + std::fabs((ld)a.x * b.z)), std::fabs((ld)a.x * b.y) + std::fabs((ld)a.y * b.x));
+    measure(stats, i, result.vals, reference, 3, condition);
+  });
+
+  //
+  // mat
+  //
+  run("mat4 * mat4", randomSamples, 4, 4e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    mat4 a, b;
+    for(unsigned int c = 0; c < 4; c++)
+      for(unsigned int r = 0; r < 4; r++)
+      {
+        a[c][r] = random.uniform(-10.0f, 10.0f);
+        b[c][r] = random.uniform(-10.0f, 10.0f);
+      }
+    mat4 result = a * b;
+    mat<ld,4,4> la, lb;
+    for(unsigned int c = 0; c < 4; c++)
+      for(unsigned int r = 0; r < 4; r++)
+      {
+        la[c][r] = a[c][r];
+        lb[c][r] = b[c][r];
+      }
+    mat<ld,4,4> reference = la * lb;
+    ld condition = 4 * 10 * 10;
+    measure(stats, i, &result[0][0], &reference[0][0], 16, condition);
+  });
+
+  run("mat4 * vec4", randomSamples, 4, 4e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    mat4 m = randomTransform(random);
+    vec4 v(random.uniform3(-100.0f, 100.0f), 1.0f);
+    vec4 result = m * v;
+    mat<ld,4,4> lm;
+    for(unsigned int c = 0; c < 4; c++)
+      for(unsigned int r = 0; r < 4; r++)
+        lm[c][r] = m[c][r];
+    tvec<ld, 4> reference = lm * tvec<ld, 4>(v.x, v.y, v.z, v.w);
+    ld condition = 0;
+    for(unsigned int r = 0; r < 4; r++)
+      condition = std::max(condition, std::fabs((ld)m[0][r] * v.x) + std::fabs((ld)m[1][r] * v.y) + std::fabs((ld)m[2][r] * v.z) + std::fabs((ld)m[3][r] * v.w));
+    measure(stats, i, result.vals, reference.vals, 4, condition);
+  });
+
+  run("mat4 inverse", randomSamples, 16, 2e-6, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    mat4 m = randomTransform(random);
+    mat4 result = mat4::inverse(m);
+    ld reference[4][4];
+    referenceInverse(m, reference);
+    measure(stats, i, &result[0][0], &reference[0][0], 16);
+  });
+
+  run("invertMatrix", randomSamples, 16, 2e-6, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    mat4 m = randomTransform(random), result;
+    invertMatrix(m, result);
+    ld reference[4][4];
+    referenceInverse(m, reference);
+    measure(stats, i, &result[0][0], &reference[0][0], 16);
+  });
+
+  run("mat3 determinant", randomSamples, 2, 2e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    mat3 m;
+    for(unsigned int c = 0; c < 3; c++)
+      for(unsigned int r = 0; r < 3; r++)
+        m[c][r] = random.uniform(-10.0f, 10.0f);
+    float result = m.determinant();
+    ld reference = (ld)m[0][0] * ((ld)m[1][1] * m[2][2] - (ld)m[2][1] * m[1][2])
+                 - (ld)m[1][0] * ((ld)m[0][1] * m[2][2] - (ld)m[2][1] * m[0][2])
+                 + (ld)m[2][0] * ((ld)m[0][1] * m[1][2] - (ld)m[1][1] * m[0][2]);
+    ld condition = 6 * 10 * 10 * 10;
+    measure(stats, i, &result, &reference, 1, condition);
+  });
+
+  //
+  // quat
+  //
+  run("quat toQuaternion", randomSamples, 4, 5e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    vec3 angles = random.uniform3(-180.0f, 180.0f);
+    fquat result = fquat::toQuaternion(angles);
+    ld reference[4];
+    referenceEulerToQuaternion(angles, RotationOrder::XYZ, reference);
+    measure(stats, i, result.vals, reference, 4, 1);
+  });
+
+  //Compares the rotations, the angles themselves are ambiguous close to gimbal lock
+  run("quat toEuler", randomSamples, 8, 1e-6, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    fquat q = random.rotation();
+    vec3 angles = fquat::toEuler(q);
+    ld reference[4];
+    referenceEulerToQuaternion(angles, RotationOrder::XYZ, reference);
+    ld error = rotationDistance(q, reference);
+    stats.add(i, (double)(error / floatUlp(1)), (double)error);
+  });
+
+  run("quat slerp", randomSamples, 64, 8e-6, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    fquat a = random.rotation(), b = random.rotation();
+    float f = random.uniform(0.0f, 1.0f);
+    fquat result = fquat::slerp(a, b, f);
+
+    ld d = (ld)a.w * b.w + (ld)a.x * b.x + (ld)a.y * b.y + (ld)a.z * b.z, sign = 1;
+    if(d < 0) { d = -d; sign = -1; }
+    ld reference[4];
+    if(d > 0.9999L || std::sqrt(1 - d * d) < 0.001L)
+      return; //Special cased by slerp, acos close to 1 is where the error comes from
+    ld theta = std::acos(d);
+    ld ra = std::sin((1 - f) * theta) / std::sin(theta), rb = std::sin(f * theta) / std::sin(theta);
+    for(unsigned int c = 0; c < 4; c++)
+      reference[c] = sign * ra * a.vals[c] + rb * b.vals[c];
+    measure(stats, i, result.vals, reference, 4, 1);
+  });
+
+  //One sample is one call with BATCH_SIZE elements, the worst sample is reported as batch * BATCH_SIZE + element
+  const uint64_t batches = randomSamples / BATCH_SIZE + 1;
+  const ConversionPrecision precisions[2] = { ConversionPrecision::PRECISE, ConversionPrecision::FAST };
+  const char* precisionNames[2] = { "", " FAST" };
+  const double toQuaternionLimits[2][2] = { { 8, 1e-6 }, { 1024, 1.2e-4 } };
+  const double toEulerLimits[2][2] = { { 8, 1e-6 }, { 64, 8e-6 } };
+  for(unsigned int p = 0; p < 2; p++)
+  {
+    ConversionPrecision precision = precisions[p];
+    run(std::string("eulerToQuaternions") + precisionNames[p], batches, toQuaternionLimits[p][0], toQuaternionLimits[p][1], [precision](uint64_t i, ErrorStats& stats) {
+      SampleRandom random(i);
+      RotationOrder order = (RotationOrder)(i % 6);
+      std::vector<vec3> angles(BATCH_SIZE);
+      std::vector<fquat> result(BATCH_SIZE);
+      for(vec3& a : angles)
+        a = random.uniform3(-720.0f, 720.0f);
+      eulerToQuaternions(angles.data(), result.data(), BATCH_SIZE, order, precision);
+      for(uint64_t e = 0; e < BATCH_SIZE; e++)
+      {
+        ld reference[4];
+        referenceEulerToQuaternion(angles[e], order, reference);
+        measure(stats, i * BATCH_SIZE + e, result[e].vals, reference, 4, 1);
+      }
+    }, 1);
+
+    run(std::string("quaternionsToEuler") + precisionNames[p], batches, toEulerLimits[p][0], toEulerLimits[p][1], [precision](uint64_t i, ErrorStats& stats) {
+      SampleRandom random(i);
+      RotationOrder order = (RotationOrder)(i % 6);
+      std::vector<fquat> q(BATCH_SIZE);
+      std::vector<vec3> angles(BATCH_SIZE);
+      for(fquat& r : q)
+        r = random.rotation();
+      quaternionsToEuler(q.data(), angles.data(), BATCH_SIZE, order, precision);
+      for(uint64_t e = 0; e < BATCH_SIZE; e++)
+      {
+        ld reference[4];
+        referenceEulerToQuaternion(angles[e], order, reference);
+        ld error = rotationDistance(q[e], reference);
+        stats.add(i * BATCH_SIZE + e, (double)(error / floatUlp(1)), (double)error);
+      }
+    }, 1);
+  }
+
+  //
+  // Colour, every 8 bit rgb colour
+  //
+  run("RGBToHSV (exhaustive)", 1 << 24, 8, 1e-6, [](uint64_t i, ErrorStats& stats) {
+    rgb color((float)(i >> 16), (float)((i >> 8) & 0xFF), (float)(i & 0xFF));
+    hsv result = RGBToHSV(color);
+    ld reference[3];
+    referenceRGBToHSV(color.r, color.g, color.b, reference);
+    if(std::fabs(result.h - reference[0]) > 180)
+      reference[0] = result.h > reference[0] ? reference[0] + 360 : reference[0] - 360;
+    measure(stats, i, result.vals, reference, 3, 360);
+  });
+
+  run("HSVToRGB", randomSamples, 8, 8e-7, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    hsv color(random.uniform(0.0f, 360.0f), random.uniform(0.0f, 100.0f), random.uniform(0.0f, 100.0f));
+    rgb result = HSVToRGB(color);
+    ld reference[3];
+    referenceHSVToRGB(color.h, color.s, color.v, reference);
+    measure(stats, i, result.vals, reference, 3, 255);
+  });
+
+  //
+  // 16 bit floats, every half and correct rounding of random floats
+  //
+  run("halfBitsToFloat (exhaustive)", 1 << 16, 0, 0, [](uint64_t i, ErrorStats& stats) {
+    uint16_t bits = (uint16_t)i;
+    unsigned int exponent = (bits >> 10) & 0x1F, mantissa = bits & 0x3FF;
+    if(exponent == 0x1F && mantissa != 0)
+      return;
+    ld reference = exponent == 0x1F ? std::numeric_limits<ld>::infinity()
+                 : exponent == 0    ? std::ldexp((ld)mantissa, -24)
+                 :                    std::ldexp((ld)(mantissa | 0x400), (int)exponent - 25);
+    if(bits & 0x8000)
+      reference = -reference;
+    float result = halfBitsToFloat(bits);
+    measure(stats, i, &result, &reference, 1, 1);
+  });
+
+  //In half ulps, correct rounding is at most 0.5
+  run("floatToHalfBits", randomSamples, 0.5, 1, [](uint64_t i, ErrorStats& stats) {
+    SampleRandom random(i);
+    float value = std::ldexp(random.uniform(-1.0f, 1.0f), (int)(random.next() % 40) - 24);
+    float result = halfBitsToFloat(floatToHalfBits(value));
+    ld reference = value;
+    ld halfUlp = std::ldexp((ld)1, std::max(std::ilogb(std::max(std::fabs(value), 1e-30f)), -14) - 10);
+    measure(stats, i, &result, &reference, 1, 0, halfUlp);
+  });
+
+
+  bool ok = true;
+  printf("%-30s %10s %12s %12s %12s %12s %10s %10s\n", "function", "samples", "max ulp", "mean ulp", "max rel", "mean rel", "ulp limit", "worst");
+  for(const AccuracyCheck& check : checks)
+  {
+    const ErrorStats& s = check.stats;
+    printf("%-30s %10llu %12.3f %12.4f %12.3e %12.3e %10.1f %10llu %s\n", check.name.c_str(), (unsigned long long)s.count, s.maxUlp,
+           s.count > 0 ? s.sumUlp / (double)s.count : 0.0, s.maxRelative, s.count > 0 ? s.sumRelative / (double)s.count : 0.0,
+           check.ulpLimit, (unsigned long long)s.worstSample, check.passed() ? "" : "FAILED");
+    ok = check.passed() && ok;
+  }
+  return ok ? 0 : 1;
+};
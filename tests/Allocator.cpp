@@ -0,0 +1,155 @@
+#include <gum-maths.h>
+#include <list>
+#include <map>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+static bool aligned(const void* ptr, size_t alignment)
+{
+  return (uintptr_t)ptr % alignment == 0;
+}
+
+struct alignas(128) Wide
+{
+  float values[5];
+};
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Aligned vectors, also after growing and for types and alignments above the default
+  {
+    aligned_vector<mat4> matrices;
+    bool allAligned = true;
+    for(unsigned int i = 0; i < 1000; i++)
+    {
+      matrices.push_back(mat4());
+      allAligned = allAligned && aligned(matrices.data(), GUM_MATHS_DEFAULT_ALIGNMENT);
+    }
+    std::vector<vec3, AlignedAllocator<vec3, 256>> points(333);
+    std::vector<Wide, AlignedAllocator<Wide, 128>> wide(7);
+    ok = check(allAligned && aligned(points.data(), 256) && aligned(wide.data(), 128), "AlignedAllocator alignment") && ok;
+    void* raw = alignedAlloc(0, 4096);
+    ok = check(raw != nullptr && aligned(raw, 4096), "alignedAlloc of 0 bytes") && ok;
+    alignedFree(raw, 4096);
+  }
+
+  //Arena: aligned bump allocations, reset reuses the same memory, oversized requests get their own block
+  {
+    Arena arena(4096);
+    std::vector<void*> first;
+    bool allAligned = true;
+    for(unsigned int i = 0; i < 200; i++)
+    {
+      size_t alignment = i % 3 == 0 ? 256 : GUM_MATHS_DEFAULT_ALIGNMENT;
+      first.push_back(arena.allocate(1 + i * 7 % 300, alignment));
+      allAligned = allAligned && aligned(first.back(), alignment);
+    }
+    vec4* typed = arena.allocate<vec4>(10);
+    Wide* wide = arena.allocate<Wide>(3);
+    allAligned = allAligned && aligned(typed, GUM_MATHS_DEFAULT_ALIGNMENT) && aligned(wide, 128);
+    ok = check(allAligned, "Arena alignment") && ok;
+
+    size_t reserved = arena.getBytesReserved();
+    arena.reset();
+    ok = check(arena.getBytesUsed() == 0, "Arena reset has to release everything") && ok;
+    bool same = true;
+    for(unsigned int i = 0; i < 200; i++)
+      same = same && arena.allocate(1 + i * 7 % 300, i % 3 == 0 ? 256 : GUM_MATHS_DEFAULT_ALIGNMENT) == first[i];
+    ok = check(same && arena.getBytesReserved() == reserved, "Arena has to hand out the same memory after reset without growing") && ok;
+
+    void* large = arena.allocate(100000);
+    ok = check(large != nullptr && aligned(large, GUM_MATHS_DEFAULT_ALIGNMENT) && arena.getBytesReserved() >= reserved + 100000, "Arena allocation larger than a block") && ok;
+    arena.shrink();
+    ok = check(arena.getBytesReserved() == 4096 && arena.getBytesUsed() == 0, "Arena shrink has to keep only the first block") && ok;
+
+    //Frame scratch through the STL adaptor, passed to a batch function
+    std::vector<vec3, ArenaAllocator<vec3>> points((ArenaAllocator<vec3>(&arena)));
+    for(unsigned int i = 0; i < 5000; i++)
+      points.push_back(vec3((float)i, 1.0f, 2.0f));
+    mat4 translation = translateMatrix<float>(vec3(1.0f, 2.0f, 3.0f));
+    transformPoints(translation, points.data(), points.data(), points.size());
+    bool moved = true;
+    for(unsigned int i = 0; i < points.size(); i++)
+      moved = moved && points[i] == vec3((float)i + 1.0f, 3.0f, 5.0f);
+    ok = check(moved && aligned(points.data(), GUM_MATHS_DEFAULT_ALIGNMENT), "batch transform on an arena vector") && ok;
+  }
+
+  //Pool: freed objects are reused before the pool grows
+  {
+    Pool<mat4, 16> pool;
+    std::vector<mat4*> objects;
+    for(unsigned int i = 0; i < 40; i++)
+      objects.push_back(pool.create());
+    bool allAligned = true;
+    for(mat4* m : objects)
+      allAligned = allAligned && aligned(m, alignof(mat4));
+    ok = check(allAligned && pool.getNumAllocated() == 40 && pool.getCapacity() == 48, "Pool growth") && ok;
+    ok = check((*objects[17])[0][0] == 1.0f && (*objects[17])[1][0] == 0.0f, "Pool create has to construct") && ok;
+
+    mat4* freed = objects[5];
+    pool.destroy(freed);
+    mat4* reused = pool.create(2.0f);
+    ok = check(reused == freed && (*reused)[1][2] == 2.0f, "Pool has to reuse the last freed slot") && ok;
+    for(mat4* m : objects)
+      if(m != freed)
+        pool.destroy(m);
+    pool.destroy(reused);
+    for(unsigned int i = 0; i < 48; i++)
+      objects.push_back(pool.create());
+    ok = check(pool.getCapacity() == 48, "Pool must not grow while slots are free") && ok;
+    for(size_t i = 40; i < objects.size(); i++)
+      pool.destroy(objects[i]);
+    ok = check(pool.getNumAllocated() == 0, "Pool count after destroying everything") && ok;
+  }
+
+  //PoolResource behind node containers, shared by copies and rebinds, memory is reused after a clear
+  {
+    PoolResource nodes(64);
+    {
+      std::list<vec3, PoolAllocator<vec3>> points((PoolAllocator<vec3>(&nodes)));
+      std::map<int, quat<float>, std::less<int>, PoolAllocator<std::pair<const int, quat<float>>>> rotations((PoolAllocator<std::pair<const int, quat<float>>>(&nodes)));
+      for(int i = 0; i < 1000; i++)
+      {
+        points.push_back(vec3((float)i));
+        rotations[i] = quat<float>();
+      }
+      ok = check(nodes.getNumAllocated() >= 2000, "PoolResource has to serve the container nodes") && ok;
+      size_t reserved = nodes.getBytesReserved();
+      points.clear();
+      rotations.clear();
+      ok = check(nodes.getNumAllocated() == 0, "PoolResource count after clearing the containers") && ok;
+      for(int i = 0; i < 1000; i++)
+      {
+        points.push_front(vec3((float)i));
+        rotations[-i] = quat<float>();
+      }
+      ok = check(nodes.getBytesReserved() == reserved, "PoolResource has to reuse freed nodes") && ok;
+
+      //Destroyed on another thread, the nodes still go back to the same resource
+      std::thread other([&points]() { points.clear(); });
+      other.join();
+      ok = check(nodes.getNumAllocated() == rotations.size(), "nodes freed on another thread have to return to the resource") && ok;
+    }
+    ok = check(nodes.getNumAllocated() == 0, "PoolResource count after destroying the containers") && ok;
+
+    PoolAllocator<vec3> a(&nodes), b(a);
+    PoolAllocator<mat4> rebound(a);
+    PoolResource other;
+    ok = check(a == b && rebound == a && a != PoolAllocator<vec3>(&other), "PoolAllocator equality follows the resource") && ok;
+    vec3* array = a.allocate(100);
+    ok = check(aligned(array, GUM_MATHS_DEFAULT_ALIGNMENT) && nodes.getNumAllocated() == 0, "arrays have to bypass the pools") && ok;
+    a.deallocate(array, 100);
+  }
+
+  return ok ? 0 : 1;
+}
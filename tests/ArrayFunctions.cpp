@@ -0,0 +1,153 @@
+#include <gum-maths.h>
+#include <algorithm>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+//Serial reductions that skip NaN, the index is the first occurrence
+template<typename T>
+void reference(const std::vector<T>& values, T& lo, T& hi, size_t& loIndex, size_t& hiIndex, double& total)
+{
+  lo = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+  hi = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+  loIndex = hiIndex = values.size();
+  total = 0.0;
+  for(size_t i = 0; i < values.size(); i++)
+  {
+    if(values[i] != values[i])
+      continue;
+    if(loIndex == values.size() || values[i] < lo) { lo = values[i]; loIndex = i; }
+    if(hiIndex == values.size() || values[i] > hi) { hi = values[i]; hiIndex = i; }
+    total += (double)values[i];
+  }
+}
+
+template<typename T>
+bool testReductions(const std::vector<T>& values, bool withNaN, const std::string& name)
+{
+  T lo, hi;
+  size_t loIndex, hiIndex;
+  double total;
+  reference(values, lo, hi, loIndex, hiIndex, total);
+  span<const T> view(values);
+
+  bool ok = check(minimum(view) == lo, name + ": minimum");
+  ok = check(maximum(view) == hi, name + ": maximum") && ok;
+  ok = check(argMin(view) == loIndex, name + ": argMin " + std::to_string(argMin(view)) + ", expected " + std::to_string(loIndex)) && ok;
+  ok = check(argMax(view) == hiIndex, name + ": argMax " + std::to_string(argMax(view)) + ", expected " + std::to_string(hiIndex)) && ok;
+  if(!withNaN)
+  {
+    //Float lanes add up one block of 2048 before widening, stay well below the serial error bound
+    double magnitude = 0.0;
+    for(T value : values)
+      magnitude += std::abs((double)value);
+    double result = (double)sum(view);
+    double tolerance = std::is_floating_point<T>::value ? 64.0 * std::numeric_limits<T>::epsilon() * magnitude : 0.0;
+    ok = check(std::abs(result - total) <= tolerance, name + ": sum " + std::to_string(result) + ", expected " + std::to_string(total)) && ok;
+  }
+  return ok;
+}
+
+//Keys of a few distinct values so stability matters, values are the original indices
+template<typename K>
+bool testRadixSort(size_t count, unsigned int bits, const std::string& name, std::mt19937_64& rng)
+{
+  std::vector<K> keys(count);
+  for(K& key : keys)
+    key = bits >= 64 ? (K)rng() : (K)(rng() & ((1ull << bits) - 1));
+
+  std::vector<uint32_t> order(count);
+  for(size_t i = 0; i < count; i++)
+    order[i] = (uint32_t)i;
+  std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+  std::vector<K> sortedKeys = keys, keysOnly = keys;
+  std::vector<uint32_t> values(count);
+  for(size_t i = 0; i < count; i++)
+    values[i] = (uint32_t)i;
+  radixSort(span<K>(sortedKeys), span<uint32_t>(values));
+  radixSort(span<K>(keysOnly));
+
+  bool sorted = true;
+  for(size_t i = 0; i < count && sorted; i++)
+    sorted = values[i] == order[i] && sortedKeys[i] == keys[order[i]] && keysOnly[i] == keys[order[i]];
+  return check(sorted, name + ": " + std::to_string(count) + " keys of " + std::to_string(bits) + " bits differ from std::stable_sort");
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Maths::max used to return the smallest element
+  std::vector<int> small = { 3, -1, 7, 2, 7 };
+  ok = check(Gum::Maths::max(small) == 7 && Gum::Maths::min(small) == -1, "Maths::max and Maths::min") && ok;
+  ok = check(Gum::Maths::max(std::vector<float>()) == 0.0f && Gum::Maths::min(std::vector<float>()) == 0.0f, "empty vectors give T()") && ok;
+
+  //Sizes below one packet, one chunk and many chunks, with and without NaN
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> uniform(-1000.0f, 1000.0f);
+  std::uniform_int_distribution<int32_t> integers(-1000000, 1000000);
+  for(size_t count : { (size_t)0, (size_t)1, (size_t)7, (size_t)5000, (size_t)100003 })
+  {
+    std::vector<float> floats(count);
+    std::vector<double> doubles(count);
+    std::vector<int32_t> ints(count);
+    std::vector<uint32_t> uints(count);
+    for(size_t i = 0; i < count; i++)
+    {
+      floats[i] = uniform(rng);
+      doubles[i] = (double)uniform(rng);
+      ints[i] = integers(rng);
+      uints[i] = (uint32_t)integers(rng) * 2654435761u;
+    }
+    std::string size = std::to_string(count);
+    ok = testReductions(floats, false, "float " + size) && ok;
+    ok = testReductions(doubles, false, "double " + size) && ok;
+    ok = testReductions(ints, false, "int32 " + size) && ok;
+    ok = testReductions(uints, false, "uint32 " + size) && ok;
+
+    for(size_t i = 0; i < count; i += 3)
+    {
+      floats[i] = std::numeric_limits<float>::quiet_NaN();
+      doubles[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    ok = testReductions(floats, true, "float with NaN " + size) && ok;
+    ok = testReductions(doubles, true, "double with NaN " + size) && ok;
+
+    std::vector<vec3> points(count / 3);
+    for(vec3& point : points)
+      point = vec3(uniform(rng), uniform(rng), uniform(rng));
+    bbox3 box = bounds(span<const vec3>(points));
+    vec3 lo = minimum(span<const vec3>(points)), hi = maximum(span<const vec3>(points));
+    bool inside = true;
+    for(const vec3& point : points)
+      for(unsigned int c = 0; c < 3; c++)
+        inside = inside && point.vals[c] >= lo.vals[c] && point.vals[c] <= hi.vals[c];
+    ok = check(inside && (points.empty() || (box.pos == lo && box.size == hi - lo)), "vec3 bounds " + size) && ok;
+  }
+
+  //All NaN gives the identities
+  std::vector<float> nans(100, std::numeric_limits<float>::quiet_NaN());
+  ok = check(minimum(span<const float>(nans)) == std::numeric_limits<float>::infinity() && maximum(span<const float>(nans)) == -std::numeric_limits<float>::infinity()
+          && argMin(span<const float>(nans)) == nans.size() && argMax(span<const float>(nans)) == nans.size(), "all NaN") && ok;
+
+  //Full width keys, keys using only their low bits (skipped passes) and many duplicates
+  std::mt19937_64 keyRng(5);
+  for(size_t count : { (size_t)0, (size_t)1, (size_t)7, (size_t)5000, (size_t)1000003 })
+  {
+    ok = testRadixSort<uint32_t>(count, 64, "uint32", keyRng) && ok;
+    ok = testRadixSort<uint32_t>(count, 5, "uint32", keyRng) && ok;
+    ok = testRadixSort<uint64_t>(count, 64, "uint64", keyRng) && ok;
+    ok = testRadixSort<uint64_t>(count, 30, "uint64", keyRng) && ok;
+  }
+
+  return ok ? 0 : 1;
+}
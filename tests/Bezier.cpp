@@ -0,0 +1,223 @@
+#include <gum-maths.h>
+#include <climits>
+#include <random>
+#include <sstream>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+template<typename T, unsigned int S>
+double difference(const tvec<T, S>& a, const tvec<T, S>& b)
+{
+  double worst = 0.0;
+  for(unsigned int c = 0; c < S; c++)
+    worst = std::max(worst, std::abs((double)a.vals[c] - (double)b.vals[c]));
+  return worst;
+}
+
+//sum B(i, D) P[i] straight from the definition
+template<unsigned int D>
+dvec3 bernsteinSum(const tbezier<double, 3, D>& curve, double t)
+{
+  dvec3 ret(0.0);
+  for(unsigned int i = 0; i <= D; i++)
+    ret += curve.points[i] * ((double)Gum::Maths::binomial(D, i) * std::pow(t, (double)i) * std::pow(1.0 - t, (double)(D - i)));
+  return ret;
+}
+
+typedef unsigned __int128 uint128;
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+  auto randomPoint = [&]() { return dvec3(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+  //Quintic, so the power basis has alternating binomial weights up to C(5, 2) * C(5, 5)
+  tbezier<double, 3, 5> curve;
+  for(dvec3& p : curve.points)
+    p = randomPoint();
+
+  //de Casteljau, Horner on the power basis, the batch and the plain definition give the same points
+  const size_t COUNT = 10000;
+  std::vector<double> params(COUNT);
+  for(size_t i = 0; i < COUNT; i++)
+    params[i] = (double)i / (double)(COUNT - 1);
+  std::vector<dvec3> batch(COUNT);
+  curve.evaluate(params.data(), batch.data(), COUNT);
+  double hornerError = 0.0, batchError = 0.0, definitionError = 0.0;
+  for(size_t i = 0; i < COUNT; i++)
+  {
+    dvec3 p = curve.evaluate(params[i]);
+    hornerError = std::max(hornerError, difference(curve.evaluateHorner(params[i]), p));
+    batchError = std::max(batchError, difference(batch[i], p));
+    definitionError = std::max(definitionError, difference(bernsteinSum(curve, params[i]), p));
+  }
+  ok = check(hornerError < 1e-11 && batchError < 1e-11 && definitionError < 1e-11, "evaluation differs, Horner " + std::to_string(hornerError) + ", batch " + std::to_string(batchError) + ", definition " + std::to_string(definitionError)) && ok;
+  ok = check(curve.evaluate(0.0) == curve.points[0] && curve.evaluate(1.0) == curve.points[5], "the curve has to start and end at its end points") && ok;
+
+  //Derivative against central differences, and the hodograph against the tangent
+  double tangentError = 0.0, hodographError = 0.0;
+  tbezier<double, 3, 4> hodograph = curve.derivative();
+  const double h = 1e-5;
+  for(unsigned int i = 1; i < 100; i++)
+  {
+    double t = (double)i / 100.0;
+    dvec3 position, tangent;
+    curve.evaluate(t, position, tangent);
+    dvec3 finite = (curve.evaluate(t + h) - curve.evaluate(t - h)) / (2.0 * h);
+    tangentError = std::max(tangentError, difference(tangent, finite));
+    tangentError = std::max(tangentError, difference(position, curve.evaluate(t)));
+    hodographError = std::max(hodographError, difference(hodograph.evaluate(t), tangent));
+  }
+  ok = check(tangentError < 1e-5, "tangent differs from the finite difference by " + std::to_string(tangentError)) && ok;
+  ok = check(hodographError < 1e-11, "derivative() differs from the tangent by " + std::to_string(hodographError)) && ok;
+
+  //Both halves of a split trace the original curve and meet with matching positions and scaled tangents
+  for(double at : { 0.3, 0.5, 0.85 })
+  {
+    tbezier<double, 3, 5> left, right;
+    curve.split(at, left, right);
+    double splitError = 0.0;
+    for(unsigned int i = 0; i <= 50; i++)
+    {
+      double u = (double)i / 50.0;
+      splitError = std::max(splitError, difference(left.evaluate(u), curve.evaluate(u * at)));
+      splitError = std::max(splitError, difference(right.evaluate(u), curve.evaluate(at + u * (1.0 - at))));
+    }
+    std::string name = "split at " + std::to_string(at);
+    ok = check(splitError < 1e-11, name + ": halves differ from the curve by " + std::to_string(splitError)) && ok;
+    ok = check(left.points[5] == right.points[0] && left.points[0] == curve.points[0] && right.points[5] == curve.points[5], name + ": end points") && ok;
+    double tangentJump = difference(left.tangent(1.0) / at, right.tangent(0.0) / (1.0 - at));
+    ok = check(tangentJump < 1e-9, name + ": tangents differ by " + std::to_string(tangentJump)) && ok;
+  }
+
+  //Curve tessellation, single and batched
+  {
+    std::vector<tbezier<double, 3, 5>> curves(300, curve);
+    for(tbezier<double, 3, 5>& c : curves)
+      for(dvec3& p : c.points)
+        p = randomPoint();
+    const unsigned int segments = 16;
+    std::vector<dvec3> single(segments + 1), all(curves.size() * (segments + 1));
+    tbezier<double, 3, 5>::tessellate(curves.data(), curves.size(), segments, all.data());
+    double tessellationError = 0.0;
+    bool batchMatches = true, endsExact = true;
+    for(size_t c = 0; c < curves.size(); c++)
+    {
+      curves[c].tessellate(segments, single.data());
+      endsExact = endsExact && single[0] == curves[c].points[0] && single[segments] == curves[c].points[5];
+      for(unsigned int i = 0; i <= segments; i++)
+      {
+        tessellationError = std::max(tessellationError, difference(single[i], curves[c].evaluate((double)i / segments)));
+        batchMatches = batchMatches && all[c * (segments + 1) + i] == single[i];
+      }
+    }
+    ok = check(tessellationError < 1e-11 && endsExact, "curve tessellation differs by " + std::to_string(tessellationError)) && ok;
+    ok = check(batchMatches, "batched curve tessellation has to match the single one") && ok;
+
+    single.assign(segments + 1, dvec3(7.0));
+    curve.tessellate(0, single.data());
+    ok = check(single[0] == dvec3(7.0), "tessellate without segments must not write") && ok;
+  }
+
+  //Surface tessellation against direct evaluation, normals against the cross product of finite differences
+  {
+    std::vector<tbeziersurface<double, 3, 3, 2>> surfaces(40);
+    for(tbeziersurface<double, 3, 3, 2>& surface : surfaces)
+      for(unsigned int j = 0; j <= 2; j++)
+        for(unsigned int i = 0; i <= 3; i++)
+          surface.points[j][i] = dvec3((double)i, (double)j, 0.0) * 3.0 + randomPoint() * 0.2;
+
+    const unsigned int uSegments = 7, vSegments = 5, stride = (uSegments + 1) * (vSegments + 1);
+    std::vector<dvec3> positions(stride), normals(stride), allPositions(surfaces.size() * stride), allNormals(surfaces.size() * stride);
+    tbeziersurface<double, 3, 3, 2>::tessellate(surfaces.data(), surfaces.size(), uSegments, vSegments, allPositions.data(), allNormals.data());
+    double positionError = 0.0, normalError = 0.0, finiteError = 0.0;
+    bool batchMatches = true, cornersExact = true;
+    for(size_t s = 0; s < surfaces.size(); s++)
+    {
+      const tbeziersurface<double, 3, 3, 2>& surface = surfaces[s];
+      surface.tessellate(uSegments, vSegments, positions.data(), normals.data());
+      cornersExact = cornersExact && difference(positions[0], surface.points[0][0]) < 1e-12 && difference(positions[stride - 1], surface.points[2][3]) < 1e-12;
+      for(unsigned int j = 0; j <= vSegments; j++)
+      {
+        for(unsigned int i = 0; i <= uSegments; i++)
+        {
+          double u = (double)i / uSegments, v = (double)j / vSegments;
+          unsigned int index = j * (uSegments + 1) + i;
+          positionError = std::max(positionError, difference(positions[index], surface.evaluate(u, v)));
+          normalError = std::max(normalError, difference(normals[index], surface.normal(u, v)));
+          dvec3 du = (surface.evaluate(std::min(u + h, 1.0), v) - surface.evaluate(std::max(u - h, 0.0), v));
+          dvec3 dv = (surface.evaluate(u, std::min(v + h, 1.0)) - surface.evaluate(u, std::max(v - h, 0.0)));
+          dvec3 finite = dvec3::cross(du, dv);
+          finiteError = std::max(finiteError, difference(normals[index], finite / finite.length()));
+          batchMatches = batchMatches && allPositions[s * stride + index] == positions[index] && allNormals[s * stride + index] == normals[index];
+        }
+      }
+    }
+    ok = check(positionError < 1e-11 && cornersExact, "surface tessellation differs by " + std::to_string(positionError)) && ok;
+    ok = check(normalError < 1e-11, "tessellated normals differ by " + std::to_string(normalError)) && ok;
+    //One sided differences at the borders are only first order accurate
+    ok = check(finiteError < 1e-3, "normals differ from finite differences by " + std::to_string(finiteError)) && ok;
+    ok = check(batchMatches, "batched surface tessellation has to match the single one") && ok;
+  }
+
+  //Binomials against Pascal's triangle in 128 bits, entries past 2^127 are only marked as too large.
+  //binomialCoeff has to be exact wherever the value fits into a long, and 0 with an error otherwise
+  {
+    const unsigned int ROWS = 201;
+    const uint128 TOO_LARGE = (uint128)1 << 127;
+    std::vector<uint128> row(ROWS + 1, 0), previous(ROWS + 1, 0);
+    size_t tableErrors = 0, coeffErrors = 0, exactOutsideTable = 0, overflows = 0;
+
+    std::stringstream errors;
+    std::streambuf* stderrBuffer = std::cerr.rdbuf(errors.rdbuf());
+    for(unsigned int n = 0; n < ROWS; n++)
+    {
+      for(unsigned int k = 0; k <= n; k++)
+      {
+        uint128 a = k > 0 ? previous[k - 1] : 0, b = k < n ? previous[k] : 0;
+        row[k] = k == 0 ? 1 : (a >= TOO_LARGE || b >= TOO_LARGE || a + b >= TOO_LARGE ? TOO_LARGE : a + b);
+      }
+
+      for(unsigned int k = 0; k <= n + 1; k++)
+      {
+        uint128 exact = k <= n ? row[k] : 0;
+        uint64_t table = Gum::Maths::binomial(n, k);
+        tableErrors += n < Gum::Maths::BINOMIAL_TABLE_ROWS ? table != exact : table != 0;
+
+        long coeff = Gum::Maths::binomialCoeff((int)n, (int)k);
+        if(exact <= (uint128)LONG_MAX)
+        {
+          coeffErrors += coeff != (long)exact;
+          exactOutsideTable += n >= Gum::Maths::BINOMIAL_TABLE_ROWS;
+        }
+        else
+        {
+          coeffErrors += coeff != 0;
+          overflows++;
+        }
+      }
+      std::swap(row, previous);
+    }
+    coeffErrors += Gum::Maths::binomialCoeff(5, -1) != 0 || Gum::Maths::binomialCoeff(-3, 2) != 0;
+    std::cerr.rdbuf(stderrBuffer);
+
+    size_t messages = 0;
+    for(std::string line; std::getline(errors, line);)
+      messages += line.find("overflows") != std::string::npos;
+
+    ok = check(tableErrors == 0, std::to_string(tableErrors) + " wrong binomial table entries") && ok;
+    ok = check(coeffErrors == 0, std::to_string(coeffErrors) + " wrong binomialCoeff results") && ok;
+    ok = check(exactOutsideTable > 1000 && overflows > 1000, "the test has to reach the exact fallback and the overflow path") && ok;
+    ok = check(messages == overflows, std::to_string(messages) + " overflow errors for " + std::to_string(overflows) + " overflows") && ok;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#include <gum-maths.h>
+#include <cstdio>
+#include <cstring>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+int main(int argc, char** argv)
+{
+  const std::string path = "BinaryFileTest.gumb";
+  std::vector<vec3> points;
+  std::vector<mat4> transforms;
+  std::vector<fquat> rotations;
+  for(int i = 0; i < 10000; i++)
+  {
+    points.push_back(vec3((float)i, i * 0.5f, -i * 0.25f));
+    transforms.push_back(Gum::Maths::translateMatrix(vec3((float)i, 1.0f, 2.0f)));
+    rotations.push_back(fquat::toQuaternion(vec3((float)(i % 360), 0.0f, 0.0f)));
+  }
+
+  Gum::Maths::BinaryFileWriter writer;
+  bool ok = writer.open(path);
+  ok = ok && writer.beginSection<vec3>("points");
+  ok = ok && writer.write(points.data(), 5000);  //Streamed in two parts
+  ok = ok && writer.write(points.data() + 5000, points.size() - 5000);
+  ok = ok && writer.endSection();
+  ok = ok && writer.writeSection("transforms", transforms.data(), transforms.size());
+  ok = ok && writer.writeSection("rotations", rotations.data(), rotations.size());
+  ok = ok && !writer.write(points.data(), 1); //Not inside a section
+  ok = ok && writer.close();
+  if(!check(ok, "writing " + path))
+    return 1;
+
+  Gum::Maths::BinaryFileReader reader;
+  if(!check(reader.open(path, true), "reading " + path))
+    return 1;
+
+  Gum::Maths::span<const vec3> readPoints = reader.get<vec3>("points");
+  Gum::Maths::span<const mat4> readTransforms = reader.get<mat4>("transforms");
+  Gum::Maths::span<const fquat> readRotations = reader.get<fquat>(2);
+
+  ok = check(reader.numSections() == 3, "section count");
+  ok = check(readPoints.size() == points.size() && memcmp(readPoints.data(), points.data(), readPoints.sizeBytes()) == 0, "points") && ok;
+  ok = check(readTransforms.size() == transforms.size() && memcmp(readTransforms.data(), transforms.data(), readTransforms.sizeBytes()) == 0, "transforms") && ok;
+  ok = check(readRotations.size() == rotations.size() && memcmp(readRotations.data(), rotations.data(), readRotations.sizeBytes()) == 0, "rotations") && ok;
+  ok = check(reader.get<dvec3>("points").empty(), "type mismatch has to be rejected") && ok;
+  ok = check(reader.get<vec3>("missing").empty(), "missing section") && ok;
+  reader.close();
+
+  //Flip one byte inside the point data, the checksum has to catch it
+  FILE* file = fopen(path.c_str(), "r+b");
+  fseek(file, 64 + 100, SEEK_SET);
+  fputc(0xFF, file);
+  fclose(file);
+  ok = check(reader.open(path) && !reader.verify(), "corruption has to fail verification") && ok;
+  reader.close();
+
+  //Section offset chosen so that offset + size wraps around, with a matching table checksum
+  Gum::Maths::BinaryFileHeader header;
+  file = fopen(path.c_str(), "r+b");
+  ok = check(fread(&header, sizeof(header), 1, file) == 1, "reading the header back") && ok;
+  std::vector<Gum::Maths::BinarySectionEntry> table(header.sectionCount);
+  fseek(file, (long)header.tableOffset, SEEK_SET);
+  ok = check(fread(table.data(), sizeof(table[0]), table.size(), file) == table.size(), "reading the section table back") && ok;
+  table[0].offset = ~(uint64_t)63;
+  header.tableChecksum = Gum::Maths::BinaryChecksum::compute(table.data(), table.size() * sizeof(table[0]));
+  fseek(file, (long)header.tableOffset, SEEK_SET);
+  fwrite(table.data(), sizeof(table[0]), table.size(), file);
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, file);
+  fclose(file);
+  ok = check(!reader.open(path), "wrapping section bounds have to be rejected") && ok;
+  reader.close();
+
+  remove(path.c_str());
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <gum-maths.h>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using Gum::Maths::DepthRange;
+
+//Largest element of |a * b - I|
+float identityError(mat4 a, const mat4& b)
+{
+  mat4 product = a * b;
+  float worst = 0.0f;
+  for(unsigned int col = 0; col < 4; col++)
+    for(unsigned int row = 0; row < 4; row++)
+      worst = std::max(worst, std::abs(product[col][row] - (col == row ? 1.0f : 0.0f)));
+  return worst;
+}
+
+//Clip space depth of a point on the view axis at distance z
+float depthAt(mat4 projection, float z)
+{
+  vec4 clip = projection * vec4(0.0f, 0.0f, -z, 1.0f);
+  return clip.z / clip.w;
+}
+
+bool orthonormal(const camera& cam)
+{
+  vec3 r = cam.getRight(), u = cam.getUp(), f = cam.getForward();
+  return std::abs(r.length() - 1.0f) < 1e-5f && std::abs(u.length() - 1.0f) < 1e-5f && std::abs(f.length() - 1.0f) < 1e-5f
+      && std::abs(vec3::dot(r, u)) < 1e-5f && std::abs(vec3::dot(r, f)) < 1e-5f && std::abs(vec3::dot(u, f)) < 1e-5f;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+  const float zNear = 0.1f, zFar = 1000.0f;
+  const DepthRange ranges[] = { DepthRange::NEGATIVE_ONE_TO_ONE, DepthRange::ZERO_TO_ONE };
+
+  //Every projection variant has to invert exactly enough and map near and far to the ends of its depth range
+  for(unsigned int orthographic = 0; orthographic < 2; orthographic++)
+  {
+    for(unsigned int r = 0; r < 2; r++)
+    {
+      for(unsigned int reversed = 0; reversed < 2; reversed++)
+      {
+        for(unsigned int infinite = 0; infinite < 2; infinite++)
+        {
+          camera cam(vec3(1.0f, 2.0f, 3.0f), quat<float>(1.0f, 0.0f, 0.0f, 0.0f), 60.0f, 16.0f / 9.0f, zNear, zFar);
+          if(orthographic)
+            cam.setOrthographic(-4.0f, 6.0f, -2.0f, 3.0f, zNear, zFar);
+          cam.setDepthRange(ranges[r]);
+          cam.setReversedZ(reversed);
+          cam.setInfiniteFar(infinite);
+          std::string name = std::string(orthographic ? "orthographic" : "perspective") + (r ? " [0,1]" : " [-1,1]") + (reversed ? " reversed" : "") + (infinite ? " infinite" : "");
+
+          //The other way around the inverse holds terms as large as far, which round on their own scale
+          float error = identityError(cam.getProjection(), cam.getInverseProjection());
+          float inverseError = identityError(cam.getInverseProjection(), cam.getProjection());
+          ok = check(error < 1e-6f, name + ": P * P^-1 is " + std::to_string(error) + " away from identity") && ok;
+          ok = check(inverseError < 1e-6f * zFar, name + ": P^-1 * P is " + std::to_string(inverseError) + " away from identity") && ok;
+
+          float lower = r ? 0.0f : -1.0f;
+          float nearDepth = reversed ? 1.0f : lower, farDepth = reversed ? lower : 1.0f;
+          ok = check(std::abs(depthAt(cam.getProjection(), zNear) - nearDepth) < 1e-5f, name + ": near plane depth " + std::to_string(depthAt(cam.getProjection(), zNear))) && ok;
+          if(!infinite || orthographic)
+            ok = check(std::abs(depthAt(cam.getProjection(), zFar) - farDepth) < 1e-3f, name + ": far plane depth " + std::to_string(depthAt(cam.getProjection(), zFar))) && ok;
+          else
+            ok = check(std::abs(depthAt(cam.getProjection(), 1e30f) - farDepth) < 1e-5f, name + ": infinite far depth " + std::to_string(depthAt(cam.getProjection(), 1e30f))) && ok;
+        }
+      }
+    }
+  }
+
+  //lookAt points the camera at the target with up on the positive side
+  camera cam;
+  cam.setPosition(vec3(1.0f, 2.0f, 3.0f));
+  cam.lookAt(vec3(4.0f, -2.0f, 3.0f));
+  ok = check((cam.getForward() - vec3(0.6f, -0.8f, 0.0f)).length() < 1e-5f && cam.getUp().y > 0.0f && orthonormal(cam), "lookAt") && ok;
+  float viewError = std::max(identityError(cam.getView(), cam.getInverseView()), identityError(cam.getViewProjection(), cam.getInverseViewProjection()));
+  ok = check(viewError < 1e-5f, "V * V^-1 and VP * VP^-1 are " + std::to_string(viewError) + " away from identity") && ok;
+
+  //The target at the camera position keeps the rotation
+  quat<float> before = cam.getRotation();
+  cam.lookAt(cam.getPosition());
+  ok = check(cam.getRotation() == before, "lookAt at the own position has to keep the rotation") && ok;
+
+  //Looking along up, or with a zero up vector, still gives a finite orthonormal basis
+  const vec3 ups[] = { vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, -1.0f, 0.0f), vec3(0.0f, 0.0f, 0.0f) };
+  for(const vec3& up : ups)
+  {
+    cam.lookAt(cam.getPosition() + vec3(0.0f, 5.0f, 0.0f), up);
+    ok = check(orthonormal(cam) && (cam.getForward() - vec3(0.0f, 1.0f, 0.0f)).length() < 1e-5f, "lookAt along the up vector") && ok;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include <gum-maths.h>
+#include <map>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+template<typename T>
+dvec3 toDouble(const tvec<T, 3>& point) { return dvec3((double)point.x, (double)point.y, (double)point.z); }
+
+//Points closer to the hull than this count as inside, see convexHull
+template<typename T>
+double hullTolerance(const std::vector<tvec<T, 3>>& points)
+{
+  dvec3 extent(0.0);
+  for(const tvec<T, 3>& point : points)
+    for(unsigned int axis = 0; axis < 3; axis++)
+      extent.vals[axis] = std::max(extent.vals[axis], std::abs((double)point.vals[axis]));
+  return 3.0 * std::numeric_limits<T>::epsilon() * (extent.x + extent.y + extent.z);
+}
+
+//Largest distance of any input point in front of any hull triangle
+template<typename T>
+double worstOutside(const std::vector<tvec<T, 3>>& points, const std::vector<uint32_t>& triangles)
+{
+  double worst = 0.0;
+  for(size_t t = 0; t < triangles.size(); t += 3)
+  {
+    dvec3 a = toDouble(points[triangles[t]]);
+    dvec3 normal = dvec3::cross(toDouble(points[triangles[t + 1]]) - a, toDouble(points[triangles[t + 2]]) - a);
+    normal = normal / normal.length();
+    for(const tvec<T, 3>& point : points)
+    {
+      dvec3 d = toDouble(point) - a;
+      worst = std::max(worst, normal.x * d.x + normal.y * d.y + normal.z * d.z);
+    }
+  }
+  return worst;
+}
+
+//Twins pair up, every face is a closed loop and V - E + F = 2
+bool validHalfEdges(const Gum::Maths::ConvexHull& hull)
+{
+  const std::vector<Gum::Maths::HullHalfEdge>& edges = hull.edges;
+  for(size_t e = 0; e < edges.size(); e++)
+  {
+    const Gum::Maths::HullHalfEdge& twin = edges[edges[e].twin];
+    if(twin.twin != e || twin.vertex != edges[edges[e].next].vertex || twin.face == edges[e].face)
+      return false;
+  }
+
+  size_t visited = 0;
+  for(size_t f = 0; f < hull.faces.size(); f++)
+  {
+    uint32_t e = hull.faces[f];
+    do
+    {
+      if(edges[e].face != f || ++visited > edges.size())
+        return false;
+      e = edges[e].next;
+    } while(e != hull.faces[f]);
+  }
+  return visited == edges.size() && (long)hull.vertices.size() - (long)edges.size() / 2 + (long)hull.faces.size() == 2;
+}
+
+template<typename T>
+bool testHull(const std::vector<tvec<T, 3>>& points, Gum::Maths::HullMode mode, const std::string& name)
+{
+  std::vector<uint32_t> triangles;
+  Gum::Maths::ConvexHull hull;
+  bool ok = check(Gum::Maths::convexHull(points.data(), points.size(), triangles, mode), name + ": hull has to be found");
+  ok = check(Gum::Maths::convexHull(points.data(), points.size(), hull, mode), name + ": half-edge hull has to be found") && ok;
+
+  //Neighboring triangles never fold inwards, decided exactly
+  size_t concave = 0;
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> opposite;
+  for(size_t t = 0; t < triangles.size(); t += 3)
+    for(unsigned int i = 0; i < 3; i++)
+      opposite[{ triangles[t + i], triangles[t + (i + 1) % 3] }] = triangles[t + (i + 2) % 3];
+  for(size_t t = 0; t < triangles.size(); t += 3)
+  {
+    for(unsigned int i = 0; i < 3; i++)
+    {
+      auto across = opposite.find({ triangles[t + (i + 1) % 3], triangles[t + i] });
+      if(across == opposite.end() || Gum::Maths::orient3d(toDouble(points[triangles[t]]), toDouble(points[triangles[t + 1]]), toDouble(points[triangles[t + 2]]), toDouble(points[across->second])) < 0.0)
+        concave++;
+    }
+  }
+  ok = check(concave == 0, name + ": " + std::to_string(concave) + " open or concave triangle edges") && ok;
+
+  double worst = worstOutside(points, triangles), tolerance = hullTolerance(points);
+  ok = check(worst <= tolerance * 1.001, name + ": a point lies " + std::to_string(worst) + " outside of the hull, the tolerance is " + std::to_string(tolerance)) && ok;
+  ok = check(validHalfEdges(hull), name + ": inconsistent half-edges") && ok;
+  return ok;
+}
+
+template<typename T>
+std::vector<tvec<T, 3>> spherePoints(size_t count, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> gaussian;
+  std::vector<tvec<T, 3>> points(count);
+  for(tvec<T, 3>& point : points)
+  {
+    dvec3 direction(gaussian(rng), gaussian(rng), gaussian(rng));
+    direction = direction / direction.length();
+    point = tvec<T, 3>((T)direction.x, (T)direction.y, (T)direction.z);
+  }
+  return points;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+  const Gum::Maths::HullMode modes[] = { Gum::Maths::HullMode::SERIAL, Gum::Maths::HullMode::PARALLEL };
+  const std::string modeNames[] = { "serial", "parallel" };
+
+  //Points on a sphere all lie on the hull, neighboring triangles are nearly coplanar
+  for(unsigned int seed = 1; seed <= 3; seed++)
+  {
+    ok = testHull(spherePoints<float>(4000, seed), Gum::Maths::HullMode::SERIAL, "float sphere " + std::to_string(seed)) && ok;
+    ok = testHull(spherePoints<double>(4000, seed), Gum::Maths::HullMode::SERIAL, "double sphere " + std::to_string(seed)) && ok;
+  }
+
+  //Large enough to be split into chunks, most points are inside
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  std::vector<vec3> cube(40000);
+  for(vec3& point : cube)
+    point = vec3(uniform(rng), uniform(rng), uniform(rng));
+  for(unsigned int m = 0; m < 2; m++)
+    ok = testHull(cube, modes[m], "float cube " + modeNames[m]) && ok;
+
+  //A grid has coplanar points everywhere, the half-edge hull has to merge them into a cube
+  std::vector<dvec3> grid;
+  for(int x = 0; x < 10; x++)
+    for(int y = 0; y < 10; y++)
+      for(int z = 0; z < 10; z++)
+        grid.push_back(dvec3(x, y, z));
+  ok = testHull(grid, Gum::Maths::HullMode::SERIAL, "grid") && ok;
+  Gum::Maths::ConvexHull box;
+  Gum::Maths::convexHull(grid.data(), grid.size(), box);
+  ok = check(box.vertices.size() == 8 && box.faces.size() == 6 && box.edges.size() == 24, "grid hull has to be a cube") && ok;
+
+  //All points in one plane
+  std::vector<uint32_t> triangles;
+  std::vector<vec3> flat = { vec3(0, 0, 0), vec3(1, 0, 0), vec3(0, 1, 0), vec3(1, 1, 0), vec3(0.5f, 0.5f, 0) };
+  ok = check(!Gum::Maths::convexHull(flat.data(), flat.size(), triangles) && triangles.empty(), "flat input has to be rejected") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <gum-maths.h>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+template<typename T>
+T difference(mat<T,4,4> a, mat<T,4,4> b)
+{
+  T worst = 0;
+  for(unsigned int col = 0; col < 4; col++)
+    for(unsigned int row = 0; row < 4; row++)
+      worst = std::max(worst, std::abs(a[col][row] - b[col][row]));
+  return worst;
+}
+
+//Translation * rotation * scale * shear, shear is upper triangular so it is not symmetric like the stretch of
+//composeMatrix(). Every third matrix mirrors one axis, every fifth all three
+template<typename T>
+std::vector<mat<T,4,4>> randomTransforms(size_t count, bool withShear, std::mt19937& rng)
+{
+  std::uniform_real_distribution<T> unit(-1, 1), positive((T)0.2, (T)4);
+  std::vector<mat<T,4,4>> matrices(count);
+  for(size_t i = 0; i < count; i++)
+  {
+    quat<T> rotation = quat<T>::normalize(quat<T>(unit(rng), unit(rng), unit(rng), unit(rng)));
+    tvec<T, 3> scale(positive(rng), positive(rng), positive(rng));
+    if(i % 3 == 0) scale.vals[i % 9 / 3] *= (T)-1;
+    if(i % 5 == 0) scale = scale * (T)-1;
+    mat<T,4,4> shear;
+    if(withShear)
+    {
+      shear[1][0] = unit(rng) * (T)0.5;
+      shear[2][0] = unit(rng) * (T)0.5;
+      shear[2][1] = unit(rng) * (T)0.5;
+    }
+    matrices[i] = translateMatrix<T>(tvec<T, 3>(unit(rng), unit(rng), unit(rng)) * (T)10) * rotateMatrix<T>(rotation) * scaleMatrix<T>(scale) * shear;
+  }
+  return matrices;
+}
+
+template<typename T>
+bool testDecomposition(T tolerance, const std::string& name)
+{
+  bool ok = true;
+  std::mt19937 rng(17);
+  for(bool withShear : { false, true })
+  {
+    std::string variant = name + (withShear ? " with shear" : " without shear");
+    std::vector<mat<T,4,4>> matrices = randomTransforms<T>(3000, withShear, rng);
+    const size_t count = matrices.size();
+
+    //composeMatrix(decomposeMatrix(m)) gives m back, rotations are proper and the shear is 0 without one
+    size_t failed = 0, badRotations = 0, badScales = 0, badShears = 0;
+    T worst = 0;
+    std::vector<tvec<T, 3>> translations(count), scales(count), shears(count);
+    std::vector<quat<T>> rotations(count);
+    for(size_t i = 0; i < count; i++)
+    {
+      failed += !decomposeMatrix<T>(matrices[i], translations[i], rotations[i], scales[i], shears[i]);
+      worst = std::max(worst, difference(composeMatrix<T>(translations[i], rotations[i], scales[i], shears[i]), matrices[i]));
+      const quat<T>& q = rotations[i];
+      badRotations += std::abs(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z - (T)1) > tolerance;
+
+      //The reflection ends up in the sign of the scale, the product of the scales has the sign of the determinant
+      mat<T,3,3> upper(matrices[i]);
+      badScales += (scales[i].x * scales[i].y * scales[i].z < 0) != (upper.determinant() < 0);
+      if(!withShear)
+      {
+        //Without shear the stretch is diagonal and the scale magnitudes are the column lengths
+        tvec<T, 3> lengths = scaleFromMatrix<T>(matrices[i]);
+        badShears += std::abs(shears[i].x) > tolerance || std::abs(shears[i].y) > tolerance || std::abs(shears[i].z) > tolerance;
+        for(unsigned int c = 0; c < 3; c++)
+          badScales += std::abs(std::abs(scales[i].vals[c]) - lengths.vals[c]) > tolerance * lengths.vals[c];
+      }
+    }
+    ok = check(failed == 0, variant + ": " + std::to_string(failed) + " decompositions failed") && ok;
+    ok = check(worst < tolerance * 16, variant + ": recomposed matrices differ by " + std::to_string(worst)) && ok;
+    ok = check(badRotations == 0, variant + ": " + std::to_string(badRotations) + " rotations are not unit quaternions") && ok;
+    ok = check(badScales == 0, variant + ": " + std::to_string(badScales) + " wrong scales") && ok;
+    ok = check(badShears == 0, variant + ": " + std::to_string(badShears) + " shears on matrices without one") && ok;
+
+    //The batch gives the same results, unused outputs may be nullptr
+    std::vector<tvec<T, 3>> batchTranslations(count), batchScales(count), batchShears(count);
+    std::vector<quat<T>> batchRotations(count);
+    decomposeMatrices<T>(matrices.data(), batchTranslations.data(), batchRotations.data(), batchScales.data(), batchShears.data(), count);
+    std::vector<tvec<T, 3>> onlyScales(count);
+    decomposeMatrices<T>(matrices.data(), nullptr, nullptr, onlyScales.data(), nullptr, count);
+    size_t mismatches = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+      mismatches += !(batchTranslations[i] == translations[i]) || !(batchRotations[i] == rotations[i]) || !(batchScales[i] == scales[i]) || !(batchShears[i] == shears[i]);
+      mismatches += !(onlyScales[i] == scales[i]);
+    }
+    ok = check(mismatches == 0, variant + ": " + std::to_string(mismatches) + " batched decompositions differ from the scalar ones") && ok;
+  }
+
+  //A singular matrix is reported, translation and column lengths are still filled
+  mat<T,4,4> flat = translateMatrix<T>(tvec<T, 3>(1, 2, 3)) * scaleMatrix<T>(tvec<T, 3>(2, 0, 3));
+  tvec<T, 3> translation, scale, shear;
+  quat<T> rotation;
+  bool singular = !decomposeMatrix<T>(flat, translation, rotation, scale, shear);
+  ok = check(singular && translation == tvec<T, 3>(1, 2, 3) && scale == tvec<T, 3>(2, 0, 3), name + ": singular matrix") && ok;
+
+  //scaleFromMatrix stays unsigned for mirroring matrices
+  mat<T,4,4> mirror = scaleMatrix<T>(tvec<T, 3>(-2, 3, 4));
+  ok = check(scaleFromMatrix<T>(mirror) == tvec<T, 3>(2, 3, 4), name + ": scaleFromMatrix has to give column lengths") && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = testDecomposition<float>(1e-5f, "float");
+  ok = testDecomposition<double>(1e-13, "double") && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include <gum-maths.h>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+//Small integers keep every partial sum exact, so the blocked product has to match the naive one bit for bit
+template<typename T>
+bool testProduct(size_t m, size_t k, size_t n, Gum::Maths::MatrixLayout layout, std::mt19937& random)
+{
+  std::uniform_int_distribution<int> value(-4, 4);
+  dmatrix<T> a(m, k, layout), bt(n, k), c(m, n, layout), expected(m, n);
+  for(size_t r = 0; r < m; r++) for(size_t i = 0; i < k; i++) a(r, i) = (T)value(random);
+  for(size_t r = 0; r < n; r++) for(size_t i = 0; i < k; i++) bt(r, i) = (T)value(random);
+  for(size_t r = 0; r < m; r++) for(size_t i = 0; i < n; i++) c(r, i) = (T)value(random);
+
+  //C = 2 * A * B + 3 * C with B given as a transposed view
+  for(size_t r = 0; r < m; r++)
+    for(size_t i = 0; i < n; i++)
+    {
+      T sum = T(0);
+      for(size_t j = 0; j < k; j++)
+        sum += a(r, j) * bt(i, j);
+      expected(r, i) = 2 * sum + 3 * c(r, i);
+    }
+
+  //Mutable views and plain literals, T comes from C
+  bool ok = Gum::Maths::gemm(2, a.view(), bt.view().transpose(), 3, c.view());
+  size_t wrong = 0;
+  for(size_t r = 0; r < m; r++)
+    for(size_t i = 0; i < n; i++)
+      if(c(r, i) != expected(r, i))
+        wrong++;
+  return check(ok && wrong == 0, std::to_string(wrong) + " wrong elements in " + std::to_string(m) + "x" + std::to_string(k) + " * " + std::to_string(k) + "x" + std::to_string(n));
+}
+
+int main(int argc, char** argv)
+{
+  std::mt19937 random(11);
+  const size_t sizes[][3] = { {1, 1, 1}, {3, 5, 7}, {4, 8, 8}, {65, 257, 33}, {130, 300, 270}, {17, 0, 9} };
+  bool ok = true;
+  for(const auto& size : sizes)
+  {
+    ok = testProduct<float>(size[0], size[1], size[2], Gum::Maths::MatrixLayout::ROW_MAJOR, random) && ok;
+    ok = testProduct<float>(size[0], size[1], size[2], Gum::Maths::MatrixLayout::COLUMN_MAJOR, random) && ok;
+    ok = testProduct<double>(size[0], size[1], size[2], Gum::Maths::MatrixLayout::ROW_MAJOR, random) && ok;
+  }
+
+  //Whole matrix overloads, gemv against the product with a single column
+  dmatrixf a(37, 19), x(19, 1), y(37, 1), expected(37, 1);
+  for(size_t r = 0; r < 37; r++) for(size_t c = 0; c < 19; c++) a(r, c) = (float)((r * 7 + c * 3) % 9) - 4.0f;
+  for(size_t r = 0; r < 19; r++) x(r, 0) = (float)(r % 5) - 2.0f;
+  ok = check(Gum::Maths::gemm(1.0f, a, x, 0.0f, expected), "gemm on whole matrices") && ok;
+  ok = check(Gum::Maths::gemv(1.0f, a, x, 0.0f, y), "gemv on whole matrices") && ok;
+  bool same = true;
+  for(size_t r = 0; r < 37; r++)
+    same = same && y(r, 0) == expected(r, 0);
+  ok = check(same, "gemv has to match gemm") && ok;
+  ok = check(!Gum::Maths::gemm(1.0f, a, a, 0.0f, y), "dimension mismatch has to be rejected") && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include <gum-maths.h>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+//Like std::max, but keeps a NaN error instead of dropping it
+template<typename T>
+T worse(T a, T b)
+{
+  return b > a || b != b ? b : a;
+}
+
+template<typename T>
+mat<T,3,3> rotation3(const quat<T>& q)
+{
+  return mat<T,3,3>(rotateMatrix<T>(q));
+}
+
+//R * diag(values) * R^T, the columns of R are the eigenvectors
+template<typename T>
+mat<T,3,3> symmetric(const mat<T,3,3>& r, const tvec<T, 3>& values)
+{
+  mat<T,3,3> a;
+  for(unsigned int col = 0; col < 3; col++)
+    for(unsigned int row = 0; row < 3; row++)
+      a[col][row] = r[0][row] * values.x * r[0][col] + r[1][row] * values.y * r[1][col] + r[2][row] * values.z * r[2][col];
+  return a;
+}
+
+//Largest of |A v - l v| over the eigenpairs and |V^T V - I|, relative to the largest eigenvalue, and the determinant of V
+template<typename T>
+void residuals(const mat<T,3,3>& a, const tvec<T, 3>& values, const mat<T,3,3>& vectors, T scale, T& eigenError, T& orthoError, T& det)
+{
+  eigenError = orthoError = 0;
+  for(unsigned int i = 0; i < 3; i++)
+  {
+    for(unsigned int row = 0; row < 3; row++)
+    {
+      T av = a[0][row] * vectors[i][0] + a[1][row] * vectors[i][1] + a[2][row] * vectors[i][2];
+      eigenError = worse(eigenError, std::abs(av - values.vals[i] * vectors[i][row]) / scale);
+    }
+    for(unsigned int j = 0; j < 3; j++)
+    {
+      T dot = vectors[i][0] * vectors[j][0] + vectors[i][1] * vectors[j][1] + vectors[i][2] * vectors[j][2];
+      orthoError = worse(orthoError, std::abs(dot - (i == j ? (T)1 : (T)0)));
+    }
+  }
+  det = vectors[0][0] * (vectors[1][1] * vectors[2][2] - vectors[1][2] * vectors[2][1])
+      - vectors[0][1] * (vectors[1][0] * vectors[2][2] - vectors[1][2] * vectors[2][0])
+      + vectors[0][2] * (vectors[1][0] * vectors[2][1] - vectors[1][1] * vectors[2][0]);
+}
+
+//Random spectra with distinct, repeated, zero and negative eigenvalues
+template<typename T>
+tvec<T, 3> spectrum(unsigned int i, std::mt19937& rng)
+{
+  std::uniform_real_distribution<T> value(-10, 10);
+  tvec<T, 3> v(value(rng), value(rng), value(rng));
+  switch(i % 6)
+  {
+    case 1: v.y = v.x; break;
+    case 2: v.y = v.z = v.x; break;
+    case 3: v.z = 0; break;
+    case 4: v.x = v.y = 0; break;
+    case 5: v = tvec<T, 3>(std::abs(v.x), std::abs(v.x) * (T)1e-4, 0); break;
+  }
+  return v;
+}
+
+template<typename T>
+bool testScalar(T tolerance, const std::string& name)
+{
+  bool ok = true;
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<T> unit(-1, 1);
+  size_t wrongValues = 0, wrongVectors = 0, wrongBasis = 0, wrongQuats = 0;
+  for(unsigned int i = 0; i < 6000; i++)
+  {
+    tvec<T, 3> values = spectrum<T>(i, rng);
+    quat<T> q = quat<T>::normalize(quat<T>(unit(rng), unit(rng), unit(rng), unit(rng)));
+    mat<T,3,3> a = symmetric<T>(rotation3<T>(q), values);
+
+    tvec<T, 3> eigenvalues;
+    mat<T,3,3> eigenvectors;
+    eigenSymmetric<T>(a, eigenvalues, eigenvectors);
+
+    T expected[3] = { values.x, values.y, values.z };
+    std::sort(expected, expected + 3, std::greater<T>());
+    T scale = std::max(std::max(std::abs(expected[0]), std::abs(expected[2])), (T)1);
+    for(unsigned int k = 0; k < 3; k++)
+      wrongValues += !(std::abs(eigenvalues.vals[k] - expected[k]) <= tolerance * scale);
+
+    T eigenError, orthoError, det;
+    residuals<T>(a, eigenvalues, eigenvectors, scale, eigenError, orthoError, det);
+    wrongVectors += !(eigenError <= tolerance);
+    wrongBasis += !(orthoError <= tolerance && std::abs(det - (T)1) <= tolerance);
+
+    //The rotation overload has to describe the same basis
+    quat<T> rotation;
+    eigenSymmetric<T>(a, eigenvalues, rotation);
+    mat<T,3,3> fromQuat = rotation3<T>(rotation);
+    T quatError = 0;
+    for(unsigned int col = 0; col < 3; col++)
+      for(unsigned int row = 0; row < 3; row++)
+        quatError = worse(quatError, std::abs(fromQuat[col][row] - eigenvectors[col][row]));
+    wrongQuats += !(quatError <= tolerance * 4);
+  }
+  ok = check(wrongValues == 0, name + ": " + std::to_string(wrongValues) + " wrong eigenvalues") && ok;
+  ok = check(wrongVectors == 0, name + ": " + std::to_string(wrongVectors) + " matrices with A v != l v") && ok;
+  ok = check(wrongBasis == 0, name + ": " + std::to_string(wrongBasis) + " eigenvector bases are not orthonormal and right handed") && ok;
+  ok = check(wrongQuats == 0, name + ": " + std::to_string(wrongQuats) + " rotations differ from the eigenvectors") && ok;
+
+  //Already diagonal and zero matrices
+  mat<T,3,3> diagonal;
+  diagonal[0][0] = 2; diagonal[1][1] = 5; diagonal[2][2] = -1;
+  tvec<T, 3> eigenvalues;
+  mat<T,3,3> eigenvectors;
+  eigenSymmetric<T>(diagonal, eigenvalues, eigenvectors);
+  ok = check(eigenvalues == tvec<T, 3>(5, 2, -1) && std::abs(eigenvectors[0][1]) == (T)1 && std::abs(eigenvectors[1][0]) == (T)1, name + ": diagonal matrix") && ok;
+  eigenSymmetric<T>(mat<T,3,3>((T)0), eigenvalues, eigenvectors);
+  T eigenError, orthoError, det;
+  residuals<T>(mat<T,3,3>((T)0), eigenvalues, eigenvectors, (T)1, eigenError, orthoError, det);
+  ok = check(eigenvalues == tvec<T, 3>((T)0) && orthoError < tolerance && det > (T)0, name + ": zero matrix") && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = testScalar<float>(2e-5f, "float");
+  ok = testScalar<double>(1e-12, "double") && ok;
+
+  //quat(mat3) round trip through every branch: trace >= 0 and each of x, y, z dominant
+  {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::vector<dquat> quats = { dquat(1, 0, 0, 0), dquat(0, 1, 0, 0), dquat(0, 0, 1, 0), dquat(0, 0, 0, 1) };
+    for(unsigned int i = 0; i < 10000; i++)
+      quats.push_back(dquat::normalize(dquat(unit(rng) * (i % 4 == 0 ? 1.0 : 0.1), unit(rng), unit(rng), unit(rng))));
+    double worst = 0.0;
+    for(const dquat& q : quats)
+    {
+      dquat back(rotation3<double>(q));
+      double sign = dquat::dot(back, q) < 0.0 ? -1.0 : 1.0;
+      worst = worse(worst, std::max(std::max(std::abs(back.w * sign - q.w), std::abs(back.x * sign - q.x)), std::max(std::abs(back.y * sign - q.y), std::abs(back.z * sign - q.z))));
+    }
+    ok = check(worst < 1e-12, "quat(mat3) round trip error " + std::to_string(worst)) && ok;
+  }
+
+  //The batch is vectorized across matrices and has to agree with the scalar float path, counts that are no
+  //multiple of the lane width included
+  {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const size_t COUNT = 10007;
+    std::vector<mat3> matrices(COUNT);
+    for(size_t i = 0; i < COUNT; i++)
+      matrices[i] = symmetric<float>(rotation3<float>(fquat::normalize(fquat(unit(rng), unit(rng), unit(rng), unit(rng)))), spectrum<float>((unsigned int)i, rng));
+
+    std::vector<vec3> values(COUNT), valuesOnly(COUNT), valuesQuat(COUNT);
+    std::vector<mat3> vectors(COUNT);
+    std::vector<fquat> rotations(COUNT);
+    eigenSymmetric(matrices.data(), values.data(), vectors.data(), COUNT);
+    eigenSymmetric(matrices.data(), valuesOnly.data(), (mat3*)nullptr, COUNT);
+    eigenSymmetric(matrices.data(), valuesQuat.data(), rotations.data(), COUNT);
+
+    float valueError = 0.0f, vectorError = 0.0f, rotationError = 0.0f;
+    size_t mismatched = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      vec3 scalarValues;
+      mat3 scalarVectors;
+      eigenSymmetric<float>(matrices[i], scalarValues, scalarVectors);
+      float scale = std::max(std::max(std::abs(scalarValues.x), std::abs(scalarValues.z)), 1.0f);
+      for(unsigned int k = 0; k < 3; k++)
+        valueError = worse(valueError, std::abs(values[i].vals[k] - scalarValues.vals[k]) / scale);
+      mismatched += !(valuesOnly[i] == values[i]) || !(valuesQuat[i] == values[i]);
+
+      //Eigenvectors of repeated eigenvalues are not unique, compare the residuals instead
+      float eigenError, orthoError, det;
+      residuals<float>(matrices[i], values[i], vectors[i], scale, eigenError, orthoError, det);
+      vectorError = worse(worse(vectorError, eigenError), worse(orthoError, std::abs(det - 1.0f)));
+      mat3 fromQuat = rotation3<float>(rotations[i]);
+      for(unsigned int col = 0; col < 3; col++)
+        for(unsigned int row = 0; row < 3; row++)
+          rotationError = worse(rotationError, std::abs(fromQuat[col][row] - vectors[i][col][row]));
+    }
+    ok = check(valueError < 1e-5f, "batched eigenvalues differ from the scalar ones by " + std::to_string(valueError)) && ok;
+    ok = check(mismatched == 0, std::to_string(mismatched) + " batched eigenvalues depend on the requested outputs") && ok;
+    ok = check(vectorError < 2e-5f, "batched eigenvectors have residual " + std::to_string(vectorError)) && ok;
+    ok = check(rotationError < 1e-4f, "batched rotations differ from the eigenvectors by " + std::to_string(rotationError)) && ok;
+  }
+
+  return ok ? 0 : 1;
+}
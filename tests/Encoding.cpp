@@ -0,0 +1,163 @@
+#include <gum-maths.h>
+#include <cstring>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+template<typename T>
+bool sameBits(const std::vector<T>& a, const std::vector<T>& b)
+{
+  return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+//Batch of f over in has to equal the scalar version element by element
+template<typename In, typename Out, typename Batch, typename Scalar>
+bool batchEqualsScalar(const std::vector<In>& in, Batch batch, Scalar scalar, const std::string& name)
+{
+  std::vector<Out> batched(in.size()), expected(in.size());
+  batch(in.data(), batched.data(), in.size());
+  for(size_t i = 0; i < in.size(); i++)
+    expected[i] = scalar(in[i]);
+  return check(sameBits(batched, expected), name + ": batch differs from the scalar version");
+}
+
+//Cells of consecutive Hilbert keys differ by one in exactly one axis
+template<typename V, unsigned int S>
+bool neighbors(const V& a, const V& b)
+{
+  unsigned int steps = 0;
+  for(unsigned int i = 0; i < S; i++)
+  {
+    uint32_t d = a.vals[i] > b.vals[i] ? a.vals[i] - b.vals[i] : b.vals[i] - a.vals[i];
+    if(d > 1)
+      return false;
+    steps += d;
+  }
+  return steps == 1;
+}
+
+bool testCurves(const std::string& path)
+{
+  std::mt19937_64 rng(11);
+  bool ok = true;
+
+  //Bit layout: x lowest, every axis at the top of its range
+  ok = check(encodeMorton2(uivec2(1, 0)) == 1 && encodeMorton2(uivec2(0, 1)) == 2 && encodeMorton2(uivec2(0xFFFFFFFFu, 0xFFFFFFFFu)) == ~0ull, path + ": Morton2 bit layout") && ok;
+  ok = check(encodeMorton3(uivec3(1, 0, 0)) == 1 && encodeMorton3(uivec3(0, 1, 0)) == 2 && encodeMorton3(uivec3(0, 0, 1)) == 4, path + ": Morton3 bit layout") && ok;
+  ok = check(encodeMorton3(uivec3(~0u, ~0u, ~0u)) == (1ull << 63) - 1, path + ": Morton3 ignores bits above 21") && ok;
+
+  std::vector<uivec2> points2(20000);
+  std::vector<uivec3> points3(20000);
+  for(size_t i = 0; i < points2.size(); i++)
+  {
+    points2[i] = uivec2((uint32_t)rng(), (uint32_t)rng());
+    points3[i] = uivec3((uint32_t)rng() & ((1u << 21) - 1), (uint32_t)rng() & ((1u << 21) - 1), (uint32_t)rng() & ((1u << 21) - 1));
+  }
+  points2[0] = uivec2(0, 0);
+  points2[1] = uivec2(0xFFFFFFFFu, 0xFFFFFFFFu);
+  points3[0] = uivec3(0, 0, 0);
+  points3[1] = uivec3((1u << 21) - 1, (1u << 21) - 1, (1u << 21) - 1);
+
+  size_t failures = 0;
+  for(size_t i = 0; i < points2.size(); i++)
+  {
+    failures += decodeMorton2(encodeMorton2(points2[i])) != points2[i];
+    failures += decodeMorton3(encodeMorton3(points3[i])) != points3[i];
+    failures += decodeHilbert2(encodeHilbert2(points2[i])) != points2[i];
+    failures += decodeHilbert3(encodeHilbert3(points3[i])) != points3[i];
+  }
+  ok = check(failures == 0, path + ": " + std::to_string(failures) + " keys do not round trip") && ok;
+
+  //Hilbert keys are a bijection, so every key decodes and the curve is continuous at random places as well
+  failures = 0;
+  for(uint64_t key = 0; key < 4096; key++)
+  {
+    failures += !neighbors<uivec2, 2>(decodeHilbert2(key), decodeHilbert2(key + 1));
+    failures += !neighbors<uivec3, 3>(decodeHilbert3(key), decodeHilbert3(key + 1));
+  }
+  for(int i = 0; i < 20000; i++)
+  {
+    uint64_t key = rng();
+    failures += encodeHilbert2(decodeHilbert2(key)) != key;
+    failures += !neighbors<uivec2, 2>(decodeHilbert2(key), decodeHilbert2(key + 1));
+    key >>= 1;
+    failures += encodeHilbert3(decodeHilbert3(key)) != key;
+    failures += key + 1 < (1ull << 63) && !neighbors<uivec3, 3>(decodeHilbert3(key), decodeHilbert3(key + 1));
+  }
+  ok = check(failures == 0, path + ": " + std::to_string(failures) + " Hilbert keys are not neighbors or do not round trip") && ok;
+  ok = check(decodeHilbert2(0) == uivec2(0, 0) && decodeHilbert3(0) == uivec3(0, 0, 0), path + ": Hilbert curves start at the origin") && ok;
+
+  //Positions round trip to the center of their cell
+  const bbox3 bounds(vec3(-10.0f, 0.0f, 5.0f), vec3(20.0f, 1.0f, 0.0f));
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::vector<vec3> positions(20000);
+  for(vec3& position : positions)
+    position = bounds.pos + bounds.size * vec3(uniform(rng), uniform(rng), uniform(rng));
+  float worst = 0.0f;
+  for(const vec3& position : positions)
+  {
+    vec3 morton = decodeMorton3(encodeMorton3(position, bounds), bounds), hilbert = decodeHilbert3(encodeHilbert3(position, bounds), bounds);
+    for(unsigned int i = 0; i < 3; i++)
+      worst = std::max(worst, std::max(std::abs(morton.vals[i] - position.vals[i]), std::abs(hilbert.vals[i] - position.vals[i])) / std::max(bounds.size.vals[i], 1.0f));
+  }
+  ok = check(worst <= 0.5f / (float)(1 << 21) + 1e-6f, path + ": position is " + std::to_string(worst) + " away from its cell center") && ok;
+
+  ok = batchEqualsScalar<uivec2, uint64_t>(points2, (void(*)(const uivec2*, uint64_t*, size_t))encodeMorton2, (uint64_t(*)(const uivec2&))encodeMorton2, path + " encodeMorton2") && ok;
+  ok = batchEqualsScalar<uivec3, uint64_t>(points3, (void(*)(const uivec3*, uint64_t*, size_t))encodeMorton3, (uint64_t(*)(const uivec3&))encodeMorton3, path + " encodeMorton3") && ok;
+  ok = batchEqualsScalar<uivec2, uint64_t>(points2, (void(*)(const uivec2*, uint64_t*, size_t))encodeHilbert2, (uint64_t(*)(const uivec2&))encodeHilbert2, path + " encodeHilbert2") && ok;
+  ok = batchEqualsScalar<uivec3, uint64_t>(points3, (void(*)(const uivec3*, uint64_t*, size_t))encodeHilbert3, (uint64_t(*)(const uivec3&))encodeHilbert3, path + " encodeHilbert3") && ok;
+
+  std::vector<uint64_t> keys(20000);
+  for(uint64_t& key : keys)
+    key = rng() >> 1;
+  ok = batchEqualsScalar<uint64_t, uivec2>(keys, (void(*)(const uint64_t*, uivec2*, size_t))decodeMorton2, (uivec2(*)(uint64_t))decodeMorton2, path + " decodeMorton2") && ok;
+  ok = batchEqualsScalar<uint64_t, uivec3>(keys, (void(*)(const uint64_t*, uivec3*, size_t))decodeMorton3, (uivec3(*)(uint64_t))decodeMorton3, path + " decodeMorton3") && ok;
+  ok = batchEqualsScalar<uint64_t, uivec2>(keys, (void(*)(const uint64_t*, uivec2*, size_t))decodeHilbert2, (uivec2(*)(uint64_t))decodeHilbert2, path + " decodeHilbert2") && ok;
+  ok = batchEqualsScalar<uint64_t, uivec3>(keys, (void(*)(const uint64_t*, uivec3*, size_t))decodeHilbert3, (uivec3(*)(uint64_t))decodeHilbert3, path + " decodeHilbert3") && ok;
+
+  ok = batchEqualsScalar<vec3, uint64_t>(positions, [&bounds](const vec3* in, uint64_t* out, size_t count) { encodeMorton3(in, out, count, bounds); },
+                                         [&bounds](const vec3& p) { return encodeMorton3(p, bounds); }, path + " encodeMorton3 positions") && ok;
+  ok = batchEqualsScalar<vec3, uint64_t>(positions, [&bounds](const vec3* in, uint64_t* out, size_t count) { encodeHilbert3(in, out, count, bounds); },
+                                         [&bounds](const vec3& p) { return encodeHilbert3(p, bounds); }, path + " encodeHilbert3 positions") && ok;
+  ok = batchEqualsScalar<uint64_t, vec3>(keys, [&bounds](const uint64_t* in, vec3* out, size_t count) { decodeMorton3(in, out, count, bounds); },
+                                         [&bounds](uint64_t k) { return decodeMorton3(k, bounds); }, path + " decodeMorton3 positions") && ok;
+  ok = batchEqualsScalar<uint64_t, vec3>(keys, [&bounds](const uint64_t* in, vec3* out, size_t count) { decodeHilbert3(in, out, count, bounds); },
+                                         [&bounds](uint64_t k) { return decodeHilbert3(k, bounds); }, path + " decodeHilbert3 positions") && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Curve keys on the path this CPU picks and on the table path, which has to be covered even where BMI2 is fast
+  std::vector<uint64_t> defaultKeys, tableKeys;
+  for(int run = 0; run < 2; run++)
+  {
+    forceCurveTables(run == 1);
+    const std::string path = run == 1 ? "tables" : "default";
+    ok = testCurves(path) && ok;
+    std::vector<uint64_t>& keys = run == 1 ? tableKeys : defaultKeys;
+    std::mt19937 rng(5);
+    for(int i = 0; i < 1000; i++)
+    {
+      uivec3 cell(rng(), rng(), rng());
+      keys.push_back(encodeMorton2(uivec2(cell.x, cell.y)));
+      keys.push_back(encodeMorton3(cell));
+      keys.push_back(encodeHilbert2(uivec2(cell.x, cell.y)));
+      keys.push_back(encodeHilbert3(cell));
+    }
+  }
+  forceCurveTables(false);
+  ok = check(sameBits(defaultKeys, tableKeys), "tables and BMI2 give different keys") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <gum-maths.h>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+//FNV-1a over the raw results
+static void hashRaw(uint64_t& hash, int64_t raw)
+{
+  hash = (hash ^ (uint64_t)raw) * 1099511628211ull;
+}
+
+//sqrt has to give floor(sqrt(raw * 2^F)) in raw units, checked with exact integer squares
+template<typename S, unsigned int F>
+static bool exactSqrt(S raw)
+{
+  unsigned __int128 radicand = (unsigned __int128)raw << F;
+  unsigned __int128 root = (unsigned __int128)sqrt(tfixed<S, F>::fromRaw(raw)).raw;
+  return root * root <= radicand && (root + 1) * (root + 1) > radicand;
+}
+
+template<typename S, unsigned int F>
+static size_t sqrtErrors(uint64_t seed)
+{
+  size_t errors = 0;
+  for(S raw = 1; raw < 100000; raw++)
+    errors += !exactSqrt<S, F>(raw);
+  for(unsigned int i = 0; i < 200000; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    errors += !exactSqrt<S, F>((S)(seed >> (64 - sizeof(S) * 8 + 1)) | 1);
+  }
+  errors += !exactSqrt<S, F>(std::numeric_limits<S>::max());
+  return errors;
+}
+
+static double error(const fxvec3& a, const vec3& b)
+{
+  return std::max(std::abs((double)a.x - b.x), std::max(std::abs((double)a.y - b.y), std::abs((double)a.z - b.z)));
+}
+
+static double error(const fxquat& a, const fquat& b)
+{
+  return std::max(std::max(std::abs((double)a.w - b.w), std::abs((double)a.x - b.x)), std::max(std::abs((double)a.y - b.y), std::abs((double)a.z - b.z)));
+}
+
+static double error(fxmat4 a, mat4 b)
+{
+  double worst = 0.0;
+  for(unsigned int col = 0; col < 4; col++)
+    for(unsigned int row = 0; row < 4; row++)
+      worst = std::max(worst, std::abs((double)a[col][row] - b[col][row]));
+  return worst;
+}
+
+static fxvec3 toFixed(const vec3& v) { return fxvec3(fixed16(v.x), fixed16(v.y), fixed16(v.z)); }
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Integer conversion saturates instead of overflowing
+  ok = check(fixed16(40000) == std::numeric_limits<fixed16>::max(), "fixed16(40000) has to saturate") && ok;
+  ok = check(fixed16(-40000) == std::numeric_limits<fixed16>::lowest(), "fixed16(-40000) has to saturate") && ok;
+  ok = check(fixed16(4000000000u) == std::numeric_limits<fixed16>::max(), "unsigned input has to saturate") && ok;
+  ok = check((int)fixed16(32767) == 32767 && (int)fixed16(-32768) == -32768, "fixed16 integer range") && ok;
+  ok = check(fixed32(INT64_MAX) == std::numeric_limits<fixed32>::max() && (int64_t)fixed32(-2000000000) == -2000000000, "fixed32 integer range") && ok;
+
+  //Accuracy against double, and one hash over all raw results that has to be the same on every platform
+  uint64_t hash = 1469598103934665603ull;
+  double sinError32 = 0.0, sinError16 = 0.0, atanError32 = 0.0, atanError16 = 0.0;
+  for(int i = -20000; i <= 20000; i++)
+  {
+    fixed32 a(i * 0.0005);
+    fixed16 b(i * 0.0005);
+    sinError32 = std::max(sinError32, std::abs((double)sin(a) - std::sin((double)a)));
+    sinError32 = std::max(sinError32, std::abs((double)cos(a) - std::cos((double)a)));
+    sinError16 = std::max(sinError16, std::abs((double)sin(b) - std::sin((double)b)));
+    sinError16 = std::max(sinError16, std::abs((double)cos(b) - std::cos((double)b)));
+    hashRaw(hash, sin(a).raw);
+    hashRaw(hash, cos(a).raw);
+    hashRaw(hash, sin(b).raw);
+  }
+  for(int y = -60; y <= 60; y++)
+  {
+    for(int x = -60; x <= 60; x++)
+    {
+      if(x == 0 && y == 0)
+        continue;
+      fixed32 ay(y * 0.37), ax(x * 0.29);
+      fixed16 by(y * 0.37), bx(x * 0.29);
+      atanError32 = std::max(atanError32, std::abs((double)atan2(ay, ax) - std::atan2((double)ay, (double)ax)));
+      atanError16 = std::max(atanError16, std::abs((double)atan2(by, bx) - std::atan2((double)by, (double)bx)));
+      hashRaw(hash, atan2(ay, ax).raw);
+      hashRaw(hash, atan2(by, bx).raw);
+    }
+  }
+
+  ok = check(sinError32 < 5e-8, "fixed32 sin/cos error " + std::to_string(sinError32)) && ok;
+  ok = check(sinError16 < 3e-5, "fixed16 sin/cos error " + std::to_string(sinError16)) && ok;
+  ok = check(atanError32 < 5e-8, "fixed32 atan2 error " + std::to_string(atanError32)) && ok;
+  ok = check(atanError16 < 3e-5, "fixed16 atan2 error " + std::to_string(atanError16)) && ok;
+  ok = check(hash == 0xcdcdd75ed522ebc1ull, "results differ from the reference platform, hash " + std::to_string(hash)) && ok;
+
+  //Multiply and divide saturate as well, also on division by zero
+  const fixed16 max16 = std::numeric_limits<fixed16>::max(), lowest16 = std::numeric_limits<fixed16>::lowest();
+  ok = check(fixed16(200) * fixed16(200) == max16 && fixed16(200) * fixed16(-200) == lowest16, "fixed16 multiply has to saturate") && ok;
+  ok = check(fixed16(1000) / fixed16(0.01) == max16 && fixed16(-1000) / fixed16(0.01) == lowest16, "fixed16 divide has to saturate") && ok;
+  ok = check(fixed16(1) / fixed16(0) == max16 && fixed16(-1) / fixed16(0) == lowest16, "fixed16 divide by zero has to saturate") && ok;
+  ok = check(fixed16(-181) * fixed16(181) == fixed16(-32761) && fixed16(3) / fixed16(-4) == fixed16(-0.75), "fixed16 multiply and divide in range") && ok;
+  ok = check(fixed32(3000000) * fixed32(3000000) == std::numeric_limits<fixed32>::max() && fixed32(-3000000) * fixed32(3000000) == std::numeric_limits<fixed32>::lowest(), "fixed32 multiply has to saturate") && ok;
+  ok = check(fixed32(1) / fixed32::fromRaw(1) == std::numeric_limits<fixed32>::max() && fixed32(-1) / fixed32(0) == std::numeric_limits<fixed32>::lowest(), "fixed32 divide has to saturate") && ok;
+
+  //sqrt for even and odd fraction bits
+  ok = check(sqrt(fixed16(4)) == fixed16(2) && sqrt(tfixed<int32_t, 15>(4)) == tfixed<int32_t, 15>(2) && sqrt(tfixed<int64_t, 31>(9)) == tfixed<int64_t, 31>(3), "sqrt of a square") && ok;
+  ok = check(sqrt(fixed16(-4)) == fixed16(0) && sqrt(fixed16(0)) == fixed16(0), "sqrt of zero and negative input has to be 0") && ok;
+  size_t errors16 = sqrtErrors<int32_t, 16>(1), errors15 = sqrtErrors<int32_t, 15>(2), errors32 = sqrtErrors<int64_t, 32>(3), errors31 = sqrtErrors<int64_t, 31>(4);
+  ok = check(errors16 + errors15 + errors32 + errors31 == 0, "sqrt not exact: " + std::to_string(errors16) + " fixed16, " + std::to_string(errors15) + " F = 15, " + std::to_string(errors32) + " fixed32, " + std::to_string(errors31) + " F = 31") && ok;
+
+  //Vectors, matrices and quaternions instantiated with fixed point against float
+  fxvec3 v(fixed16(1), fixed16(2), fixed16(2));
+  ok = check(v.length() == fixed16(3), "fxvec3 length") && ok;
+  ok = check(error(fxvec3::normalize(v), vec3(1.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f)) < 3e-5, "fxvec3 normalize") && ok;
+
+  const vec3 angles(10.0f, -35.0f, 70.0f), axis = vec3::normalize(vec3(1.0f, -2.0f, 3.0f));
+  fxquat fxq = fxquat::toQuaternion(toFixed(angles)), fxr = fxquat::rotateAround(fixed16(50), toFixed(axis));
+  fquat q = fquat::toQuaternion(angles), r = fquat::rotateAround(50.0f, axis);
+  ok = check(error(fxq, q) < 2e-4, "fxquat toQuaternion error " + std::to_string(error(fxq, q))) && ok;
+  ok = check(error(fxr, r) < 1e-4, "fxquat rotateAround error " + std::to_string(error(fxr, r))) && ok;
+  ok = check(error(fxquat::toEuler(fxq), angles) < 5e-2, "fxquat toEuler error " + std::to_string(error(fxquat::toEuler(fxq), angles)) + " degrees") && ok;
+  fxquat fxs = fxquat::slerp(fxq, fxr, fixed16(0.3));
+  fquat s = fquat::slerp(q, r, 0.3f);
+  ok = check(error(fxs, s) < 2e-4, "fxquat slerp error " + std::to_string(error(fxs, s))) && ok;
+
+  fxmat4 fxa = Gum::Maths::rotateMatrix(fxs), fxb = Gum::Maths::rotateMatrix(toFixed(angles));
+  mat4 a = Gum::Maths::rotateMatrix(s), b = Gum::Maths::rotateMatrix(angles);
+  ok = check(error(fxa, a) < 5e-4 && error(fxb, b) < 5e-4, "fixed point rotateMatrix error " + std::to_string(std::max(error(fxa, a), error(fxb, b)))) && ok;
+  fxb[3][0] = fixed16(12.5); fxb[3][1] = fixed16(-3); b[3][0] = 12.5f; b[3][1] = -3.0f;
+  ok = check(error(fxa * fxb, a * b) < 3e-3, "fxmat4 multiply error " + std::to_string(error(fxa * fxb, a * b))) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <gum-maths.h>
+#include <cstring>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+static uint32_t floatBits(float f)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &f, 4);
+  return bits;
+}
+
+static float bitsFloat(uint32_t bits)
+{
+  float f;
+  std::memcpy(&f, &bits, 4);
+  return f;
+}
+
+static std::string hex(uint32_t bits)
+{
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "0x%08X", bits);
+  return buffer;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Every half through the bulk path (F16C where available) against the software conversion, bit for bit
+  {
+    std::vector<half> halves(1 << 16);
+    for(uint32_t i = 0; i < halves.size(); i++)
+      halves[i] = half::fromBits((uint16_t)i);
+    std::vector<float> floats(halves.size());
+    convert(halves.data(), floats.data(), halves.size());
+    size_t wrong = 0, notBack = 0;
+    for(uint32_t i = 0; i < halves.size(); i++)
+    {
+      float software = halfBitsToFloat((uint16_t)i);
+      wrong += floatBits(floats[i]) != floatBits(software);
+      //Every half survives the way back, signaling NaNs come back quiet
+      uint16_t back = floatToHalfBits(software);
+      bool nan = (i & 0x7C00u) == 0x7C00u && (i & 0x3FFu) != 0;
+      notBack += back != (nan ? (i | 0x200u) : i);
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " halves convert differently in bulk") && ok;
+    ok = check(notBack == 0, std::to_string(notBack) + " halves do not survive a round trip through float") && ok;
+  }
+
+  //Floats through the bulk path against the software conversion, bit for bit. Every sign, exponent and upper
+  //mantissa combination, with the 13 bits below the half mantissa covering below, at and above halfway
+  {
+    const uint32_t LOW[] = { 0x0000u, 0x0001u, 0x0555u, 0x0FFFu, 0x1000u, 0x1001u, 0x1AAAu, 0x1FFFu };
+    std::vector<float> floats;
+    floats.reserve((size_t)1 << 22);
+    for(uint32_t top = 0; top < (1u << 19); top++)
+      for(uint32_t low : LOW)
+        floats.push_back(bitsFloat((top << 13) | low));
+    std::vector<half> halves(floats.size());
+    convert(floats.data(), halves.data(), floats.size());
+    size_t wrong = 0;
+    uint32_t firstWrong = 0;
+    for(size_t i = 0; i < floats.size(); i++)
+    {
+      if(halves[i].bits != floatToHalfBits(floats[i]) && wrong++ == 0)
+        firstWrong = floatBits(floats[i]);
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " floats convert to half differently in bulk, first " + hex(firstWrong)) && ok;
+  }
+
+  //Round to nearest even: halfway between two neighbouring halves goes to the even one, one float ulp off goes
+  //to the closer one. Covers subnormals and the rounding into infinity above 65504
+  {
+    size_t wrong = 0;
+    uint32_t firstWrong = 0;
+    for(uint32_t h = 0; h < 0x7C00u; h++)
+    {
+      float low = halfBitsToFloat((uint16_t)h);
+      float high = h + 1 < 0x7C00u ? halfBitsToFloat((uint16_t)(h + 1)) : 65536.0f;
+      float mid = (float)(((double)low + (double)high) * 0.5);
+      uint16_t even = (h & 1) ? (uint16_t)(h + 1) : (uint16_t)h;
+      bool right = floatToHalfBits(mid) == even
+                && floatToHalfBits(bitsFloat(floatBits(mid) - 1)) == h
+                && floatToHalfBits(bitsFloat(floatBits(mid) + 1)) == h + 1
+                && floatToHalfBits(-mid) == (even | 0x8000u);
+      if(!right && wrong++ == 0)
+        firstWrong = h;
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " halfway cases round wrong, first after half " + hex(firstWrong)) && ok;
+    ok = check(floatToHalfBits(1.0f + 1.0f / 2048.0f) == 0x3C00u && floatToHalfBits(1.0f + 3.0f / 2048.0f) == 0x3C02u, "ties to even at 1") && ok;
+    ok = check(floatToHalfBits(std::ldexp(1.0f, -25)) == 0x0000u && floatToHalfBits(std::ldexp(3.0f, -25)) == 0x0002u, "ties to even in the subnormals") && ok;
+    ok = check(floatToHalfBits(65519.0f) == 0x7BFFu && floatToHalfBits(65520.0f) == 0x7C00u && floatToHalfBits(1e10f) == 0x7C00u, "overflow into infinity") && ok;
+    ok = check((floatToHalfBits(std::numeric_limits<float>::quiet_NaN()) & 0x7E00u) == 0x7E00u && floatToHalfBits(bitsFloat(0x7F800001u)) != 0x7C00u, "NaN has to stay NaN") && ok;
+  }
+
+  //bfloat16: every value survives a round trip, halfway cases go to even, bulk agrees with the software path
+  {
+    size_t notBack = 0, wrongTies = 0;
+    std::vector<bfloat16> all(1 << 16);
+    for(uint32_t b = 0; b < (1 << 16); b++)
+    {
+      all[b] = bfloat16::fromBits((uint16_t)b);
+      bool nan = (b & 0x7F80u) == 0x7F80u && (b & 0x7Fu) != 0;
+      notBack += floatToBFloat16Bits(bfloat16BitsToFloat((uint16_t)b)) != (nan ? (b | 0x40u) : b);
+
+      if((b & 0x7F80u) == 0x7F80u)
+        continue;
+      uint32_t mid = (b << 16) | 0x8000u;
+      uint16_t even = (b & 1) ? (uint16_t)(b + 1) : (uint16_t)b;
+      wrongTies += floatToBFloat16Bits(bitsFloat(mid)) != even
+                || floatToBFloat16Bits(bitsFloat(mid - 1)) != b
+                || floatToBFloat16Bits(bitsFloat(mid + 1)) != (uint16_t)(b + 1);
+    }
+    ok = check(notBack == 0, std::to_string(notBack) + " bfloat16 values do not survive a round trip through float") && ok;
+    ok = check(wrongTies == 0, std::to_string(wrongTies) + " bfloat16 halfway cases round wrong") && ok;
+    ok = check(floatToBFloat16Bits(bitsFloat(0x7F7F8000u)) == 0x7F80u && floatToBFloat16Bits(bitsFloat(0x7F7F7FFFu)) == 0x7F7Fu, "bfloat16 overflow into infinity") && ok;
+
+    std::vector<float> floats(all.size());
+    std::vector<bfloat16> back(all.size());
+    convert(all.data(), floats.data(), all.size());
+    convert(floats.data(), back.data(), floats.size());
+    size_t wrong = 0;
+    for(uint32_t b = 0; b < (1 << 16); b++)
+      wrong += floatBits(floats[b]) != floatBits(bfloat16BitsToFloat((uint16_t)b)) || back[b].bits != floatToBFloat16Bits(floats[b]);
+    ok = check(wrong == 0, std::to_string(wrong) + " bfloat16 values convert differently in bulk") && ok;
+  }
+
+  //Vector arrays, counts that are no multiple of the F16C width
+  {
+    std::vector<vec3> positions(1001);
+    for(size_t i = 0; i < positions.size(); i++)
+      positions[i] = vec3((float)i * 0.37f, -(float)i, 1.0f / (float)(i + 1));
+    std::vector<hvec3> packed(positions.size());
+    std::vector<vec3> unpacked(positions.size());
+    convert(positions.data(), packed.data(), positions.size());
+    convert(packed.data(), unpacked.data(), packed.size());
+    size_t wrong = 0;
+    for(size_t i = 0; i < positions.size(); i++)
+      for(unsigned int k = 0; k < 3; k++)
+        wrong += floatBits(unpacked[i].vals[k]) != floatBits(halfBitsToFloat(floatToHalfBits(positions[i].vals[k])));
+    ok = check(wrong == 0, std::to_string(wrong) + " hvec3 components convert wrong") && ok;
+  }
+
+  return ok ? 0 : 1;
+}
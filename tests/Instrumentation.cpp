@@ -0,0 +1,72 @@
+#include <gum-maths.h>
+#include <thread>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+static const InstrumentationEntry* findEntry(const std::vector<InstrumentationEntry>& report, InstrumentedOperation operation, InstrumentedScalar scalar, unsigned int rows, unsigned int cols, bool vector)
+{
+  for(const InstrumentationEntry& entry : report)
+    if(entry.operation == operation && entry.scalar == scalar && entry.rows == rows && entry.cols == cols && entry.vector == vector)
+      return &entry;
+  return nullptr;
+}
+
+//Only built with -DGUM_MATHS_INSTRUMENTATION=ON
+int main(int argc, char** argv)
+{
+  resetInstrumentation();
+  setInstrumentationSampleInterval(1);
+
+  vec3 a(1.0f, 2.0f, 3.0f), b(4.0f, 5.0f, 6.0f);
+  float dots = 0.0f;
+  for(int i = 0; i < 10; i++)
+    dots += vec3::dot(a, b);
+
+  //Same rows and cols as a vec3, but a matrix
+  mat<float, 3, 1> column;
+  mat<double, 3, 1> doubleColumn;
+  mat4 m;
+  for(int i = 0; i < 5; i++)
+    m = m * m;
+
+  //A thread that already finished still counts
+  std::thread worker([]() {
+    dvec2 c(1.0, 2.0);
+    for(int i = 0; i < 7; i++)
+      c.length();
+  });
+  worker.join();
+
+  std::vector<InstrumentationEntry> report = getInstrumentationReport();
+  const InstrumentationEntry* dot = findEntry(report, InstrumentedOperation::VEC_DOT, InstrumentedScalar::FLOAT, 3, 1, true);
+  const InstrumentationEntry* columnConstruct = findEntry(report, InstrumentedOperation::MAT_CONSTRUCT, InstrumentedScalar::FLOAT, 3, 1, false);
+  const InstrumentationEntry* doubleColumnConstruct = findEntry(report, InstrumentedOperation::MAT_CONSTRUCT, InstrumentedScalar::DOUBLE, 3, 1, false);
+  const InstrumentationEntry* multiply = findEntry(report, InstrumentedOperation::MAT_MULTIPLY, InstrumentedScalar::FLOAT, 4, 4, false);
+  const InstrumentationEntry* length = findEntry(report, InstrumentedOperation::VEC_LENGTH, InstrumentedScalar::DOUBLE, 2, 1, true);
+
+  bool ok = check(dot != nullptr && dot->count == 10, "vec3 dot has to be counted 10 times");
+  ok = check(columnConstruct != nullptr && columnConstruct->count >= 1, "mat<float, 3, 1> has to be counted as a matrix") && ok;
+  ok = check(doubleColumnConstruct != nullptr && doubleColumnConstruct->count >= 1, "mat<double, 3, 1> has to be counted as a matrix") && ok;
+  ok = check(findEntry(report, InstrumentedOperation::MAT_CONSTRUCT, InstrumentedScalar::FLOAT, 3, 1, true) == nullptr, "no matrix may be counted as a vector") && ok;
+  ok = check(multiply != nullptr && multiply->count == 5 && multiply->samples == 5 && multiply->estimatedNanoseconds > 0.0, "every mat4 product has to be timed with interval 1") && ok;
+  ok = check(length != nullptr && length->count == 7, "counts of a finished thread have to be kept") && ok;
+  for(size_t i = 1; i < report.size(); i++)
+    ok = check(report[i - 1].count >= report[i].count, "report has to be sorted by count") && ok;
+
+  std::string text = instrumentationReportToString();
+  ok = check(text.find("mat3x1") != std::string::npos && text.find("vec3") != std::string::npos && text.find("VEC_DOT") != std::string::npos, "report text:\n" + text) && ok;
+
+  resetInstrumentation();
+  ok = check(getInstrumentationReport().empty(), "reset has to clear every counter") && ok;
+  setInstrumentationSampleInterval(64);
+
+  return ok && dots > 0.0f ? 0 : 1;
+}
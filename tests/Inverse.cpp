@@ -0,0 +1,183 @@
+#include <gum-maths.h>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+//Largest elementwise difference relative to the largest element of b, at least 1
+template<typename T>
+T maxDifference(const mat<T,4,4>& a, const mat<T,4,4>& b)
+{
+  T worst = 0, scale = 1;
+  for(unsigned int c = 0; c < 4; c++)
+    for(unsigned int r = 0; r < 4; r++)
+    {
+      T d = std::abs(a[c][r] - b[c][r]);
+      worst = d > worst || d != d ? d : worst;
+      scale = std::max(scale, std::abs(b[c][r]));
+    }
+  return worst / scale;
+}
+
+template<typename T>
+T maxAbs(const mat<T,4,4>& m)
+{
+  T largest = 0;
+  for(unsigned int c = 0; c < 4; c++)
+    for(unsigned int r = 0; r < 4; r++)
+      largest = std::max(largest, std::abs(m[c][r]));
+  return largest;
+}
+
+template<typename T>
+bool sameBits(const mat<T,4,4>& a, const mat<T,4,4>& b)
+{
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+template<typename T>
+mat<T,4,4> randomRigid(std::mt19937& rng)
+{
+  std::uniform_real_distribution<T> unit(-1, 1);
+  quat<T> q = quat<T>::normalize(quat<T>(unit(rng), unit(rng), unit(rng), unit(rng)));
+  return translateMatrix<T>(tvec<T, 3>(unit(rng), unit(rng), unit(rng)) * (T)100) * rotateMatrix<T>(q);
+}
+
+//Rigid transforms with scale and shear, and full projective matrices
+template<typename T>
+mat<T,4,4> randomGeneral(std::mt19937& rng, unsigned int i)
+{
+  std::uniform_real_distribution<T> unit(-1, 1);
+  if(i % 2 == 0)
+  {
+    mat<T,4,4> shear;
+    shear[1][0] = unit(rng);
+    shear[2][1] = unit(rng);
+    tvec<T, 3> scale(unit(rng) + (T)1.5, unit(rng) + (T)1.5, -(unit(rng) + (T)1.5));
+    return randomRigid<T>(rng) * scaleMatrix<T>(scale) * shear;
+  }
+  mat<T,4,4> m;
+  for(unsigned int c = 0; c < 4; c++)
+    for(unsigned int r = 0; r < 4; r++)
+      m[c][r] = unit(rng) + (c == r ? (T)3 : (T)0);
+  return m;
+}
+
+template<typename T>
+bool testScalar(T tolerance, const std::string& name)
+{
+  bool ok = true;
+  std::mt19937 rng(23);
+  T identityError = 0, rigidError = 0, legacyError = 0;
+  size_t failed = 0;
+  for(unsigned int i = 0; i < 5000; i++)
+  {
+    mat<T,4,4> m = randomGeneral<T>(rng, i), inv;
+    failed += !invertMatrix(m, inv);
+    //Rounding in m * inv grows with the magnitudes of both
+    identityError = std::max(identityError, maxDifference<T>(m * inv, mat<T,4,4>()) / (maxAbs<T>(m) * maxAbs<T>(inv)));
+    legacyError = std::max(legacyError, maxDifference<T>(mat<T,4,4>::inverse(m), inv));
+
+    mat<T,4,4> rigid = randomRigid<T>(rng), general;
+    invertMatrix(rigid, general);
+    rigidError = std::max(rigidError, maxDifference<T>(invertRigidMatrix<T>(rigid), general));
+  }
+  ok = check(failed == 0, name + ": " + std::to_string(failed) + " invertible matrices reported as singular") && ok;
+  ok = check(identityError < tolerance, name + ": m * inverse(m) is " + std::to_string(identityError) + " relative" + " away from identity") && ok;
+  ok = check(legacyError < tolerance, name + ": mat::inverse and invertMatrix differ by " + std::to_string(legacyError) + " relative") && ok;
+  ok = check(rigidError < tolerance * 4, name + ": rigid and general inverse differ by " + std::to_string(rigidError)) && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = testScalar<float>(4e-6f, "float");
+  ok = testScalar<double>(1e-14, "double") && ok;
+
+  //The SSE float path against the generic template
+  {
+    std::mt19937 rng(29);
+    float worst = 0.0f;
+    for(unsigned int i = 0; i < 5000; i++)
+    {
+      mat4 m = randomGeneral<float>(rng, i), sse, generic;
+      invertMatrix(m, sse);
+      invertMatrix<float>(m, generic);
+      worst = std::max(worst, maxDifference<float>(sse, generic));
+    }
+    ok = check(worst < 1e-5f, "SSE and generic float inverse differ by " + std::to_string(worst)) && ok;
+  }
+
+  //Singular matrices: invertMatrix reports them and leaves out alone, mat::inverse returns its input with an error message
+  {
+    mat4 rankThree = translateMatrix<float>(vec3(1, 2, 3)) * scaleMatrix<float>(vec3(1, 0, 1));
+    //Small integers keep the determinant exactly zero
+    mat4 duplicated;
+    for(unsigned int r = 0; r < 4; r++)
+    {
+      duplicated[0][r] = duplicated[2][r] = (float)(r + 1);
+      duplicated[1][r] = (float)(r * r) - 2.0f;
+      duplicated[3][r] = (float)(r % 2);
+    }
+    mat4 untouched(2.0f);
+    mat<double,4,4> untouchedDouble;
+    bool reported = !invertMatrix(mat4(0.0f), untouched) && !invertMatrix(rankThree, untouched)
+                 && !invertMatrix(duplicated, untouched) && !invertMatrix<double>(mat<double,4,4>(0.0), untouchedDouble);
+    ok = check(reported && sameBits<float>(untouched, mat4(2.0f)), "singular matrices have to be reported and leave out untouched") && ok;
+
+    std::stringstream errors;
+    std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+    mat4 legacy = mat4::inverse(rankThree);
+    std::cerr.rdbuf(previous);
+    ok = check(sameBits<float>(legacy, rankThree) && errors.str().find("singular") != std::string::npos, "mat::inverse of a singular matrix has to return it and print an error") && ok;
+  }
+
+  //Batches against the scalar functions, singular matrices in between, in place included
+  {
+    std::mt19937 rng(31);
+    const size_t COUNT = 10007;
+    std::vector<mat4> matrices(COUNT), rigid(COUNT);
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      matrices[i] = i % 97 == 5 ? mat4(0.0f) : randomGeneral<float>(rng, (unsigned int)i);
+      rigid[i] = randomRigid<float>(rng);
+    }
+
+    std::vector<mat4> inverses(COUNT, mat4(7.0f)), inPlace = matrices;
+    std::vector<char> invertible(COUNT);
+    size_t singular = invertMatrices(matrices.data(), inverses.data(), (bool*)invertible.data(), COUNT);
+    size_t singularInPlace = invertMatrices(inPlace.data(), inPlace.data(), nullptr, COUNT);
+    size_t wrong = 0, expectedSingular = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      mat4 expected(7.0f);
+      bool scalarOk = invertMatrix(matrices[i], expected);
+      expectedSingular += !scalarOk;
+      wrong += (bool)invertible[i] != scalarOk || !sameBits<float>(inverses[i], expected) || !sameBits<float>(inPlace[i], scalarOk ? expected : matrices[i]);
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " batched inverses differ from the scalar ones") && ok;
+    ok = check(singular == expectedSingular && singularInPlace == expectedSingular && expectedSingular == COUNT / 97 + 1, "batched inverse found " + std::to_string(singular) + " singular matrices, expected " + std::to_string(expectedSingular)) && ok;
+
+    std::vector<mat4> rigidInverses(COUNT), rigidInPlace = rigid;
+    invertRigidMatrices(rigid.data(), rigidInverses.data(), COUNT);
+    invertRigidMatrices(rigidInPlace.data(), rigidInPlace.data(), COUNT);
+    wrong = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      mat4 expected = invertRigidMatrix<float>(rigid[i]);
+      wrong += !sameBits<float>(rigidInverses[i], expected) || !sameBits<float>(rigidInPlace[i], expected);
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " batched rigid inverses differ from the scalar ones") && ok;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <gum-maths.h>
+#include <cmath>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+struct Mesh
+{
+  std::vector<vec3> positions, normals;
+  std::vector<vec2> uvs;
+  std::vector<uint32_t> indices;
+};
+
+//Grid in the xy plane from x = first to x = last, one vertex per integer coordinate, u = uOfX(x) and v = y
+template<typename F>
+Mesh planeGrid(int first, int last, int rows, F uOfX)
+{
+  Mesh mesh;
+  const uint32_t columns = (uint32_t)(last - first + 1);
+  for(int y = 0; y <= rows; y++)
+  {
+    for(int x = first; x <= last; x++)
+    {
+      mesh.positions.push_back(vec3((float)x, (float)y, 0.0f));
+      mesh.normals.push_back(vec3(0.0f, 0.0f, 1.0f));
+      mesh.uvs.push_back(vec2(uOfX((float)x), (float)y));
+    }
+  }
+  for(uint32_t y = 0; y < (uint32_t)rows; y++)
+  {
+    for(uint32_t x = 0; x + 1 < columns; x++)
+    {
+      uint32_t i = y * columns + x;
+      mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + columns + 1, i, i + columns + 1, i + columns });
+    }
+  }
+  return mesh;
+}
+
+std::vector<vec4> tangentsOf(const Mesh& mesh)
+{
+  std::vector<vec4> tangents(mesh.positions.size());
+  Gum::Maths::computeTangents(mesh.positions.data(), mesh.normals.data(), mesh.uvs.data(), mesh.positions.size(), mesh.indices.data(), mesh.indices.size() / 3, tangents.data());
+  return tangents;
+}
+
+bool near(const vec4& a, const vec4& b, float tolerance)
+{
+  return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance && std::abs(a.z - b.z) <= tolerance && a.w == b.w;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Plain and mirrored UV mappings, the bitangent has to follow v in both
+  Mesh plain = planeGrid(0, 4, 3, [](float x) { return x; });
+  Mesh mirrored = planeGrid(0, 4, 3, [](float x) { return -x; });
+  std::vector<vec4> plainTangents = tangentsOf(plain), mirroredTangents = tangentsOf(mirrored);
+  size_t wrong = 0;
+  for(size_t v = 0; v < plain.positions.size(); v++)
+  {
+    wrong += !near(plainTangents[v], vec4(1.0f, 0.0f, 0.0f, 1.0f), 1e-6f);
+    wrong += !near(mirroredTangents[v], vec4(-1.0f, 0.0f, 0.0f, -1.0f), 1e-6f);
+    vec3 t(mirroredTangents[v].x, mirroredTangents[v].y, mirroredTangents[v].z);
+    vec3 bitangent = vec3::cross(mirrored.normals[v], t) * mirroredTangents[v].w;
+    wrong += !near(vec4(bitangent.x, bitangent.y, bitangent.z, 1.0f), vec4(0.0f, 1.0f, 0.0f, 1.0f), 1e-6f);
+  }
+  ok = check(wrong == 0, std::to_string(wrong) + " wrong tangents on the plain and mirrored grids") && ok;
+
+  //Mirrored seam at x = 0: with equal corner angles on both sides the seam vertices keep w = +1 and must
+  //not average the opposite u directions into the v axis
+  Mesh seam = planeGrid(-2, 2, 3, [](float x) { return std::abs(x); });
+  std::vector<vec4> seamTangents = tangentsOf(seam);
+  wrong = 0;
+  for(size_t v = 0; v < seam.positions.size(); v++)
+    wrong += !near(seamTangents[v], seam.positions[v].x < 0.0f ? vec4(-1.0f, 0.0f, 0.0f, -1.0f) : vec4(1.0f, 0.0f, 0.0f, 1.0f), 1e-6f);
+  ok = check(wrong == 0, std::to_string(wrong) + " wrong tangents at a straight mirrored seam") && ok;
+
+  //Zigzag seam: every seam vertex takes the tangent and sign of the side with the larger corner angles
+  for(size_t v = 0; v < seam.positions.size(); v++)
+    if(seam.positions[v].x == 0.0f && seam.positions[v].y > 0.0f && seam.positions[v].y < 3.0f)
+      seam.positions[v].x = (int)seam.positions[v].y % 2 ? 0.4f : -0.4f;
+  seamTangents = tangentsOf(seam);
+  wrong = 0;
+  for(size_t v = 0; v < seam.positions.size(); v++)
+  {
+    float x = seam.positions[v].x;
+    if(x == 0.0f)
+      continue; //Border corners of the seam tie like the straight seam
+    //A seam vertex shifted to the right has the smaller angles on its left
+    const vec4& t = seamTangents[v];
+    wrong += (x > 0.0f ? t.x < 0.9f || t.w != 1.0f : t.x > -0.9f || t.w != -1.0f) || std::abs(t.z) > 1e-6f;
+  }
+  ok = check(wrong == 0, std::to_string(wrong) + " wrong tangents at a zigzag mirrored seam") && ok;
+
+  //Cylinder around z with u along the circumference: tangents follow the circle, the bitangent points along z
+  Mesh cylinder;
+  const unsigned int segments = 32, rings = 4;
+  for(unsigned int r = 0; r <= rings; r++)
+  {
+    for(unsigned int s = 0; s <= segments; s++)
+    {
+      float angle = 2.0f * (float)M_PI * (float)s / (float)segments;
+      cylinder.positions.push_back(vec3(std::cos(angle), std::sin(angle), (float)r));
+      cylinder.uvs.push_back(vec2((float)s / (float)segments, (float)r / (float)rings));
+    }
+  }
+  for(unsigned int r = 0; r < rings; r++)
+  {
+    for(unsigned int s = 0; s < segments; s++)
+    {
+      uint32_t i = r * (segments + 1) + s;
+      cylinder.indices.insert(cylinder.indices.end(), { i, i + 1, i + segments + 2, i, i + segments + 2, i + segments + 1 });
+    }
+  }
+  cylinder.normals.resize(cylinder.positions.size());
+  Gum::Maths::computeNormals(cylinder.positions.data(), cylinder.positions.size(), cylinder.indices.data(), cylinder.indices.size() / 3, cylinder.normals.data(), Gum::Maths::NormalWeighting::ANGLE);
+
+  Gum::Maths::VertexCorners adjacency;
+  Gum::Maths::buildVertexCorners(cylinder.indices.data(), cylinder.indices.size() / 3, cylinder.positions.size(), adjacency);
+  std::vector<vec4> tangents = tangentsOf(cylinder), reused(cylinder.positions.size());
+  Gum::Maths::computeTangents(cylinder.positions.data(), cylinder.normals.data(), cylinder.uvs.data(), cylinder.positions.size(), cylinder.indices.data(), cylinder.indices.size() / 3, reused.data(), &adjacency);
+  wrong = 0;
+  for(size_t v = 0; v < cylinder.positions.size(); v++)
+  {
+    const vec3& p = cylinder.positions[v];
+    vec3 radial(p.x, p.y, 0.0f);
+    //The UV seam is not welded, its vertices only see the faces on one side
+    unsigned int s = (unsigned int)(v % (segments + 1));
+    float tolerance = s == 0 || s == segments ? std::sin((float)M_PI / (float)segments) + 1e-5f : 1e-5f;
+    wrong += std::abs(vec3::dot(cylinder.normals[v], radial) - 1.0f) > tolerance;
+    wrong += !near(tangents[v], vec4(-p.y, p.x, 0.0f, 1.0f), tolerance);
+    vec3 t(tangents[v].x, tangents[v].y, tangents[v].z);
+    wrong += std::abs(t.length() - 1.0f) > 1e-5f || std::abs(vec3::dot(t, cylinder.normals[v])) > 1e-5f;
+    wrong += !near(tangents[v], reused[v], 0.0f);
+  }
+  ok = check(wrong == 0, std::to_string(wrong) + " wrong normals or tangents on the cylinder") && ok;
+
+  //Without UV area every vertex still gets a unit tangent orthogonal to its normal
+  Mesh flat = planeGrid(0, 3, 2, [](float x) { return 0.0f; });
+  for(vec2& uv : flat.uvs)
+    uv = vec2(0.5f);
+  wrong = 0;
+  for(const vec4& t : tangentsOf(flat))
+    wrong += std::abs(vec3(t.x, t.y, t.z).length() - 1.0f) > 1e-6f || t.z != 0.0f || t.w != 1.0f;
+  ok = check(wrong == 0, std::to_string(wrong) + " invalid fallback tangents") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+#include <gum-maths.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+//Separating axis test written out plainly: corners of both boxes projected onto all 15 candidate axes in double
+//gap is the largest separation found, negative when the boxes overlap. faceGap only looks at the 6 face normals
+static double separation(const obb& a, const obb& b, double& faceGap)
+{
+  vec3 ca[8], cb[8];
+  a.getCorners(ca);
+  b.getCorners(cb);
+  tvec<double, 3> axes[15];
+  for(unsigned int i = 0; i < 3; i++)
+  {
+    vec3 u = a.getAxis(i), v = b.getAxis(i);
+    axes[i] = tvec<double, 3>(u.x, u.y, u.z);
+    axes[3 + i] = tvec<double, 3>(v.x, v.y, v.z);
+  }
+  for(unsigned int i = 0; i < 3; i++)
+    for(unsigned int j = 0; j < 3; j++)
+    {
+      const tvec<double, 3>& u = axes[i];
+      const tvec<double, 3>& v = axes[3 + j];
+      axes[6 + i * 3 + j] = tvec<double, 3>(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+    }
+
+  double gap = -std::numeric_limits<double>::max();
+  faceGap = gap;
+  for(unsigned int k = 0; k < 15; k++)
+  {
+    const tvec<double, 3>& n = axes[k];
+    double length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+    if(length < 1e-6)
+      continue;
+    double loA = std::numeric_limits<double>::max(), hiA = -loA, loB = loA, hiB = -loA;
+    for(unsigned int c = 0; c < 8; c++)
+    {
+      double pa = (ca[c].x * n.x + ca[c].y * n.y + ca[c].z * n.z) / length;
+      double pb = (cb[c].x * n.x + cb[c].y * n.y + cb[c].z * n.z) / length;
+      loA = std::min(loA, pa); hiA = std::max(hiA, pa);
+      loB = std::min(loB, pb); hiB = std::max(hiB, pb);
+    }
+    double axisGap = std::max(loB - hiA, loA - hiB);
+    gap = std::max(gap, axisGap);
+    if(k < 6)
+      faceGap = std::max(faceGap, axisGap);
+  }
+  return gap;
+}
+
+static obb randomBox(std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  fquat rotation(unit(rng), unit(rng), unit(rng), unit(rng));
+  float length = std::sqrt(rotation.w * rotation.w + rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z);
+  rotation = fquat(rotation.w / length, rotation.x / length, rotation.y / length, rotation.z / length);
+  return obb(vec3(unit(rng), unit(rng), unit(rng)) * 3.0f, vec3(unit(rng), unit(rng), unit(rng)) * 0.9f + vec3(1.1f), rotation);
+}
+
+//Position of p in the frame of box, in units of the half extents
+static vec3 local(const obb& box, const vec3& p)
+{
+  vec3 d = p - box.center;
+  return vec3(vec3::dot(d, box.getAxis(0)) / box.halfExtents.x, vec3::dot(d, box.getAxis(1)) / box.halfExtents.y, vec3::dot(d, box.getAxis(2)) / box.halfExtents.z);
+}
+
+static float maxAbs(const vec3& v)
+{
+  return std::max(std::max(std::abs(v.x), std::abs(v.y)), std::abs(v.z));
+}
+
+bool testIntersects()
+{
+  bool ok = true;
+  const obb unit(vec3(0.0f), vec3(1.0f));
+  ok = check(!unit.intersects(obb(vec3(2.5f, 0.0f, 0.0f), vec3(1.0f))), "separated boxes intersect") && ok;
+  ok = check(unit.intersects(obb(vec3(2.0f, 0.0f, 0.0f), vec3(1.0f))) && unit.intersects(obb(vec3(2.0f, 2.0f, 2.0f), vec3(1.0f))), "touching faces and corners have to intersect") && ok;
+  ok = check(unit.intersects(obb(vec3(1.5f, 0.5f, -0.5f), vec3(1.0f))) && unit.intersects(obb(vec3(0.0f), vec3(0.1f))), "overlapping and contained boxes have to intersect") && ok;
+  obb diamond(vec3(1.0f + std::sqrt(2.0f) + 0.01f, 0.0f, 0.0f), vec3(1.0f), fquat::toQuaternion(vec3(0.0f, 0.0f, 45.0f)));
+  ok = check(!unit.intersects(diamond), "box rotated by 45 degrees next to another") && ok;
+  diamond.center.x -= 0.02f;
+  ok = check(unit.intersects(diamond), "box rotated by 45 degrees reaching into another with its edge") && ok;
+
+  //Two sticks with diamond cross sections crossing above each other, only the cross product of their long axes separates them
+  obb along(vec3(0.0f), vec3(5.0f, 0.1f, 0.1f), fquat::toQuaternion(vec3(45.0f, 0.0f, 0.0f)));
+  obb across(vec3(0.0f, 0.0f, 0.3f), vec3(0.1f, 5.0f, 0.1f), fquat::toQuaternion(vec3(0.0f, 45.0f, 0.0f)));
+  double faceGap;
+  double gap = separation(along, across, faceGap);
+  ok = check(gap > 0.0 && faceGap < 0.0 && !along.intersects(across) && !across.intersects(along), "crossing sticks separated by an edge axis") && ok;
+  across.center.z = 0.25f;
+  ok = check(along.intersects(across) && across.intersects(along), "crossing sticks close enough to touch") && ok;
+
+  //Random boxes against the plain test, cases closer than rounding to touching are skipped
+  std::mt19937 rng(13);
+  size_t wrong = 0, edgeOnly = 0, hits = 0;
+  std::vector<obb> a(20000), b(20000);
+  for(size_t i = 0; i < a.size(); i++)
+  {
+    a[i] = randomBox(rng);
+    b[i] = randomBox(rng);
+    double gap = separation(a[i], b[i], faceGap);
+    bool expected = gap <= 0.0;
+    if(std::abs(gap) < 1e-4)
+      continue;
+    wrong += a[i].intersects(b[i]) != expected || b[i].intersects(a[i]) != expected;
+    edgeOnly += !expected && faceGap <= 0.0;
+    hits += expected;
+  }
+  ok = check(wrong == 0, std::to_string(wrong) + " random box pairs disagree with the plain separating axis test") && ok;
+  ok = check(edgeOnly > 100 && hits > 1000 && hits < a.size() - 1000, "random pairs cover too few cases: " + std::to_string(edgeOnly) + " separated by edges only, " + std::to_string(hits) + " hits") && ok;
+
+  //Batches against single tests
+  std::unique_ptr<bool[]> oneToMany(new bool[a.size()]), pairwise(new bool[a.size()]);
+  intersects(a[0], b.data(), oneToMany.get(), b.size());
+  intersects(a.data(), b.data(), pairwise.get(), a.size());
+  size_t batchWrong = 0;
+  for(size_t i = 0; i < a.size(); i++)
+    batchWrong += oneToMany[i] != a[0].intersects(b[i]) || pairwise[i] != a[i].intersects(b[i]);
+  ok = check(batchWrong == 0, std::to_string(batchWrong) + " batched box tests differ from single tests") && ok;
+  return ok;
+}
+
+bool testRays()
+{
+  bool ok = true;
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  size_t missed = 0, wrongEntry = 0, falseHits = 0, insideWrong = 0;
+  std::vector<obb> boxes;
+  std::vector<vec3> origins, directions;
+  for(unsigned int i = 0; i < 20000; i++)
+  {
+    obb box = randomBox(rng);
+    vec3 target = box.center;
+    for(unsigned int k = 0; k < 3; k++)
+      target += box.getAxis(k) * (unit(rng) * box.halfExtents.vals[k] * 0.99f);
+    vec3 origin = box.center + vec3(unit(rng), unit(rng), unit(rng)) * 10.0f;
+    vec3 direction = (target - origin) * (0.5f + (unit(rng) + 1.0f));
+
+    float distance;
+    if(box.contains(origin))
+    {
+      insideWrong += !box.intersectsRay(origin, direction, distance) || distance != 0.0f;
+      continue;
+    }
+
+    //Aimed at a point inside: the entry lies on the surface, before the target
+    if(!box.intersectsRay(origin, direction, distance))
+      missed++;
+    else
+      wrongEntry += std::abs(maxAbs(local(box, origin + direction * distance)) - 1.0f) > 1e-4f || distance <= 0.0f
+                 || (direction * distance).length() > (target - origin).length() * 1.0001f;
+
+    //The box is convex and origin outside, so it only lies on one side
+    falseHits += box.intersectsRay(origin, direction * -1.0f);
+
+    boxes.push_back(box);
+    origins.push_back(origin);
+    directions.push_back(direction);
+  }
+  ok = check(missed == 0 && wrongEntry == 0, "rays aimed into boxes: " + std::to_string(missed) + " missed, " + std::to_string(wrongEntry) + " wrong entry points") && ok;
+  ok = check(falseHits == 0, std::to_string(falseHits) + " rays pointing away hit the box") && ok;
+  ok = check(insideWrong == 0, std::to_string(insideWrong) + " rays starting inside did not report distance 0") && ok;
+
+  //Rays parallel to a face, inside and outside of its slab
+  const obb unitBox(vec3(0.0f), vec3(1.0f));
+  float distance;
+  ok = check(unitBox.intersectsRay(vec3(-5.0f, 0.5f, 0.0f), vec3(1.0f, 0.0f, 0.0f), distance) && std::abs(distance - 4.0f) < 1e-6f, "axis parallel ray through the box") && ok;
+  ok = check(!unitBox.intersectsRay(vec3(-5.0f, 1.5f, 0.0f), vec3(1.0f, 0.0f, 0.0f)) && !unitBox.intersectsRay(vec3(5.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f)), "axis parallel rays next to and behind the box") && ok;
+
+  //Batches against single tests, misses are infinity
+  std::vector<float> manyBoxes(boxes.size()), manyRays(boxes.size());
+  intersectsRay(origins[0], directions[0], boxes.data(), manyBoxes.data(), boxes.size());
+  intersectsRay(boxes[0], origins.data(), directions.data(), manyRays.data(), boxes.size());
+  size_t batchWrong = 0, batchHits = 0;
+  for(size_t i = 0; i < boxes.size(); i++)
+  {
+    float single = std::numeric_limits<float>::infinity(), d;
+    if(boxes[i].intersectsRay(origins[0], directions[0], d))
+      single = d;
+    batchWrong += manyBoxes[i] != single;
+    batchHits += single != std::numeric_limits<float>::infinity();
+    single = std::numeric_limits<float>::infinity();
+    if(boxes[0].intersectsRay(origins[i], directions[i], d))
+      single = d;
+    batchWrong += manyRays[i] != single;
+  }
+  ok = check(batchWrong == 0 && batchHits > 0, std::to_string(batchWrong) + " batched ray tests differ from single tests") && ok;
+  return ok;
+}
+
+bool testTransform()
+{
+  bool ok = true;
+  std::mt19937 rng(19);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  size_t wrong = 0, leftHanded = 0;
+  for(unsigned int i = 0; i < 2000; i++)
+  {
+    obb box = randomBox(rng);
+    //Rigid motion after a scale along the box axes, every fourth one mirrored
+    vec3 scale(1.0f + unit(rng) * 0.5f, 1.0f + unit(rng) * 0.5f, (1.0f + unit(rng) * 0.5f) * (i % 4 == 0 ? -1.0f : 1.0f));
+    mat4 toBox = translateMatrix<float>(box.center) * mat4(box.axes);
+    mat4 fromBox = mat4(mat3::transpose(box.axes)) * translateMatrix<float>(box.center * -1.0f);
+    fquat spin = fquat::toQuaternion(vec3(unit(rng), unit(rng), unit(rng)) * 180.0f);
+    mat4 m = translateMatrix<float>(vec3(unit(rng), unit(rng), unit(rng)) * 50.0f) * rotateMatrix<float>(spin) * toBox * scaleMatrix<float>(scale) * fromBox;
+    obb moved = box.transform(m);
+
+    //Every transformed corner is a corner of the new box, and the new extents are the scaled ones
+    vec3 corners[8];
+    box.getCorners(corners);
+    float cornerError = 0.0f;
+    for(const vec3& corner : corners)
+    {
+      vec3 p(m[0][0] * corner.x + m[1][0] * corner.y + m[2][0] * corner.z + m[3][0],
+             m[0][1] * corner.x + m[1][1] * corner.y + m[2][1] * corner.z + m[3][1],
+             m[0][2] * corner.x + m[1][2] * corner.y + m[2][2] * corner.z + m[3][2]);
+      vec3 l = local(moved, p);
+      cornerError = std::max(cornerError, std::max(std::max(std::abs(std::abs(l.x) - 1.0f), std::abs(std::abs(l.y) - 1.0f)), std::abs(std::abs(l.z) - 1.0f)));
+    }
+    float extentError = 0.0f;
+    for(unsigned int k = 0; k < 3; k++)
+      extentError = std::max(extentError, std::abs(moved.halfExtents.vals[k] - box.halfExtents.vals[k] * std::abs(scale.vals[k])));
+    wrong += cornerError > 1e-4f || extentError > 1e-4f;
+    leftHanded += vec3::dot(vec3::cross(moved.getAxis(0), moved.getAxis(1)), moved.getAxis(2)) < 0.999f;
+  }
+  ok = check(wrong == 0, std::to_string(wrong) + " transformed boxes do not match their transformed corners") && ok;
+  ok = check(leftHanded == 0, std::to_string(leftHanded) + " transformed boxes have no right handed orthonormal basis") && ok;
+  return ok;
+}
+
+//Fits a rotated 20 x 2 x 0.2 box of random points at the given offset
+bool fitAt(const vec3& offset)
+{
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  const vec3 half(10.0f, 1.0f, 0.1f);
+  obb reference(offset, half, fquat::toQuaternion(vec3(30.0f, 45.0f, 10.0f)));
+
+  std::vector<vec3> points(100000);
+  for(vec3& p : points)
+    p = offset + reference.getAxis(0) * (unit(random) * half.x) + reference.getAxis(1) * (unit(random) * half.y) + reference.getAxis(2) * (unit(random) * half.z);
+
+  obb fitted = obb::fromPoints(points.data(), points.size());
+  float extents[3] = { fitted.halfExtents.x, fitted.halfExtents.y, fitted.halfExtents.z };
+  std::sort(extents, extents + 3);
+
+  //Coordinates near 1e5 are only stored to about 0.01
+  const float tolerance = 0.01f + 1e-7f * std::abs(offset.x);
+  bool ok = check(std::abs(extents[2] - 10.0f) < 0.02f + tolerance && std::abs(extents[1] - 1.0f) < 0.02f + tolerance && std::abs(extents[0] - 0.1f) < 0.01f + tolerance,
+                  "half extents " + fitted.halfExtents.toString() + " at offset " + offset.toString());
+
+  size_t outside = 0;
+  for(const vec3& p : points)
+  {
+    vec3 d = p - fitted.center;
+    for(unsigned int a = 0; a < 3; a++)
+      if(std::abs(vec3::dot(d, fitted.getAxis(a))) > fitted.halfExtents.vals[a] + tolerance)
+        outside++;
+  }
+  ok = check(outside == 0, std::to_string(outside) + " points outside of the box at offset " + offset.toString()) && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = fitAt(vec3(0.0f));
+  ok = fitAt(vec3(1000.0f)) && ok;
+  ok = fitAt(vec3(1e5f, -1e5f, 1e5f)) && ok;
+  ok = testIntersects() && ok;
+  ok = testRays() && ok;
+  ok = testTransform() && ok;
+  return ok ? 0 : 1;
+}
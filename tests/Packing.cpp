@@ -0,0 +1,191 @@
+#include <gum-maths.h>
+#include <cstring>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+template<typename T>
+bool sameBits(const std::vector<T>& a, const std::vector<T>& b)
+{
+  return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+//Batch of f over in has to equal the scalar version element by element
+template<typename In, typename Out, typename Batch, typename Scalar>
+bool batchEqualsScalar(const std::vector<In>& in, Batch batch, Scalar scalar, const std::string& name)
+{
+  std::vector<Out> batched(in.size()), expected(in.size());
+  batch(in.data(), batched.data(), in.size());
+  for(size_t i = 0; i < in.size(); i++)
+    expected[i] = scalar(in[i]);
+  return check(sameBits(batched, expected), name + ": batch differs from the scalar version");
+}
+
+//Largest angle in degrees between the unit vectors and their decoded encodings
+//atan2 of sine and cosine, acos of a dot product close to 1 would only measure float rounding
+template<typename E>
+double worstNormalAngle(const std::vector<vec3>& normals, E (*encode)(const vec3&), vec3 (*decode)(E))
+{
+  double worst = 0.0;
+  for(const vec3& n : normals)
+  {
+    vec3 d = decode(encode(n));
+    double cx = (double)n.y * d.z - (double)n.z * d.y, cy = (double)n.z * d.x - (double)n.x * d.z, cz = (double)n.x * d.y - (double)n.y * d.x;
+    worst = std::max(worst, std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), (double)n.x * d.x + (double)n.y * d.y + (double)n.z * d.z));
+  }
+  return worst * 180.0 / M_PI;
+}
+
+//Angle of the rotation from q to its decoded encoding, conj(q) * d
+template<typename E>
+double worstRotationAngle(const std::vector<fquat>& rotations, E (*encode)(const fquat&), fquat (*decode)(E))
+{
+  double worst = 0.0;
+  for(const fquat& q : rotations)
+  {
+    fquat d = decode(encode(q));
+    double w = (double)q.w * d.w + (double)q.x * d.x + (double)q.y * d.y + (double)q.z * d.z;
+    double x = (double)q.w * d.x - (double)q.x * d.w - (double)q.y * d.z + (double)q.z * d.y;
+    double y = (double)q.w * d.y + (double)q.x * d.z - (double)q.y * d.w - (double)q.z * d.x;
+    double z = (double)q.w * d.z - (double)q.x * d.y + (double)q.y * d.x - (double)q.z * d.w;
+    worst = std::max(worst, 2.0 * std::atan2(std::sqrt(x * x + y * y + z * z), std::abs(w)));
+  }
+  return worst * 180.0 / M_PI;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+
+  //Unit vectors and rotations, including the axes, the octahedron edges and the seam of the lower half
+  std::mt19937 rng(17);
+  std::normal_distribution<float> gaussian;
+  std::vector<vec3> normals = { vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0), vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1), vec3(0.70710678f, 0, -0.70710678f), vec3(0, -0.70710678f, -0.70710678f) };
+  std::vector<fquat> rotations = { fquat(1, 0, 0, 0), fquat(-1, 0, 0, 0), fquat(0.5f, 0.5f, 0.5f, 0.5f), fquat(0.70710678f, 0, -0.70710678f, 0) };
+  while(normals.size() < 100000)
+  {
+    vec3 n(gaussian(rng), gaussian(rng), gaussian(rng));
+    normals.push_back(n / n.length());
+    fquat q(gaussian(rng), gaussian(rng), gaussian(rng), gaussian(rng));
+    float length = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    rotations.push_back(fquat(q.w / length, q.x / length, q.y / length, q.z / length));
+  }
+
+  //Bounds from the documentation, with a little margin for the random samples
+  double octahedral16 = worstNormalAngle<uint32_t>(normals, encodeOctahedral16, decodeOctahedral16);
+  double octahedral8 = worstNormalAngle<uint16_t>(normals, encodeOctahedral8, decodeOctahedral8);
+  double quat32 = worstRotationAngle<uint32_t>(rotations, encodeQuat32, decodeQuat32);
+  double quat64 = worstRotationAngle<uint64_t>(rotations, encodeQuat64, decodeQuat64);
+  ok = check(octahedral16 < 0.005, "octahedral 16 bit error " + std::to_string(octahedral16) + " degrees") && ok;
+  ok = check(octahedral8 < 0.7, "octahedral 8 bit error " + std::to_string(octahedral8) + " degrees") && ok;
+  ok = check(quat32 < 0.3, "quat 32 bit error " + std::to_string(quat32) + " degrees") && ok;
+  ok = check(quat64 < 0.001, "quat 64 bit error " + std::to_string(quat64) + " degrees") && ok;
+
+  //Every 8 bit octahedral code decodes to a unit vector that encodes to a code within the documented error
+  {
+    float worstLength = 0.0f;
+    size_t unstable = 0;
+    for(uint32_t code = 0; code < (1 << 16); code++)
+    {
+      vec3 n = decodeOctahedral8((uint16_t)code);
+      worstLength = std::max(worstLength, std::abs(n.length() - 1.0f));
+      vec3 again = decodeOctahedral8(encodeOctahedral8(n));
+      unstable += n.x * again.x + n.y * again.y + n.z * again.z < std::cos(0.7f * (float)M_PI / 180.0f);
+    }
+    ok = check(worstLength < 1e-6f && unstable == 0, "octahedral 8 bit codes: length error " + std::to_string(worstLength) + ", " + std::to_string(unstable) + " drift when encoded again") && ok;
+  }
+
+  //q and -q are the same rotation and decode to unit quaternions
+  {
+    size_t wrong = 0;
+    float worstLength = 0.0f;
+    for(size_t i = 0; i < 10000; i++)
+    {
+      const fquat& q = rotations[i];
+      fquat negated(-q.w, -q.x, -q.y, -q.z);
+      fquat a = decodeQuat32(encodeQuat32(q)), b = decodeQuat32(encodeQuat32(negated));
+      fquat c = decodeQuat64(encodeQuat64(q)), d = decodeQuat64(encodeQuat64(negated));
+      wrong += std::abs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z) < 0.9999f || std::abs(c.w * d.w + c.x * d.x + c.y * d.y + c.z * d.z) < 0.99999f;
+      for(const fquat& r : { a, c })
+        worstLength = std::max(worstLength, std::abs(std::sqrt(r.w * r.w + r.x * r.x + r.y * r.y + r.z * r.z) - 1.0f));
+    }
+    ok = check(wrong == 0 && worstLength < 1e-6f, "smallest three: " + std::to_string(wrong) + " negated rotations differ, length error " + std::to_string(worstLength)) && ok;
+  }
+
+  //Half a step, values outside the range are clamped
+  std::uniform_real_distribution<float> uniform(-1.2f, 1.2f);
+  std::vector<vec2> values2(20000);
+  std::vector<vec4> values4(20000);
+  for(size_t i = 0; i < values2.size(); i++)
+  {
+    values2[i] = vec2(uniform(rng), uniform(rng));
+    values4[i] = vec4(uniform(rng), uniform(rng), uniform(rng), uniform(rng));
+  }
+  float snorm16 = 0.0f, unorm16 = 0.0f, snorm8 = 0.0f, unorm8 = 0.0f, snorm4x16 = 0.0f, unorm4x16 = 0.0f;
+  for(size_t i = 0; i < values2.size(); i++)
+  {
+    vec2 s2 = unpackSnorm2x16(packSnorm2x16(values2[i])), u2 = unpackUnorm2x16(packUnorm2x16(values2[i]));
+    vec4 s8 = unpackSnorm4x8(packSnorm4x8(values4[i])), u8 = unpackUnorm4x8(packUnorm4x8(values4[i]));
+    vec4 s16 = unpackSnorm4x16(packSnorm4x16(values4[i])), u16 = unpackUnorm4x16(packUnorm4x16(values4[i]));
+    for(unsigned int c = 0; c < 4; c++)
+    {
+      float v = values4[i].vals[c], signedValue = std::min(std::max(v, -1.0f), 1.0f), unsignedValue = std::min(std::max(v, 0.0f), 1.0f);
+      if(c < 2)
+      {
+        float w = values2[i].vals[c];
+        snorm16 = std::max(snorm16, std::abs(s2.vals[c] - std::min(std::max(w, -1.0f), 1.0f)));
+        unorm16 = std::max(unorm16, std::abs(u2.vals[c] - std::min(std::max(w, 0.0f), 1.0f)));
+      }
+      snorm8 = std::max(snorm8, std::abs(s8.vals[c] - signedValue));
+      unorm8 = std::max(unorm8, std::abs(u8.vals[c] - unsignedValue));
+      snorm4x16 = std::max(snorm4x16, std::abs(s16.vals[c] - signedValue));
+      unorm4x16 = std::max(unorm4x16, std::abs(u16.vals[c] - unsignedValue));
+    }
+  }
+  ok = check(snorm16 <= 1.54e-5f && snorm4x16 <= 1.54e-5f, "snorm 16 error " + std::to_string(std::max(snorm16, snorm4x16))) && ok;
+  ok = check(unorm16 <= 7.7e-6f && unorm4x16 <= 7.7e-6f, "unorm 16 error " + std::to_string(std::max(unorm16, unorm4x16))) && ok;
+  ok = check(snorm8 <= 3.95e-3f, "snorm 8 error " + std::to_string(snorm8)) && ok;
+  ok = check(unorm8 <= 1.97e-3f, "unorm 8 error " + std::to_string(unorm8)) && ok;
+  ok = check(unpackSnorm2x16(packSnorm2x16(vec2(-1.0f, 1.0f))) == vec2(-1.0f, 1.0f) && unpackUnorm4x8(packUnorm4x8(vec4(0, 1, 0, 1))) == vec4(0, 1, 0, 1), "range ends have to be exact") && ok;
+
+  ok = batchEqualsScalar<vec3, uint32_t>(normals, (void(*)(const vec3*, uint32_t*, size_t))encodeOctahedral16, (uint32_t(*)(const vec3&))encodeOctahedral16, "encodeOctahedral16") && ok;
+  ok = batchEqualsScalar<vec3, uint16_t>(normals, (void(*)(const vec3*, uint16_t*, size_t))encodeOctahedral8, (uint16_t(*)(const vec3&))encodeOctahedral8, "encodeOctahedral8") && ok;
+  ok = batchEqualsScalar<fquat, uint32_t>(rotations, (void(*)(const fquat*, uint32_t*, size_t))encodeQuat32, (uint32_t(*)(const fquat&))encodeQuat32, "encodeQuat32") && ok;
+  ok = batchEqualsScalar<fquat, uint64_t>(rotations, (void(*)(const fquat*, uint64_t*, size_t))encodeQuat64, (uint64_t(*)(const fquat&))encodeQuat64, "encodeQuat64") && ok;
+  ok = batchEqualsScalar<vec2, uint32_t>(values2, (void(*)(const vec2*, uint32_t*, size_t))packSnorm2x16, (uint32_t(*)(const vec2&))packSnorm2x16, "packSnorm2x16") && ok;
+  ok = batchEqualsScalar<vec2, uint32_t>(values2, (void(*)(const vec2*, uint32_t*, size_t))packUnorm2x16, (uint32_t(*)(const vec2&))packUnorm2x16, "packUnorm2x16") && ok;
+  ok = batchEqualsScalar<vec4, uint32_t>(values4, (void(*)(const vec4*, uint32_t*, size_t))packSnorm4x8, (uint32_t(*)(const vec4&))packSnorm4x8, "packSnorm4x8") && ok;
+  ok = batchEqualsScalar<vec4, uint32_t>(values4, (void(*)(const vec4*, uint32_t*, size_t))packUnorm4x8, (uint32_t(*)(const vec4&))packUnorm4x8, "packUnorm4x8") && ok;
+  ok = batchEqualsScalar<vec4, uint64_t>(values4, (void(*)(const vec4*, uint64_t*, size_t))packSnorm4x16, (uint64_t(*)(const vec4&))packSnorm4x16, "packSnorm4x16") && ok;
+  ok = batchEqualsScalar<vec4, uint64_t>(values4, (void(*)(const vec4*, uint64_t*, size_t))packUnorm4x16, (uint64_t(*)(const vec4&))packUnorm4x16, "packUnorm4x16") && ok;
+
+  std::vector<uint32_t> codes32(20000);
+  std::vector<uint16_t> codes16(20000);
+  std::vector<uint64_t> codes64(20000);
+  for(size_t i = 0; i < codes32.size(); i++)
+  {
+    codes32[i] = (uint32_t)rng();
+    codes16[i] = (uint16_t)rng();
+    codes64[i] = (uint64_t)rng() << 32 | rng();
+  }
+  ok = batchEqualsScalar<uint32_t, vec3>(codes32, (void(*)(const uint32_t*, vec3*, size_t))decodeOctahedral16, (vec3(*)(uint32_t))decodeOctahedral16, "decodeOctahedral16") && ok;
+  ok = batchEqualsScalar<uint16_t, vec3>(codes16, (void(*)(const uint16_t*, vec3*, size_t))decodeOctahedral8, (vec3(*)(uint16_t))decodeOctahedral8, "decodeOctahedral8") && ok;
+  ok = batchEqualsScalar<uint32_t, fquat>(codes32, (void(*)(const uint32_t*, fquat*, size_t))decodeQuat32, (fquat(*)(uint32_t))decodeQuat32, "decodeQuat32") && ok;
+  ok = batchEqualsScalar<uint64_t, fquat>(codes64, (void(*)(const uint64_t*, fquat*, size_t))decodeQuat64, (fquat(*)(uint64_t))decodeQuat64, "decodeQuat64") && ok;
+  ok = batchEqualsScalar<uint32_t, vec2>(codes32, (void(*)(const uint32_t*, vec2*, size_t))unpackSnorm2x16, (vec2(*)(uint32_t))unpackSnorm2x16, "unpackSnorm2x16") && ok;
+  ok = batchEqualsScalar<uint32_t, vec2>(codes32, (void(*)(const uint32_t*, vec2*, size_t))unpackUnorm2x16, (vec2(*)(uint32_t))unpackUnorm2x16, "unpackUnorm2x16") && ok;
+  ok = batchEqualsScalar<uint32_t, vec4>(codes32, (void(*)(const uint32_t*, vec4*, size_t))unpackSnorm4x8, (vec4(*)(uint32_t))unpackSnorm4x8, "unpackSnorm4x8") && ok;
+  ok = batchEqualsScalar<uint32_t, vec4>(codes32, (void(*)(const uint32_t*, vec4*, size_t))unpackUnorm4x8, (vec4(*)(uint32_t))unpackUnorm4x8, "unpackUnorm4x8") && ok;
+  ok = batchEqualsScalar<uint64_t, vec4>(codes64, (void(*)(const uint64_t*, vec4*, size_t))unpackSnorm4x16, (vec4(*)(uint64_t))unpackSnorm4x16, "unpackSnorm4x16") && ok;
+  ok = batchEqualsScalar<uint64_t, vec4>(codes64, (void(*)(const uint64_t*, vec4*, size_t))unpackUnorm4x16, (vec4(*)(uint64_t))unpackUnorm4x16, "unpackUnorm4x16") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <gum-maths.h>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+/**
+ * Integer coordinates make the exact determinant computable in 128 bit integers. They are large
+ * enough that the products round in double and the points are nearly or exactly collinear,
+ * coplanar or cocircular, so the plain double determinant often has the wrong sign here.
+ */
+typedef __int128 int128;
+
+static int sign(int128 v)  { return v > 0 ? 1 : (v < 0 ? -1 : 0); }
+static int sign(double v)  { return v > 0.0 ? 1 : (v < 0.0 ? -1 : 0); }
+
+static int128 det3(int128 a0, int128 a1, int128 a2, int128 b0, int128 b1, int128 b2, int128 c0, int128 c1, int128 c2)
+{
+  return a0 * (b1 * c2 - b2 * c1) - a1 * (b0 * c2 - b2 * c0) + a2 * (b0 * c1 - b1 * c0);
+}
+
+static int exactOrient2d(const dvec2& a, const dvec2& b, const dvec2& c)
+{
+  int128 acx = (int64_t)a.x - (int64_t)c.x, acy = (int64_t)a.y - (int64_t)c.y;
+  int128 bcx = (int64_t)b.x - (int64_t)c.x, bcy = (int64_t)b.y - (int64_t)c.y;
+  return sign(acx * bcy - acy * bcx);
+}
+
+static int exactOrient3d(const dvec3& a, const dvec3& b, const dvec3& c, const dvec3& d)
+{
+  return sign(det3((int64_t)a.x - (int64_t)d.x, (int64_t)a.y - (int64_t)d.y, (int64_t)a.z - (int64_t)d.z,
+                   (int64_t)b.x - (int64_t)d.x, (int64_t)b.y - (int64_t)d.y, (int64_t)b.z - (int64_t)d.z,
+                   (int64_t)c.x - (int64_t)d.x, (int64_t)c.y - (int64_t)d.y, (int64_t)c.z - (int64_t)d.z));
+}
+
+static int exactIncircle(const dvec2& a, const dvec2& b, const dvec2& c, const dvec2& d)
+{
+  int128 adx = (int64_t)a.x - (int64_t)d.x, ady = (int64_t)a.y - (int64_t)d.y;
+  int128 bdx = (int64_t)b.x - (int64_t)d.x, bdy = (int64_t)b.y - (int64_t)d.y;
+  int128 cdx = (int64_t)c.x - (int64_t)d.x, cdy = (int64_t)c.y - (int64_t)d.y;
+  return sign(det3(adx, ady, adx * adx + ady * ady, bdx, bdy, bdx * bdx + bdy * bdy, cdx, cdy, cdx * cdx + cdy * cdy));
+}
+
+int main(int argc, char** argv)
+{
+  const size_t COUNT = 100000;
+  std::mt19937_64 rng(23);
+  std::uniform_int_distribution<int> perturbation(-1, 1), small(-7, 7);
+  bool ok = true;
+
+  //Coordinates below 2^40: the products need up to 82 bits
+  {
+    std::uniform_int_distribution<int64_t> coordinate(-(1ll << 40), 1ll << 40), step(-(1ll << 20), 1ll << 20);
+    std::vector<dvec2> a(COUNT), b(COUNT), c(COUNT);
+    size_t errors = 0, zeros = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      dvec2 v((double)step(rng), (double)step(rng));
+      a[i] = dvec2((double)coordinate(rng), (double)coordinate(rng));
+      b[i] = a[i] + v * (double)small(rng);
+      c[i] = a[i] + v * (double)(small(rng) * 65536 + 1) + dvec2((double)perturbation(rng), (double)perturbation(rng));
+      int expected = exactOrient2d(a[i], b[i], c[i]);
+      zeros += expected == 0;
+      errors += sign(Gum::Maths::orient2d(a[i], b[i], c[i])) != expected;
+    }
+    std::vector<double> results(COUNT);
+    Gum::Maths::orient2d(a.data(), b.data(), c.data(), results.data(), COUNT);
+    size_t batchErrors = 0;
+    for(size_t i = 0; i < COUNT; i++)
+      batchErrors += sign(results[i]) != exactOrient2d(a[i], b[i], c[i]);
+    ok = check(errors == 0 && batchErrors == 0, "orient2d: " + std::to_string(errors) + " scalar and " + std::to_string(batchErrors) + " batch sign errors") && ok;
+    ok = check(zeros > COUNT / 10 && zeros < COUNT - COUNT / 10, "orient2d: " + std::to_string(zeros) + " collinear cases") && ok;
+  }
+
+  //Coordinates below 2^30: the terms need up to 96 bits
+  {
+    std::uniform_int_distribution<int64_t> coordinate(-(1ll << 30), 1ll << 30), step(-(1ll << 14), 1ll << 14);
+    std::vector<dvec3> a(COUNT), b(COUNT), c(COUNT), d(COUNT);
+    size_t errors = 0, zeros = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      dvec3 u((double)step(rng), (double)step(rng), (double)step(rng));
+      dvec3 v((double)step(rng), (double)step(rng), (double)step(rng));
+      a[i] = dvec3((double)coordinate(rng), (double)coordinate(rng), (double)coordinate(rng));
+      b[i] = a[i] + u * (double)small(rng) + v * (double)small(rng);
+      c[i] = a[i] + u * (double)small(rng) + v * (double)small(rng);
+      d[i] = a[i] + u * (double)(small(rng) * 4096 + 1) + v * (double)(small(rng) * 4096 - 1) + dvec3((double)perturbation(rng), (double)perturbation(rng), (double)perturbation(rng));
+      int expected = exactOrient3d(a[i], b[i], c[i], d[i]);
+      zeros += expected == 0;
+      errors += sign(Gum::Maths::orient3d(a[i], b[i], c[i], d[i])) != expected;
+    }
+    std::vector<double> results(COUNT);
+    Gum::Maths::orient3d(a.data(), b.data(), c.data(), d.data(), results.data(), COUNT);
+    size_t batchErrors = 0;
+    for(size_t i = 0; i < COUNT; i++)
+      batchErrors += sign(results[i]) != exactOrient3d(a[i], b[i], c[i], d[i]);
+    ok = check(errors == 0 && batchErrors == 0, "orient3d: " + std::to_string(errors) + " scalar and " + std::to_string(batchErrors) + " batch sign errors") && ok;
+    ok = check(zeros > COUNT / 20, "orient3d: " + std::to_string(zeros) + " coplanar cases") && ok;
+  }
+
+  //Coordinates below 2^24: the lifted terms need up to 103 bits. Rectangle corners are exactly cocircular
+  {
+    std::uniform_int_distribution<int64_t> coordinate(-(1ll << 24), 1ll << 24), extent(1, 1ll << 22);
+    std::vector<dvec2> a(COUNT), b(COUNT), c(COUNT), d(COUNT);
+    size_t errors = 0, zeros = 0;
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      dvec2 corner((double)coordinate(rng), (double)coordinate(rng));
+      double w = (double)extent(rng), h = (double)extent(rng);
+      a[i] = corner;
+      b[i] = corner + dvec2(w, 0.0);
+      c[i] = corner + dvec2(w, h);
+      d[i] = corner + dvec2((double)perturbation(rng), h + (double)perturbation(rng));
+      if(i % 2)
+        std::swap(a[i], b[i]);
+      int expected = exactIncircle(a[i], b[i], c[i], d[i]);
+      zeros += expected == 0;
+      errors += sign(Gum::Maths::incircle(a[i], b[i], c[i], d[i])) != expected;
+    }
+    std::vector<double> results(COUNT);
+    Gum::Maths::incircle(a.data(), b.data(), c.data(), d.data(), results.data(), COUNT);
+    size_t batchErrors = 0;
+    for(size_t i = 0; i < COUNT; i++)
+      batchErrors += sign(results[i]) != exactIncircle(a[i], b[i], c[i], d[i]);
+    ok = check(errors == 0 && batchErrors == 0, "incircle: " + std::to_string(errors) + " scalar and " + std::to_string(batchErrors) + " batch sign errors") && ok;
+    ok = check(zeros > COUNT / 20, "incircle: " + std::to_string(zeros) + " cocircular cases") && ok;
+  }
+
+  //The documented orientation
+  ok = check(Gum::Maths::orient2d(dvec2(0, 0), dvec2(1, 0), dvec2(0, 1)) > 0.0, "orient2d has to be positive for counter clockwise points") && ok;
+  ok = check(Gum::Maths::orient3d(dvec3(0, 0, 0), dvec3(1, 0, 0), dvec3(0, 1, 0), dvec3(0, 0, -1)) > 0.0, "orient3d has to be positive below the plane") && ok;
+  ok = check(Gum::Maths::incircle(dvec2(0, 0), dvec2(1, 0), dvec2(0, 1), dvec2(0.25, 0.25)) > 0.0, "incircle has to be positive inside") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -1,13 +1,14 @@
 #include <gum-maths.h>
 #include <cassert>
 
+//Euler angles are not unique (pitch > 90, gimbal lock), so the rotations are compared, q and -q being the same
 template<typename T>
-bool unitTest(T given, T expected)
+bool unitTest(quat<T> given, quat<T> expected, T tolerance)
 {
-  if(given != expected)
+  T distance = std::min(std::abs(quat<T>::dot(given, expected) - (T)1), std::abs(quat<T>::dot(given, expected) + (T)1));
+  if(distance > tolerance)
   {
-    std::cerr << "Unit test failed: expected " << expected.toString("", "", ", ", 10) << ", got " << given.toString("", "", ", ", 10) << std::endl;
-    //assert(false);
+    std::cerr << "Unit test failed: expected " << expected.toString() << ", got " << given.toString() << std::endl;
     return false;
   }
 
@@ -16,16 +17,51 @@ bool unitTest(T given, T expected)
 
 int main(int argc, char** argv)
 {
-  for(float i = 0.0f; i < 180; i += 1.0f)
-  for(float j = 0.0f; j < 180; j += 1.0f)
-  for(float k = 0.0f; k < 180; k += 1.0f)
+  //Every grid point is converted on its own, split across the default ThreadPool
+  const size_t steps = 180;
+  size_t failed = Gum::Maths::parallelReduce(0, steps * steps * steps, (size_t)0, [](size_t begin, size_t end, size_t failed) {
+    for(size_t n = begin; n < end; n++)
+    {
+      vec3 testVal((float)(n / (steps * steps)), (float)(n / steps % steps), (float)(n % steps));
+      fquat q = fquat::toQuaternion(testVal);
+      if(!unitTest(fquat::toQuaternion(fquat::toEuler(q)), q, 1e-5f))
+        failed++;
+    }
+    return failed;
+  }, [](size_t a, size_t b) { return a + b; }, 4096);
+
+  if(failed > 0)
+    std::cerr << failed << " of " << steps * steps * steps << " conversions failed" << std::endl;
+
+  //Close to gimbal lock roll and yaw used to come from atan2 of rounding noise, at lock yaw has to be 0
+  const float pitches[] = { 90.0f, 89.999f, 89.99f, 89.9f, -89.9f, -89.99f, -89.999f, -90.0f };
+  for(float pitch : pitches)
   {
-    vec3 testVal(i,j,k);
-    fquat q = fquat::toQuaternion(testVal);
-    //if(!unitTest(fquat::toEuler(q), testVal))
-      //return 1;
-    unitTest(fquat::toEuler(q), testVal);
+    for(int roll = -170; roll <= 170; roll += 17)
+    {
+      for(int yaw = -170; yaw <= 170; yaw += 19)
+      {
+        fquat q = fquat::toQuaternion(vec3((float)roll, pitch, (float)yaw));
+        vec3 euler = fquat::toEuler(q);
+        if(!unitTest(fquat::toQuaternion(euler), q, 1e-5f) || (std::abs(pitch) == 90.0f && euler.z != 0.0f))
+          failed++;
+      }
+    }
   }
 
-	return 1;
+  //Away from the lock the angles come back unchanged
+  for(int pitch = -85; pitch <= 85; pitch += 5)
+  {
+    for(int roll = -175; roll <= 175; roll += 25)
+    {
+      vec3 angles((float)roll, (float)pitch, (float)-roll / 2);
+      vec3 euler = fquat::toEuler(fquat::toQuaternion(angles));
+      if(std::abs(euler.x - angles.x) > 1e-3f || std::abs(euler.y - angles.y) > 1e-3f || std::abs(euler.z - angles.z) > 1e-3f)
+      {
+        std::cerr << "Unit test failed: expected " << angles.toString() << ", got " << euler.toString() << std::endl;
+        failed++;
+      }
+    }
+  }
+	return failed == 0 ? 0 : 1;
 };
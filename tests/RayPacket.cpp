@@ -0,0 +1,148 @@
+#include <gum-maths.h>
+#include <cstring>
+#include <random>
+
+using Gum::Maths::RayHit;
+using Gum::Maths::RayPacket;
+using Gum::Maths::RayPacketHit;
+using Gum::Maths::vfloat4;
+using Gum::Maths::vfloat8;
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+/**
+ * Small integer coordinates keep every product exact, so the packet and the scalar code have to
+ * agree bit for bit whether or not the compiler contracts them into fused multiply adds.
+ * Directions with zero components give axis parallel rays, a few directions are NaN.
+ */
+static std::vector<ray3> randomRays(size_t count, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> coordinate(-8, 8), component(-3, 3), choice(0, 15);
+  std::vector<ray3> rays;
+  for(size_t i = 0; i < count; i++)
+  {
+    vec3 origin((float)coordinate(rng), (float)coordinate(rng), (float)coordinate(rng));
+    vec3 direction((float)component(rng), (float)component(rng), (float)component(rng));
+    if(choice(rng) == 0)
+      direction.vals[choice(rng) % 3] = std::numeric_limits<float>::quiet_NaN();
+    float tmin = choice(rng) < 4 ? 0.5f : 0.0f;
+    float tmax = choice(rng) < 4 ? 2.0f : std::numeric_limits<float>::infinity();
+    rays.push_back(ray3(origin, direction, tmin, tmax));
+  }
+  return rays;
+}
+
+//Closest hit like RayPacket: tmax shrinks to every hit, so of two equally distant triangles the later one wins
+static RayHit scalarHit(ray3 ray, const std::vector<vec3>& vertices, const std::vector<uint32_t>& indices)
+{
+  RayHit hit = { std::numeric_limits<float>::infinity(), 0.0f, 0.0f, RayHit::NO_HIT };
+  for(size_t i = 0; i < indices.size() / 3; i++)
+  {
+    float t, u, v;
+    if(ray.intersectsTriangle(vertices[indices[3 * i]], vertices[indices[3 * i + 1]], vertices[indices[3 * i + 2]], t, u, v))
+    {
+      hit = { t, u, v, (uint32_t)i };
+      ray.tmax = t;
+    }
+  }
+  return hit;
+}
+
+static bool sameHit(const RayHit& a, const RayHit& b)
+{
+  return a.primitive == b.primitive && (a.primitive == RayHit::NO_HIT || (a.distance == b.distance && a.u == b.u && a.v == b.v));
+}
+
+template<typename V>
+static bool testPacket(const std::vector<ray3>& rays, const std::vector<vec3>& vertices, const std::vector<uint32_t>& indices, const bbox3& box, const std::string& name)
+{
+  size_t triangleMismatches = 0, boxMismatches = 0;
+  for(size_t first = 0; first < rays.size(); first += V::width)
+  {
+    size_t count = std::min<size_t>(V::width, rays.size() - first);
+    RayPacket<V> packet(rays.data() + first, count);
+    RayPacketHit<V> packetHit;
+    for(size_t i = 0; i < indices.size() / 3; i++)
+      packet.intersectTriangle(vertices[indices[3 * i]], vertices[indices[3 * i + 1]], vertices[indices[3 * i + 2]], (uint32_t)i, packetHit);
+    RayHit hits[V::width];
+    packetHit.store(hits, count);
+
+    V tNear, tFar;
+    alignas(32) float boxMask[V::width], near[V::width];
+    RayPacket<V>(rays.data() + first, count).intersectBox(box, tNear, tFar).storeAligned(boxMask);
+    tNear.storeAligned(near);
+
+    for(size_t l = 0; l < count; l++)
+    {
+      if(!sameHit(hits[l], scalarHit(rays[first + l], vertices, indices)))
+        triangleMismatches++;
+      float scalarNear, scalarFar;
+      bool scalarHitsBox = rays[first + l].intersectsBox(box, scalarNear, scalarFar);
+      uint32_t maskBits;
+      memcpy(&maskBits, &boxMask[l], sizeof(maskBits));
+      if((maskBits != 0) != scalarHitsBox || (scalarHitsBox && !(near[l] == scalarNear || (near[l] != near[l] && scalarNear != scalarNear))))
+        boxMismatches++;
+    }
+  }
+  bool ok = check(triangleMismatches == 0, name + ": " + std::to_string(triangleMismatches) + " triangle hits differ from the scalar test");
+  return check(boxMismatches == 0, name + ": " + std::to_string(boxMismatches) + " box hits differ from the scalar test") && ok;
+}
+
+int main(int argc, char** argv)
+{
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> coordinate(-6, 6);
+  std::vector<vec3> vertices;
+  std::vector<uint32_t> indices;
+  for(uint32_t i = 0; i < 3 * 48; i++)
+  {
+    vertices.push_back(vec3((float)coordinate(rng), (float)coordinate(rng), (float)coordinate(rng)));
+    indices.push_back(i);
+  }
+  //Shared edge and a triangle lying in an axis plane
+  vertices.push_back(vec3(-4, -4, 0)); vertices.push_back(vec3(4, -4, 0)); vertices.push_back(vec3(0, 4, 0));
+  indices.insert(indices.end(), { 144, 145, 146 });
+  const bbox3 box(vec3(-2, -3, -1), vec3(4, 5, 3));
+
+  //1003 rays: full packets and a partly filled last one
+  std::vector<ray3> rays = randomRays(1003, rng);
+
+  bool ok = testPacket<vfloat4>(rays, vertices, indices, box, "RayPacket4");
+  ok = testPacket<vfloat8>(rays, vertices, indices, box, "RayPacket8") && ok;
+
+  //Batched functions against the scalar code, and the scene has to produce both hits and misses
+  std::vector<RayHit> hits(rays.size());
+  std::vector<float> distances(rays.size());
+  Gum::Maths::intersectTriangles(rays.data(), hits.data(), rays.size(), vertices.data(), indices.data(), indices.size() / 3);
+  Gum::Maths::intersectBox(rays.data(), distances.data(), rays.size(), box);
+  size_t hitCount = 0, boxHitCount = 0, mismatches = 0;
+  for(size_t i = 0; i < rays.size(); i++)
+  {
+    RayHit expected = scalarHit(rays[i], vertices, indices);
+    hitCount += expected.primitive != RayHit::NO_HIT;
+    mismatches += !sameHit(hits[i], expected);
+
+    float tNear, tFar;
+    bool boxHit = rays[i].intersectsBox(box, tNear, tFar);
+    boxHitCount += boxHit;
+    float expectedDistance = boxHit ? tNear : std::numeric_limits<float>::infinity();
+    mismatches += !(distances[i] == expectedDistance || (distances[i] != distances[i] && expectedDistance != expectedDistance));
+  }
+  ok = check(mismatches == 0, std::to_string(mismatches) + " batched results differ from the scalar test") && ok;
+  ok = check(hitCount > 50 && hitCount < rays.size() - 50, "triangle hits " + std::to_string(hitCount) + " of " + std::to_string(rays.size())) && ok;
+  ok = check(boxHitCount > 50 && boxHitCount < rays.size() - 50, "box hits " + std::to_string(boxHitCount) + " of " + std::to_string(rays.size())) && ok;
+
+  //A NaN direction never hits a triangle
+  ray3 nanRay(vec3(0, 0, 5), vec3(0, std::numeric_limits<float>::quiet_NaN(), -1));
+  RayHit nanHit;
+  Gum::Maths::intersectTriangles(&nanRay, &nanHit, 1, vertices.data(), indices.data(), indices.size() / 3);
+  ok = check(nanHit.primitive == RayHit::NO_HIT && std::isinf(nanHit.distance), "NaN direction has to miss") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <gum-maths.h>
+#include <cmath>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+//1D Laplacian with Dirichlet ends, tridiagonal (-1, 2 + shift, -1) plus an optional one sided convection term
+smatrixd laplacian(size_t n, double convection)
+{
+  std::vector<smatrixd::Triplet> triplets;
+  for(size_t i = 0; i < n; i++)
+  {
+    triplets.push_back({ i, i, 2.0 + convection });
+    if(i > 0)     triplets.push_back({ i, i - 1, -1.0 - convection });
+    if(i + 1 < n) triplets.push_back({ i, i + 1, -1.0 });
+  }
+  return smatrixd::fromTriplets(n, n, triplets);
+}
+
+template<typename V>
+double maxError(const std::vector<V>& a, const std::vector<V>& b)
+{
+  double error = 0.0;
+  for(size_t i = 0; i < a.size(); i++)
+    error = std::max(error, (double)(a[i] - b[i]).length());
+  return error;
+}
+
+double maxError(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double error = 0.0;
+  for(size_t i = 0; i < a.size(); i++)
+    error = std::max(error, std::abs(a[i] - b[i]));
+  return error;
+}
+
+int main(int argc, char** argv)
+{
+  const size_t n = 200;
+  Gum::Maths::SparseSolverSettings settings;
+  settings.tolerance = 1e-10;
+  bool ok = true;
+
+  //b from a known solution, CG has to find it on the symmetric matrix
+  smatrixd A = laplacian(n, 0.0);
+  std::vector<double> solution(n), x(n, 0.0);
+  for(size_t i = 0; i < n; i++)
+    solution[i] = std::sin(0.05 * (double)i) + 0.01 * (double)i;
+  std::vector<double> b = A * solution;
+  Gum::Maths::SparseSolverResult result = Gum::Maths::conjugateGradient(A, b.data(), x.data(), settings);
+  ok = check(result.converged && result.iterations <= n && maxError(x, solution) < 1e-6, "CG on the 1D Laplacian, error " + std::to_string(maxError(x, solution))) && ok;
+
+  //Same matrix acting on every component of dvec3 entries
+  std::vector<dvec3> solution3(n), x3(n, dvec3(0.0));
+  for(size_t i = 0; i < n; i++)
+    solution3[i] = dvec3(solution[i], -2.0 * solution[i], std::cos(0.1 * (double)i));
+  std::vector<dvec3> b3 = A * solution3;
+  result = Gum::Maths::conjugateGradient(A, b3.data(), x3.data(), settings);
+  ok = check(result.converged && maxError(x3, solution3) < 1e-6, "CG on dvec3 entries, error " + std::to_string(maxError(x3, solution3))) && ok;
+
+  //Non symmetric, BiCGSTAB
+  smatrixd C = laplacian(n, 0.5);
+  std::fill(x.begin(), x.end(), 0.0);
+  b = C * solution;
+  result = Gum::Maths::biCGSTAB(C, b.data(), x.data(), settings);
+  ok = check(result.converged && maxError(x, solution) < 1e-6, "BiCGSTAB on the convection matrix, error " + std::to_string(maxError(x, solution))) && ok;
+
+  //The transposed product of CSC equals the product with the transposed matrix
+  std::vector<double> y1(n), y2(n);
+  C.toCSC().transposeMultiply(solution.data(), y1.data());
+  C.transposed().multiply(solution.data(), y2.data());
+  ok = check(maxError(y1, y2) < 1e-12, "transposed products") && ok;
+  return ok ? 0 : 1;
+}
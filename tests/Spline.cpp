@@ -0,0 +1,219 @@
+#include <gum-maths.h>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using Gum::Maths::SplineType;
+
+static double difference(const dvec3& a, const dvec3& b)
+{
+  return std::max(std::abs(a.x - b.x), std::max(std::abs(a.y - b.y), std::abs(a.z - b.z)));
+}
+
+static double norm(const dvec3& v)
+{
+  return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+//Arc length from a to b with two point Gauss on a fine grid inside every segment. The nodes never
+//touch the segment joins, where the speed may jump
+static double referenceLength(const dspline3& spline, double a, double b, unsigned int steps = 1000)
+{
+  const double node = 0.5 / std::sqrt(3.0);
+  double sum = 0.0;
+  while(a < b)
+  {
+    double end = std::min(std::floor(a) + 1.0, b), h = (end - a) / steps;
+    for(unsigned int i = 0; i < steps; i++)
+    {
+      double center = a + (i + 0.5) * h;
+      sum += (norm(spline.tangent(center - node * h)) + norm(spline.tangent(center + node * h))) * h * 0.5;
+    }
+    a = end;
+  }
+  return sum;
+}
+
+//Largest jump of position and tangent direction across the segment joins. Non uniform Catmull-Rom
+//only keeps the direction, the speed changes with the knot spacing
+static double jointError(const dspline3& spline)
+{
+  const double e = 1e-9;
+  double worst = 0.0;
+  for(size_t k = 1; k < spline.getSegmentCount(); k++)
+  {
+    dvec3 before = spline.tangent(k - e), after = spline.tangent(k + e);
+    worst = std::max(worst, difference(spline.evaluate(k - e), spline.evaluate(k + e)));
+    worst = std::max(worst, difference(before / norm(before), after / norm(after)));
+  }
+  return worst;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+  const std::vector<dvec3> points = {
+    dvec3(0.0, 0.0, 0.0), dvec3(4.0, 1.0, 0.0), dvec3(5.0, 5.0, 1.0), dvec3(5.2, 5.1, 1.0),
+    dvec3(1.0, 6.0, -2.0), dvec3(-3.0, 2.0, 0.0), dvec3(-2.0, -4.0, 3.0)
+  };
+  const size_t n = points.size();
+
+  //Catmull-Rom passes through every control point, open and closed, for every alpha
+  for(double alpha : { 0.0, 0.5, 1.0 })
+  {
+    for(bool closed : { false, true })
+    {
+      dspline3 spline(SplineType::CATMULL_ROM);
+      spline.setAlpha(alpha);
+      spline.setPoints(points, closed);
+      std::string name = "Catmull-Rom alpha " + std::to_string(alpha) + (closed ? " closed" : " open");
+      double error = 0.0;
+      for(size_t i = 0; i < n; i++)
+        error = std::max(error, difference(spline.evaluate((double)i), points[i]));
+      if(closed)
+        error = std::max(error, difference(spline.evaluate((double)n), points[0]));
+      ok = check(spline.getSegmentCount() == (closed ? n : n - 1), name + ": segment count") && ok;
+      ok = check(error < 1e-12, name + ": misses the control points by " + std::to_string(error)) && ok;
+      ok = check(jointError(spline) < 1e-6, name + ": tangent direction jumps at the joins") && ok;
+    }
+  }
+
+  //Closed paths wrap around: the loop closes with a matching tangent and distances are taken modulo the length
+  {
+    dspline3 spline(SplineType::CATMULL_ROM, points, true);
+    double length = spline.getLength();
+    dvec3 first = spline.tangent(0.0), last = spline.tangent((double)n);
+    ok = check(difference(first / norm(first), last / norm(last)) < 1e-12, "closed Catmull-Rom: tangent direction jumps where the loop closes") && ok;
+    double wrapError = 0.0;
+    for(double d : { 0.0, 0.3, 7.5, 20.0 })
+    {
+      wrapError = std::max(wrapError, std::abs(spline.getParameter(d + length) - spline.getParameter(d)));
+      wrapError = std::max(wrapError, std::abs(spline.getParameter(d - 2.0 * length) - spline.getParameter(d)));
+      wrapError = std::max(wrapError, std::abs(spline.getParameterFast(-d) - spline.getParameterFast(length - d)));
+    }
+    ok = check(wrapError < 1e-9, "closed Catmull-Rom: distances do not wrap, error " + std::to_string(wrapError)) && ok;
+
+    std::vector<dvec3> loop(500);
+    spline.sampleUniform(loop.data(), loop.size());
+    double step = norm(loop[1] - loop[0]), closing = norm(loop[0] - loop.back());
+    ok = check(std::abs(closing - step) < 1e-3 * step, "closed Catmull-Rom: the last uniform step does not lead back to the start") && ok;
+  }
+
+  //Open distances are clamped to the ends
+  dspline3 spline(SplineType::CATMULL_ROM, points);
+  const double length = spline.getLength();
+  ok = check(spline.getParameter(-1.0) == 0.0 && spline.getParameter(length + 1.0) == (double)(n - 1), "open Catmull-Rom: distances have to be clamped") && ok;
+
+  //The arc length table against a fine reference integral, getParameter and getParameterFast agree
+  {
+    double lengthError = std::abs(referenceLength(spline, 0.0, (double)(n - 1)) - length);
+    ok = check(lengthError < 1e-6 * length, "arc length differs from the reference by " + std::to_string(lengthError)) && ok;
+
+    double parameterError = 0.0, fastDifference = 0.0;
+    for(unsigned int i = 0; i <= 200; i++)
+    {
+      double d = length * i / 200.0;
+      double u = spline.getParameter(d);
+      parameterError = std::max(parameterError, std::abs(referenceLength(spline, 0.0, u) - d));
+      fastDifference = std::max(fastDifference, std::abs(spline.getParameterFast(d) - u));
+    }
+    for(unsigned int i = 0; i <= 100000; i++)
+    {
+      double d = length * i / 100000.0;
+      fastDifference = std::max(fastDifference, std::abs(spline.getParameterFast(d) - spline.getParameter(d)));
+    }
+    ok = check(parameterError < 1e-3, "getParameter misses the distance by " + std::to_string(parameterError)) && ok;
+    ok = check(fastDifference < 1e-12, "getParameter and getParameterFast differ by " + std::to_string(fastDifference)) && ok;
+  }
+
+  //Uniform samples are equally far apart along the curve. Around the short segment 2 the speed changes tenfold
+  //within a segment, which needs a finer table than the default. An even loop already works with the default
+  std::vector<dvec3> ring;
+  for(unsigned int i = 0; i < 8; i++)
+    ring.push_back(dvec3(std::cos(i * 0.785398) * 3.0, std::sin(i * 0.785398) * 2.0, (i % 2) * 0.5));
+  dspline3 loop(SplineType::CATMULL_ROM, ring, true), fine = spline;
+  fine.setSamplesPerSegment(64);
+  for(const dspline3* path : { &loop, &fine })
+  {
+    const size_t COUNT = 2000;
+    double step = path->getLength() / (path->isClosed() ? COUNT : COUNT - 1), stepError = 0.0, previous = 0.0;
+    std::vector<dvec3> uniform(COUNT);
+    path->sampleUniform(uniform.data(), COUNT);
+    for(size_t i = 1; i <= (path->isClosed() ? COUNT : COUNT - 1); i++)
+    {
+      double u = i < COUNT ? path->getParameterFast(i * step) : (double)path->getSegmentCount();
+      stepError = std::max(stepError, std::abs(referenceLength(*path, previous, u, 20) - step));
+      stepError = std::max(stepError, difference(uniform[i % COUNT], path->evaluate(u)) * (i < COUNT));
+      previous = u;
+    }
+    std::string name = path->isClosed() ? "uniform samples around a loop" : "uniform samples with 64 samples per segment";
+    ok = check(stepError < 1e-3 * step, name + ": steps differ by " + std::to_string(stepError) + " from " + std::to_string(step)) && ok;
+  }
+
+  //Uniform samples include both ends, batched samples match single lookups
+  {
+    const size_t COUNT = 5000;
+    std::vector<dvec3> uniform(COUNT);
+    spline.sampleUniform(uniform.data(), COUNT);
+    ok = check(difference(uniform.front(), points.front()) < 1e-12 && difference(uniform.back(), points.back()) < 1e-9, "uniform samples have to start and end at the end points") && ok;
+
+    std::vector<double> distances(COUNT);
+    std::vector<dvec3> positions(COUNT), tangents(COUNT);
+    for(size_t i = 0; i < COUNT; i++)
+      distances[i] = length * (double)((i * 7919) % COUNT) / COUNT;
+    spline.sample(distances.data(), positions.data(), tangents.data(), COUNT);
+    bool batchMatches = true;
+    for(size_t i = 0; i < COUNT; i++)
+      batchMatches = batchMatches && positions[i] == spline.evaluateAtDistance(distances[i]) && tangents[i] == spline.tangent(spline.getParameterFast(distances[i]));
+    ok = check(batchMatches, "batched samples have to match single lookups") && ok;
+  }
+
+  //Hermite: the ends and every knot have the given position and tangent
+  {
+    std::vector<dvec3> tangents(n);
+    for(size_t i = 0; i < n; i++)
+      tangents[i] = dvec3(1.0, -2.0, 0.5) * (double)i - dvec3(3.0, 0.0, 1.0);
+    dspline3 hermite(SplineType::HERMITE);
+    hermite.setHermite(points.data(), tangents.data(), n);
+    double error = 0.0;
+    for(size_t i = 0; i < n; i++)
+    {
+      error = std::max(error, difference(hermite.evaluate((double)i), points[i]));
+      error = std::max(error, difference(hermite.tangent((double)i), tangents[i]));
+      if(i > 0)
+        error = std::max(error, difference(hermite.tangent(i - 1e-12), tangents[i]) * 1e-3);
+    }
+    ok = check(hermite.getType() == SplineType::HERMITE && hermite.getSegmentCount() == n - 1, "Hermite: type and segment count") && ok;
+    ok = check(error < 1e-9, "Hermite: misses the points or tangents by " + std::to_string(error)) && ok;
+
+    hermite.setHermite(points.data(), tangents.data(), n, true);
+    double closing = std::max(difference(hermite.evaluate((double)n), points[0]), difference(hermite.tangent((double)n), tangents[0]));
+    ok = check(hermite.getSegmentCount() == n && closing < 1e-12, "closed Hermite: has to end at the first point and tangent") && ok;
+  }
+
+  //B-spline: open splines are clamped to the end points, closed ones pass (p[i-1] + 4 p[i] + p[i+1]) / 6, both C1
+  {
+    dspline3 open(SplineType::BSPLINE, points), closed(SplineType::BSPLINE, points, true);
+    double segments = (double)open.getSegmentCount();
+    ok = check(open.getSegmentCount() == n + 1 && closed.getSegmentCount() == n, "B-spline: segment count") && ok;
+    ok = check(difference(open.evaluate(0.0), points.front()) < 1e-12 && difference(open.evaluate(segments), points.back()) < 1e-12, "open B-spline: has to start and end at the end points") && ok;
+    dvec3 startDirection = open.evaluate(1e-3) - points.front(), endDirection = points.back() - open.evaluate(segments - 1e-3);
+    dvec3 firstEdge = points[1] - points[0], lastEdge = points[n - 1] - points[n - 2];
+    double startAlignment = dvec3::dot(startDirection, firstEdge) / (norm(startDirection) * norm(firstEdge));
+    double endAlignment = dvec3::dot(endDirection, lastEdge) / (norm(endDirection) * norm(lastEdge));
+    ok = check(startAlignment > 0.999 && endAlignment > 0.999, "open B-spline: has to leave and reach the ends along the control polygon") && ok;
+
+    double error = 0.0;
+    for(size_t i = 0; i < n; i++)
+      error = std::max(error, difference(closed.evaluate((double)i), (points[(i + n - 1) % n] + points[i] * 4.0 + points[(i + 1) % n]) / 6.0));
+    ok = check(error < 1e-12, "closed B-spline: knot positions differ by " + std::to_string(error)) && ok;
+    ok = check(jointError(open) < 1e-6 && jointError(closed) < 1e-6, "B-spline: tangent direction jumps at the joins") && ok;
+  }
+
+  return ok ? 0 : 1;
+}
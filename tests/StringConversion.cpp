@@ -0,0 +1,152 @@
+#include <gum-maths.h>
+#include <cstring>
+#include <random>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+template<typename T>
+bool sameBits(const T& a, const T& b)
+{
+  return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+//Random finite bit patterns, denormals included, written in the shortest form and parsed back
+template<typename T, typename Bits>
+bool testNumbers(const std::string& name)
+{
+  bool ok = true;
+  std::mt19937_64 rng(5);
+  std::vector<T> values = { (T)0, -(T)0, (T)1, (T)-1, (T)0.1, std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest(),
+                            std::numeric_limits<T>::min(), std::numeric_limits<T>::denorm_min(), std::numeric_limits<T>::epsilon() };
+  while(values.size() < 200000)
+  {
+    Bits bits = (Bits)rng();
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    if(std::isfinite(value))
+      values.push_back(value);
+  }
+
+  size_t wrong = 0, unparsed = 0;
+  std::string text;
+  for(const T& value : values)
+  {
+    text.clear();
+    appendNumber(text, value);
+    std::string_view view(text);
+    T back;
+    if(!parseNumber(view, back) || !view.empty())
+      unparsed++;
+    else if(!sameBits(back, value))
+      wrong++;
+  }
+  ok = check(unparsed == 0 && wrong == 0, name + ": " + std::to_string(unparsed) + " numbers did not parse, " + std::to_string(wrong) + " did not read back exactly") && ok;
+
+  //Fixed notation, numbers too long for the buffer fall back to the shortest form
+  text.clear();
+  appendNumber(text, (T)1.5, 2);
+  ok = check(text == "1.50", name + ": fixed precision gave " + text) && ok;
+  text.clear();
+  appendNumber(text, std::numeric_limits<T>::max(), 6);
+  std::string_view view(text);
+  T back;
+  ok = check(parseNumber(view, back) && back == std::numeric_limits<T>::max(), name + ": fixed notation of the largest value gave " + text) && ok;
+  return ok;
+}
+
+template<typename T>
+bool testTypes(const std::string& name)
+{
+  bool ok = true;
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<T> value(-1000, 1000);
+  size_t wrong = 0;
+  for(unsigned int i = 0; i < 2000; i++)
+  {
+    tvec<T, 3> v(value(rng), value(rng), value(rng) * (T)1e-30);
+    tvec<T, 3> vback;
+    wrong += !tvec<T, 3>::fromString(v.toString("vec3(", ")", ", ", -1), vback) || !(vback == v);
+
+    mat<T, 4, 4> m;
+    for(unsigned int c = 0; c < 4; c++)
+      for(unsigned int r = 0; r < 4; r++)
+        m[c][r] = value(rng) / (T)7;
+    mat<T, 4, 4> mback, multiline;
+    bool parsed = mat<T, 4, 4>::fromString(m.toString(true, "mat4(", ")", ", ", -1), mback)
+               && mat<T, 4, 4>::fromString(m.toString(false, "mat4(", ")", ", ", -1), multiline);
+    for(unsigned int c = 0; c < 4; c++)
+      for(unsigned int r = 0; r < 4; r++)
+        parsed = parsed && mback[c][r] == m[c][r] && multiline[c][r] == m[c][r];
+    wrong += !parsed;
+
+    quat<T> q(value(rng), value(rng), value(rng), value(rng));
+    quat<T> qback;
+    wrong += !quat<T>::fromString(q.toString("quat(", ")", ",", -1), qback) || qback.w != q.w || qback.x != q.x || qback.y != q.y || qback.z != q.z;
+  }
+  ok = check(wrong == 0, name + ": " + std::to_string(wrong) + " vec, mat or quat strings did not read back exactly") && ok;
+
+  //The default formatting stays short and still parses
+  tvec<T, 3> rounded;
+  ok = check(tvec<T, 3>(1, (T)2.5, -3).toString() == "vec3(1.00, 2.50, -3.00)", name + ": default vec3 string " + tvec<T, 3>(1, (T)2.5, -3).toString()) && ok;
+  ok = check(tvec<T, 3>::fromString(tvec<T, 3>((T)0.25, 2, -3).toString(), rounded) && rounded == tvec<T, 3>((T)0.25, 2, -3), name + ": default vec3 string did not parse") && ok;
+  mat<T, 3, 3> identity;
+  ok = check(mat<T, 3, 3>::fromString(mat<T, 3, 3>().toString(false), identity) && identity[0][0] == 1 && identity[1][0] == 0, name + ": default mat3 string did not parse") && ok;
+
+  //Missing, incomplete and malformed numbers are rejected
+  size_t accepted = 0;
+  for(const char* text : { "", "vec3()", "vec3(1, 2)", "vec3(1, x, 3)", "(1;;a)", "1 2", "+-1 2 3", "--1 2 3", "vec3(1, 2, )", "abc" })
+  {
+    tvec<T, 3> out(7, 7, 7);
+    if(tvec<T, 3>::fromString(text, out))
+      accepted++;
+  }
+  for(const char* text : { "mat3(1, 2, 3, 4, 5, 6, 7, 8)", "1 2 3 4 5 6 7 8 nine" })
+  {
+    mat<T, 3, 3> out;
+    if(mat<T, 3, 3>::fromString(text, out))
+      accepted++;
+  }
+  quat<T> q;
+  accepted += quat<T>::fromString("quat(1,0,0)", q);
+  ok = check(accepted == 0, name + ": " + std::to_string(accepted) + " malformed strings were accepted") && ok;
+
+  std::string_view view("  +-5");
+  T number = 3;
+  ok = check(!parseNumber(view, number) && view == "  +-5" && number == 3, name + ": a failed parse has to leave the input untouched") && ok;
+  view = "\t+4.5, 6";
+  ok = check(parseNumber(view, number) && number == (T)4.5 && view == ", 6", name + ": whitespace and a leading + have to be skipped") && ok;
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = testNumbers<float, uint32_t>("float");
+  ok = testNumbers<double, uint64_t>("double") && ok;
+  ok = testTypes<float>("float") && ok;
+  ok = testTypes<double>("double") && ok;
+
+  //Integers and booleans
+  std::string text;
+  for(long long value : { std::numeric_limits<long long>::min(), -1LL, 0LL, std::numeric_limits<long long>::max() })
+  {
+    text.clear();
+    appendNumber(text, value);
+    std::string_view view(text);
+    long long back = 1;
+    ok = check(parseNumber(view, back) && back == value, "integer " + text + " did not read back") && ok;
+  }
+  bvec3 flags;
+  ok = check(bvec3::fromString(bvec3(true, false, true).toString(), flags) && flags == bvec3(true, false, true), "bvec3 did not read back") && ok;
+  uivec3 unsigned3;
+  ok = check(!uivec3::fromString("uivec3(1, -2, 3)", unsigned3), "negative unsigned component was accepted") && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include <gum-maths.h>
+#include <algorithm>
+#include <numeric>
+
+template<typename T>
+bool check(bool condition, const T& message)
+{
+  if(!condition)
+    std::cerr << "Unit test failed: " << message << std::endl;
+  return condition;
+}
+
+using namespace Gum::Maths;
+
+//Runs one job over [offset, offset + count) and checks that every index was visited exactly once, inside the range
+//and by a valid worker
+static bool coversOnce(ThreadPool& pool, size_t offset, size_t count, size_t grain)
+{
+  std::vector<std::atomic<uint32_t>> visits(count);
+  std::atomic<size_t> outside(0), badWorkers(0);
+  pool.parallelFor(offset, offset + count, [&](size_t b, size_t e, unsigned int worker) {
+    if(b < offset || e > offset + count || b >= e)
+      outside++;
+    if(worker >= pool.numWorkers())
+      badWorkers++;
+    for(size_t i = b; i < e && i < offset + count; i++)
+      if(i >= offset)
+        visits[i - offset]++;
+  }, grain);
+
+  size_t wrong = 0;
+  for(const std::atomic<uint32_t>& v : visits)
+    wrong += v != 1;
+  return check(wrong == 0 && outside == 0 && badWorkers == 0, std::to_string(pool.numWorkers()) + " workers, " + std::to_string(count) + " indices, grain " + std::to_string(grain)
+             + ": " + std::to_string(wrong) + " indices not visited exactly once, " + std::to_string(outside) + " chunks outside the range");
+}
+
+int main(int argc, char** argv)
+{
+  bool ok = true;
+  ThreadPool single(1), four(4), seven(7);
+
+  //Exactly once coverage, for ranges below, around and far above the grain, and empty ranges
+  for(ThreadPool* pool : { &single, &four, &seven, &ThreadPool::getDefault() })
+    for(size_t count : { 0, 1, 2, 7, 1000, 100003 })
+      for(size_t grain : { 0, 1, 64, 5000 })
+        ok = coversOnce(*pool, 17, count, grain) && ok;
+
+  size_t calls = 0;
+  seven.parallelFor(10, 10, [&](size_t, size_t, unsigned int) { calls++; });
+  seven.parallelFor(10, 5, [&](size_t, size_t, unsigned int) { calls++; });
+  parallelFor(3, 3, [&](size_t, size_t) { calls++; });
+  ok = check(calls == 0, "empty ranges must not call the function") && ok;
+  ok = check(parallelReduce(5, 5, 0, [](size_t, size_t, int acc) { return acc + 1; }, [](int a, int b) { return a + b; }) == 0, "reducing an empty range has to give the identity") && ok;
+
+  //Many short jobs back to back, workers that wake up late must not mix up two jobs
+  {
+    size_t wrong = 0;
+    std::vector<std::atomic<uint32_t>> visits(64);
+    for(unsigned int job = 1; job <= 20000; job++)
+    {
+      seven.parallelFor(0, visits.size(), [&](size_t b, size_t e, unsigned int) {
+        for(size_t i = b; i < e; i++)
+          visits[i]++;
+      }, 1);
+      wrong += visits[job % 64] != job;
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " short jobs did not cover their range") && ok;
+  }
+
+  //Nested calls run serially on the same pool and still cover everything, another pool runs in parallel
+  for(ThreadPool* inner : { &seven, &four })
+  {
+    const size_t rows = 64, columns = 1000;
+    std::vector<std::atomic<uint32_t>> visits(rows * columns);
+    seven.parallelFor(0, rows, [&](size_t rb, size_t re, unsigned int) {
+      for(size_t r = rb; r < re; r++)
+      {
+        inner->parallelFor(0, columns, [&, r](size_t cb, size_t ce, unsigned int) {
+          for(size_t c = cb; c < ce; c++)
+            visits[r * columns + c]++;
+        }, 16);
+      }
+    }, 1);
+    size_t wrong = 0;
+    for(const std::atomic<uint32_t>& v : visits)
+      wrong += v != 1;
+    ok = check(wrong == 0, std::string(inner == &seven ? "nested on the same pool: " : "nested on another pool: ") + std::to_string(wrong) + " indices not visited exactly once") && ok;
+  }
+
+  //Two threads submitting to the same pool at once
+  {
+    std::vector<std::atomic<uint32_t>> visits(200000);
+    auto submit = [&](size_t b, size_t e) {
+      for(unsigned int repeat = 0; repeat < 50; repeat++)
+      {
+        four.parallelFor(b, e, [&](size_t cb, size_t ce, unsigned int) {
+          for(size_t i = cb; i < ce; i++)
+            visits[i]++;
+        }, 256);
+      }
+    };
+    std::thread other(submit, 0, visits.size() / 2);
+    submit(visits.size() / 2, visits.size());
+    other.join();
+    size_t wrong = 0;
+    for(const std::atomic<uint32_t>& v : visits)
+      wrong += v != 50;
+    ok = check(wrong == 0, "concurrent submitters: " + std::to_string(wrong) + " wrong visit counts") && ok;
+  }
+
+  //Reductions with associative and commutative operations give the serial result on every run
+  {
+    const size_t COUNT = 1000003;
+    std::vector<uint64_t> values(COUNT);
+    std::vector<float> floats(COUNT);
+    for(size_t i = 0; i < COUNT; i++)
+    {
+      values[i] = (i * 2654435761u) % 1000003;
+      floats[i] = (float)values[i] * 0.37f - 5000.0f;
+    }
+    uint64_t expectedSum = std::accumulate(values.begin(), values.end(), (uint64_t)0);
+    float expectedMax = *std::max_element(floats.begin(), floats.end());
+    uint64_t expectedRanged = 0;
+    for(size_t i = 0; i < COUNT; i++)
+      expectedRanged += values[i] * i;
+
+    size_t wrong = 0;
+    for(unsigned int run = 0; run < 20; run++)
+    {
+      uint64_t sum = parallelReduce(span<const uint64_t>(values.data(), values.size()), (uint64_t)0,
+        [](uint64_t acc, uint64_t v) { return acc + v; }, [](uint64_t a, uint64_t b) { return a + b; }, run % 2 ? 0 : 1000);
+      float max = parallelReduce(span<const float>(floats.data(), floats.size()), -std::numeric_limits<float>::infinity(),
+        [](float acc, float v) { return std::max(acc, v); }, [](float a, float b) { return std::max(a, b); });
+      uint64_t ranged = parallelReduce(0, COUNT, (uint64_t)0, [&](size_t b, size_t e, uint64_t acc) {
+        for(size_t i = b; i < e; i++)
+          acc += values[i] * i;
+        return acc;
+      }, [](uint64_t a, uint64_t b) { return a + b; });
+      wrong += sum != expectedSum || max != expectedMax || ranged != expectedRanged;
+    }
+    ok = check(wrong == 0, std::to_string(wrong) + " of 20 reductions differ from the serial result") && ok;
+
+    std::vector<float> out(COUNT);
+    parallelTransform(span<const float>(floats.data(), floats.size()), span<float>(out.data(), out.size()), [](float v) { return v * 2.0f; });
+    size_t transformed = 0;
+    for(size_t i = 0; i < COUNT; i++)
+      transformed += out[i] != floats[i] * 2.0f;
+    ok = check(transformed == 0, std::to_string(transformed) + " wrong parallelTransform results") && ok;
+  }
+
+  return ok ? 0 : 1;
+}